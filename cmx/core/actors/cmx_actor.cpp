@@ -3,6 +3,7 @@
 // cmx
 #include "cmx_component.h"
 #include "cmx_register.h"
+#include "cmx_scene_records.h"
 #include "cmx_utils.h"
 
 // lib
@@ -38,17 +39,22 @@ Actor::~Actor()
 
 void Actor::despawn()
 {
-    _state = State::DEAD;
+    _scene->defer([this]() {
+        _state = State::DEAD;
 
-    for (auto &pair : _components)
-    {
-        pair.second->setParent(nullptr);
-    }
+        for (auto &pair : _components)
+        {
+            pair.second->setParent(nullptr);
+        }
+    });
 }
 
 std::shared_ptr<Component> Actor::attachComponent(std::shared_ptr<Component> component, std::string componentName,
                                                   bool force)
 {
+    // resolved here on the main thread, before any update may query it
+    component->getTypeInfo();
+
     componentName = (componentName.compare("") == 0) ? component->getType() : componentName;
 #ifndef NDEBUG
     // expensive operation so we only use it in debug mode
@@ -83,6 +89,7 @@ std::shared_ptr<Component> Actor::attachComponent(std::shared_ptr<Component> com
 
     _components[component->name] = component;
     getScene()->addComponent(component);
+    markDirty();
 
     return component;
 }
@@ -98,6 +105,7 @@ void Actor::detachComponent(const std::string &componentName)
 
     it->second->setParent(nullptr);
     _components.erase(componentName);
+    markDirty();
 
     spdlog::info("Actor {0}: Removed component <{1}>", name, componentName);
 }
@@ -131,14 +139,16 @@ Transform Actor::getWorldSpaceTransform() const
 
 void Actor::editor()
 {
-    ImGui::Checkbox("is visible", &_isVisible);
+    _dirty |= ImGui::Checkbox("is visible", &_isVisible);
+    _dirty |= ImGui::DragFloat("tick interval", &_tickInterval, 0.01f, 0.f, 10.f, "%.2fs");
+    _dirty |= ImGui::Checkbox("tick LOD", &_tickLOD);
 
     // if (auto camera = getScene()->getCamera().lock())
     // {
     //     Transformable::editor(camera.get());
     // }
 
-    _transform.editor();
+    _dirty |= _transform.editor();
 
     int i = 0;
     if (_components.size() > 0)
@@ -213,6 +223,8 @@ tinyxml2::XMLElement &Actor::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLEleme
     actorElement->SetAttribute("name", name.c_str());
     actorElement->SetAttribute("id", _id);
     actorElement->SetAttribute("visible", _isVisible);
+    actorElement->SetAttribute("tickInterval", _tickInterval);
+    actorElement->SetAttribute("tickLOD", _tickLOD);
 
     _transform.save(doc, actorElement);
 
@@ -229,6 +241,8 @@ tinyxml2::XMLElement &Actor::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLEleme
 void Actor::load(tinyxml2::XMLElement *actorElement)
 {
     _isVisible = actorElement->BoolAttribute("visible");
+    _tickInterval = actorElement->FloatAttribute("tickInterval", _tickInterval);
+    _tickLOD = actorElement->BoolAttribute("tickLOD", _tickLOD);
 
     if (tinyxml2::XMLElement *transformElement = actorElement->FirstChildElement("transform"))
     {
@@ -250,6 +264,54 @@ void Actor::load(tinyxml2::XMLElement *actorElement)
     }
 }
 
+void Actor::writeRecord(RecordWriter &writer) const
+{
+    ActorRecord record{writer.addString(getType()), writer.addString(name), _isVisible, _tickLOD, _tickInterval};
+    _transform.writeRecord(record.transform);
+    record.componentCount = uint32_t(_components.size());
+    writer.write(record);
+
+    for (auto &[componentName, component] : _components)
+    {
+        const size_t offset = writer.size();
+        component->writeRecord(writer);
+        writer.at<ComponentRecord>(offset).size = uint32_t(writer.size() - offset - sizeof(ComponentRecord));
+    }
+}
+
+void Actor::readRecord(RecordReader &reader, const ActorRecord &record)
+{
+    _isVisible = record.visible != 0;
+    _tickInterval = record.tickInterval;
+    _tickLOD = record.tickLOD != 0;
+    _transform.readRecord(record.transform);
+
+    for (uint32_t i = 0; i < record.componentCount; i++)
+    {
+        const ComponentRecord *componentRecord = reader.read<ComponentRecord>();
+        if (componentRecord == nullptr)
+        {
+            spdlog::error("Actor {0}: component records are truncated", name);
+            return;
+        }
+        const size_t end = reader.tell() + componentRecord->size;
+
+        if (const ComponentBuilder *builder = reader.getComponentBuilder(componentRecord->type))
+        {
+            const char *componentName = reader.getString(componentRecord->name);
+            attachComponent((*builder)(), componentName)->readRecord(reader, *componentRecord);
+        }
+        else
+        {
+            spdlog::error("Actor {0}: component type '{1}' not found in register", name,
+                          reader.getString(componentRecord->type));
+        }
+
+        // skips whatever the component's type didn't read
+        reader.seek(end);
+    }
+}
+
 #ifdef _WIN32
 std::string Actor::getType() const
 {
@@ -12,6 +12,7 @@
 #include <tinyxml2.h>
 
 // std
+#include <atomic>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -53,6 +54,9 @@ class Actor : public std::enable_shared_from_this<Actor>, public Transformable
 
     virtual tinyxml2::XMLElement &save(tinyxml2::XMLDocument &, tinyxml2::XMLElement *) const;
     virtual void load(tinyxml2::XMLElement *);
+    // fixed layout counterparts of save and load, see cmx_scene_records.h
+    virtual void writeRecord(class RecordWriter &) const;
+    virtual void readRecord(class RecordReader &, const struct ActorRecord &);
     virtual void editor();
 
     std::shared_ptr<class Component> attachComponent(std::shared_ptr<class Component>, std::string name = "",
@@ -72,6 +76,12 @@ class Actor : public std::enable_shared_from_this<Actor>, public Transformable
         return _scene;
     }
 
+    // nullptr while parked in a SceneSnapshot, so the parked actor can't reach the playing scene
+    void setScene(Scene *scene)
+    {
+        _scene = scene;
+    }
+
     bool isVisible() const
     {
         return _isVisible;
@@ -80,6 +90,7 @@ class Actor : public std::enable_shared_from_this<Actor>, public Transformable
     void setVisible(bool newState)
     {
         _isVisible = newState;
+        markDirty();
     }
 
     void reparent(std::shared_ptr<Actor> actor)
@@ -102,6 +113,54 @@ class Actor : public std::enable_shared_from_this<Actor>, public Transformable
     {
         return _state == State::DEAD;
     }
+
+    TickGroup getTickGroup() const
+    {
+        return _tickGroup;
+    }
+
+    bool hasThreadSafeUpdate() const
+    {
+        return _threadSafeUpdate;
+    }
+
+    float getTickInterval() const
+    {
+        return _tickInterval;
+    }
+
+    void setTickInterval(float tickInterval)
+    {
+        _tickInterval = tickInterval;
+        markDirty();
+    }
+
+    bool hasTickLOD() const
+    {
+        return _tickLOD;
+    }
+
+    void setTickLOD(bool tickLOD)
+    {
+        _tickLOD = tickLOD;
+        markDirty();
+    }
+
+    bool isDirty() const
+    {
+        return _dirty;
+    }
+
+    // set by the actor's setters, its components' and their editors
+    void markDirty() override
+    {
+        _dirty = true;
+    }
+
+    void clearDirty()
+    {
+        _dirty = false;
+    }
     // getters and setters :: end
 
     // friend functions
@@ -116,6 +175,19 @@ class Actor : public std::enable_shared_from_this<Actor>, public Transformable
   protected:
     State _state{State::LIVING};
 
+    // set in onBegin, a thread safe update only touches the actor itself and goes through spawn, despawn or
+    // Scene::defer for anything else, it may then run alongside other actors of the same tick group
+    TickGroup _tickGroup{TickGroup::POST_PHYSICS};
+    bool _threadSafeUpdate{false};
+
+    // seconds between two updates, 0 ticks every frame, the scene may raise it for actors far from the camera
+    // when they opt into tick LOD, only cosmetic actors should, gameplay would silently run at a few hertz
+    float _tickInterval{0.f};
+    bool _tickLOD{false};
+
+    // changed since the scene last serialized it
+    bool _dirty{true};
+
     Actor(Scene *, uint32_t id, const std::string &name, const Transform &);
     std::weak_ptr<Actor> _parent;
 
@@ -125,10 +197,10 @@ class Actor : public std::enable_shared_from_this<Actor>, public Transformable
 
     std::unordered_map<std::string, std::shared_ptr<Component>> _components{};
 
-    static uint32_t _idProvider;
+    static std::atomic<uint32_t> _idProvider;
 };
 
-inline uint32_t Actor::_idProvider = 0;
+inline std::atomic<uint32_t> Actor::_idProvider{0};
 
 template <typename T> inline T *Actor::spawn(Scene *scene, const char *name, const Transform &transform)
 {
@@ -157,11 +229,20 @@ template <typename T> inline std::weak_ptr<T> Actor::getComponentByType()
         return std::weak_ptr<T>();
     }
 
+    if constexpr (ComponentType<T>::id == 0)
+    {
+        spdlog::error("'{0}' isn't registered, use REGISTER_COMPONENT, 'getComponentByType<{1}>' will always return "
+                      "invalid pointer",
+                      typeid(T).name(), typeid(T).name());
+        return std::weak_ptr<T>();
+    }
+
+    // exact type only, a subclass is registered under its own id
     for (const auto &component : _components)
     {
-        if (auto castedComponent = std::dynamic_pointer_cast<T>(component.second))
+        if (component.second->getTypeID() == ComponentType<T>::id)
         {
-            return castedComponent;
+            return std::static_pointer_cast<T>(component.second);
         }
     }
 
@@ -0,0 +1,286 @@
+#include "cmx_benchmark.h"
+
+// cmx
+#include "cmx_device.h"
+#include "cmx_game.h"
+#include "cmx_gpu_profiler.h"
+#include "cmx_graphics_manager.h"
+#include "cmx_render_system.h"
+#include "cmx_scene.h"
+#include "cmx_scene_file.h"
+#include "cmx_window.h"
+
+// lib
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace cmx
+{
+
+namespace
+{
+
+// exits rather than falling back to a windowed run, which would never return on a CI machine
+int parsePositive(const char *option, const char *value)
+{
+    char *end = nullptr;
+    const long parsed = value ? std::strtol(value, &end, 10) : 0;
+    if (value == nullptr || *end != '\0' || parsed <= 0)
+    {
+        std::cerr << "Benchmark: " << option << " expects a positive integer" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    return int(parsed);
+}
+
+// a GPU scope summed over every frame read back, matched by name and nesting
+struct GpuTotal
+{
+    std::string name;
+    uint32_t depth;
+    float milliseconds;
+};
+
+void printRow(const std::string &label, float milliseconds)
+{
+    std::cout << "  " << std::left << std::setw(18) << label << std::right << std::setw(10) << milliseconds << " ms"
+              << std::endl;
+}
+
+} // namespace
+
+Benchmark::Benchmark(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *option = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(option, "--frames") == 0)
+        {
+            _frames = uint32_t(parsePositive(option, value));
+        }
+        else if (std::strcmp(option, "--load-runs") == 0)
+        {
+            _loadRuns = uint32_t(parsePositive(option, value));
+        }
+        else if (std::strcmp(option, "--width") == 0)
+        {
+            _width = parsePositive(option, value);
+        }
+        else if (std::strcmp(option, "--height") == 0)
+        {
+            _height = parsePositive(option, value);
+        }
+        else if (std::strcmp(option, "--scene") == 0 && value)
+        {
+            _scene = value;
+        }
+        else if (std::strcmp(option, "--dump") == 0 && value)
+        {
+            _dumpPath = value;
+        }
+        else
+        {
+            std::cerr << "Benchmark: ignoring unknown argument `" << option << "`" << std::endl;
+            continue;
+        }
+        i++;
+    }
+
+    if (!isEnabled())
+    {
+        if (!_scene.empty() || !_dumpPath.empty())
+        {
+            std::cerr << "Benchmark: --scene and --dump only apply with --frames or --load-runs" << std::endl;
+        }
+        return;
+    }
+
+    Window &window = Game::getWindow();
+    window.setExtent(_width > 0 ? _width : Game::WIDTH, _height > 0 ? _height : Game::HEIGHT);
+    window.open(true);
+}
+
+int Benchmark::run(Game &game)
+{
+    if (!_scene.empty())
+    {
+        const int index = game.findScene(_scene);
+        if (index < 0)
+        {
+            std::cerr << "Benchmark: no scene called `" << _scene << "`" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (game.getScene()->name != _scene)
+        {
+            game.setScene(size_t(index));
+        }
+    }
+
+    Scene *scene = game.getScene();
+    RenderSystem *renderSystem = RenderSystem::getInstance();
+
+    if (_loadRuns > 0)
+    {
+        measureLoads(scene);
+    }
+    if (_frames == 0)
+    {
+        scene->unload();
+        renderSystem->closeWindow();
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<float> frameTimes{};
+    frameTimes.reserve(_frames);
+    float updateTotal{0.f};
+    float renderTotal{0.f};
+    PassTimings passTotals{};
+
+    // results arrive MAX_FRAMES_IN_FLIGHT frames late, the last few frames are never read back
+    GpuProfiler *profiler = renderSystem->getProfiler();
+    uint64_t gpuResultCount = profiler->getResultCount();
+    uint32_t gpuFrames{0};
+    std::vector<GpuTotal> gpuTotals{};
+
+    for (uint32_t frame = 0; frame < _frames; frame++)
+    {
+        const auto frameStart = std::chrono::steady_clock::now();
+        scene->update(BENCHMARK_TIMESTEP);
+        const auto updateEnd = std::chrono::steady_clock::now();
+        scene->render();
+        const auto renderEnd = std::chrono::steady_clock::now();
+
+        const float update = std::chrono::duration<float, std::milli>(updateEnd - frameStart).count();
+        const float render = std::chrono::duration<float, std::milli>(renderEnd - updateEnd).count();
+        frameTimes.push_back(update + render);
+        updateTotal += update;
+        renderTotal += render;
+
+        const PassTimings &passTimings = scene->getGraphicsManager()->getPassTimings();
+        passTotals.shadows += passTimings.shadows;
+        passTotals.geometry += passTimings.geometry;
+        passTotals.postProcess += passTimings.postProcess;
+        passTotals.submit += passTimings.submit;
+
+        if (profiler->getResultCount() == gpuResultCount)
+            continue;
+
+        gpuResultCount = profiler->getResultCount();
+        gpuFrames++;
+        for (const GpuScope &gpuScope : profiler->getScopes())
+        {
+            auto it = std::find_if(gpuTotals.begin(), gpuTotals.end(), [&gpuScope](const GpuTotal &total) {
+                return total.depth == gpuScope.depth && total.name == gpuScope.name;
+            });
+            if (it == gpuTotals.end())
+            {
+                gpuTotals.push_back({gpuScope.name, gpuScope.depth, 0.f});
+                it = gpuTotals.end() - 1;
+            }
+            it->milliseconds += gpuScope.milliseconds;
+        }
+    }
+
+    renderSystem->getDevice()->device().waitIdle();
+
+    std::vector<float> &sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    const float frames = float(_frames);
+    const float average = std::accumulate(sorted.begin(), sorted.end(), 0.f) / frames;
+    const auto percentile = [&sorted](float p) { return sorted[size_t(p * float(sorted.size() - 1) + .5f)]; };
+
+    const vk::Extent2D resolution = Game::getWindow().getExtent();
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "benchmark: " << scene->name << ", " << _frames << " frames at " << resolution.width << "x"
+              << resolution.height << " on " << renderSystem->getDevice()->_properties.deviceName << std::endl;
+    std::cout << "frame" << std::endl;
+    printRow("average", average);
+    printRow("min", sorted.front());
+    printRow("median", percentile(.5f));
+    printRow("95th", percentile(.95f));
+    printRow("max", sorted.back());
+    std::cout << "average per frame (cpu)" << std::endl;
+    printRow("update", updateTotal / frames);
+    printRow("render", renderTotal / frames);
+    printRow("shadows", passTotals.shadows / frames);
+    printRow("geometry", passTotals.geometry / frames);
+    printRow("post process", passTotals.postProcess / frames);
+    printRow("submit", passTotals.submit / frames);
+    if (gpuFrames > 0)
+    {
+        std::cout << "average per frame (gpu, " << gpuFrames << " frames read back)" << std::endl;
+        for (const GpuTotal &total : gpuTotals)
+        {
+            printRow(std::string(total.depth * 2, ' ') + total.name, total.milliseconds / float(gpuFrames));
+        }
+    }
+
+    int result = EXIT_SUCCESS;
+    if (!_dumpPath.empty())
+    {
+        std::vector<uint8_t> pixels{};
+        vk::Extent2D extent{};
+        renderSystem->readLastFrame(pixels, extent);
+
+        if (stbi_write_png(_dumpPath.c_str(), int(extent.width), int(extent.height), 4, pixels.data(),
+                           int(extent.width) * 4) == 0)
+        {
+            std::cerr << "Benchmark: failed to write `" << _dumpPath << "`" << std::endl;
+            result = EXIT_FAILURE;
+        }
+        else
+        {
+            std::cout << "last frame written to " << _dumpPath << std::endl;
+        }
+    }
+
+    scene->unload();
+    renderSystem->closeWindow();
+
+    return result;
+}
+
+void Benchmark::measureLoads(Scene *scene) const
+{
+    RenderSystem::getInstance()->getDevice()->device().waitIdle();
+
+    // the scene's own file goes last, so it is the one left loaded
+    const std::string path = scene->getXMLPath();
+    const bool binary = SceneFile::isBinary(path);
+    const std::string other = path.substr(0, path.find_last_of('.')) + (binary ? ".xml" : CMX_SCENE_EXTENSION);
+    scene->saveAs(other.c_str(), true);
+
+    const std::string paths[2] = {other, path};
+    float totals[2] = {0.f, 0.f};
+    for (uint32_t run = 0; run < _loadRuns; run++)
+    {
+        for (size_t i = 0; i < 2; i++)
+        {
+            const auto loadStart = std::chrono::steady_clock::now();
+            scene->unload(true);
+            scene->loadFrom(paths[i], true);
+            totals[i] += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "load: " << scene->name << ", " << _loadRuns << " runs, assets kept" << std::endl;
+    printRow("xml", totals[binary ? 0 : 1] / float(_loadRuns));
+    printRow("binary", totals[binary ? 1 : 0] / float(_loadRuns));
+}
+
+} // namespace cmx
@@ -0,0 +1,49 @@
+#ifndef CMX_BENCHMARK
+#define CMX_BENCHMARK
+
+// std
+#include <cstdint>
+#include <string>
+
+// every benchmarked frame advances the scene by the same step, so runs stay comparable
+#define BENCHMARK_TIMESTEP (1.f / 60.f)
+
+namespace cmx
+{
+
+// headless runner, `--frames N [--scene name|index] [--width W] [--height H] [--dump frame.png]` renders N frames
+// offscreen and prints frame and per pass timings to stdout. `--load-runs N` first reloads the scene N times from
+// its xml and its .cmxscene, writing the missing one next to it, and prints the average load time of each.
+// Has to be built before the game so the window opens headless, without either option it does nothing and the game
+// runs as usual
+class Benchmark
+{
+  public:
+    Benchmark(int argc, char **argv);
+
+    Benchmark(const Benchmark &) = delete;
+    Benchmark &operator=(const Benchmark &) = delete;
+
+    // call after the game is loaded instead of running it, returns the process exit code
+    int run(class Game &);
+
+    bool isEnabled() const
+    {
+        return _frames > 0 || _loadRuns > 0;
+    }
+
+  private:
+    // assets are kept loaded between runs, only the scene itself is timed
+    void measureLoads(class Scene *) const;
+
+    uint32_t _frames{0};
+    uint32_t _loadRuns{0};
+    std::string _scene{};
+    std::string _dumpPath{};
+    int _width{0};
+    int _height{0};
+};
+
+} // namespace cmx
+
+#endif
@@ -3,7 +3,9 @@
 // cmx
 #include "cmx_actor.h"
 #include "cmx_input_manager.h"
+#include "cmx_render_system.h"
 #include "cmx_scene.h"
+#include "cmx_scene_loader.h"
 #include "cmx_sink.h"
 #include "cmx_window.h"
 
@@ -23,6 +25,8 @@
 #include <glm/gtc/constants.hpp>
 
 // std
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
 
 namespace cmx
@@ -35,6 +39,12 @@ Window Game::_window = Window{WIDTH, HEIGHT, "chamoix"};
 
 Game::Game()
 {
+    // the benchmark runner opens it headless before the game exists
+    if (!_window.isOpen())
+    {
+        _window.open();
+    }
+
     _inputManager = std::make_unique<InputManager>(_window);
 
 #ifdef NDEBUG
@@ -65,6 +75,102 @@ void Game::setScene(size_t i)
     }
 }
 
+int Game::findScene(const std::string &name) const
+{
+    for (size_t i = 0; i < _scenes.size(); i++)
+    {
+        if (_scenes[i]->name == name)
+        {
+            return int(i);
+        }
+    }
+
+    const bool isIndex = !name.empty() && name.size() < 10 &&
+                         std::all_of(name.begin(), name.end(), [](unsigned char c) { return std::isdigit(c); });
+    if (isIndex)
+    {
+        const size_t i = std::stoul(name);
+        if (i < _scenes.size())
+        {
+            return int(i);
+        }
+    }
+
+    return -1;
+}
+
+void Game::setSceneAsync(size_t i, std::function<void(float)> onProgress, std::function<void(Scene *)> onLoaded)
+{
+    if (i >= _scenes.size())
+    {
+        spdlog::error("Scene: no scene at index {0}", i);
+        return;
+    }
+
+    startSceneLoading(_scenes.at(i), _scenes.at(i)->getXMLPath(), onProgress, onLoaded);
+}
+
+void Game::reloadSceneAsync(const std::string &filepath, std::function<void(float)> onProgress,
+                            std::function<void(Scene *)> onLoaded)
+{
+    startSceneLoading(getScene(), filepath, onProgress, onLoaded);
+}
+
+void Game::startSceneLoading(Scene *scene, const std::string &filepath, std::function<void(float)> onProgress,
+                             std::function<void(Scene *)> onLoaded)
+{
+    if (_sceneLoader)
+    {
+        spdlog::warn("Game: a scene is already being loaded, ignoring request for `{0}`", filepath);
+        return;
+    }
+
+    _sceneLoader = std::make_unique<SceneLoader>(scene, filepath, onProgress);
+    _onSceneLoaded = onLoaded;
+}
+
+void Game::finishSceneLoading()
+{
+    RenderSystem *renderSystem = RenderSystem::getInstance();
+
+    while (_sceneLoader)
+    {
+        // keeps the window responsive
+        glfwPollEvents();
+        renderSystem->drawLoadingFrame(_sceneLoader->getProgress());
+
+        updateSceneLoading();
+    }
+}
+
+void Game::updateSceneLoading()
+{
+    if (!_sceneLoader)
+        return;
+
+    if (!_sceneLoader->update())
+        return;
+
+    // the assets are uploaded and the pipelines compiled by now, building the scene doesn't wait on the GPU
+    if (_activeScene != nullptr)
+    {
+        _activeScene->unload();
+        // bound to the actors that were just deleted
+        _inputManager->unbindAll();
+    }
+    _activeScene = _sceneLoader->getScene();
+    _activeScene->loadPrepared(*_sceneLoader);
+
+    _sceneLoader.reset();
+
+    if (_onSceneLoaded)
+    {
+        std::function<void(Scene *)> onLoaded = std::move(_onSceneLoaded);
+        _onSceneLoaded = nullptr;
+        onLoaded(_activeScene);
+    }
+}
+
 Scene *Game::newScene()
 {
     srand(static_cast<unsigned>(time(0)));
@@ -10,7 +10,9 @@
 
 // std
 #include <cstdlib>
+#include <functional>
 #include <memory>
+#include <string>
 
 namespace cmx
 {
@@ -34,9 +36,26 @@ class Game
     // getters and setters :: begin
     class Scene *getScene();
     void setScene(size_t i);
+    // index of the scene called name, or the index name spells out, -1 when there is none
+    int findScene(const std::string &name) const;
 
     class Scene *newScene();
 
+    // prepares the scene on worker threads while the active one keeps running, it replaces the active scene at the
+    // start of the first frame after it is ready, `onProgress` is called on the main thread with values in [0, 1]
+    // and `onLoaded` once the scene is active
+    void setSceneAsync(size_t i, std::function<void(float)> onProgress = nullptr,
+                       std::function<void(class Scene *)> onLoaded = nullptr);
+    // the same for the active scene, built again from another file
+    void reloadSceneAsync(const std::string &filepath, std::function<void(float)> onProgress = nullptr,
+                          std::function<void(class Scene *)> onLoaded = nullptr);
+    bool isLoadingScene() const
+    {
+        return _sceneLoader != nullptr;
+    }
+    // draws loading frames until the scene being loaded is active, for when there is nothing to run meanwhile
+    void finishSceneLoading();
+
     class InputManager *getInputManager() const
     {
         return _inputManager.get();
@@ -45,12 +64,19 @@ class Game
     // getters and setters :: end
 
   protected:
+    // call once per frame before updating the scene
+    void updateSceneLoading();
+    void startSceneLoading(class Scene *, const std::string &filepath, std::function<void(float)> onProgress,
+                           std::function<void(class Scene *)> onLoaded);
+
     class Scene *_activeScene{nullptr};
     std::vector<Scene *> _scenes;
 
     static Window _window;
 
     std::unique_ptr<class InputManager> _inputManager;
+    std::unique_ptr<class SceneLoader> _sceneLoader;
+    std::function<void(class Scene *)> _onSceneLoaded;
 
     // warning flags
     bool _noCameraFlag{false};
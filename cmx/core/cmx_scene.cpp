@@ -9,13 +9,17 @@
 #include "cmx_editor.h"
 #include "cmx_game.h"
 #include "cmx_graphics_manager.h"
+#include "cmx_job_system.h"
 #include "cmx_light_environment.h"
 #include "cmx_physics_body.h"
 #include "cmx_physics_manager.h"
 #include "cmx_register.h"
+#include "cmx_scene_file.h"
+#include "cmx_scene_loader.h"
 #include "cmx_utils.h"
 
 // std
+#include <chrono>
 #include <memory>
 #include <stdexcept>
 
@@ -31,6 +35,8 @@ Scene::Scene(const std::string &xmlPath, class Game *game, const std::string &na
 
 Scene::~Scene()
 {
+    waitForSave();
+
     for (auto &pair : _actors)
     {
         delete pair.second;
@@ -44,24 +50,53 @@ void Scene::load(bool skipAssets)
 
 void Scene::loadFrom(const std::string &filepath, bool skipAssets, bool absolute)
 {
-    if (!skipAssets)
+    _xmlPath = absolute ? filepath : std::string(GAME_FILES) + filepath;
+
+    const auto loadStart = std::chrono::steady_clock::now();
+
+    tinyxml2::XMLDocument doc;
+    SceneFile::File binaryFile{};
+    const bool binary = SceneFile::isBinary(_xmlPath);
+    const bool parsed =
+        binary ? binaryFile.open(_xmlPath, doc) : doc.LoadFile(_xmlPath.c_str()) == tinyxml2::XML_SUCCESS;
+    const std::chrono::duration<float, std::milli> parseTime = std::chrono::steady_clock::now() - loadStart;
+
+    if (build(doc, parsed, skipAssets, nullptr, binary ? &binaryFile : nullptr))
     {
-        _assetsManager = std::make_unique<AssetsManager>(this);
+        const std::chrono::duration<float, std::milli> loadTime = std::chrono::steady_clock::now() - loadStart;
+        spdlog::info("Scene {0}: {1} parsed in {2:.2f}ms, loaded in {3:.2f}ms", name, binary ? "binary" : "xml",
+                     parseTime.count(), loadTime.count());
     }
+}
 
-    _xmlPath = absolute ? filepath : std::string(GAME_FILES) + filepath;
+void Scene::loadPrepared(SceneLoader &loader)
+{
+    _xmlPath = loader.getFilepath();
 
-    _graphicsManager = std::make_unique<GraphicsManager>();
-    _physicsManager = std::make_unique<PhysicsManager>();
-    _lightEnvironment = std::make_unique<LightEnvironment>();
+    const auto loadStart = std::chrono::steady_clock::now();
 
-    _activeCamera = std::make_shared<Camera>();
-    _activeCamera->setViewDirection(glm::vec3{0.f}, glm::vec3{0.f, 0.f, 1.f});
+    if (build(loader.getDocument(), loader.isParsed(), false, &loader.getPreparedAssets(), loader.getBinaryFile()))
+    {
+        const std::chrono::duration<float, std::milli> loadTime = std::chrono::steady_clock::now() - loadStart;
+        spdlog::info("Scene {0}: prepared scene built in {1:.2f}ms", name, loadTime.count());
+    }
+}
+
+bool Scene::build(tinyxml2::XMLDocument &doc, bool parsed, bool skipAssets, PreparedAssets *preparedAssets,
+                  const SceneFile::File *binaryFile)
+{
+    invalidateSavedDocument();
+
+    if (!skipAssets)
+    {
+        _assetsManager = std::make_unique<AssetsManager>(this);
+    }
+
+    createManagers();
 
     Register &cmxRegister = Register::getInstance();
 
-    tinyxml2::XMLDocument doc;
-    if (doc.LoadFile(_xmlPath.c_str()) == tinyxml2::XML_SUCCESS)
+    if (parsed)
     {
         spdlog::info("Scene: Loading new scene from `{0}`...", _xmlPath);
 
@@ -70,14 +105,30 @@ void Scene::loadFrom(const std::string &filepath, bool skipAssets, bool absolute
 
         if (!skipAssets)
         {
-            _assetsManager->load(rootElement);
+            _assetsManager->load(rootElement, preparedAssets);
         }
-        else
+        else if (_assetsManager->getPostProcesses().empty())
         {
+            // still loaded when playing from a snapshot
             _assetsManager->loadPostProcesses(rootElement);
         }
+
+        if (binaryFile != nullptr)
+        {
+            RecordReader reader = binaryFile->getRecords();
+            if (!readRecords(reader))
+            {
+                spdlog::error("Scene {0}: records of `{1}` are corrupted, the scene is only partially loaded", name,
+                              _xmlPath);
+            }
+
+            spdlog::info("Scene {0}: Succesfully loaded new scene!", name);
+            return true;
+        }
+
         _lightEnvironment->load(rootElement);
         _graphicsManager->load(rootElement, _assetsManager.get());
+        _tickScheduler.load(rootElement);
 
         tinyxml2::XMLElement *actorElement = rootElement->FirstChildElement("actor");
         while (actorElement)
@@ -97,16 +148,95 @@ void Scene::loadFrom(const std::string &filepath, bool skipAssets, bool absolute
         }
 
         spdlog::info("Scene {0}: Succesfully loaded new scene!", name);
+        return true;
     }
-    else
+
+    spdlog::warn("Scene {0}: Couldn't load scene from `{1}`, {2}", name, _xmlPath, doc.ErrorStr());
+    return false;
+}
+
+void Scene::createManagers()
+{
+    _graphicsManager = std::make_unique<GraphicsManager>();
+    _physicsManager = std::make_unique<PhysicsManager>();
+    _lightEnvironment = std::make_unique<LightEnvironment>();
+
+    _activeCamera = std::make_shared<Camera>();
+    _activeCamera->setViewDirection(glm::vec3{0.f}, glm::vec3{0.f, 0.f, 1.f});
+}
+
+void Scene::writeRecords(RecordWriter &writer) const
+{
+    const size_t sceneOffset = writer.write(SceneRecord{writer.addString(name), 0});
+
+    _lightEnvironment->writeRecord(writer);
+    _graphicsManager->writeRecord(writer);
+    _tickScheduler.writeRecord(writer);
+
+    uint32_t actorCount = 0;
+    for (const auto &[id, actor] : _actors)
     {
-        spdlog::warn("Scene {0}: Couldn't load scene from `{1}`, {2}", name, _xmlPath, doc.ErrorStr());
+        const size_t offset = writer.size();
+        actor->writeRecord(writer);
+
+        // some actors opt out of saving by writing nothing
+        if (writer.size() == offset)
+        {
+            continue;
+        }
+
+        writer.at<ActorRecord>(offset).size = uint32_t(writer.size() - offset - sizeof(ActorRecord));
+        actorCount++;
+    }
+
+    writer.at<SceneRecord>(sceneOffset).actorCount = actorCount;
+}
+
+bool Scene::readRecords(RecordReader &reader)
+{
+    const SceneRecord *sceneRecord = reader.read<SceneRecord>();
+    if (sceneRecord == nullptr)
+    {
+        return false;
+    }
+
+    name = reader.getString(sceneRecord->name);
+
+    _lightEnvironment->readRecord(reader);
+    _graphicsManager->readRecord(reader, _assetsManager.get());
+    _tickScheduler.readRecord(reader);
+
+    for (uint32_t i = 0; i < sceneRecord->actorCount; i++)
+    {
+        const ActorRecord *record = reader.read<ActorRecord>();
+        if (record == nullptr)
+        {
+            break;
+        }
+        const size_t end = reader.tell() + record->size;
+
+        if (const ActorBuilder *builder = reader.getActorBuilder(record->type))
+        {
+            (*builder)(this, reader.getString(record->name))->readRecord(reader, *record);
+        }
+        else
+        {
+            spdlog::error("Scene {0}: No actor type <{1}> in register of actors", name,
+                          reader.getString(record->type));
+        }
+
+        // skips whatever the actor's type didn't read
+        reader.seek(end);
     }
+
+    return !reader.failed();
 }
 
 void Scene::unload(bool keepAssets)
 {
     spdlog::info("Scene {0}: Unloading scene...", name);
+    invalidateSavedDocument();
+
     if (!keepAssets)
     {
         _assetsManager->unload();
@@ -116,17 +246,144 @@ void Scene::unload(bool keepAssets)
     {
         _assetsManager->unloadPostProcesses();
     }
+
+    clear();
+    spdlog::info("Scene {0}: Succesfully unloaded scene!");
+}
+
+void Scene::clear()
+{
+    // actors and components first, they may still reach for the managers on their way out
+    for (auto &pair : _actors)
+    {
+        delete pair.second;
+    }
+    _actors = std::unordered_map<uint32_t, Actor *>{};
+    _components = std::vector<std::shared_ptr<Component>>{};
+
     delete _graphicsManager.release();
     delete _physicsManager.release();
     delete _lightEnvironment.release();
+    _tickScheduler.clear();
+    _dueTicks.clear();
+    _tickingActors.clear();
+}
 
-    for (auto &pair : _actors)
+SceneSnapshot::~SceneSnapshot()
+{
+    // same order as Scene::clear, the parked managers outlive the parked actors
+    for (auto &pair : actors)
     {
         delete pair.second;
     }
+    components.clear();
+
+    graphicsManager.reset();
+    physicsManager.reset();
+    lightEnvironment.reset();
+}
+
+std::unique_ptr<SceneSnapshot> Scene::takeSnapshot()
+{
+    const auto snapshotStart = std::chrono::steady_clock::now();
+
+    waitForSave();
+
+    auto snapshot = std::make_unique<SceneSnapshot>();
+    writeRecords(snapshot->records);
+
+    snapshot->name = name;
+    snapshot->camera = std::move(_activeCamera);
+    snapshot->actors = std::move(_actors);
+    snapshot->components = std::move(_components);
+    snapshot->tickScheduler = std::move(_tickScheduler);
+    snapshot->graphicsManager = std::move(_graphicsManager);
+    snapshot->physicsManager = std::move(_physicsManager);
+    snapshot->lightEnvironment = std::move(_lightEnvironment);
+    snapshot->document = std::move(_savedDocument);
+    snapshot->documentActors = std::move(_savedActors);
+    snapshot->documentAssets = _savedAssets;
+    snapshot->documentAssetElements = std::move(_savedAssetElements);
+    snapshot->dirty = _dirty;
+
     _actors = std::unordered_map<uint32_t, Actor *>{};
     _components = std::vector<std::shared_ptr<Component>>{};
-    spdlog::info("Scene {0}: Succesfully unloaded scene!");
+    _tickScheduler = TickScheduler{};
+    _savedActors = std::unordered_map<uint32_t, tinyxml2::XMLElement *>{};
+    _savedAssets = nullptr;
+    _savedAssetElements = AssetsManager::SavedElements{};
+
+    // parked, so nothing they do on their way out reaches the playing scene's managers
+    for (auto &[id, actor] : snapshot->actors)
+    {
+        actor->setScene(nullptr);
+    }
+    for (auto &component : snapshot->components)
+    {
+        component->setScene(nullptr);
+    }
+
+    const std::chrono::duration<float, std::milli> snapshotTime = std::chrono::steady_clock::now() - snapshotStart;
+    spdlog::info("Scene {0}: snapshot of {1} actors taken in {2:.2f}ms, {3} bytes of records", name,
+                 snapshot->actors.size(), snapshotTime.count(), snapshot->records.size());
+
+    return snapshot;
+}
+
+void Scene::loadSnapshot(SceneSnapshot &snapshot)
+{
+    const auto loadStart = std::chrono::steady_clock::now();
+
+    invalidateSavedDocument();
+    createManagers();
+
+    RecordReader reader{snapshot.records};
+    if (!readRecords(reader))
+    {
+        spdlog::error("Scene {0}: snapshot records are corrupted, the scene is only partially built", name);
+        return;
+    }
+
+    const std::chrono::duration<float, std::milli> loadTime = std::chrono::steady_clock::now() - loadStart;
+    spdlog::info("Scene {0}: built from snapshot in {1:.2f}ms", name, loadTime.count());
+}
+
+void Scene::restoreSnapshot(std::unique_ptr<SceneSnapshot> snapshot)
+{
+    const auto restoreStart = std::chrono::steady_clock::now();
+
+    invalidateSavedDocument();
+    clear();
+
+    name = snapshot->name;
+    _activeCamera = std::move(snapshot->camera);
+    _actors = std::move(snapshot->actors);
+    _components = std::move(snapshot->components);
+    _tickScheduler = std::move(snapshot->tickScheduler);
+    _graphicsManager = std::move(snapshot->graphicsManager);
+    _physicsManager = std::move(snapshot->physicsManager);
+    _lightEnvironment = std::move(snapshot->lightEnvironment);
+
+    for (auto &[id, actor] : _actors)
+    {
+        actor->setScene(this);
+    }
+    for (auto &component : _components)
+    {
+        component->setScene(this);
+    }
+
+    // the parked actors are the ones the document was made from, following saves stay incremental
+    _savedDocument = std::move(snapshot->document);
+    _savedActors = std::move(snapshot->documentActors);
+    _savedAssets = snapshot->documentAssets;
+    _savedAssetElements = std::move(snapshot->documentAssetElements);
+    _dirty = snapshot->dirty;
+
+    snapshot->actors = std::unordered_map<uint32_t, Actor *>{};
+
+    const std::chrono::duration<float, std::milli> restoreTime = std::chrono::steady_clock::now() - restoreStart;
+    spdlog::info("Scene {0}: snapshot restored in {1:.2f}ms", name, restoreTime.count());
 }
 
 Actor *Scene::getActorByName(const std::string &name)
@@ -171,6 +428,12 @@ void Scene::setCamera(std::shared_ptr<Camera> camera, bool bForce)
 
 void Scene::addActor(class Actor *actor)
 {
+    if (_deferCommands)
+    {
+        defer([this, actor]() { addActor(actor); });
+        return;
+    }
+
 #ifndef NDEBUG
     // expensive operation so we only use it in debug mode
     if (getActorByName(actor->name) != nullptr)
@@ -190,15 +453,28 @@ void Scene::addActor(class Actor *actor)
     }
 
     _actors[actor->_id] = actor;
+    _tickScheduler.schedule(actor->_id, 0.f);
     actor->onBegin();
     spdlog::info("Scene {0}: Added new Actor <{1}>", name, actor->name);
 }
 
 void Scene::update(float dt)
 {
+    // simulated actors change without going through the editor, the next save starts from scratch
+    if (_savedDocument)
+    {
+        invalidateSavedDocument();
+    }
+
+    collectTicks(dt);
+
+    updateActors(TickGroup::PRE_PHYSICS);
     _physicsManager->executeStep(dt);
-    updateActors(dt);
+    updateActors(TickGroup::POST_PHYSICS);
     updateComponents(dt);
+    updateActors(TickGroup::POST_UPDATE);
+
+    rescheduleTicks();
 }
 
 void Scene::render()
@@ -240,41 +516,139 @@ bool Scene::renameActor(Actor *actor, std::string name)
     }
 
     actor->name = name;
+    actor->markDirty();
     return true;
 }
 
-void Scene::updateActors(float dt)
+void Scene::collectTicks(float dt)
 {
-    auto it = _actors.begin();
+    _tickScheduler.advance(dt, _dueTicks);
+    _tickingActors.clear();
 
-    while (it != _actors.end())
+    for (const Tick &tick : _dueTicks)
     {
+        auto it = _actors.find(tick.id);
+        if (it == _actors.end())
+        {
+            continue;
+        }
         if ((*it).second == nullptr)
         {
-            goto erase;
+            _actors.erase(it);
+            continue;
         }
         if ((*it).second->markedForDeletion())
         {
             spdlog::info("Scene {0}: Removed actor <{1}>", name, (*it).second->name);
-        erase:
-            it = _actors.erase(it);
+            _actors.erase(it);
             continue;
         }
 
-        (*it).second->update(dt);
-        it++;
+        _tickingActors.emplace_back((*it).second, tick.dt);
+    }
+}
+
+void Scene::rescheduleTicks()
+{
+    for (const Tick &tick : _dueTicks)
+    {
+        auto it = _actors.find(tick.id);
+        if (it == _actors.end() || (*it).second == nullptr)
+        {
+            continue;
+        }
+
+        Actor *actor = (*it).second;
+        float interval = actor->getTickInterval();
+
+        if (actor->markedForDeletion())
+        {
+            // wake up next frame to get cleaned up
+            interval = 0.f;
+        }
+        else if (actor->hasTickLOD() && _activeCamera)
+        {
+            interval = _tickScheduler.getTickInterval(interval, actor->getWorldSpaceTransform().position,
+                                                      _activeCamera->getPosition());
+        }
+
+        _tickScheduler.schedule(tick.id, interval);
+    }
+}
+
+void Scene::updateActors(TickGroup tickGroup)
+{
+    _parallelActors.clear();
+
+    for (auto [actor, dt] : _tickingActors)
+    {
+        if (actor->getTickGroup() != tickGroup || actor->markedForDeletion())
+        {
+            continue;
+        }
+
+        if (actor->hasThreadSafeUpdate())
+        {
+            _parallelActors.emplace_back(actor, dt);
+        }
+        else
+        {
+            actor->update(dt);
+        }
+    }
+
+    if (!_parallelActors.empty())
+    {
+        _deferCommands = true;
+        JobSystem::getInstance().parallelFor(_parallelActors.size(), [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                _parallelActors[i].first->update(_parallelActors[i].second);
+            }
+        });
+        _deferCommands = false;
+    }
+
+    flushDeferredCommands();
+}
+
+void Scene::defer(std::function<void()> command)
+{
+    if (!_deferCommands)
+    {
+        command();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{_deferredCommandsMutex};
+    _deferredCommands.push_back(std::move(command));
+}
+
+void Scene::flushDeferredCommands()
+{
+    std::vector<std::function<void()>> commands;
+    {
+        std::lock_guard<std::mutex> lock{_deferredCommandsMutex};
+        commands.swap(_deferredCommands);
+    }
+
+    for (auto &command : commands)
+    {
+        command();
     }
 }
 
 void Scene::removeComponent(std::shared_ptr<Component> component)
 {
-    if (std::shared_ptr<Drawable> drawable = std::dynamic_pointer_cast<Drawable>(component))
+    component->onDetach();
+
+    if (Drawable *drawable = component->asDrawable())
     {
-        _graphicsManager->remove(drawable.get());
+        _graphicsManager->remove(drawable);
     }
-    if (std::shared_ptr<PhysicsBody> physicsBody = std::dynamic_pointer_cast<PhysicsBody>(component))
+    if (PhysicsBody *physicsBody = component->asPhysicsBody())
     {
-        _physicsManager->remove(physicsBody.get());
+        _physicsManager->remove(physicsBody);
     }
 
     auto it = _components.begin();
@@ -307,19 +681,24 @@ void Scene::updateComponents(float dt)
         // if component is deleted, remove it from our list
         if (component->getParent() == nullptr)
         {
-            if (std::shared_ptr<Drawable> drawable = std::dynamic_pointer_cast<Drawable>(component))
+            component->onDetach();
+
+            if (Drawable *drawable = component->asDrawable())
             {
-                _graphicsManager->remove(drawable.get());
+                _graphicsManager->remove(drawable);
             }
-            if (std::shared_ptr<PhysicsBody> physicsBody = std::dynamic_pointer_cast<PhysicsBody>(component))
+            if (PhysicsBody *physicsBody = component->asPhysicsBody())
             {
-                _physicsManager->remove(physicsBody.get());
+                _physicsManager->remove(physicsBody);
             }
             it = _components.erase(it);
             continue;
         }
 
-        component->update(dt);
+        if (component->hasInterface(HAS_UPDATE))
+        {
+            component->tick(dt);
+        }
 
         it++;
     }
@@ -336,30 +715,187 @@ tinyxml2::XMLElement &Scene::saveAs(const char *filepath, bool absolute)
 
     _xmlPath = absolute ? std::string(filepath) : std::string(GAME_FILES) + std::string(filepath);
 
-    tinyxml2::XMLDocument doc;
-    doc.InsertFirstChild(doc.NewDeclaration());
+    tinyxml2::XMLElement &sceneElement = updateSavedDocument();
+
+    RecordWriter records{};
+    if (SceneFile::isBinary(_xmlPath))
+    {
+        writeRecords(records);
+    }
+
+    if (writeDocument(*_savedDocument, records, _xmlPath))
+    {
+        spdlog::info("Scene {0}: Succesfully saved to `{1}`!", name, _xmlPath);
+    }
+    return sceneElement;
+}
+
+void Scene::saveInBackground(const char *filepath, bool absolute)
+{
+    const std::string path = absolute ? std::string(filepath) : std::string(GAME_FILES) + std::string(filepath);
+
+    updateSavedDocument();
 
-    tinyxml2::XMLElement *sceneElement = doc.NewElement("scene");
+    // records are taken here, the actors may change while the file is written
+    RecordWriter records{};
+    if (SceneFile::isBinary(path))
+    {
+        writeRecords(records);
+    }
+
+    _saveThread =
+        std::thread([document = _savedDocument.get(), records = std::move(records), path, sceneName = name]() {
+            if (writeDocument(*document, records, path))
+            {
+                spdlog::info("Scene {0}: Succesfully saved to `{1}` in the background", sceneName, path);
+            }
+        });
+}
+
+bool Scene::hasUnsavedChanges() const
+{
+    if (_dirty || !_savedDocument || _assetsManager->hasUnsavedChanges(_savedAssetElements))
+        return true;
+
+    for (const auto &[id, actor] : _actors)
+    {
+        if (actor->isDirty())
+            return true;
+    }
+
+    // removed since, added ones are dirty already
+    for (const auto &[id, element] : _savedActors)
+    {
+        if (_actors.find(id) == _actors.end())
+            return true;
+    }
+
+    return false;
+}
+
+tinyxml2::XMLElement &Scene::updateSavedDocument()
+{
+    waitForSave();
+
+    if (!_savedDocument)
+    {
+        _savedDocument = std::make_unique<tinyxml2::XMLDocument>();
+        _savedDocument->InsertFirstChild(_savedDocument->NewDeclaration());
+        _savedDocument->InsertEndChild(_savedDocument->NewElement("scene"));
+    }
+
+    tinyxml2::XMLDocument &doc = *_savedDocument;
+    tinyxml2::XMLElement *sceneElement = doc.RootElement();
     sceneElement->SetAttribute("name", name.c_str());
 
-    _assetsManager->save(doc, sceneElement);
-    _lightEnvironment->save(doc, sceneElement);
-    _graphicsManager->save(doc, sceneElement);
+    if (_savedAssets == nullptr)
+    {
+        _savedAssets = doc.NewElement("assets");
+        _savedAssetElements.clear();
+    }
+    _assetsManager->save(doc, _savedAssets, _savedAssetElements);
 
-    for (auto &actorPair : _actors)
+    // these only hold a handful of attributes, cheaper to rebuild than to track
+    for (const char *section : {"lightEnvironment", "graphicsManager", "tickLOD"})
     {
-        actorPair.second->save(doc, sceneElement);
+        if (tinyxml2::XMLElement *sectionElement = sceneElement->FirstChildElement(section))
+        {
+            sceneElement->DeleteChild(sectionElement);
+        }
     }
 
-    doc.InsertEndChild(sceneElement);
+    tinyxml2::XMLElement &lightEnvironmentElement = _lightEnvironment->save(doc, sceneElement);
+    _dirty = false;
+    tinyxml2::XMLElement &graphicsManagerElement = _graphicsManager->save(doc, sceneElement);
+    tinyxml2::XMLElement &tickElement = _tickScheduler.save(doc, sceneElement);
+
+    // keep the scene wide sections ahead of the actors
+    sceneElement->InsertFirstChild(_savedAssets);
+    sceneElement->InsertAfterChild(_savedAssets, &lightEnvironmentElement);
+    sceneElement->InsertAfterChild(&lightEnvironmentElement, &graphicsManagerElement);
+    sceneElement->InsertAfterChild(&graphicsManagerElement, &tickElement);
 
-    if (doc.SaveFile(_xmlPath.c_str()) != tinyxml2::XML_SUCCESS)
+    auto it = _savedActors.begin();
+    while (it != _savedActors.end())
     {
-        spdlog::error("Scene {0}: {1}", name, doc.ErrorStr());
-    };
+        if (_actors.find(it->first) == _actors.end())
+        {
+            sceneElement->DeleteChild(it->second);
+            it = _savedActors.erase(it);
+            continue;
+        }
+        it++;
+    }
+
+    size_t savedCount = 0;
+    for (auto &[id, actor] : _actors)
+    {
+        auto savedIt = _savedActors.find(id);
+        if (savedIt != _savedActors.end() && !actor->isDirty())
+        {
+            continue;
+        }
+
+        tinyxml2::XMLElement &actorElement = actor->save(doc, sceneElement);
+        actor->clearDirty();
+        savedCount++;
+
+        // some actors opt out of saving by returning the parent element
+        if (&actorElement == sceneElement)
+        {
+            continue;
+        }
+
+        if (savedIt != _savedActors.end())
+        {
+            sceneElement->InsertAfterChild(savedIt->second, &actorElement);
+            sceneElement->DeleteChild(savedIt->second);
+            savedIt->second = &actorElement;
+        }
+        else
+        {
+            _savedActors[id] = &actorElement;
+        }
+    }
+
+    spdlog::info("Scene {0}: serialized {1} out of {2} actors", name, savedCount, _actors.size());
 
-    spdlog::info("Scene {0}: Succesfully saved to `{1}`!", name, _xmlPath);
     return *sceneElement;
 }
 
+void Scene::invalidateSavedDocument()
+{
+    waitForSave();
+
+    _savedDocument.reset();
+    _savedActors.clear();
+    _savedAssets = nullptr;
+    _savedAssetElements.clear();
+    _dirty = true;
+}
+
+void Scene::waitForSave()
+{
+    if (_saveThread.joinable())
+    {
+        _saveThread.join();
+    }
+}
+
+bool Scene::writeDocument(tinyxml2::XMLDocument &doc, const RecordWriter &records, const std::string &filepath)
+{
+    if (SceneFile::isBinary(filepath))
+    {
+        return SceneFile::write(doc, records, filepath);
+    }
+
+    if (doc.SaveFile(filepath.c_str()) != tinyxml2::XML_SUCCESS)
+    {
+        spdlog::error("Scene: {0}", doc.ErrorStr());
+        return false;
+    }
+
+    return true;
+}
+
 } // namespace cmx
@@ -2,7 +2,11 @@
 #define CMX_SCENE
 
 // cmx
+#include "cmx_assets_manager.h"
 #include "cmx_light_environment.h"
+#include "cmx_scene_file.h"
+#include "cmx_scene_records.h"
+#include "cmx_tick_scheduler.h"
 
 // lib
 #include <spdlog/spdlog.h>
@@ -10,14 +14,55 @@
 
 // std
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 namespace cmx
 {
 
+enum TickGroup
+{
+    PRE_PHYSICS,
+    POST_PHYSICS,
+    POST_UPDATE
+};
+
+// editor side of a scene parked while playing, handed back as is on stop so nothing is read or spawned again, the
+// parked actors and components have no scene until then
+struct SceneSnapshot
+{
+    SceneSnapshot() = default;
+    ~SceneSnapshot();
+
+    SceneSnapshot(const SceneSnapshot &) = delete;
+    SceneSnapshot &operator=(const SceneSnapshot &) = delete;
+
+    std::string name;
+    std::shared_ptr<class Camera> camera;
+    std::unordered_map<uint32_t, class Actor *> actors{};
+    std::vector<std::shared_ptr<class Component>> components{};
+    TickScheduler tickScheduler{};
+
+    std::unique_ptr<class GraphicsManager> graphicsManager;
+    std::unique_ptr<class PhysicsManager> physicsManager;
+    std::unique_ptr<class LightEnvironment> lightEnvironment;
+
+    // state of the parked scene, the playing scene is built from it
+    RecordWriter records{};
+
+    // last saved document, handed back with the parked actors so following saves stay incremental
+    std::unique_ptr<tinyxml2::XMLDocument> document;
+    std::unordered_map<uint32_t, tinyxml2::XMLElement *> documentActors{};
+    tinyxml2::XMLElement *documentAssets{nullptr};
+    AssetsManager::SavedElements documentAssetElements{};
+    bool dirty{true};
+};
+
 class Scene
 {
   public:
@@ -27,6 +72,7 @@ class Scene
     class Actor *getActorByName(const std::string &name);
     class Actor *getActorByID(uint32_t id);
     template <typename T> void getAllActorsByType(std::vector<class Actor *> &actorList);
+    // defined in cmx_component.h
     template <typename T> void getAllComponentsByType(std::vector<std::weak_ptr<class Component>> &componentList);
 
     std::vector<std::shared_ptr<class Component>> &getAllComponents()
@@ -36,10 +82,27 @@ class Scene
 
     tinyxml2::XMLElement &save();
     tinyxml2::XMLElement &saveAs(const char *filepath, bool absolute = true);
+    // the document is brought up to date on the calling thread, then written to disk on a background thread
+    void saveInBackground(const char *filepath, bool absolute = true);
+    // anything a save would write differently than the last one did
+    bool hasUnsavedChanges() const;
+    // for the scene wide sections, actors and assets track their own changes
+    void markDirty()
+    {
+        _dirty = true;
+    }
     void load(bool skipAssets = false);
     void loadFrom(const std::string &filepath, bool skipAssets = false, bool absolute = true);
+    void loadPrepared(class SceneLoader &);
     void unload(bool keepAssets = false);
 
+    // moves everything but the assets out of the scene, leaving it empty
+    std::unique_ptr<SceneSnapshot> takeSnapshot();
+    // builds a fresh copy of the snapshot's actors from its records, assets are left untouched
+    void loadSnapshot(SceneSnapshot &);
+    // drops the current actors and puts the snapshot's back in place
+    void restoreSnapshot(std::unique_ptr<SceneSnapshot>);
+
     void update(float dt);
     void render();
 
@@ -48,6 +111,15 @@ class Scene
     void addComponent(std::shared_ptr<class Component>);
     void removeComponent(std::shared_ptr<class Component>);
 
+    // runs the command right away, unless actors are being updated in parallel, in which case it is applied at the
+    // end of the current tick group
+    void defer(std::function<void()> command);
+
+    bool isDeferringCommands() const
+    {
+        return _deferCommands;
+    }
+
     void setCamera(std::shared_ptr<class Camera> camera, bool bForce = false);
 
     const std::weak_ptr<class Camera> getCamera() const
@@ -90,23 +162,63 @@ class Scene
         return _lightEnvironment.get();
     }
 
+    TickScheduler &getTickScheduler()
+    {
+        return _tickScheduler;
+    }
+
     bool renameActor(Actor *, std::string name);
     std::string name;
 
   private:
-    void updateActors(float dt);
+    // everything but the assets is read from the binary file's records when there is one
+    bool build(tinyxml2::XMLDocument &, bool parsed, bool skipAssets, struct PreparedAssets *,
+               const SceneFile::File *binaryFile = nullptr);
+    void createManagers();
+    void clear();
+
+    void writeRecords(RecordWriter &) const;
+    bool readRecords(RecordReader &);
+
+    tinyxml2::XMLElement &updateSavedDocument();
+    void invalidateSavedDocument();
+    void waitForSave();
+    // the records are only written to binary files
+    static bool writeDocument(tinyxml2::XMLDocument &, const RecordWriter &, const std::string &filepath);
+
+    void collectTicks(float dt);
+    void rescheduleTicks();
+    void updateActors(TickGroup);
     void updateComponents(float dt);
+    void flushDeferredCommands();
     void draw();
 
     std::shared_ptr<class Camera> _activeCamera;
     std::unordered_map<uint32_t, class Actor *> _actors{};
     std::vector<std::shared_ptr<class Component>> _components{};
 
+    TickScheduler _tickScheduler{};
+    std::vector<Tick> _dueTicks{};
+    std::vector<std::pair<class Actor *, float>> _tickingActors{};
+    std::vector<std::pair<class Actor *, float>> _parallelActors{};
+    std::vector<std::function<void()>> _deferredCommands{};
+    std::mutex _deferredCommandsMutex;
+    bool _deferCommands{false};
+
     std::unique_ptr<class AssetsManager> _assetsManager;
     std::unique_ptr<class GraphicsManager> _graphicsManager;
     std::unique_ptr<class PhysicsManager> _physicsManager;
     std::unique_ptr<class LightEnvironment> _lightEnvironment;
 
+    // last saved document, only records of dirty actors are serialized again, left untouched while being written
+    std::unique_ptr<tinyxml2::XMLDocument> _savedDocument;
+    std::unordered_map<uint32_t, tinyxml2::XMLElement *> _savedActors{};
+    tinyxml2::XMLElement *_savedAssets{nullptr};
+    // likewise, only changed assets are serialized again, see AssetsManager::save
+    AssetsManager::SavedElements _savedAssetElements{};
+    std::thread _saveThread;
+    bool _dirty{true};
+
     std::string _xmlPath;
     class Game *_game;
 };
@@ -129,24 +241,6 @@ template <typename T> inline void Scene::getAllActorsByType(std::vector<Actor *>
     }
 }
 
-template <typename T> inline void Scene::getAllComponentsByType(std::vector<std::weak_ptr<Component>> &componentList)
-{
-    if constexpr (!std::is_base_of<Component, T>::value)
-    {
-        spdlog::error(
-            "Scene {0}: '{1}' is not of base type 'Components', 'getAllComponentsByType<{2}>' will return nothing",
-            name, typeid(T).name(), typeid(T).name());
-        return;
-    }
-    for (auto component : _components)
-    {
-        if (typeid(T) == typeid(component))
-        {
-            componentList.push_back(component);
-        }
-    }
-}
-
 } // namespace cmx
 
 #endif
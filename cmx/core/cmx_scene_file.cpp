@@ -0,0 +1,317 @@
+#include "cmx_scene_file.h"
+
+// cmx
+#include "cmx_mapped_file.h"
+
+// lib
+#include <spdlog/spdlog.h>
+
+// std
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace cmx
+{
+
+namespace SceneFile
+{
+
+namespace
+{
+
+constexpr char MAGIC[4] = {'C', 'M', 'X', 'S'};
+
+struct Writer
+{
+    uint32_t intern(const char *string)
+    {
+        auto it = stringIndices.find(string);
+        if (it != stringIndices.end())
+        {
+            return it->second;
+        }
+
+        const uint32_t index = uint32_t(stringOffsets.size());
+        stringOffsets.push_back(uint32_t(strings.size()));
+        strings.append(string);
+        strings.push_back('\0');
+
+        stringIndices[string] = index;
+        return index;
+    }
+
+    uint32_t addElement(const tinyxml2::XMLElement *xmlElement, bool withChildren = true)
+    {
+        const uint32_t index = uint32_t(elements.size());
+        const char *text = xmlElement->GetText();
+
+        elements.push_back(Element{intern(xmlElement->Name()), text ? intern(text) : INVALID_INDEX,
+                                   uint32_t(attributes.size()), 0, INVALID_INDEX, INVALID_INDEX});
+
+        for (const tinyxml2::XMLAttribute *attribute = xmlElement->FirstAttribute(); attribute;
+             attribute = attribute->Next())
+        {
+            attributes.push_back(Attribute{intern(attribute->Name()), intern(attribute->Value())});
+            elements[index].attributeCount++;
+        }
+
+        uint32_t previous = INVALID_INDEX;
+        for (const tinyxml2::XMLElement *child = withChildren ? xmlElement->FirstChildElement() : nullptr; child;
+             child = child->NextSiblingElement())
+        {
+            const uint32_t childIndex = addElement(child);
+
+            if (previous == INVALID_INDEX)
+            {
+                elements[index].firstChild = childIndex;
+            }
+            else
+            {
+                elements[previous].nextSibling = childIndex;
+            }
+            previous = childIndex;
+        }
+
+        return index;
+    }
+
+    // every section following the strings starts 4 byte aligned
+    void padStrings()
+    {
+        strings.resize((strings.size() + 3) & ~size_t(3), '\0');
+    }
+
+    std::unordered_map<std::string, uint32_t> stringIndices{};
+    std::vector<uint32_t> stringOffsets{};
+    std::string strings{};
+    std::vector<Element> elements{};
+    std::vector<Attribute> attributes{};
+};
+
+struct View
+{
+    const char *string(uint32_t index) const
+    {
+        return index < header.stringCount ? strings + stringOffsets[index] : "";
+    }
+
+    tinyxml2::XMLElement *buildElement(tinyxml2::XMLDocument &doc, uint32_t index) const
+    {
+        const Element &element = elements[index];
+
+        tinyxml2::XMLElement *xmlElement = doc.NewElement(string(element.name));
+
+        for (uint32_t i = element.firstAttribute; i < element.firstAttribute + element.attributeCount; i++)
+        {
+            xmlElement->SetAttribute(string(attributes[i].name), string(attributes[i].value));
+        }
+
+        if (element.text != INVALID_INDEX)
+        {
+            xmlElement->SetText(string(element.text));
+        }
+
+        // children and siblings always come after in depth first order, which also rules out cycles
+        uint32_t previous = index;
+        for (uint32_t child = element.firstChild; child != INVALID_INDEX; child = elements[child].nextSibling)
+        {
+            if (child <= previous || child >= header.elementCount)
+            {
+                spdlog::error("SceneFile: corrupted element hierarchy");
+                break;
+            }
+
+            xmlElement->InsertEndChild(buildElement(doc, child));
+            previous = child;
+        }
+
+        return xmlElement;
+    }
+
+    Header header;
+    const uint32_t *stringOffsets;
+    const Element *elements;
+    const Attribute *attributes;
+    const char *strings;
+};
+
+// offsets within the string table, which has to end with '\0'
+bool isStringTableValid(const uint32_t *stringOffsets, uint32_t stringCount, const char *strings, uint32_t size)
+{
+    if (stringCount > 0 && (size == 0 || strings[size - 1] != '\0'))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < stringCount; i++)
+    {
+        if (stringOffsets[i] >= size)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+bool isBinary(const std::string &filepath)
+{
+    const size_t extensionLength = strlen(CMX_SCENE_EXTENSION);
+
+    return filepath.size() >= extensionLength &&
+           filepath.compare(filepath.size() - extensionLength, extensionLength, CMX_SCENE_EXTENSION) == 0;
+}
+
+bool write(const tinyxml2::XMLDocument &doc, const RecordWriter &records, const std::string &filepath)
+{
+    const tinyxml2::XMLElement *rootElement = doc.RootElement();
+    if (rootElement == nullptr)
+    {
+        spdlog::error("SceneFile: nothing to write to `{0}`", filepath);
+        return false;
+    }
+
+    Writer writer{};
+    const uint32_t rootIndex = writer.addElement(rootElement, false);
+    if (const tinyxml2::XMLElement *assetsElement = rootElement->FirstChildElement("assets"))
+    {
+        const uint32_t assetsIndex = writer.addElement(assetsElement);
+        writer.elements[rootIndex].firstChild = assetsIndex;
+    }
+    writer.padStrings();
+
+    std::string recordStrings = records.getStrings();
+    recordStrings.resize((recordStrings.size() + 3) & ~size_t(3), '\0');
+
+    Header header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = CMX_SCENE_VERSION;
+    header.stringCount = uint32_t(writer.stringOffsets.size());
+    header.elementCount = uint32_t(writer.elements.size());
+    header.attributeCount = uint32_t(writer.attributes.size());
+    header.stringsSize = uint32_t(writer.strings.size());
+    header.recordStringCount = uint32_t(records.getStringOffsets().size());
+    header.recordStringsSize = uint32_t(recordStrings.size());
+    header.recordsSize = uint32_t(records.size());
+
+    std::ofstream file{filepath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open())
+    {
+        spdlog::error("SceneFile: couldn't open `{0}` for writing", filepath);
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char *>(writer.stringOffsets.data()),
+               writer.stringOffsets.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char *>(writer.elements.data()), writer.elements.size() * sizeof(Element));
+    file.write(reinterpret_cast<const char *>(writer.attributes.data()),
+               writer.attributes.size() * sizeof(Attribute));
+    file.write(writer.strings.data(), writer.strings.size());
+    file.write(reinterpret_cast<const char *>(records.getStringOffsets().data()),
+               records.getStringOffsets().size() * sizeof(uint32_t));
+    file.write(recordStrings.data(), recordStrings.size());
+    file.write(records.getRecords().data(), records.getRecords().size());
+
+    if (!file.good())
+    {
+        spdlog::error("SceneFile: failed writing `{0}`", filepath);
+        return false;
+    }
+
+    return true;
+}
+
+File::File() = default;
+
+File::~File() = default;
+
+bool File::open(const std::string &filepath, tinyxml2::XMLDocument &doc)
+{
+    _file = std::make_unique<MappedFile>(filepath);
+    if (!_file->isValid())
+    {
+        return false;
+    }
+
+    View view{};
+    if (_file->size() < sizeof(Header))
+    {
+        spdlog::error("SceneFile: `{0}` is truncated", filepath);
+        return false;
+    }
+    memcpy(&view.header, _file->data(), sizeof(Header));
+
+    const Header &header = view.header;
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != CMX_SCENE_VERSION)
+    {
+        spdlog::error("SceneFile: `{0}` is not a version {1} scene file", filepath, CMX_SCENE_VERSION);
+        return false;
+    }
+
+    const uint64_t stringOffsetsOffset = sizeof(Header);
+    const uint64_t elementsOffset = stringOffsetsOffset + uint64_t(header.stringCount) * sizeof(uint32_t);
+    const uint64_t attributesOffset = elementsOffset + uint64_t(header.elementCount) * sizeof(Element);
+    const uint64_t stringsOffset = attributesOffset + uint64_t(header.attributeCount) * sizeof(Attribute);
+    const uint64_t recordStringOffsetsOffset = stringsOffset + header.stringsSize;
+    const uint64_t recordStringsOffset =
+        recordStringOffsetsOffset + uint64_t(header.recordStringCount) * sizeof(uint32_t);
+    const uint64_t recordsOffset = recordStringsOffset + header.recordStringsSize;
+
+    if (_file->size() < recordsOffset + header.recordsSize || header.elementCount == 0 ||
+        header.stringsSize % sizeof(uint32_t) != 0 || header.recordStringsSize % sizeof(uint32_t) != 0)
+    {
+        spdlog::error("SceneFile: `{0}` is truncated", filepath);
+        return false;
+    }
+
+    // the mapping is page aligned and every section 4 byte aligned, so they are all used in place
+    const char *data = _file->data();
+    view.stringOffsets = reinterpret_cast<const uint32_t *>(data + stringOffsetsOffset);
+    view.elements = reinterpret_cast<const Element *>(data + elementsOffset);
+    view.attributes = reinterpret_cast<const Attribute *>(data + attributesOffset);
+    view.strings = data + stringsOffset;
+
+    _recordStringOffsets = reinterpret_cast<const uint32_t *>(data + recordStringOffsetsOffset);
+    _recordStringCount = header.recordStringCount;
+    _recordStrings = data + recordStringsOffset;
+    _records = data + recordsOffset;
+    _recordsSize = header.recordsSize;
+
+    if (!isStringTableValid(view.stringOffsets, header.stringCount, view.strings, header.stringsSize) ||
+        !isStringTableValid(_recordStringOffsets, _recordStringCount, _recordStrings, header.recordStringsSize))
+    {
+        spdlog::error("SceneFile: `{0}` has an invalid string table", filepath);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.elementCount; i++)
+    {
+        const Element &element = view.elements[i];
+        if (uint64_t(element.firstAttribute) + element.attributeCount > header.attributeCount)
+        {
+            spdlog::error("SceneFile: `{0}` has an invalid attribute range", filepath);
+            return false;
+        }
+    }
+
+    // only the scene element and its assets, actors and components never go through a document
+    doc.Clear();
+    doc.InsertFirstChild(doc.NewDeclaration());
+    doc.InsertEndChild(view.buildElement(doc, 0));
+
+    return true;
+}
+
+RecordReader File::getRecords() const
+{
+    return RecordReader{_records, _recordsSize, _recordStringOffsets, _recordStringCount, _recordStrings};
+}
+
+} // namespace SceneFile
+
+} // namespace cmx
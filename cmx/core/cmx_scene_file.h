@@ -0,0 +1,93 @@
+#ifndef CMX_SCENE_FILE
+#define CMX_SCENE_FILE
+
+// cmx
+#include "cmx_scene_records.h"
+
+// lib
+#include <tinyxml2.h>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#define CMX_SCENE_EXTENSION ".cmxscene"
+#define CMX_SCENE_VERSION 2
+
+namespace cmx
+{
+
+class MappedFile;
+
+// .cmxscene layout, every section is 4 byte aligned, string tables are padded with '\0':
+// Header | uint32 stringOffsets[stringCount] | Element[elementCount] | Attribute[attributeCount] | char strings[]
+//        | uint32 recordStringOffsets[recordStringCount] | char recordStrings[] | records
+// the elements only hold the scene element and its assets, depth first, the root element being the first one, the
+// assets are all the scene loader's workers need, everything else is in the records, see cmx_scene_records.h
+namespace SceneFile
+{
+
+constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+struct Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t stringCount;
+    uint32_t elementCount;
+    uint32_t attributeCount;
+    uint32_t stringsSize;
+    uint32_t recordStringCount;
+    uint32_t recordStringsSize;
+    uint32_t recordsSize;
+};
+
+struct Element
+{
+    uint32_t name;
+    uint32_t text;
+    uint32_t firstAttribute;
+    uint32_t attributeCount;
+    uint32_t firstChild;
+    uint32_t nextSibling;
+};
+
+struct Attribute
+{
+    uint32_t name;
+    uint32_t value;
+};
+
+bool isBinary(const std::string &filepath);
+
+// the document's scene element and its assets, along with the rest of the scene as records
+bool write(const tinyxml2::XMLDocument &, const RecordWriter &, const std::string &filepath);
+
+// mapped .cmxscene, the records are read in place for as long as it stays open
+class File
+{
+  public:
+    File();
+    ~File();
+
+    // the document only receives the scene element and its assets
+    bool open(const std::string &filepath, tinyxml2::XMLDocument &);
+
+    RecordReader getRecords() const;
+
+  private:
+    std::unique_ptr<MappedFile> _file;
+
+    const char *_records{nullptr};
+    size_t _recordsSize{0};
+    const uint32_t *_recordStringOffsets{nullptr};
+    uint32_t _recordStringCount{0};
+    const char *_recordStrings{nullptr};
+};
+
+} // namespace SceneFile
+
+} // namespace cmx
+
+#endif
@@ -0,0 +1,352 @@
+#include "cmx_scene_loader.h"
+
+// cmx
+#include "cmx_material.h"
+#include "cmx_register.h"
+#include "cmx_render_system.h"
+#include "cmx_scene.h"
+#include "cmx_scene_file.h"
+
+// lib
+#include <spdlog/spdlog.h>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace cmx
+{
+
+std::string PreparedAssets::key(const std::string &name, const std::vector<std::string> &filepaths)
+{
+    std::string key{name};
+    key += ';';
+    for (const std::string &filepath : filepaths)
+    {
+        key += filepath;
+        key += ';';
+    }
+
+    return key;
+}
+
+std::unique_ptr<Model> PreparedAssets::takeModel(const std::string &name, const std::string &filepath)
+{
+    auto it = models.find(key(name, {filepath}));
+    if (it == models.end())
+        return nullptr;
+
+    std::unique_ptr<Model> model = std::move(it->second);
+    models.erase(it);
+    return model;
+}
+
+std::unique_ptr<Texture> PreparedAssets::takeTexture(const std::string &name,
+                                                     const std::vector<std::string> &filepaths)
+{
+    auto it = textures.find(key(name, filepaths));
+    if (it == textures.end())
+        return nullptr;
+
+    std::unique_ptr<Texture> texture = std::move(it->second);
+    textures.erase(it);
+    return texture;
+}
+
+SceneLoader::SceneLoader(Scene *scene, const std::string &filepath, std::function<void(float)> onProgress)
+    : _scene{scene}, _filepath{filepath}, _onProgress{onProgress}
+{
+    _thread = std::thread(&SceneLoader::prepare, this);
+}
+
+SceneLoader::~SceneLoader()
+{
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    // images are released on upload, whatever is left was never used
+    for (PendingTexture &pending : _pendingTextures)
+    {
+        for (stbi_uc *image : pending.builder.images)
+        {
+            stbi_image_free(image);
+        }
+    }
+    for (auto &[key, model] : _preparedAssets.models)
+    {
+        model->free();
+    }
+    for (auto &[key, texture] : _preparedAssets.textures)
+    {
+        texture->free();
+    }
+
+    // the scene's materials hold their own references by now, the pipelines stay
+    for (Material *material : _warmMaterials)
+    {
+        material->free();
+        delete material;
+    }
+}
+
+float SceneLoader::getProgress() const
+{
+    return float(_stepsDone.load()) / float(std::max(_stepsTotal.load(), 1u));
+}
+
+void SceneLoader::reportProgress()
+{
+    const float progress = _staged && isUploaded() ? 1.f : std::min(getProgress(), .99f);
+
+    if (_onProgress && progress != _reportedProgress)
+    {
+        _onProgress(progress);
+    }
+    _reportedProgress = progress;
+}
+
+bool SceneLoader::update()
+{
+    if (isDecoded() && !_staged)
+    {
+        const auto stagingStart = std::chrono::steady_clock::now();
+        while (!_staged)
+        {
+            _staged = !stageNext();
+
+            const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - stagingStart;
+            if (elapsed.count() >= SCENE_STAGING_BUDGET_MS)
+                break;
+        }
+    }
+
+    reportProgress();
+
+    return _staged && isUploaded();
+}
+
+bool SceneLoader::stageNext()
+{
+    Device *device = RenderSystem::getInstance()->getDevice();
+
+    // recorded into the upload manager, copied while the current scene keeps rendering
+    if (!_pendingModels.empty())
+    {
+        PendingModel &pending = _pendingModels.back();
+        std::unique_ptr<Model> &model = _preparedAssets.models[PreparedAssets::key(pending.name, {pending.filepath})];
+        if (!model)
+        {
+            model = std::make_unique<Model>(device, pending.builder, pending.name);
+        }
+        _pendingModels.pop_back();
+        _stepsDone++;
+        return true;
+    }
+
+    if (!_pendingTextures.empty())
+    {
+        PendingTexture &pending = _pendingTextures.back();
+        std::unique_ptr<Texture> &texture =
+            _preparedAssets.textures[PreparedAssets::key(pending.name, pending.filepaths)];
+        if (!texture)
+        {
+            texture = std::make_unique<Texture>(device, pending.builder, pending.name.c_str());
+        }
+        else
+        {
+            // declared twice, the first one is used
+            for (stbi_uc *image : pending.builder.images)
+            {
+                stbi_image_free(image);
+            }
+        }
+        _pendingTextures.pop_back();
+        _stepsDone++;
+        return true;
+    }
+
+    // the registry shares pipelines, the scene's materials find these already compiled
+    if (!_pendingMaterials.empty())
+    {
+        PendingMaterial &pending = _pendingMaterials.back();
+        if (Material *material = Register::getInstance().getMaterial(pending.type.c_str()))
+        {
+            material->name = pending.name;
+            material->initialize();
+            _warmMaterials.push_back(material);
+        }
+        _pendingMaterials.pop_back();
+        _stepsDone++;
+        return true;
+    }
+
+    return false;
+}
+
+bool SceneLoader::isUploaded() const
+{
+    for (const auto &[key, model] : _preparedAssets.models)
+    {
+        if (!model->isReady())
+            return false;
+    }
+    for (const auto &[key, texture] : _preparedAssets.textures)
+    {
+        if (!texture->isReady())
+            return false;
+    }
+
+    return true;
+}
+
+void SceneLoader::prepare()
+{
+    spdlog::info("SceneLoader: preparing `{0}`...", _filepath);
+
+    _binary = SceneFile::isBinary(_filepath);
+    _parsed = _binary ? _binaryFile.open(_filepath, _doc) : _doc.LoadFile(_filepath.c_str()) == tinyxml2::XML_SUCCESS;
+
+    std::vector<std::string> modelNames{};
+    std::vector<std::string> modelPaths{};
+    std::vector<std::string> textureNames{};
+    std::vector<std::vector<std::string>> texturePaths{};
+
+    tinyxml2::XMLElement *rootElement = _parsed ? _doc.RootElement() : nullptr;
+    if (tinyxml2::XMLElement *assetsElement = rootElement ? rootElement->FirstChildElement("assets") : nullptr)
+    {
+        for (tinyxml2::XMLElement *modelElement = assetsElement->FirstChildElement("model"); modelElement;
+             modelElement = modelElement->NextSiblingElement("model"))
+        {
+            const char *name = modelElement->Attribute("name");
+            const char *filepath = modelElement->Attribute("filepath");
+            if (name && filepath)
+            {
+                modelNames.push_back(name);
+                modelPaths.push_back(filepath);
+            }
+        }
+
+        for (tinyxml2::XMLElement *textureElement = assetsElement->FirstChildElement("texture"); textureElement;
+             textureElement = textureElement->NextSiblingElement("texture"))
+        {
+            std::vector<std::string> filepaths{};
+            if (tinyxml2::XMLElement *layerElement = textureElement->FirstChildElement("layer"))
+            {
+                for (; layerElement; layerElement = layerElement->NextSiblingElement("layer"))
+                {
+                    filepaths.push_back(layerElement->Attribute("filepath"));
+                }
+            }
+            else if (const char *filepath = textureElement->Attribute("filepath"))
+            {
+                filepaths.push_back(filepath);
+            }
+
+            const char *name = textureElement->Attribute("name");
+            if (name && !filepaths.empty())
+            {
+                textureNames.push_back(name);
+                texturePaths.push_back(filepaths);
+            }
+        }
+
+        for (const char *role : {"material", "postProcess"})
+        {
+            for (tinyxml2::XMLElement *materialElement = assetsElement->FirstChildElement(role); materialElement;
+                 materialElement = materialElement->NextSiblingElement(role))
+            {
+                const char *type = materialElement->Attribute("type");
+                const char *name = materialElement->Attribute("name");
+                if (type && name)
+                {
+                    _pendingMaterials.push_back({type, name});
+                }
+            }
+        }
+    }
+
+    // parsing, then decoding and staging each asset, then warming each material
+    const size_t assetCount = modelPaths.size() + texturePaths.size();
+    _stepsTotal.store(uint32_t(1 + 2 * assetCount + _pendingMaterials.size()));
+    _stepsDone++;
+
+    std::vector<Model::Builder> models(modelPaths.size());
+    std::vector<Texture::Builder> textures(texturePaths.size());
+    std::vector<char> succeeded(assetCount, 0);
+    std::atomic<size_t> next{0};
+
+    // decoding gets its own threads rather than the job system, so long decodes never stall a frame's parallel update
+    auto decode = [&]() {
+        for (size_t i = next++; i < assetCount; i = next++)
+        {
+            try
+            {
+                if (i < modelPaths.size())
+                {
+                    models[i].loadModel(modelPaths[i]);
+                }
+                else
+                {
+                    const size_t t = i - modelPaths.size();
+                    if (texturePaths[t].size() > 1)
+                    {
+                        textures[t].loadTexture3D(texturePaths[t]);
+                    }
+                    else
+                    {
+                        textures[t].loadTexture(texturePaths[t][0].c_str());
+                    }
+                }
+                succeeded[i] = 1;
+            }
+            catch (const std::exception &e)
+            {
+                // left for the main thread, which will load it again and report the error where it used to
+                spdlog::warn("SceneLoader: {0}", e.what());
+            }
+            _stepsDone++;
+        }
+    };
+
+    const size_t threadCount =
+        std::min(assetCount, size_t(std::max(std::thread::hardware_concurrency() / 2, 1u)));
+    std::vector<std::thread> threads{};
+    for (size_t i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(decode);
+    }
+    decode();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < modelPaths.size(); i++)
+    {
+        if (succeeded[i])
+        {
+            _pendingModels.push_back({modelNames[i], modelPaths[i], std::move(models[i])});
+        }
+    }
+    for (size_t t = 0; t < texturePaths.size(); t++)
+    {
+        if (succeeded[modelPaths.size() + t])
+        {
+            _pendingTextures.push_back({textureNames[t], texturePaths[t], textures[t]});
+        }
+    }
+
+    // failed decodes won't be staged either
+    _stepsTotal.store(
+        uint32_t(_stepsDone.load() + _pendingModels.size() + _pendingTextures.size() + _pendingMaterials.size()));
+
+    spdlog::info("SceneLoader: `{0}` prepared, {1} models and {2} textures decoded", _filepath,
+                 _pendingModels.size(), _pendingTextures.size());
+
+    _decoded.store(true, std::memory_order_release);
+}
+
+} // namespace cmx
@@ -0,0 +1,153 @@
+#ifndef CMX_SCENE_LOADER
+#define CMX_SCENE_LOADER
+
+// cmx
+#include "cmx_model.h"
+#include "cmx_scene_file.h"
+#include "cmx_texture.h"
+
+// lib
+#include <tinyxml2.h>
+
+// std
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// main thread time spent uploading and warming pipelines for the next scene, per frame
+#define SCENE_STAGING_BUDGET_MS 4.f
+
+namespace cmx
+{
+
+// assets already uploaded for the next scene, keyed by name and filepaths, consumed by the AssetsManager
+struct PreparedAssets
+{
+    static std::string key(const std::string &name, const std::vector<std::string> &filepaths);
+
+    // moves the asset out, nullptr if it wasn't prepared
+    std::unique_ptr<Model> takeModel(const std::string &name, const std::string &filepath);
+    std::unique_ptr<Texture> takeTexture(const std::string &name, const std::vector<std::string> &filepaths);
+
+    std::unordered_map<std::string, std::unique_ptr<Model>> models{};
+    std::unordered_map<std::string, std::unique_ptr<Texture>> textures{};
+};
+
+// parses a scene file and decodes its assets on worker threads, then uploads them and creates the materials'
+// pipelines a few at a time on the main thread, the scene is swapped in once the GPU has everything
+class SceneLoader
+{
+  public:
+    // the scene is built from filepath, which becomes its path
+    SceneLoader(class Scene *, const std::string &filepath, std::function<void(float)> onProgress);
+    ~SceneLoader();
+
+    SceneLoader(const SceneLoader &) = delete;
+    SceneLoader &operator=(const SceneLoader &) = delete;
+
+    // main thread only, once a frame, stages what the workers decoded within SCENE_STAGING_BUDGET_MS and forwards
+    // progress to the callback, true once every upload completed and the scene can be built without stalling
+    bool update();
+
+    float getProgress() const;
+
+    // getters and setters :: begin
+    class Scene *getScene()
+    {
+        return _scene;
+    }
+
+    const std::string &getFilepath() const
+    {
+        return _filepath;
+    }
+
+    bool isParsed() const
+    {
+        return _parsed;
+    }
+
+    tinyxml2::XMLDocument &getDocument()
+    {
+        return _doc;
+    }
+
+    PreparedAssets &getPreparedAssets()
+    {
+        return _preparedAssets;
+    }
+
+    // nullptr for xml scenes
+    const SceneFile::File *getBinaryFile() const
+    {
+        return _binary ? &_binaryFile : nullptr;
+    }
+    // getters and setters :: end
+
+  private:
+    struct PendingModel
+    {
+        std::string name;
+        std::string filepath;
+        Model::Builder builder;
+    };
+
+    struct PendingTexture
+    {
+        std::string name;
+        std::vector<std::string> filepaths;
+        Texture::Builder builder;
+    };
+
+    struct PendingMaterial
+    {
+        std::string type;
+        std::string name;
+    };
+
+    void prepare();
+    // one asset or material, false once there is nothing left
+    bool stageNext();
+    bool isUploaded() const;
+    void reportProgress();
+
+    bool isDecoded() const
+    {
+        return _decoded.load(std::memory_order_acquire);
+    }
+
+    class Scene *_scene;
+    std::string _filepath;
+
+    tinyxml2::XMLDocument _doc;
+    bool _parsed{false};
+    // holds the mapped records until the scene is built
+    SceneFile::File _binaryFile{};
+    bool _binary{false};
+    PreparedAssets _preparedAssets{};
+
+    // filled by the workers, emptied by stageNext
+    std::vector<PendingModel> _pendingModels{};
+    std::vector<PendingTexture> _pendingTextures{};
+    std::vector<PendingMaterial> _pendingMaterials{};
+    // only hold on to their pipelines until the scene's own materials acquired them
+    std::vector<class Material *> _warmMaterials{};
+    bool _staged{false};
+
+    std::function<void(float)> _onProgress;
+    float _reportedProgress{-1.f};
+
+    std::atomic<uint32_t> _stepsDone{0};
+    std::atomic<uint32_t> _stepsTotal{1};
+    std::atomic<bool> _decoded{false};
+
+    std::thread _thread;
+};
+
+} // namespace cmx
+
+#endif
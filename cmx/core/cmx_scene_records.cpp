@@ -0,0 +1,80 @@
+#include "cmx_scene_records.h"
+
+// cmx
+#include "cmx_register.h"
+
+// lib
+#include <spdlog/spdlog.h>
+
+namespace cmx
+{
+
+uint32_t RecordWriter::addString(const std::string &string)
+{
+    auto it = _stringIndices.find(string);
+    if (it != _stringIndices.end())
+    {
+        return it->second;
+    }
+
+    const uint32_t index = uint32_t(_stringOffsets.size());
+    _stringOffsets.push_back(uint32_t(_strings.size()));
+    _strings.append(string);
+    _strings.push_back('\0');
+
+    _stringIndices[string] = index;
+    return index;
+}
+
+RecordReader::RecordReader(const char *records, size_t size, const uint32_t *stringOffsets, uint32_t stringCount,
+                           const char *strings)
+    : _records{records}, _size{size}, _stringOffsets{stringOffsets}, _stringCount{stringCount}, _strings{strings}
+{
+}
+
+RecordReader::RecordReader(const RecordWriter &writer)
+    : RecordReader{writer.getRecords().data(), writer.getRecords().size(), writer.getStringOffsets().data(),
+                   uint32_t(writer.getStringOffsets().size()), writer.getStrings().data()}
+{
+}
+
+const char *RecordReader::getString(uint32_t index) const
+{
+    return index < _stringCount ? _strings + _stringOffsets[index] : "";
+}
+
+const ActorBuilder *RecordReader::getActorBuilder(uint32_t type)
+{
+    auto it = _actorBuilders.find(type);
+    if (it == _actorBuilders.end())
+    {
+        it = _actorBuilders.emplace(type, Register::getInstance().findActor(getString(type))).first;
+    }
+
+    return it->second;
+}
+
+const ComponentBuilder *RecordReader::getComponentBuilder(uint32_t type)
+{
+    auto it = _componentBuilders.find(type);
+    if (it == _componentBuilders.end())
+    {
+        it = _componentBuilders.emplace(type, Register::getInstance().findComponent(getString(type))).first;
+    }
+
+    return it->second;
+}
+
+void RecordReader::seek(size_t offset)
+{
+    if (offset > _size)
+    {
+        spdlog::error("RecordReader: attempt to seek past the end of the records");
+        _failed = true;
+        return;
+    }
+
+    _offset = offset;
+}
+
+} // namespace cmx
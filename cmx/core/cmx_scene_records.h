@@ -0,0 +1,265 @@
+#ifndef CMX_SCENE_RECORDS
+#define CMX_SCENE_RECORDS
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace cmx
+{
+
+// fixed layout records of a scene, read in place from a .cmxscene mapping or a play mode snapshot, no document is
+// built in between, strings are indices into the records' own string table
+// SceneRecord | LightEnvironmentRecord | GraphicsManagerRecord | TickLODRecord | actors
+// an actor is its ActorRecord, every component's ComponentRecord and own record, then its own type's record
+// every record is made of 4 byte fields, so they stay aligned back to back
+
+constexpr uint32_t NO_RECORD_STRING = UINT32_MAX;
+
+struct SceneRecord
+{
+    uint32_t name;
+    uint32_t actorCount;
+};
+
+struct TransformRecord
+{
+    float position[3];
+    float rotation[4];
+    float scale[3];
+};
+
+struct ActorRecord
+{
+    uint32_t type;
+    uint32_t name;
+    uint32_t visible;
+    uint32_t tickLOD;
+    float tickInterval;
+    TransformRecord transform;
+    uint32_t componentCount;
+    // bytes following this record up to the next actor
+    uint32_t size;
+};
+
+struct ComponentRecord
+{
+    uint32_t type;
+    uint32_t name;
+    float tickInterval;
+    TransformRecord transform;
+    // bytes of the component type's own record, following this one
+    uint32_t size;
+};
+
+// followed by optionCount DrawOptionRecords
+struct DrawableRecord
+{
+    uint32_t optionCount;
+};
+
+// followed by textureCount texture names
+struct DrawOptionRecord
+{
+    uint32_t index;
+    uint32_t material;
+    uint32_t model;
+    uint32_t textureCount;
+};
+
+struct PhysicsBodyRecord
+{
+    uint32_t shape;
+    uint32_t physicsMode;
+    float gravity[3];
+    float inverseMass;
+    float bounciness;
+    float friction;
+};
+
+struct PointLightRecord
+{
+    float lightIntensity;
+    float lightColor[3];
+};
+
+struct CameraRecord
+{
+    float fov;
+    float nearPlane;
+    float farPlane;
+    uint32_t isMain;
+};
+
+// followed by markCount GradientMarkRecords
+struct LightEnvironmentRecord
+{
+    float timeOfDay;
+    uint32_t hasSun;
+    float sunAxis;
+    float shadowDistance;
+    uint32_t shadowCascades;
+    float ambientLighting[4];
+    uint32_t markCount;
+};
+
+struct GradientMarkRecord
+{
+    float position;
+    float color[3];
+};
+
+// followed by postProcessCount PostProcessRecords, the first one being the built in passthrough
+struct GraphicsManagerRecord
+{
+    uint32_t fusePostProcesses;
+    uint32_t postProcessCount;
+};
+
+struct PostProcessRecord
+{
+    uint32_t material;
+    uint32_t divisor;
+};
+
+struct TickLODRecord
+{
+    uint32_t enabled;
+    float nearDistance;
+    float farDistance;
+    float maxInterval;
+};
+
+using ActorBuilder = std::function<class Actor *(class Scene *, const char *)>;
+using ComponentBuilder = std::function<std::shared_ptr<class Component>()>;
+
+template <typename T> constexpr bool isRecord()
+{
+    return std::is_trivially_copyable<T>::value && alignof(T) <= sizeof(uint32_t) && sizeof(T) % sizeof(uint32_t) == 0;
+}
+
+class RecordWriter
+{
+  public:
+    // offset of the record, for patching it once what follows is known
+    template <typename T> size_t write(const T &record)
+    {
+        return write(&record, 1);
+    }
+
+    template <typename T> size_t write(const T *records, size_t count)
+    {
+        static_assert(isRecord<T>(), "RecordWriter: records are made of 4 byte fields only");
+
+        const size_t offset = _records.size();
+        _records.resize(offset + sizeof(T) * count);
+        if (count > 0)
+        {
+            memcpy(_records.data() + offset, records, sizeof(T) * count);
+        }
+        return offset;
+    }
+
+    // only valid until the next write
+    template <typename T> T &at(size_t offset)
+    {
+        return *reinterpret_cast<T *>(_records.data() + offset);
+    }
+
+    uint32_t addString(const std::string &);
+
+    size_t size() const
+    {
+        return _records.size();
+    }
+
+    const std::vector<char> &getRecords() const
+    {
+        return _records;
+    }
+
+    const std::vector<uint32_t> &getStringOffsets() const
+    {
+        return _stringOffsets;
+    }
+
+    const std::string &getStrings() const
+    {
+        return _strings;
+    }
+
+  private:
+    std::unordered_map<std::string, uint32_t> _stringIndices{};
+    std::vector<uint32_t> _stringOffsets{};
+    std::string _strings{};
+    // heap allocated, so aligned for any record
+    std::vector<char> _records{};
+};
+
+class RecordReader
+{
+  public:
+    // the string table is trusted, SceneFile checks it before handing a mapping over
+    RecordReader(const char *records, size_t size, const uint32_t *stringOffsets, uint32_t stringCount,
+                 const char *strings);
+    RecordReader(const RecordWriter &);
+
+    // points into the records, nullptr if they are too short, which also fails the reader
+    template <typename T> const T *read(size_t count = 1)
+    {
+        static_assert(isRecord<T>(), "RecordReader: records are made of 4 byte fields only");
+
+        if (_failed || count > (_size - _offset) / sizeof(T))
+        {
+            _failed = true;
+            return nullptr;
+        }
+
+        const T *records = reinterpret_cast<const T *>(_records + _offset);
+        _offset += sizeof(T) * count;
+        return records;
+    }
+
+    // empty for NO_RECORD_STRING
+    const char *getString(uint32_t index) const;
+
+    // registered types by string index, each type is only looked up once per read
+    const ActorBuilder *getActorBuilder(uint32_t type);
+    const ComponentBuilder *getComponentBuilder(uint32_t type);
+
+    size_t tell() const
+    {
+        return _offset;
+    }
+
+    void seek(size_t offset);
+
+    bool failed() const
+    {
+        return _failed;
+    }
+
+  private:
+    const char *_records;
+    size_t _size;
+    size_t _offset{0};
+    bool _failed{false};
+
+    const uint32_t *_stringOffsets;
+    uint32_t _stringCount;
+    const char *_strings;
+
+    std::unordered_map<uint32_t, const ActorBuilder *> _actorBuilders{};
+    std::unordered_map<uint32_t, const ComponentBuilder *> _componentBuilders{};
+};
+
+} // namespace cmx
+
+#endif
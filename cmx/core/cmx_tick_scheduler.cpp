@@ -0,0 +1,157 @@
+#include "cmx_tick_scheduler.h"
+
+// cmx
+#include "cmx_scene_records.h"
+
+// lib
+#include <glm/geometric.hpp>
+#include <imgui.h>
+
+// std
+#include <algorithm>
+#include <cmath>
+
+namespace cmx
+{
+
+void TickScheduler::schedule(uint32_t id, float delay)
+{
+    if (delay <= 0.f)
+    {
+        _nextFrame.push_back(Entry{id, 0, _time});
+        return;
+    }
+
+    const size_t ticks = std::max(size_t(std::ceil(delay / TICK_WHEEL_RESOLUTION)), size_t(1));
+    const size_t slot = (_cursor + ticks) % TICK_WHEEL_SLOTS;
+
+    _wheel[slot].push_back(Entry{id, uint32_t((ticks - 1) / TICK_WHEEL_SLOTS), _time});
+    _sleepingCount++;
+}
+
+void TickScheduler::advance(float dt, std::vector<Tick> &due)
+{
+    _time += dt;
+    _accumulator += dt;
+
+    due.clear();
+
+    _ticking.swap(_nextFrame);
+    _nextFrame.clear();
+    for (const Entry &entry : _ticking)
+    {
+        due.push_back(Tick{entry.id, float(_time - entry.scheduledAt)});
+    }
+
+    while (_accumulator >= TICK_WHEEL_RESOLUTION)
+    {
+        _accumulator -= TICK_WHEEL_RESOLUTION;
+        _cursor = (_cursor + 1) % TICK_WHEEL_SLOTS;
+
+        std::vector<Entry> &slot = _wheel[_cursor];
+
+        size_t i = 0;
+        while (i < slot.size())
+        {
+            if (slot[i].rounds > 0)
+            {
+                slot[i].rounds--;
+                i++;
+                continue;
+            }
+
+            due.push_back(Tick{slot[i].id, float(_time - slot[i].scheduledAt)});
+            _sleepingCount--;
+
+            slot[i] = slot.back();
+            slot.pop_back();
+        }
+    }
+}
+
+void TickScheduler::clear()
+{
+    _nextFrame.clear();
+    _ticking.clear();
+    for (auto &slot : _wheel)
+    {
+        slot.clear();
+    }
+
+    _cursor = 0;
+    _sleepingCount = 0;
+    _accumulator = 0.f;
+    _time = 0.;
+}
+
+float TickScheduler::getTickInterval(float baseInterval, const glm::vec3 &position,
+                                     const glm::vec3 &cameraPosition) const
+{
+    if (!lodEnabled || lodFarDistance <= lodNearDistance)
+    {
+        return baseInterval;
+    }
+
+    const float distance = glm::distance(position, cameraPosition);
+    const float t = std::clamp((distance - lodNearDistance) / (lodFarDistance - lodNearDistance), 0.f, 1.f);
+
+    return std::max(baseInterval, t * lodMaxInterval);
+}
+
+tinyxml2::XMLElement &TickScheduler::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const
+{
+    tinyxml2::XMLElement *tickElement = doc.NewElement("tickLOD");
+    tickElement->SetAttribute("enabled", lodEnabled);
+    tickElement->SetAttribute("near", lodNearDistance);
+    tickElement->SetAttribute("far", lodFarDistance);
+    tickElement->SetAttribute("maxInterval", lodMaxInterval);
+
+    parentElement->InsertEndChild(tickElement);
+
+    return *tickElement;
+}
+
+void TickScheduler::load(tinyxml2::XMLElement *parentElement)
+{
+    if (tinyxml2::XMLElement *tickElement = parentElement->FirstChildElement("tickLOD"))
+    {
+        lodEnabled = tickElement->BoolAttribute("enabled", lodEnabled);
+        lodNearDistance = tickElement->FloatAttribute("near", lodNearDistance);
+        lodFarDistance = tickElement->FloatAttribute("far", lodFarDistance);
+        lodMaxInterval = tickElement->FloatAttribute("maxInterval", lodMaxInterval);
+    }
+}
+
+void TickScheduler::writeRecord(RecordWriter &writer) const
+{
+    writer.write(TickLODRecord{lodEnabled, lodNearDistance, lodFarDistance, lodMaxInterval});
+}
+
+void TickScheduler::readRecord(RecordReader &reader)
+{
+    if (const TickLODRecord *record = reader.read<TickLODRecord>())
+    {
+        lodEnabled = record->enabled != 0;
+        lodNearDistance = record->nearDistance;
+        lodFarDistance = record->farDistance;
+        lodMaxInterval = record->maxInterval;
+    }
+}
+
+bool TickScheduler::editor()
+{
+    bool edited = ImGui::Checkbox("distance based update LOD", &lodEnabled);
+
+    if (lodEnabled)
+    {
+        edited |= ImGui::DragFloat("near distance", &lodNearDistance, 1.f, 0.f, lodFarDistance, "%.0f");
+        edited |= ImGui::DragFloat("far distance", &lodFarDistance, 1.f, lodNearDistance, 1000.f, "%.0f");
+        edited |= ImGui::DragFloat("max interval", &lodMaxInterval, 0.01f, 0.f, 2.f, "%.2fs");
+    }
+
+    ImGui::Text("sleeping actors: %zu", _sleepingCount);
+
+    return edited;
+}
+
+} // namespace cmx
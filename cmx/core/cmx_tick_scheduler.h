@@ -0,0 +1,74 @@
+#ifndef CMX_TICK_SCHEDULER
+#define CMX_TICK_SCHEDULER
+
+// lib
+#include <glm/ext/vector_float3.hpp>
+#include <tinyxml2.h>
+
+// std
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define TICK_WHEEL_SLOTS 256
+#define TICK_WHEEL_RESOLUTION (1.f / 60.f)
+
+namespace cmx
+{
+
+struct Tick
+{
+    uint32_t id;
+    float dt; // time elapsed since the previous tick
+};
+
+// timing wheel, actors ticking every frame go through a flat list while throttled ones sleep in their slot until due
+class TickScheduler
+{
+  public:
+    void schedule(uint32_t id, float delay);
+    void advance(float dt, std::vector<Tick> &due);
+    void clear();
+
+    // distance based update LOD, far away actors get their interval raised up to `lodMaxInterval`
+    float getTickInterval(float baseInterval, const glm::vec3 &position, const glm::vec3 &cameraPosition) const;
+
+    tinyxml2::XMLElement &save(tinyxml2::XMLDocument &, tinyxml2::XMLElement *) const;
+    void load(tinyxml2::XMLElement *);
+    void writeRecord(class RecordWriter &) const;
+    void readRecord(class RecordReader &);
+    // true when edited, the scene is then marked dirty
+    bool editor();
+
+    size_t getSleepingCount() const
+    {
+        return _sleepingCount;
+    }
+
+    bool lodEnabled{true};
+    float lodNearDistance{30.f};
+    float lodFarDistance{150.f};
+    float lodMaxInterval{.5f};
+
+  private:
+    struct Entry
+    {
+        uint32_t id;
+        uint32_t rounds;
+        double scheduledAt;
+    };
+
+    std::vector<Entry> _nextFrame{};
+    std::vector<Entry> _ticking{};
+    std::array<std::vector<Entry>, TICK_WHEEL_SLOTS> _wheel{};
+
+    size_t _cursor{0};
+    size_t _sleepingCount{0};
+    float _accumulator{0.f};
+    double _time{0.};
+};
+
+} // namespace cmx
+
+#endif
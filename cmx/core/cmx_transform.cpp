@@ -4,6 +4,7 @@
 #include "cmx_camera.h"
 #include "cmx_editor.h"
 #include "cmx_scene.h"
+#include "cmx_scene_records.h"
 
 // lib
 #include <glm/ext/quaternion_geometric.hpp>
@@ -88,15 +89,17 @@ Transform operator+(const Transform &a, const Transform &b)
     return c;
 }
 
-void Transform::editor()
+bool Transform::editor()
 {
+    bool edited{false};
+
     if (ImGui::TreeNode("Transform"))
     {
         float *positionFloat[3] = {&(this->position.x), &(this->position.y), &(this->position.z)};
-        ImGui::DragFloat3("Position", *positionFloat, 0.1f);
+        edited |= ImGui::DragFloat3("Position", *positionFloat, 0.1f);
 
         float *scaleFloat[3] = {&(this->scale.x), &(this->scale.y), &(this->scale.z)};
-        ImGui::DragFloat3("Scale", *scaleFloat, 0.1f);
+        edited |= ImGui::DragFloat3("Scale", *scaleFloat, 0.1f);
 
         float *eulerFloat[3] = {&(_euler.x), &(_euler.y), &(_euler.z)};
         ImGui::DragFloat3("Euler", *eulerFloat, 0.1f);
@@ -112,6 +115,7 @@ void Transform::editor()
         if (_isActive)
         {
             rotation = glm::quat{glm::radians(_euler)};
+            edited = true;
         }
     }
     else
@@ -121,9 +125,12 @@ void Transform::editor()
             rotation = glm::quat{glm::radians(_euler)} * rotation;
             rotation = glm::normalize(rotation);
             _euler = glm::vec3{0.f, 0.f, 0.f};
+            edited = true;
         }
     }
     _wasActive = _isActive;
+
+    return edited;
 }
 
 tinyxml2::XMLElement &Transform::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const
@@ -179,6 +186,21 @@ void Transform::load(tinyxml2::XMLElement *transformElement)
     }
 }
 
+void Transform::writeRecord(TransformRecord &record) const
+{
+    record = TransformRecord{{position.x, position.y, position.z},
+                             {rotation.x, rotation.y, rotation.z, rotation.w},
+                             {scale.x, scale.y, scale.z}};
+}
+
+void Transform::readRecord(const TransformRecord &record)
+{
+    position = glm::vec3{record.position[0], record.position[1], record.position[2]};
+    rotation = glm::quat{record.rotation[3], record.rotation[0], record.rotation[1], record.rotation[2]};
+    rotation = glm::normalize(rotation);
+    scale = glm::vec3{record.scale[0], record.scale[1], record.scale[2]};
+}
+
 ImGuizmo::OPERATION Transformable::currentGuizmoOperation{ImGuizmo::ROTATE};
 bool Transformable::guizmoSnap{true};
 float Transformable::guizmoSnapTo{1.0f};
@@ -186,22 +208,26 @@ float Transformable::guizmoSnapTo{1.0f};
 void Transformable::setPosition(const glm::vec3 &position)
 {
     _transform.position = position;
+    markDirty();
 }
 
 void Transformable::setRotation(const glm::quat &rotation)
 {
     _transform.rotation = rotation;
     _transform.rotation = glm::normalize(_transform.rotation);
+    markDirty();
 }
 
 void Transformable::setRotation(const glm::vec3 &euler)
 {
     _transform.rotation = glm::quat{euler};
+    markDirty();
 }
 
 void Transformable::setScale(const glm::vec3 &scale)
 {
     _transform.scale = scale;
+    markDirty();
 }
 
 #ifndef NDEBUG
@@ -225,6 +251,11 @@ void Transformable::editor(class Camera *camera)
                          (float *)&localMat, NULL, (guizmoSnap) ? snap : defaultSnap);
 
     _transform.fromMat4(localMat);
+
+    if (ImGuizmo::IsUsing())
+    {
+        markDirty();
+    }
 }
 #endif
 
@@ -31,9 +31,12 @@ struct Transform
     glm::vec3 right() const;
     glm::vec3 up() const;
 
-    void editor();
+    // true when edited
+    bool editor();
     tinyxml2::XMLElement &save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const;
     void load(tinyxml2::XMLElement *);
+    void writeRecord(struct TransformRecord &) const;
+    void readRecord(const struct TransformRecord &);
 
     static Transform ONE;
 
@@ -58,6 +61,9 @@ class Transformable
 
     void editor(class Camera *camera);
 
+    // called by every change worth saving, actors keep track of it for the scene's incremental saves
+    virtual void markDirty() {};
+
     void setPosition(const glm::vec3 &position);
     void setRotation(const glm::quat &rotation);
     void setRotation(const glm::vec3 &euler);
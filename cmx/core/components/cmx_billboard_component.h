@@ -4,6 +4,7 @@
 // cmx
 #include "cmx_component.h"
 #include "cmx_drawable.h"
+#include "cmx_register.h"
 
 // lib
 #include <vulkan/vulkan_core.h>
@@ -33,4 +34,6 @@ class BillboardComponent : public Component, public virtual Drawable
 
 } // namespace cmx
 
+REGISTER_COMPONENT(cmx::BillboardComponent)
+
 #endif
@@ -4,6 +4,7 @@
 #include "cmx_actor.h"
 #include "cmx_camera.h"
 #include "cmx_register.h"
+#include "cmx_scene_records.h"
 #ifndef NDEBUG
 #include "cmx_mesh_material.h"
 #endif
@@ -82,6 +83,8 @@ void CameraComponent::editor(int i)
 #ifndef NDEBUG
     if (ImGui::Checkbox("make main", &_mainCamera))
     {
+        markDirty();
+
         if (_mainCamera)
         {
             _material->setColor({1, 1, 0});
@@ -92,7 +95,10 @@ void CameraComponent::editor(int i)
         }
     }
 
-    _camera->editor();
+    if (_camera->editor())
+    {
+        markDirty();
+    }
     Component::editor(i);
     Drawable::editor(i);
 #endif
@@ -141,4 +147,36 @@ tinyxml2::XMLElement &CameraComponent::save(tinyxml2::XMLDocument &doc, tinyxml2
     return cameraComponent;
 }
 
+// the debug gizmo isn't part of the record, onAttach sets it up again
+void CameraComponent::writeRecord(RecordWriter &writer) const
+{
+    Component::writeRecord(writer);
+    writer.write(CameraRecord{_camera->getFOV(), _camera->getNearPlane(), _camera->getFarPlane(), _mainCamera});
+}
+
+void CameraComponent::readRecord(RecordReader &reader, const ComponentRecord &componentRecord)
+{
+    Component::readRecord(reader, componentRecord);
+
+    const CameraRecord *record = reader.read<CameraRecord>();
+    if (record == nullptr)
+    {
+        return;
+    }
+
+    _camera->setFOV(record->fov);
+    _camera->setNearPlane(record->nearPlane);
+    _camera->setFarPlane(record->farPlane);
+    _mainCamera = record->isMain != 0;
+
+#ifndef NDEBUG
+    _material->setColor(_mainCamera ? glm::vec3{1, 1, 0} : glm::vec3{0, 1, 1});
+#endif
+
+    if (_mainCamera)
+    {
+        _parent->getScene()->setCamera(_camera);
+    }
+}
+
 } // namespace cmx
@@ -34,6 +34,8 @@ class CameraComponent : public Component
     void editor(int i) override;
     void load(tinyxml2::XMLElement *componentElement) override;
     tinyxml2::XMLElement &save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const override;
+    void writeRecord(class RecordWriter &) const override;
+    void readRecord(class RecordReader &, const struct ComponentRecord &) override;
 
     const std::shared_ptr<class Camera> getCamera()
     {
@@ -4,11 +4,13 @@
 #include "cmx_actor.h"
 #include "cmx_frame_info.h"
 #include "cmx_register.h"
+#include "cmx_scene_records.h"
 
 // lib
 #include <spdlog/spdlog.h>
 
 // std
+#include <stdexcept>
 #ifndef _WIN32
 #include <cxxabi.h>
 #else
@@ -22,9 +24,15 @@ REGISTER_COMPONENT(cmx::Component)
 namespace cmx
 {
 
-Component::~Component()
+void Component::tick(float dt)
 {
-    onDetach();
+    _timeSinceTick += dt;
+
+    if (_timeSinceTick < _tickInterval)
+        return;
+
+    update(_timeSinceTick);
+    _timeSinceTick = 0.f;
 }
 
 void Component::render(const FrameInfo &, vk::PipelineLayout)
@@ -36,7 +44,13 @@ void Component::editor(int i)
 {
     ImGui::PushID(i);
 
-    _transform.editor();
+    bool edited = _transform.editor();
+    edited |= ImGui::DragFloat("tick interval", &_tickInterval, 0.01f, 0.f, 10.f, "%.2fs");
+
+    if (edited)
+    {
+        markDirty();
+    }
 
     ImGui::PopID();
 }
@@ -46,6 +60,7 @@ tinyxml2::XMLElement &Component::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLE
     tinyxml2::XMLElement *componentElement = doc.NewElement("component");
     componentElement->SetAttribute("type", getType().c_str());
     componentElement->SetAttribute("name", name.c_str());
+    componentElement->SetAttribute("tickInterval", _tickInterval);
     parentElement->InsertEndChild(componentElement);
 
     _transform.save(doc, componentElement);
@@ -55,22 +70,42 @@ tinyxml2::XMLElement &Component::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLE
 
 void Component::load(tinyxml2::XMLElement *componentElement)
 {
+    _tickInterval = componentElement->FloatAttribute("tickInterval", _tickInterval);
+
     if (tinyxml2::XMLElement *transformElement = componentElement->FirstChildElement("transform"))
     {
         _transform.load(transformElement);
     }
 }
 
-#ifdef _WIN32
+void Component::writeRecord(RecordWriter &writer) const
+{
+    ComponentRecord record{writer.addString(getType()), writer.addString(name), _tickInterval};
+    _transform.writeRecord(record.transform);
+    writer.write(record);
+}
+
+void Component::readRecord(RecordReader &, const ComponentRecord &record)
+{
+    _tickInterval = record.tickInterval;
+    _transform.readRecord(record.transform);
+}
+
 std::string Component::getType() const
 {
-    return std::regex_replace(typeid(*this).name(), std::regex(R"(^(class |struct ))"), "");
+    return getTypeInfo().name;
+}
+
+#ifdef _WIN32
+static std::string demangle(const char *typeName)
+{
+    return std::regex_replace(typeName, std::regex(R"(^(class |struct ))"), "");
 }
 #else
-std::string Component::getType() const
+static std::string demangle(const char *typeName)
 {
     int status;
-    char *demangled = abi::__cxa_demangle(typeid(*this).name(), nullptr, nullptr, &status);
+    char *demangled = abi::__cxa_demangle(typeName, nullptr, nullptr, &status);
 
     if (status == 0)
     {
@@ -81,11 +116,26 @@ std::string Component::getType() const
     else
     {
         spdlog::critical("Component: Error demangling component type");
-        return typeid(this).name();
+        return typeName;
     }
 }
 #endif
 
+const ComponentTypeInfo &Component::resolveTypeInfo() const
+{
+    Register &cmxRegister = Register::getInstance();
+
+    _typeInfo = cmxRegister.findComponentType(typeid(*this));
+    if (_typeInfo == nullptr)
+    {
+        // every component type is known at compile time, guessing its interfaces at runtime would hide the mistake
+        throw std::runtime_error("Component: <" + demangle(typeid(*this).name()) +
+                                 "> isn't registered, use REGISTER_COMPONENT");
+    }
+
+    return *_typeInfo;
+}
+
 void Component::setParent(Actor *actor)
 {
     _parent = actor;
@@ -97,6 +147,14 @@ void Component::setParent(Actor *actor)
     }
 }
 
+void Component::markDirty()
+{
+    if (_parent != nullptr)
+    {
+        _parent->markDirty();
+    }
+}
+
 const Transform &Component::getLocalSpaceTransform() const
 {
     return _transform;
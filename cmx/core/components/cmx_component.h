@@ -16,17 +16,62 @@
 #include <vulkan/vulkan.hpp>
 
 // std
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <type_traits>
 
 namespace cmx
 {
 
+class Component;
+class Drawable;
+class PhysicsBody;
+
+enum ComponentInterface : uint32_t
+{
+    IS_DRAWABLE = 1 << 0,
+    IS_PHYSICS_BODY = 1 << 1,
+    HAS_UPDATE = 1 << 2
+};
+
+// FNV-1a of the registered type name, stable across builds so it may be compared with what was saved
+constexpr uint32_t hashComponentType(const char *typeName)
+{
+    uint32_t hash = 2166136261u;
+    for (; *typeName != '\0'; typeName++)
+    {
+        hash = (hash ^ uint32_t(*typeName)) * 16777619u;
+    }
+    return hash;
+}
+
+// specialized by REGISTER_COMPONENT, 0 for unregistered types
+template <typename T> struct ComponentType
+{
+    static constexpr uint32_t id = 0;
+};
+
+// resolved once per type, components only keep a pointer to it
+struct ComponentTypeInfo
+{
+    uint32_t id;
+    uint32_t interfaces;
+    std::string name;
+
+    Drawable *(*asDrawable)(Component *);
+    PhysicsBody *(*asPhysicsBody)(Component *);
+};
+
+template <typename T> ComponentTypeInfo makeComponentTypeInfo(const char *typeName);
+
 class Component : public virtual Transformable
 {
   public:
     Component() = default;
-    ~Component();
+    ~Component() = default;
 
+    // called by the scene when the component leaves it, while its managers are still alive
     virtual void onDetach() {};
     virtual void onAttach() {};
 
@@ -35,11 +80,16 @@ class Component : public virtual Transformable
         return std::make_shared<Component>(*this);
     }
 
+    // calls update once every tick interval, with the time elapsed since the previous update
+    void tick(float dt);
     virtual void update(float dt) {};
     virtual void render(const struct FrameInfo &, vk::PipelineLayout);
 
     virtual tinyxml2::XMLElement &save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const;
     virtual void load(tinyxml2::XMLElement *);
+    // fixed layout counterparts of save and load, the record's header is written here and read by the actor
+    virtual void writeRecord(class RecordWriter &) const;
+    virtual void readRecord(class RecordReader &, const struct ComponentRecord &);
 
     // for viewport
     virtual void editor(int i);
@@ -48,6 +98,32 @@ class Component : public virtual Transformable
 
     std::string getType() const;
 
+    // resolved when first attached to an actor
+    const ComponentTypeInfo &getTypeInfo() const
+    {
+        return _typeInfo ? *_typeInfo : resolveTypeInfo();
+    }
+
+    uint32_t getTypeID() const
+    {
+        return getTypeInfo().id;
+    }
+
+    bool hasInterface(uint32_t interfaces) const
+    {
+        return (getTypeInfo().interfaces & interfaces) == interfaces;
+    }
+
+    Drawable *asDrawable()
+    {
+        return hasInterface(IS_DRAWABLE) ? _typeInfo->asDrawable(this) : nullptr;
+    }
+
+    PhysicsBody *asPhysicsBody()
+    {
+        return hasInterface(IS_PHYSICS_BODY) ? _typeInfo->asPhysicsBody(this) : nullptr;
+    }
+
     // getters and setters :: begin
     void setParent(class Actor *actor);
 
@@ -63,6 +139,26 @@ class Component : public virtual Transformable
     {
         return _scene;
     }
+
+    // nullptr while parked in a SceneSnapshot, see Actor::setScene
+    void setScene(class Scene *scene)
+    {
+        _scene = scene;
+    }
+
+    float getTickInterval() const
+    {
+        return _tickInterval;
+    }
+
+    void setTickInterval(float tickInterval)
+    {
+        _tickInterval = tickInterval;
+        markDirty();
+    }
+
+    // components are saved with their actor, which is marked instead
+    void markDirty() override;
     // getters and setters :: end
 
     std::string name;
@@ -70,8 +166,73 @@ class Component : public virtual Transformable
   protected:
     class Actor *_parent{nullptr};
     class Scene *_scene{nullptr};
+
+    float _tickInterval{0.f};
+    float _timeSinceTick{0.f};
+
+  private:
+    const ComponentTypeInfo &resolveTypeInfo() const;
+
+    mutable const ComponentTypeInfo *_typeInfo{nullptr};
 };
 
+template <typename T> inline ComponentTypeInfo makeComponentTypeInfo(const char *typeName)
+{
+    uint32_t interfaces = 0;
+    if constexpr (std::is_base_of<Drawable, T>::value)
+    {
+        interfaces |= IS_DRAWABLE;
+    }
+    if constexpr (std::is_base_of<PhysicsBody, T>::value)
+    {
+        interfaces |= IS_PHYSICS_BODY;
+    }
+    // &T::update names the class that last declared it, so this tells overrides from Component's empty update
+    if constexpr (!std::is_same<decltype(&T::update), decltype(&Component::update)>::value)
+    {
+        interfaces |= HAS_UPDATE;
+    }
+
+    return ComponentTypeInfo{hashComponentType(typeName), interfaces, typeName,
+                             [](Component *component) -> Drawable * {
+                                 if constexpr (std::is_base_of<Drawable, T>::value)
+                                     return static_cast<T *>(component);
+                                 else
+                                     return nullptr;
+                             },
+                             [](Component *component) -> PhysicsBody * {
+                                 if constexpr (std::is_base_of<PhysicsBody, T>::value)
+                                     return static_cast<T *>(component);
+                                 else
+                                     return nullptr;
+                             }};
+}
+
+template <typename T> inline void Scene::getAllComponentsByType(std::vector<std::weak_ptr<Component>> &componentList)
+{
+    if constexpr (!std::is_base_of<Component, T>::value)
+    {
+        spdlog::error(
+            "Scene {0}: '{1}' is not of base type 'Components', 'getAllComponentsByType<{2}>' will return nothing",
+            name, typeid(T).name(), typeid(T).name());
+        return;
+    }
+    for (auto component : _components)
+    {
+        if constexpr (ComponentType<T>::id != 0)
+        {
+            if (component->getTypeID() == ComponentType<T>::id)
+            {
+                componentList.push_back(component);
+            }
+        }
+        else if (typeid(T) == typeid(*component))
+        {
+            componentList.push_back(component);
+        }
+    }
+}
+
 } // namespace cmx
 
 #define CONCAT_IMPL(x, y) x##y
@@ -79,11 +240,16 @@ class Component : public virtual Transformable
 #define UNIQUE_ID CONCAT(__COUNTER__, __LINE__)
 
 #define REGISTER_COMPONENT_INTERNAL(Type, ID)                                                                          \
+    template <> struct cmx::ComponentType<Type>                                                                        \
+    {                                                                                                                  \
+        static constexpr uint32_t id = cmx::hashComponentType(#Type);                                                  \
+    };                                                                                                                 \
     struct CONCAT(Registrar_, ID)                                                                                      \
     {                                                                                                                  \
         CONCAT(Registrar_, ID)()                                                                                       \
         {                                                                                                              \
-            cmx::Register::getInstance().addComponent(#Type, []() { return std::make_shared<Type>(); });               \
+            cmx::Register::getInstance().addComponent(#Type, []() { return std::make_shared<Type>(); }, typeid(Type),  \
+                                                      cmx::makeComponentTypeInfo<Type>(#Type));                        \
         }                                                                                                              \
     };                                                                                                                 \
     [[maybe_unused]] inline CONCAT(Registrar_, ID) CONCAT(registrar_, ID){};
@@ -4,6 +4,7 @@
 #include "cmx_actor.h"
 #include "cmx_assets_manager.h"
 #include "cmx_primitives.h"
+#include "cmx_scene_records.h"
 
 // lib
 #include <GLFW/glfw3.h>
@@ -49,6 +50,18 @@ void MeshComponent::load(tinyxml2::XMLElement *componentElement)
     Drawable::load(componentElement);
 }
 
+void MeshComponent::writeRecord(RecordWriter &writer) const
+{
+    Component::writeRecord(writer);
+    Drawable::writeRecord(writer);
+}
+
+void MeshComponent::readRecord(RecordReader &reader, const ComponentRecord &componentRecord)
+{
+    Component::readRecord(reader, componentRecord);
+    Drawable::readRecord(reader);
+}
+
 void MeshComponent::editor(int i)
 {
     Component::editor(i);
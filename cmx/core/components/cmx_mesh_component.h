@@ -37,6 +37,8 @@ class MeshComponent : public Component, public virtual Drawable
 
     tinyxml2::XMLElement &save(tinyxml2::XMLDocument &, tinyxml2::XMLElement *) const override;
     void load(tinyxml2::XMLElement *) override;
+    void writeRecord(class RecordWriter &) const override;
+    void readRecord(class RecordReader &, const struct ComponentRecord &) override;
     void editor(int i) override;
 };
 
@@ -5,6 +5,7 @@
 #include "cmx_physics_body.h"
 #include "cmx_physics_manager.h"
 #include "cmx_primitives.h"
+#include "cmx_scene_records.h"
 #include "imgui.h"
 
 // lib
@@ -70,6 +71,18 @@ void PhysicsComponent::load(tinyxml2::XMLElement *componentElement)
     PhysicsBody::load(componentElement);
 }
 
+void PhysicsComponent::writeRecord(RecordWriter &writer) const
+{
+    Component::writeRecord(writer);
+    PhysicsBody::writeRecord(writer);
+}
+
+void PhysicsComponent::readRecord(RecordReader &reader, const ComponentRecord &componentRecord)
+{
+    Component::readRecord(reader, componentRecord);
+    PhysicsBody::readRecord(reader);
+}
+
 void PhysicsComponent::editor(int i)
 {
     PhysicsBody::editor(i);
@@ -28,6 +28,8 @@ class PhysicsComponent : public Component,
 
     tinyxml2::XMLElement &save(tinyxml2::XMLDocument &, tinyxml2::XMLElement *) const override;
     void load(tinyxml2::XMLElement *) override;
+    void writeRecord(class RecordWriter &) const override;
+    void readRecord(class RecordReader &, const struct ComponentRecord &) override;
     void editor(int i) override;
 
     void setPhysicsMode(PhysicsMode) override;
@@ -5,6 +5,7 @@
 #include "cmx_frame_info.h"
 #include "cmx_graphics_manager.h"
 #include "cmx_render_system.h"
+#include "cmx_scene_records.h"
 #include "cmx_texture.h"
 
 // lib
@@ -15,8 +16,6 @@
 namespace cmx
 {
 
-uint32_t PointLightComponent::_keyChain{0u};
-
 PointLightComponent::PointLightComponent()
 {
 }
@@ -28,18 +27,48 @@ void PointLightComponent::onAttach()
         _texture = getScene()->getAssetsManager()->get2DTexture("cmx_point_light");
     }
 
-    _key = _keyChain++;
-
     Transform absoluteTransform = getWorldSpaceTransform();
     _absolutePosition = absoluteTransform.position;
     _absoluteScaleXY = glm::vec2(absoluteTransform.scale.x, absoluteTransform.scale.y);
 
-    getScene()->getLightEnvironment()->addPointLight(_key, {&_absolutePosition, &_lightColor, &_lightIntensity});
+    _lightHandle = getScene()->getLightEnvironment()->createPointLight();
+    _lightDirty = true;
+    pushLight();
 }
 
 void PointLightComponent::onDetach()
 {
-    getScene()->getLightEnvironment()->removePointLight(_key);
+    if (_lightHandle == INVALID_POINT_LIGHT)
+        return;
+
+    // parked in a snapshot, its light went with the parked light environment
+    if (getScene() == nullptr)
+        return;
+
+    if (LightEnvironment *lightEnvironment = getScene()->getLightEnvironment())
+    {
+        lightEnvironment->releasePointLight(_lightHandle);
+    }
+    _lightHandle = INVALID_POINT_LIGHT;
+}
+
+void PointLightComponent::update(float dt)
+{
+    pushLight();
+}
+
+void PointLightComponent::pushLight()
+{
+    if (_lightHandle == INVALID_POINT_LIGHT)
+        return;
+
+    const glm::vec3 position = getWorldSpaceTransform().position;
+    if (!_lightDirty && position == _absolutePosition)
+        return;
+
+    _absolutePosition = position;
+    _lightDirty = false;
+    getScene()->getLightEnvironment()->updatePointLight(_lightHandle, _absolutePosition, _lightColor, _lightIntensity);
 }
 
 void PointLightComponent::render(const FrameInfo &frameInfo, vk::PipelineLayout pipelineLayout)
@@ -76,8 +105,15 @@ void PointLightComponent::render(const FrameInfo &frameInfo, vk::PipelineLayout
 
 void PointLightComponent::editor(int i)
 {
-    ImGui::DragFloat("Light Intensity", &_lightIntensity, 0.01f, 0.0f, 100.0f, "%.2f");
-    ImGui::ColorPicker3("Light Color", (float *)&_lightColor);
+    bool edited = ImGui::DragFloat("Light Intensity", &_lightIntensity, 0.01f, 0.0f, 100.0f, "%.2f");
+    edited |= ImGui::ColorPicker3("Light Color", (float *)&_lightColor);
+    if (edited)
+    {
+        _lightDirty = true;
+        markDirty();
+    }
+    // the scene doesn't update while editing
+    pushLight();
 
     Component::editor(i);
 }
@@ -90,6 +126,7 @@ void PointLightComponent::load(tinyxml2::XMLElement *componentElement)
     _lightColor.r = componentElement->FloatAttribute("r");
     _lightColor.g = componentElement->FloatAttribute("g");
     _lightColor.b = componentElement->FloatAttribute("b");
+    _lightDirty = true;
 }
 
 tinyxml2::XMLElement &PointLightComponent::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const
@@ -104,4 +141,22 @@ tinyxml2::XMLElement &PointLightComponent::save(tinyxml2::XMLDocument &doc, tiny
     return componentElement;
 }
 
+void PointLightComponent::writeRecord(RecordWriter &writer) const
+{
+    Component::writeRecord(writer);
+    writer.write(PointLightRecord{_lightIntensity, {_lightColor.r, _lightColor.g, _lightColor.b}});
+}
+
+void PointLightComponent::readRecord(RecordReader &reader, const ComponentRecord &componentRecord)
+{
+    Component::readRecord(reader, componentRecord);
+
+    if (const PointLightRecord *record = reader.read<PointLightRecord>())
+    {
+        _lightIntensity = record->lightIntensity;
+        _lightColor = glm::vec3{record->lightColor[0], record->lightColor[1], record->lightColor[2]};
+        _lightDirty = true;
+    }
+}
+
 } // namespace cmx
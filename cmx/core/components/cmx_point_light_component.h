@@ -2,6 +2,7 @@
 #define CMX_POINT_LIGHT_COMPONENT
 
 #include "cmx_component.h"
+#include "cmx_light_environment.h"
 #include "cmx_register.h"
 
 // lib
@@ -20,12 +21,15 @@ class PointLightComponent : public Component
 
     void onAttach() override;
     void onDetach() override;
+    void update(float dt) override;
 
     void render(const struct FrameInfo &, vk::PipelineLayout) override;
 
     void editor(int i) override;
     void load(tinyxml2::XMLElement *componentElement) override;
     tinyxml2::XMLElement &save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const override;
+    void writeRecord(class RecordWriter &) const override;
+    void readRecord(class RecordReader &, const struct ComponentRecord &) override;
 
     float getLightIntensity() const
     {
@@ -34,6 +38,8 @@ class PointLightComponent : public Component
     void setLightIntensity(float lightIntensity)
     {
         _lightIntensity = lightIntensity;
+        _lightDirty = true;
+        markDirty();
     }
 
     const glm::vec3 &getLightColor()
@@ -43,6 +49,8 @@ class PointLightComponent : public Component
     void setLightColor(const glm::vec3 &lightColor)
     {
         _lightColor = lightColor;
+        _lightDirty = true;
+        markDirty();
     }
 
   private:
@@ -54,8 +62,11 @@ class PointLightComponent : public Component
     glm::vec3 _absolutePosition{};
     glm::vec2 _absoluteScaleXY{1.0f};
 
-    uint32_t _key;
-    static uint32_t _keyChain;
+    // writes the light into its registry slot, only when it moved or changed since the last write
+    void pushLight();
+
+    uint32_t _lightHandle{INVALID_POINT_LIGHT};
+    bool _lightDirty{true};
 };
 
 REGISTER_COMPONENT(cmx::PointLightComponent)
@@ -5,6 +5,7 @@
 #include "cmx_math.h"
 #include "cmx_physics_manager.h"
 #include "cmx_primitives.h"
+#include "cmx_scene_records.h"
 #include "cmx_shapes.h"
 
 namespace cmx
@@ -17,6 +18,7 @@ PhysicsBody::PhysicsBody(class Actor **parentP) : _parentP{parentP}
 void PhysicsBody::setPhysicsMode(PhysicsMode newMode)
 {
     _physicsMode = newMode;
+    markDirty();
 
     if (getParentActor() == nullptr)
         return;
@@ -26,6 +28,8 @@ void PhysicsBody::setPhysicsMode(PhysicsMode newMode)
 
 void PhysicsBody::setShape(const std::string &type)
 {
+    markDirty();
+
     if (type.compare(PRIMITIVE_SPHERE) == 0)
     {
         _shape = std::shared_ptr<Shape>(new Sphere(this));
@@ -306,6 +310,33 @@ void PhysicsBody::load(tinyxml2::XMLElement *componentElement)
     }
 }
 
+void PhysicsBody::writeRecord(RecordWriter &writer) const
+{
+    writer.write(PhysicsBodyRecord{writer.addString(_shape->getName()), uint32_t(_physicsMode),
+                                   {_gravity.x, _gravity.y, _gravity.z}, _inverseMass, _bounciness, _friction});
+}
+
+void PhysicsBody::readRecord(RecordReader &reader)
+{
+    const PhysicsBodyRecord *record = reader.read<PhysicsBodyRecord>();
+    if (record == nullptr || record->physicsMode > PhysicsMode::RIGID)
+    {
+        return;
+    }
+
+    setShape(reader.getString(record->shape));
+    setPhysicsMode(PhysicsMode(record->physicsMode));
+
+    if (_physicsMode == PhysicsMode::RIGID)
+    {
+        _gravity = glm::vec3{record->gravity[0], record->gravity[1], record->gravity[2]};
+        _inverseMass = record->inverseMass <= glm::epsilon<float>() ? 0.f : record->inverseMass;
+    }
+
+    _bounciness = record->bounciness;
+    _friction = record->friction;
+}
+
 void PhysicsBody::editor(int i)
 {
     {
@@ -365,24 +396,31 @@ void PhysicsBody::editor(int i)
         }
     }
 
-    ImGui::DragFloat("bounciness", &_bounciness, 0.05f, 0.f, 1.0f);
-    ImGui::DragFloat("friction", &_friction, 0.05f, 0.f, 1.0f);
+    bool edited = ImGui::DragFloat("bounciness", &_bounciness, 0.05f, 0.f, 1.0f);
+    edited |= ImGui::DragFloat("friction", &_friction, 0.05f, 0.f, 1.0f);
 
     if (_physicsMode == PhysicsMode::RIGID)
     {
-        ImGui::DragFloat("inverse mass", &_inverseMass, .1f, 0.f, 10.f);
-        ImGui::DragFloat3("gravity", (float *)&_gravity, 0.f, 100.f);
+        edited |= ImGui::DragFloat("inverse mass", &_inverseMass, .1f, 0.f, 10.f);
+        edited |= ImGui::DragFloat3("gravity", (float *)&_gravity, 0.f, 100.f);
+    }
+
+    if (edited)
+    {
+        markDirty();
     }
 }
 
 void PhysicsBody::setMass(float mass)
 {
     _inverseMass = 1.f / glm::max(glm::epsilon<float>(), mass);
+    markDirty();
 }
 
 void PhysicsBody::setInverseMass(float inverseMass)
 {
     _inverseMass = glm::max(0.f, inverseMass);
+    markDirty();
 }
 
 } // namespace cmx
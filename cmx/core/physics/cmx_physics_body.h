@@ -26,6 +26,8 @@ class PhysicsBody : public virtual Transformable
 
     tinyxml2::XMLElement &save(tinyxml2::XMLElement &) const;
     void load(tinyxml2::XMLElement *);
+    void writeRecord(class RecordWriter &) const;
+    void readRecord(class RecordReader &);
     void editor(int i);
 
     virtual void setPhysicsMode(PhysicsMode);
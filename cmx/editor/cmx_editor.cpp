@@ -4,6 +4,7 @@
 // cmx
 #include "cmx_game.h"
 #include "cmx_input_manager.h"
+#include "cmx_scene.h"
 #include "cmx_viewport_actor.h"
 #include "cmx_viewport_ui.h"
 
@@ -83,14 +84,13 @@ void Editor::play()
     {
         _playIntent = false;
         _viewportUI->saveState();
-        _scene->saveAs(".editor/temp.xml", false);
-        _scene->unload(true);
+        _snapshot = _scene->takeSnapshot();
         _scene->getGame()->getInputManager()->unbindAll();
 
         _active = false;
         _viewportActor->lock();
 
-        _scene->load(true);
+        _scene->loadSnapshot(*_snapshot);
     }
 }
 
@@ -98,11 +98,10 @@ void Editor::leave(float dt, int)
 {
     if (!_active)
     {
-        _scene->unload(true);
+        _scene->restoreSnapshot(std::move(_snapshot));
         _scene->getGame()->getInputManager()->unbindAll();
 
         _active = true;
-        _scene->load(true);
         _scene->setCamera(_viewportActor->getCamera(), true);
         _viewportUI->reloadState();
 
@@ -156,6 +155,17 @@ void Editor::update(float dt)
         _viewportActor->update(dt);
         _viewportUI->update();
 
+        _autosaveTimer += dt;
+        if (_autosaveTimer >= _autosaveInterval)
+        {
+            _autosaveTimer = 0.f;
+            // an idle editor would rewrite the same file every minute
+            if (_scene->hasUnsavedChanges())
+            {
+                _scene->saveInBackground(".editor/autosave.xml", false);
+            }
+        }
+
         if (_playIntent)
             play();
     }
@@ -49,6 +49,10 @@ class Editor
     void play();
     bool _playIntent{false};
 
+    // seconds between two background saves of the edited scene
+    float _autosaveInterval{60.f};
+    float _autosaveTimer{0.f};
+
     Editor();
 
     static Editor *_instance;
@@ -56,6 +60,8 @@ class Editor
     std::unique_ptr<class ViewportActor> _viewportActor;
     std::unique_ptr<class ViewportUI> _viewportUI;
     std::unique_ptr<class InputManager> _inputManager;
+    // editor scene parked while playing
+    std::unique_ptr<struct SceneSnapshot> _snapshot;
 
     class Scene *_scene;
 
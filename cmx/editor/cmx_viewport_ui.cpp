@@ -15,6 +15,7 @@
 #include "cmx_register.h"
 #include "cmx_render_system.h"
 #include "cmx_renderer.h"
+#include "cmx_scene_file.h"
 #include "cmx_sink.h"
 #include "cmx_transform.h"
 #include "cmx_viewport_actor.h"
@@ -109,6 +110,7 @@ void ViewportUI::initImGUI()
     initInfo.Device = cmxDevice.device();
     initInfo.Queue = cmxDevice.graphicsQueue();
     initInfo.DescriptorPool = _imguiPool->getDescriptorPool().operator VkDescriptorPool();
+    initInfo.PipelineCache = cmxDevice.getPipelineCache().operator VkPipelineCache();
     initInfo.MinImageCount = 3;
     initInfo.ImageCount = 3;
     initInfo.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
@@ -303,18 +305,16 @@ void ViewportUI::update()
 
     if (_openFileDialog.HasSelected())
     {
-        _attachedScene->unload();
-        _attachedScene->getGame()->getInputManager()->unbindAll();
-
-        if (Editor *editor = Editor::getInstance())
-        {
-            _attachedScene->loadFrom(_openFileDialog.GetSelected().string().c_str());
-
-            if (ViewportActor *viewportActor = editor->getViewportActor())
+        // the current scene keeps running until the new one is ready, the game swaps them
+        _attachedScene->getGame()->reloadSceneAsync(_openFileDialog.GetSelected().string(), nullptr, [](Scene *scene) {
+            if (Editor *editor = Editor::getInstance())
             {
-                _attachedScene->setCamera(viewportActor->getCamera(), true);
+                if (ViewportActor *viewportActor = editor->getViewportActor())
+                {
+                    scene->setCamera(viewportActor->getCamera(), true);
+                }
             }
-        }
+        });
 
         _openFileDialog.ClearSelected();
     }
@@ -399,15 +399,31 @@ void ViewportUI::renderTopBar()
             {
                 _saveFileDialog.SetPwd(GAME_FILES);
                 _saveFileDialog.SetTitle("choose save location");
-                _saveFileDialog.SetTypeFilters({".xml"});
+                _saveFileDialog.SetTypeFilters({".xml", CMX_SCENE_EXTENSION});
                 _saveFileDialog.Open();
             }
         }
+        if (ImGui::MenuItem(ICON_MS_SWAP_HORIZ " Convert scene file"))
+        {
+            if (_attachedScene == nullptr)
+            {
+                spdlog::warn("ViewportUI: No attached scene!");
+            }
+            else
+            {
+                // saved next to the current file in the other format, which the scene then keeps saving to
+                const std::string path = _attachedScene->getXMLPath();
+                const std::string stem = path.substr(0, path.find_last_of('.'));
+                const std::string converted = stem + (SceneFile::isBinary(path) ? ".xml" : CMX_SCENE_EXTENSION);
+
+                _attachedScene->saveAs(converted.c_str(), true);
+            }
+        }
         if (ImGui::MenuItem(ICON_MS_UPLOAD_FILE " Load from", "Ctrl+S"))
         {
             _openFileDialog.SetPwd(GAME_FILES);
             _openFileDialog.SetTitle("choose save location");
-            _openFileDialog.SetTypeFilters({".xml"});
+            _openFileDialog.SetTypeFilters({".xml", CMX_SCENE_EXTENSION});
             _openFileDialog.Open();
         }
         ImGui::EndMenu();
@@ -593,7 +609,22 @@ void ViewportUI::renderWorldManager()
         {
             activeTab = 0;
 
-            _attachedScene->getLightEnvironment()->editor();
+            if (_attachedScene->getLightEnvironment()->editor())
+            {
+                _attachedScene->markDirty();
+            }
+
+            ImGui::EndTabItem();
+        }
+
+        if (ImGui::BeginTabItem("Update"))
+        {
+            activeTab = 1;
+
+            if (_attachedScene->getTickScheduler().editor())
+            {
+                _attachedScene->markDirty();
+            }
 
             ImGui::EndTabItem();
         }
@@ -734,7 +765,10 @@ void ViewportUI::renderGraphicsManager()
     _showGraphicsManager = true;
     ImGui::Begin("Graphics Manager", &_showGraphicsManager, ImGuiWindowFlags_AlwaysAutoResize);
 
-    _attachedScene->getGraphicsManager()->editor(_attachedScene->getAssetsManager());
+    if (_attachedScene->getGraphicsManager()->editor(_attachedScene->getAssetsManager()))
+    {
+        _attachedScene->markDirty();
+    }
 
     ImGui::End();
 }
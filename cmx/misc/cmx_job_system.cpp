@@ -0,0 +1,149 @@
+#include "cmx_job_system.h"
+
+// lib
+#include <spdlog/spdlog.h>
+
+// std
+#include <algorithm>
+#include <exception>
+
+namespace cmx
+{
+
+thread_local bool JobSystem::_insideJob{false};
+
+JobSystem::JobSystem()
+{
+    const size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+
+    // the main thread takes part in every parallelFor, so we keep one core for it
+    for (size_t i = 0; i < hardwareThreads - 1; i++)
+    {
+        _workers.emplace_back(&JobSystem::work, this);
+    }
+
+    spdlog::info("JobSystem: started {0} worker threads", _workers.size());
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _stopping = true;
+    }
+    _condition.notify_all();
+
+    for (std::thread &worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+JobSystem &JobSystem::getInstance()
+{
+    static JobSystem instance;
+    return instance;
+}
+
+void JobSystem::work()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _condition.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+
+            if (_stopping && _jobs.empty())
+            {
+                return;
+            }
+
+            job = std::move(_jobs.front());
+            _jobs.pop();
+        }
+
+        _insideJob = true;
+        job();
+        _insideJob = false;
+    }
+}
+
+void JobSystem::parallelFor(size_t count, const std::function<void(size_t, size_t)> &job, size_t minBatchSize)
+{
+    if (count == 0)
+        return;
+
+    minBatchSize = std::max(minBatchSize, size_t(1));
+    const size_t maxBatches = (count + minBatchSize - 1) / minBatchSize;
+    const size_t batchCount = std::min(_workers.size() + 1, maxBatches);
+
+    if (batchCount <= 1 || _insideJob)
+    {
+        job(0, count);
+        return;
+    }
+
+    const size_t batchSize = (count + batchCount - 1) / batchCount;
+
+    // guarded by doneMutex, the last batch notifies while holding it so this frame outlives every access to it
+    size_t remaining{batchCount - 1};
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    std::exception_ptr exception{nullptr};
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        for (size_t batch = 1; batch < batchCount; batch++)
+        {
+            const size_t begin = batch * batchSize;
+            const size_t end = std::min(begin + batchSize, count);
+
+            _jobs.push([&, begin, end]() {
+                try
+                {
+                    if (begin < end)
+                    {
+                        job(begin, end);
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> doneLock{doneMutex};
+                    exception = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> doneLock{doneMutex};
+                if (--remaining == 0)
+                {
+                    doneCondition.notify_one();
+                }
+            });
+        }
+    }
+    _condition.notify_all();
+
+    _insideJob = true;
+    try
+    {
+        job(0, std::min(batchSize, count));
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> doneLock{doneMutex};
+        exception = std::current_exception();
+    }
+    _insideJob = false;
+
+    {
+        std::unique_lock<std::mutex> doneLock{doneMutex};
+        doneCondition.wait(doneLock, [&remaining]() { return remaining == 0; });
+    }
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+} // namespace cmx
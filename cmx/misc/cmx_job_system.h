@@ -0,0 +1,49 @@
+#ifndef CMX_JOB_SYSTEM
+#define CMX_JOB_SYSTEM
+
+// std
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace cmx
+{
+
+class JobSystem
+{
+  public:
+    static JobSystem &getInstance();
+
+    // splits [0, count) in contiguous batches and blocks until every batch is done, the calling thread works too.
+    // Called from inside a job it runs inline, nested batches would queue behind the jobs waiting for them
+    void parallelFor(size_t count, const std::function<void(size_t begin, size_t end)> &job, size_t minBatchSize = 8);
+
+    size_t getWorkerCount() const
+    {
+        return _workers.size();
+    }
+
+  private:
+    JobSystem();
+    ~JobSystem();
+
+    void work();
+
+    std::vector<std::thread> _workers;
+    std::queue<std::function<void()>> _jobs;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stopping{false};
+
+    // whether this thread is running a batch, see parallelFor
+    static thread_local bool _insideJob;
+};
+
+} // namespace cmx
+
+#endif
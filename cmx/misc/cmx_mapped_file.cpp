@@ -0,0 +1,112 @@
+#include "cmx_mapped_file.h"
+
+// lib
+#include <spdlog/spdlog.h>
+
+// std
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cmx
+{
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &filepath)
+{
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        spdlog::warn("MappedFile: couldn't open `{0}`", filepath);
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        spdlog::warn("MappedFile: `{0}` is empty", filepath);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        spdlog::warn("MappedFile: couldn't map `{0}`", filepath);
+        return;
+    }
+
+    _data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        spdlog::warn("MappedFile: couldn't map `{0}`", filepath);
+        return;
+    }
+
+    _size = static_cast<size_t>(size.QuadPart);
+    _fileHandle = file;
+    _mappingHandle = mapping;
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data)
+    {
+        UnmapViewOfFile(_data);
+        CloseHandle(_mappingHandle);
+        CloseHandle(_fileHandle);
+    }
+}
+#else
+MappedFile::MappedFile(const std::string &filepath)
+{
+    int file = open(filepath.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        spdlog::warn("MappedFile: couldn't open `{0}`", filepath);
+        return;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0)
+    {
+        close(file);
+        spdlog::warn("MappedFile: `{0}` is empty", filepath);
+        return;
+    }
+
+    void *data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (data == MAP_FAILED)
+    {
+        spdlog::warn("MappedFile: couldn't map `{0}`", filepath);
+        return;
+    }
+
+    madvise(data, status.st_size, MADV_SEQUENTIAL);
+
+    _data = static_cast<const char *>(data);
+    _size = static_cast<size_t>(status.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data)
+    {
+        munmap(const_cast<char *>(_data), _size);
+    }
+}
+#endif
+
+} // namespace cmx
@@ -0,0 +1,48 @@
+#ifndef CMX_MAPPED_FILE
+#define CMX_MAPPED_FILE
+
+// std
+#include <cstddef>
+#include <string>
+
+namespace cmx
+{
+
+// read-only memory mapping of a whole file, unmapped on destruction
+class MappedFile
+{
+  public:
+    MappedFile(const std::string &filepath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isValid() const
+    {
+        return _data != nullptr;
+    }
+
+    const char *data() const
+    {
+        return _data;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+  private:
+    const char *_data{nullptr};
+    size_t _size{0};
+
+#ifdef _WIN32
+    void *_fileHandle{nullptr};
+    void *_mappingHandle{nullptr};
+#endif
+};
+
+} // namespace cmx
+
+#endif
@@ -39,7 +39,8 @@ void Register::addActor(const char *name, std::function<Actor *(class Scene *, c
     actorRegister[name] = builder;
 }
 
-void Register::addComponent(const char *name, std::function<std::shared_ptr<class Component>()> builder)
+void Register::addComponent(const char *name, std::function<std::shared_ptr<class Component>()> builder,
+                            std::type_index type, ComponentTypeInfo typeInfo)
 {
     if (componentRegister.find(name) != componentRegister.end())
     {
@@ -48,6 +49,27 @@ void Register::addComponent(const char *name, std::function<std::shared_ptr<clas
     }
 
     componentRegister[name] = builder;
+    addComponentType(type, std::move(typeInfo));
+}
+
+const ComponentTypeInfo *Register::findComponentType(std::type_index type)
+{
+    auto it = componentTypes.find(type);
+    return it == componentTypes.end() ? nullptr : &it->second;
+}
+
+const ComponentTypeInfo &Register::addComponentType(std::type_index type, ComponentTypeInfo typeInfo)
+{
+    for (const auto &[otherType, otherInfo] : componentTypes)
+    {
+        if (otherInfo.id == typeInfo.id && otherType != type)
+        {
+            spdlog::error("Register: components '{0}' and '{1}' share the same type id", otherInfo.name,
+                          typeInfo.name);
+        }
+    }
+
+    return componentTypes.emplace(type, std::move(typeInfo)).first->second;
 }
 
 void Register::addMaterial(const char *name, std::function<class Material *()> builder)
@@ -84,6 +106,18 @@ std::shared_ptr<class Component> Register::attachComponent(const char *typeName,
     return actor->attachComponent(componentRegister.at(typeName)(), componentName, force);
 }
 
+const ActorBuilder *Register::findActor(const char *typeName) const
+{
+    auto it = actorRegister.find(typeName);
+    return it == actorRegister.end() ? nullptr : &it->second;
+}
+
+const ComponentBuilder *Register::findComponent(const char *typeName) const
+{
+    auto it = componentRegister.find(typeName);
+    return it == componentRegister.end() ? nullptr : &it->second;
+}
+
 class Material *Register::getMaterial(const char *typeName)
 {
     if (materialRegister.find(typeName) == materialRegister.end())
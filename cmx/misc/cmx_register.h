@@ -3,11 +3,13 @@
 
 #include "cmx_actor.h"
 #include "cmx_component.h"
+#include "cmx_scene_records.h"
 
 // std
 #include <cstdlib>
 #include <functional>
 #include <memory>
+#include <typeindex>
 #include <unordered_map>
 
 namespace cmx
@@ -19,14 +21,22 @@ class Register
     static Register &getInstance();
 
     void addActor(const char *, std::function<class Actor *(class Scene *, const char *)>);
-    void addComponent(const char *, std::function<std::shared_ptr<class Component>()>);
+    void addComponent(const char *, std::function<std::shared_ptr<class Component>()>, std::type_index,
+                      ComponentTypeInfo);
     void addMaterial(const char *, std::function<class Material *()>);
 
     class Actor *spawnActor(const char *, class Scene *, const char *);
     std::shared_ptr<class Component> attachComponent(const char *, class Actor *, const char *, bool force = false);
 
+    // nullptr for unregistered types
+    const ActorBuilder *findActor(const char *) const;
+    const ComponentBuilder *findComponent(const char *) const;
+
     class Material *getMaterial(const char *);
 
+    const ComponentTypeInfo *findComponentType(std::type_index);
+    const ComponentTypeInfo &addComponentType(std::type_index, ComponentTypeInfo);
+
     const auto &getActorRegister()
     {
         return actorRegister;
@@ -45,6 +55,8 @@ class Register
 
     std::map<std::string, std::function<std::shared_ptr<class Component>()>> componentRegister;
 
+    std::unordered_map<std::type_index, ComponentTypeInfo> componentTypes;
+
     std::map<std::string, std::function<class Material *()>> materialRegister;
 };
 
@@ -16,6 +16,7 @@
 #include "cmx_register.h"
 #include "cmx_render_system.h"
 #include "cmx_scene.h"
+#include "cmx_scene_loader.h"
 #include "cmx_shaded_material.h"
 #include "cmx_texture.h"
 
@@ -25,7 +26,9 @@
 
 // std
 #include <cstdlib>
+#include <functional>
 #include <stdexcept>
+#include <unordered_set>
 
 namespace cmx
 {
@@ -54,51 +57,142 @@ AssetsManager::AssetsManager(class Scene *parent)
     addPostProcess(new PostOutlineMaterial(), "outline_postprocess");
 };
 
-tinyxml2::XMLElement &AssetsManager::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement)
+size_t AssetsManager::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *assetsElement,
+                           SavedElements &savedElements)
 {
-    tinyxml2::XMLElement *assetsElement = doc.NewElement("assets");
+    std::unordered_set<std::string> liveKeys{};
+    size_t savedCount = 0;
 
-    for (const auto &pair : _materials)
-    {
-        tinyxml2::XMLElement *materialElement = pair.second->save(doc, assetsElement);
-        if (materialElement != nullptr)
+    // models and textures never change once loaded, they are only serialized the first time around
+    const auto saveAsset = [&](const std::string &key, const std::string &name, bool changed,
+                               const std::function<tinyxml2::XMLElement *()> &serialize) {
+        liveKeys.insert(key);
+
+        auto savedIt = savedElements.find(key);
+        if (savedIt != savedElements.end() && !changed)
+        {
+            return;
+        }
+
+        tinyxml2::XMLElement *element = serialize();
+        if (element != nullptr)
+        {
+            element->SetAttribute("name", name.c_str());
+        }
+        savedCount++;
+
+        if (savedIt == savedElements.end())
         {
-            materialElement->SetAttribute("name", pair.first.c_str());
+            savedElements[key] = element;
+            return;
         }
+
+        if (savedIt->second != nullptr)
+        {
+            if (element != nullptr)
+            {
+                assetsElement->InsertAfterChild(savedIt->second, element);
+            }
+            assetsElement->DeleteChild(savedIt->second);
+        }
+        savedIt->second = element;
+    };
+
+    for (const auto &pair : _materials)
+    {
+        Material *material = pair.second;
+        saveAsset("material:" + pair.first, pair.first, material->isDirty(),
+                  [&]() { return material->save(doc, assetsElement); });
+        material->clearDirty();
     }
 
     for (const auto &pair : _postProcesses)
     {
-        tinyxml2::XMLElement *postProcessElement = pair.second->save(doc, assetsElement);
-        if (postProcessElement != nullptr)
-        {
-            postProcessElement->SetAttribute("name", pair.first.c_str());
-        }
+        Material *postProcess = pair.second;
+        saveAsset("postProcess:" + pair.first, pair.first, postProcess->isDirty(),
+                  [&]() { return postProcess->save(doc, assetsElement); });
+        postProcess->clearDirty();
     }
 
     for (const auto &pair : _models)
     {
-        tinyxml2::XMLElement &modelElement = pair.second->save(doc, assetsElement);
-        modelElement.SetAttribute("name", pair.first.c_str());
+        Model *model = pair.second.get();
+        saveAsset("model:" + pair.first, pair.first, false, [&]() { return &model->save(doc, assetsElement); });
     }
 
     for (const auto &pair : _textures2D)
     {
-        tinyxml2::XMLElement &textureElement = pair.second->save(doc, assetsElement);
-        textureElement.SetAttribute("name", pair.first.c_str());
+        Texture *texture = pair.second.get();
+        saveAsset("texture2D:" + pair.first, pair.first, false,
+                  [&]() { return &texture->save(doc, assetsElement); });
     }
 
     for (const auto &pair : _textures3D)
     {
-        tinyxml2::XMLElement &textureElement = pair.second->save(doc, assetsElement);
-        textureElement.SetAttribute("name", pair.first.c_str());
+        Texture *texture = pair.second.get();
+        saveAsset("texture3D:" + pair.first, pair.first, false,
+                  [&]() { return &texture->save(doc, assetsElement); });
     }
 
-    parentElement->InsertEndChild(assetsElement);
+    auto it = savedElements.begin();
+    while (it != savedElements.end())
+    {
+        if (liveKeys.find(it->first) == liveKeys.end())
+        {
+            if (it->second != nullptr)
+            {
+                assetsElement->DeleteChild(it->second);
+            }
+            it = savedElements.erase(it);
+            continue;
+        }
+        it++;
+    }
 
-    spdlog::info("Saved asset manager");
+    spdlog::info("AssetsManager: serialized {0} assets", savedCount);
 
-    return *assetsElement;
+    return savedCount;
+}
+
+bool AssetsManager::hasUnsavedChanges(const SavedElements &savedElements) const
+{
+    if (savedElements.size() !=
+        _materials.size() + _postProcesses.size() + _models.size() + _textures2D.size() + _textures3D.size())
+    {
+        return true;
+    }
+
+    for (const auto &pair : _materials)
+    {
+        if (pair.second->isDirty() || savedElements.find("material:" + pair.first) == savedElements.end())
+            return true;
+    }
+
+    for (const auto &pair : _postProcesses)
+    {
+        if (pair.second->isDirty() || savedElements.find("postProcess:" + pair.first) == savedElements.end())
+            return true;
+    }
+
+    for (const auto &pair : _models)
+    {
+        if (savedElements.find("model:" + pair.first) == savedElements.end())
+            return true;
+    }
+
+    for (const auto &pair : _textures2D)
+    {
+        if (savedElements.find("texture2D:" + pair.first) == savedElements.end())
+            return true;
+    }
+
+    for (const auto &pair : _textures3D)
+    {
+        if (savedElements.find("texture3D:" + pair.first) == savedElements.end())
+            return true;
+    }
+
+    return false;
 }
 
 AssetsManager::~AssetsManager()
@@ -215,12 +309,16 @@ void AssetsManager::loadPostProcesses(tinyxml2::XMLElement *parentElement)
     }
 }
 
-void AssetsManager::load(tinyxml2::XMLElement *parentElement)
+void AssetsManager::load(tinyxml2::XMLElement *parentElement, PreparedAssets *preparedAssets)
 {
+    _preparedAssets = preparedAssets;
+
     loadModels(parentElement);
     loadTextures(parentElement);
     loadMaterials(parentElement);
     loadPostProcesses(parentElement);
+
+    _preparedAssets = nullptr;
 }
 
 void AssetsManager::unloadModels()
@@ -476,7 +574,14 @@ void AssetsManager::addModel(const char *filepath, const char *name)
         Device *device = RenderSystem::getInstance()->getDevice();
         if (device)
         {
-            _models[name] = std::unique_ptr<Model>(Model::createModelFromFile(device, filepath, name));
+            if (std::unique_ptr<Model> model = _preparedAssets ? _preparedAssets->takeModel(name, filepath) : nullptr)
+            {
+                _models[name] = std::move(model);
+            }
+            else
+            {
+                _models[name] = std::unique_ptr<Model>(Model::createModelFromFile(device, filepath, name));
+            }
         }
     }
 }
@@ -508,7 +613,16 @@ void AssetsManager::add2DTexture(const char *filepath, const char *name)
         Device *device = RenderSystem::getInstance()->getDevice();
         if (device)
         {
-            _textures2D[name] = std::unique_ptr<Texture>(Texture::create2DTextureFromFile(device, filepath, name));
+            if (std::unique_ptr<Texture> texture =
+                    _preparedAssets ? _preparedAssets->takeTexture(name, {filepath}) : nullptr)
+            {
+                _textures2D[name] = std::move(texture);
+            }
+            else
+            {
+                _textures2D[name] =
+                    std::unique_ptr<Texture>(Texture::create2DTextureFromFile(device, filepath, name));
+            }
         }
     }
 }
@@ -529,7 +643,16 @@ void AssetsManager::add3DTexture(const std::vector<std::string> &filepaths, cons
         Device *device = RenderSystem::getInstance()->getDevice();
         if (device)
         {
-            _textures3D[name] = std::unique_ptr<Texture>(Texture::create3DTextureFromFile(device, filepaths, name));
+            if (std::unique_ptr<Texture> texture =
+                    _preparedAssets ? _preparedAssets->takeTexture(name, filepaths) : nullptr)
+            {
+                _textures3D[name] = std::move(texture);
+            }
+            else
+            {
+                _textures3D[name] =
+                    std::unique_ptr<Texture>(Texture::create3DTextureFromFile(device, filepaths, name));
+            }
         }
     }
 }
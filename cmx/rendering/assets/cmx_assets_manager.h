@@ -8,6 +8,7 @@
 // std
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace cmx
@@ -22,8 +23,15 @@ class AssetsManager final
     AssetsManager(class Scene *parent);
     ~AssetsManager();
 
-    tinyxml2::XMLElement &save(tinyxml2::XMLDocument &, tinyxml2::XMLElement *);
-    void load(tinyxml2::XMLElement *);
+    // every asset's element under the assets element by kind and name, nullptr for materials which aren't saved
+    using SavedElements = std::unordered_map<std::string, tinyxml2::XMLElement *>;
+
+    // only serializes the assets added or changed since `savedElements` was last updated, replacing their elements
+    // under `assetsElement` in place and dropping the ones of removed assets, returns how many were serialized
+    size_t save(tinyxml2::XMLDocument &, tinyxml2::XMLElement *assetsElement, SavedElements &savedElements);
+    bool hasUnsavedChanges(const SavedElements &) const;
+    // assets the scene loader already uploaded are picked from `preparedAssets` instead of being read again
+    void load(tinyxml2::XMLElement *, struct PreparedAssets *preparedAssets = nullptr);
     void loadModels(tinyxml2::XMLElement *);
     void loadTextures(tinyxml2::XMLElement *);
     void loadMaterials(tinyxml2::XMLElement *);
@@ -86,6 +94,8 @@ class AssetsManager final
     std::map<std::string, class Material *> _materials;
     std::map<std::string, class Material *> _postProcesses;
 
+    struct PreparedAssets *_preparedAssets{nullptr};
+
     // TODO:
     // fonts
     // sprites
@@ -2,9 +2,11 @@
 
 // cmx
 #include "cmx_editor.h"
+#include "cmx_frame_info.h"
 #include "cmx_pipeline.h"
 #include "cmx_render_system.h"
 #include "cmx_renderer.h"
+#include "cmx_texture.h"
 
 // lib
 #include <imgui.h>
@@ -12,8 +14,10 @@
 #include <vulkan/vulkan_handles.hpp>
 
 // std
+#include <array>
 #include <cstdlib>
 #include <fstream>
+#include <iterator>
 #ifndef _WIN32
 #include <cxxabi.h>
 #else
@@ -25,7 +29,8 @@ namespace cmx
 {
 
 size_t Material::_idProvider{1};
-size_t Material::_boundID{1};
+thread_local size_t Material::_boundID{1};
+std::unordered_map<std::string, std::vector<BindingInfo>> Material::_reflectionCache{};
 
 Material::Material(const std::string &vertPath, const std::string &fragPath, bool modelBased, Role role)
     : _vertFilepath{vertPath}, _fragFilepath{fragPath}, _modelBased{modelBased}, _role{role}, _id{_idProvider},
@@ -50,7 +55,7 @@ void Material::editor()
     ImGui::Text("Material:");
     ImGui::Checkbox("visible", &_isVisible);
     ImGui::SameLine();
-    ImGui::Checkbox("editor only", &_editorOnly);
+    _dirty |= ImGui::Checkbox("editor only", &_editorOnly);
 }
 
 tinyxml2::XMLElement *Material::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const
@@ -122,11 +127,58 @@ void Material::initialize()
     createPipeline(renderSystem->getRenderPass());
 }
 
+void Material::bindInstanced(FrameInfo *)
+{
+    spdlog::error("Material: <{0}> has no instanced variant", name);
+}
+
+void Material::bindTextureIndices(FrameInfo *frameInfo, const std::vector<Texture *> &textures) const
+{
+    TextureIndices textureIndices{};
+    for (size_t i = 0; i < textures.size() && i < std::size(textureIndices.indices); i++)
+    {
+        textureIndices.indices[i] = textures[i]->getBindlessIndex();
+    }
+
+    frameInfo->commandBuffer.pushConstants(_pipelineLayout, vk::ShaderStageFlagBits::eFragment, 0,
+                                           sizeof(TextureIndices), &textureIndices);
+}
+
+void Material::bindPostProcess(FrameInfo *frameInfo) const
+{
+    Pipeline *pipeline = _pipeline;
+    if (_fusionSource != POST_PROCESS_UNFUSED && size_t(_fusionSource) < _fusedPipelines.size())
+    {
+        pipeline = _fusedPipelines[_fusionSource];
+    }
+    pipeline->bind(frameInfo->commandBuffer);
+
+    size_t *gBufferSetIDs = _renderSystem->getGBuffer()->getSamplerDescriptorSetIDs();
+    const std::array<vk::DescriptorSet, 3> descriptorSets{_renderSystem->getSamplerDescriptorSet(_postProcessInput),
+                                                          _renderSystem->getSamplerDescriptorSet(gBufferSetIDs[1]),
+                                                          _renderSystem->getSamplerDescriptorSet(gBufferSetIDs[2])};
+    frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 0,
+                                                uint32_t(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+}
+
 void Material::free()
 {
-    _pipeline->free();
+    PipelineRegistry &pipelineRegistry = RenderSystem::getInstance()->getDevice()->getPipelineRegistry();
 
-    RenderSystem::getInstance()->getDevice()->device().destroyPipelineLayout(_pipelineLayout);
+    pipelineRegistry.releasePipeline(_pipeline);
+    _pipeline = nullptr;
+    if (_instancedPipeline)
+    {
+        pipelineRegistry.releasePipeline(_instancedPipeline);
+        _instancedPipeline = nullptr;
+    }
+    for (Pipeline *fusedPipeline : _fusedPipelines)
+    {
+        pipelineRegistry.releasePipeline(fusedPipeline);
+    }
+    _fusedPipelines.clear();
+
+    pipelineRegistry.releaseLayout(_pipelineLayout);
 
     _bindings.clear();
 }
@@ -145,35 +197,47 @@ void Material::loadBindings()
 
 void Material::loadBindings(const std::string &filename)
 {
-    std::vector<uint32_t> spirvCode = loadSpirvData(filename);
-
-    SpvReflectShaderModule module{};
-    SpvReflectResult result =
-        spvReflectCreateShaderModule(spirvCode.size() * sizeof(uint32_t), spirvCode.data(), &module);
-    if (result != SPV_REFLECT_RESULT_SUCCESS)
+    auto cached = _reflectionCache.find(filename);
+    if (cached == _reflectionCache.end())
     {
-        throw std::runtime_error(std::string("Material: failed to load bindings for ") + filename);
-    }
+        std::vector<uint32_t> spirvCode = loadSpirvData(filename);
+
+        SpvReflectShaderModule module{};
+        SpvReflectResult result =
+            spvReflectCreateShaderModule(spirvCode.size() * sizeof(uint32_t), spirvCode.data(), &module);
+        if (result != SPV_REFLECT_RESULT_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Material: failed to load bindings for ") + filename);
+        }
 
-    uint32_t bindingCount = 0;
+        uint32_t bindingCount = 0;
 
-    result = spvReflectEnumerateDescriptorBindings(&module, &bindingCount, nullptr);
-    std::vector<SpvReflectDescriptorBinding *> bindings(bindingCount);
-    result = spvReflectEnumerateDescriptorBindings(&module, &bindingCount, bindings.data());
+        result = spvReflectEnumerateDescriptorBindings(&module, &bindingCount, nullptr);
+        std::vector<SpvReflectDescriptorBinding *> bindings(bindingCount);
+        result = spvReflectEnumerateDescriptorBindings(&module, &bindingCount, bindings.data());
 
-    for (const SpvReflectDescriptorBinding *binding : bindings)
+        std::vector<BindingInfo> reflected{};
+        for (const SpvReflectDescriptorBinding *binding : bindings)
+        {
+            reflected.emplace_back(binding->set, binding->binding, binding->descriptor_type, binding->image.dim);
+        }
+
+        // Clean up
+        spvReflectDestroyShaderModule(&module);
+
+        cached = _reflectionCache.emplace(filename, std::move(reflected)).first;
+    }
+
+    for (const BindingInfo &binding : cached->second)
     {
-        if (_bindings.emplace(binding->set, binding->binding, binding->descriptor_type, binding->image.dim).second)
+        if (_bindings.insert(binding).second)
         {
-            if (binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+            if (binding.type == SPV_REFLECT_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
             {
                 _requestedSamplerCount++;
             }
         }
     }
-
-    // Clean up
-    spvReflectDestroyShaderModule(&module);
 }
 
 std::vector<uint32_t> Material::loadSpirvData(const std::string &filename)
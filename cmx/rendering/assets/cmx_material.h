@@ -16,6 +16,13 @@
 // std
 #include <memory>
 #include <set>
+#include <unordered_map>
+#include <vector>
+
+// what a fused post process computes its input from, see Material::getFusionSource
+#define POST_PROCESS_UNFUSED -1
+// color, normals and depth, PostPassthroughMaterial's modes
+#define POST_PROCESS_SOURCE_COUNT 3
 
 namespace cmx
 {
@@ -26,6 +33,12 @@ struct PushConstantData
     glm::mat4 normalMatrix{1.f};
 };
 
+// slots of a draw's textures in the bindless table, pushed to the fragment stage
+struct TextureIndices
+{
+    uint32_t indices[4]{0, 0, 0, 0};
+};
+
 struct BindingInfo
 {
     uint32_t set;
@@ -85,6 +98,10 @@ class Material
     virtual Material *clone(bool doNotSave = true) const = 0;
 
     virtual void bind(struct FrameInfo *, const class Drawable *) = 0;
+    // binds the instanced variant, per object data then comes from the instance stream
+    virtual void bindInstanced(struct FrameInfo *);
+    // bindless materials read their textures from the bindless table, only their indices change between draws
+    void bindTextureIndices(struct FrameInfo *, const std::vector<class Texture *> &) const;
     virtual void editor();
     virtual tinyxml2::XMLElement *save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const;
     virtual void load(tinyxml2::XMLElement *materialElement);
@@ -114,14 +131,55 @@ class Material
     {
         return _modelBased;
     }
+    bool supportsInstancing() const
+    {
+        return _instancedPipeline != nullptr;
+    }
+    bool usesBindlessTextures() const
+    {
+        return _bindlessTextures;
+    }
     bool isVisible() const;
     bool editorOnly() const
     {
         return _editorOnly;
     }
 
+    bool isDirty() const
+    {
+        return _dirty;
+    }
+    void markDirty()
+    {
+        _dirty = true;
+    }
+    void clearDirty()
+    {
+        _dirty = false;
+    }
+
     static void resetBoundID();
 
+    // post processes :: begin
+    // what the next bind() samples at set 0 instead of the G-buffer's color, the previous effect's output in a chain.
+    // Given a fusion source, it computes its input from the G-buffer itself, see getFusionSource
+    void setPostProcessInput(size_t samplerDescriptorSetID, int fusionSource = POST_PROCESS_UNFUSED)
+    {
+        _postProcessInput = samplerDescriptorSetID;
+        _fusionSource = fusionSource;
+    }
+    // a post process whose output only depends on the G-buffer at the pixel it shades returns which source that is,
+    // the next effect can then be fused with it, one draw with no intermediate target in between
+    virtual int getFusionSource() const
+    {
+        return POST_PROCESS_UNFUSED;
+    }
+    bool supportsFusion() const
+    {
+        return !_fusedPipelines.empty();
+    }
+    // post processes :: end
+
     const std::set<BindingInfo> &getBindings() const
     {
         return _bindings;
@@ -146,33 +204,49 @@ class Material
     virtual void createPipeline(vk::RenderPass) = 0;
 
     void loadBindings(const std::string &filename);
+    // binds the permutation for the fusion source, the post process input and the G-buffer's normal and depth
+    void bindPostProcess(struct FrameInfo *) const;
     static std::vector<uint32_t> loadSpirvData(const std::string &filename);
 
     class Actor *parent{nullptr};
     bool _transparent{false};
+    bool _bindlessTextures{false};
 
     Role _role{Role::eMaterial};
     bool _modelBased;
     bool _doNotSave;
     bool _editorOnly;
     bool _isVisible;
+    // changed since the scene last serialized it, set by the setters and editors
+    bool _dirty{true};
 
     const size_t _id;
     static size_t _idProvider;
 
-    static size_t _boundID;
+    // per thread, every thread records into its own command buffer
+    static thread_local size_t _boundID;
 
     std::string _vertFilepath;
     std::string _fragFilepath;
 
+    // owned by the device's PipelineRegistry, shared with every clone built from the same shaders and state
     vk::PipelineLayout _pipelineLayout;
-    std::unique_ptr<Pipeline> _pipeline;
+    Pipeline *_pipeline{nullptr};
+    Pipeline *_instancedPipeline{nullptr};
+    // post processes, one permutation per fusion source
+    std::vector<Pipeline *> _fusedPipelines{};
 
     std::set<BindingInfo> _bindings;
     size_t _requestedSamplerCount;
 
+    // reflected bindings per shader file, clones don't parse their SPIR-V again
+    static std::unordered_map<std::string, std::vector<BindingInfo>> _reflectionCache;
+
     class RenderSystem *_renderSystem{nullptr};
 
+    size_t _postProcessInput{0};
+    int _fusionSource{POST_PROCESS_UNFUSED};
+
     static Material *_instance;
 };
 
@@ -3,6 +3,7 @@
 // cmx
 #include "cmx_buffer.h"
 #include "cmx_physics.h"
+#include "cmx_upload_manager.h"
 #include "cmx_utils.h"
 
 // lib
@@ -18,6 +19,8 @@
 #include <glm/gtx/hash.hpp>
 
 // std
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -41,6 +44,10 @@ Model::Model(Device *device, const Model::Builder &builder, const std::string &n
     createVertexBuffers(device, builder.vertices);
     createIndexBuffers(device, builder.indices);
     _filepath = builder.filepath;
+
+    _aabbMin = builder.aabbMin;
+    _aabbMax = builder.aabbMax;
+    _boundingSphere = builder.boundingSphere;
 }
 
 Model::~Model()
@@ -53,6 +60,12 @@ Model::~Model()
 
 void Model::free()
 {
+    // the copies may still be reading or writing them
+    if (_uploadManager)
+    {
+        _uploadManager->wait(_uploadTicket);
+    }
+
     _vertexBuffer->free();
     _indexBuffer->free();
 
@@ -68,6 +81,11 @@ Model *Model::createModelFromFile(Device *device, const std::string &filepath, c
     return new Model(device, builder, name);
 }
 
+bool Model::isReady() const
+{
+    return _uploadManager == nullptr || _uploadManager->isComplete(_uploadTicket);
+}
+
 void Model::bind(vk::CommandBuffer commandBuffer)
 {
     vk::Buffer buffers[] = {_vertexBuffer->getBuffer()};
@@ -80,15 +98,15 @@ void Model::bind(vk::CommandBuffer commandBuffer)
     }
 }
 
-void Model::draw(vk::CommandBuffer commandBuffer)
+void Model::draw(vk::CommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance)
 {
     if (_hasIndexBuffer)
     {
-        commandBuffer.drawIndexed(_indexCount, 1, 0, 0, 0);
+        commandBuffer.drawIndexed(_indexCount, instanceCount, 0, 0, firstInstance);
     }
     else
     {
-        commandBuffer.draw(_vertexCount, 1, 0, 0);
+        commandBuffer.draw(_vertexCount, instanceCount, 0, firstInstance);
     }
 }
 
@@ -102,19 +120,15 @@ void Model::createVertexBuffers(Device *device, const std::vector<Vertex> &verti
     vk::DeviceSize bufferSize = sizeof(vertices[0]) * _vertexCount;
     uint32_t vertexSize = sizeof(vertices[0]);
 
-    Buffer stagingBuffer{*device, vertexSize, _vertexCount, vk::BufferUsageFlagBits::eTransferSrc,
-                         vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent};
-
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void *)vertices.data());
-
     _vertexBuffer =
         std::make_unique<Buffer>(*device, vertexSize, _vertexCount,
                                  vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst,
                                  vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-    device->copyBuffer(stagingBuffer.getBuffer(), _vertexBuffer->getBuffer(), bufferSize);
-    stagingBuffer.free();
+    _uploadManager = &device->getUploadManager();
+    _uploadTicket = _uploadManager->uploadBuffer(_vertexBuffer->getBuffer(), vertices.data(), bufferSize,
+                                                 vk::PipelineStageFlagBits::eVertexInput,
+                                                 vk::AccessFlagBits::eVertexAttributeRead);
 }
 
 void Model::createIndexBuffers(Device *device, const std::vector<uint32_t> &indices)
@@ -131,18 +145,14 @@ void Model::createIndexBuffers(Device *device, const std::vector<uint32_t> &indi
     vk::DeviceSize bufferSize = sizeof(indices[0]) * _indexCount;
     uint32_t indexSize = sizeof(indices[0]);
 
-    Buffer stagingBuffer{*device, indexSize, _indexCount, vk::BufferUsageFlagBits::eTransferSrc,
-                         vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent};
-
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void *)indices.data());
-
     _indexBuffer = std::make_unique<Buffer>(
         *device, indexSize, _indexCount, vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
         vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-    device->copyBuffer(stagingBuffer.getBuffer(), _indexBuffer->getBuffer(), bufferSize);
-    stagingBuffer.free();
+    // both buffers go in the same batch, the later ticket covers the two
+    _uploadTicket = _uploadManager->uploadBuffer(_indexBuffer->getBuffer(), indices.data(), bufferSize,
+                                                 vk::PipelineStageFlagBits::eVertexInput,
+                                                 vk::AccessFlagBits::eIndexRead);
 }
 
 std::vector<vk::VertexInputBindingDescription> Model::Vertex::getBindingDescriptions()
@@ -166,6 +176,33 @@ std::vector<vk::VertexInputAttributeDescription> Model::Vertex::getAttributeDesc
     return attributeDescriptions;
 }
 
+std::vector<vk::VertexInputBindingDescription> Model::Instance::getBindingDescriptions()
+{
+    std::vector<vk::VertexInputBindingDescription> bindingDescriptions(1);
+    bindingDescriptions[0].binding = 1;
+    bindingDescriptions[0].stride = sizeof(Instance);
+    bindingDescriptions[0].inputRate = vk::VertexInputRate::eInstance;
+    return bindingDescriptions;
+}
+
+std::vector<vk::VertexInputAttributeDescription> Model::Instance::getAttributeDescriptions()
+{
+    std::vector<vk::VertexInputAttributeDescription> attributeDescriptions{};
+
+    // a mat4 attribute takes one location per column, following the 5 vertex attributes
+    for (uint32_t column = 0; column < 4; column++)
+    {
+        attributeDescriptions.push_back({5 + column, 1, vk::Format::eR32G32B32A32Sfloat,
+                                         uint32_t(offsetof(Instance, modelMatrix) + column * sizeof(glm::vec4))});
+    }
+    for (uint32_t column = 0; column < 4; column++)
+    {
+        attributeDescriptions.push_back({9 + column, 1, vk::Format::eR32G32B32A32Sfloat,
+                                         uint32_t(offsetof(Instance, normalMatrix) + column * sizeof(glm::vec4))});
+    }
+    return attributeDescriptions;
+}
+
 void Model::Builder::loadModel(const std::string &filepath)
 {
     tinyobj::attrib_t attrib;
@@ -263,6 +300,36 @@ void Model::Builder::loadModel(const std::string &filepath)
         }
         this->filepath = filepath;
     }
+
+    computeBounds();
+}
+
+void Model::Builder::computeBounds()
+{
+    if (vertices.empty())
+    {
+        aabbMin = aabbMax = glm::vec3{0.f};
+        boundingSphere = glm::vec4{0.f};
+        return;
+    }
+
+    aabbMin = aabbMax = vertices[0].position;
+    for (const Vertex &vertex : vertices)
+    {
+        aabbMin = glm::min(aabbMin, vertex.position);
+        aabbMax = glm::max(aabbMax, vertex.position);
+    }
+
+    // centered on the box, tighter than its half diagonal
+    const glm::vec3 center = (aabbMin + aabbMax) * .5f;
+    float radiusSquared = 0.f;
+    for (const Vertex &vertex : vertices)
+    {
+        const glm::vec3 offset = vertex.position - center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+
+    boundingSphere = glm::vec4{center, std::sqrt(radiusSquared)};
 }
 
 tinyxml2::XMLElement &Model::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement)
@@ -37,13 +37,28 @@ class Model
                    tangent == other.tangent;
         }
     };
+    // per instance vertex stream (binding 1) used by instanced pipelines
+    struct Instance
+    {
+        glm::mat4 modelMatrix{1.f};
+        glm::mat4 normalMatrix{1.f};
+
+        static std::vector<vk::VertexInputBindingDescription> getBindingDescriptions();
+        static std::vector<vk::VertexInputAttributeDescription> getAttributeDescriptions();
+    };
     struct Builder
     {
         std::vector<Vertex> vertices{};
         std::vector<uint32_t> indices{};
         std::string filepath;
 
+        // local space bounds, filled by computeBounds
+        glm::vec3 aabbMin{0.f};
+        glm::vec3 aabbMax{0.f};
+        glm::vec4 boundingSphere{0.f};
+
         void loadModel(const std::string &filepath);
+        void computeBounds();
     };
 
     Model(class Device *, const Model::Builder &, const std::string &name);
@@ -59,10 +74,30 @@ class Model
     static Model *createModelFromFile(class Device *, const std::string &filepath, const std::string &name);
 
     void bind(vk::CommandBuffer);
-    void draw(vk::CommandBuffer);
+    void draw(vk::CommandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
 
     void editor();
 
+    // getters and setters :: begin
+    const glm::vec4 &getBoundingSphere() const
+    {
+        return _boundingSphere;
+    }
+
+    const glm::vec3 &getAABBMin() const
+    {
+        return _aabbMin;
+    }
+
+    const glm::vec3 &getAABBMax() const
+    {
+        return _aabbMax;
+    }
+
+    // false until the vertex and index uploads complete
+    bool isReady() const;
+    // getters and setters :: end
+
     const std::string name;
 
   private:
@@ -78,6 +113,13 @@ class Model
 
     std::string _filepath;
 
+    class UploadManager *_uploadManager{nullptr};
+    uint64_t _uploadTicket{0};
+
+    glm::vec3 _aabbMin{0.f};
+    glm::vec3 _aabbMax{0.f};
+    glm::vec4 _boundingSphere{0.f}; // xyz center, w radius
+
     bool _freed{false};
 };
 
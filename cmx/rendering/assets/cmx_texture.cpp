@@ -3,9 +3,9 @@
 #include "cmx_texture.h"
 
 // cmx
-#include "cmx_buffer.h"
 #include "cmx_device.h"
 #include "cmx_render_system.h"
+#include "cmx_upload_manager.h"
 
 // lib
 #include <spdlog/spdlog.h>
@@ -19,7 +19,7 @@
 namespace cmx
 {
 
-size_t Texture::_boundID{MAX_SAMPLER_SETS + 1};
+thread_local size_t Texture::_boundID{MAX_SAMPLER_SETS + 1};
 
 void Texture::resetBoundID()
 {
@@ -32,11 +32,10 @@ Texture::Texture(Device *device, const Texture::Builder &builder, const char *na
 
     createImage(device, builder);
     createImageView(device, builder);
-    generateMipmaps(device, builder);
     createSampler(device);
 
     _renderSystem = RenderSystem::getInstance();
-    _descriptorSetID = _renderSystem->createSamplerDescriptor(_imageView, _sampler);
+    _bindlessIndex = _renderSystem->registerBindlessTexture(_imageView, _sampler);
     _filepaths = builder.filepaths;
 }
 
@@ -57,11 +56,18 @@ void Texture::free()
         throw std::runtime_error("Texture: cannot free texture after having destroyed device");
     }
 
+    // the upload may still be writing to it
+    _uploadManager->wait(_uploadTicket);
+
     device->device().destroySampler(_sampler);
     device->device().destroyImage(_image);
     device->device().destroyImageView(_imageView);
-    device->device().freeMemory(_imageMemory);
-    _renderSystem->freeSamplerDescriptor(_descriptorSetID);
+    device->freeMemory(_imageMemory);
+    _renderSystem->freeBindlessTexture(_bindlessIndex);
+    if (_descriptorSetID != SIZE_MAX)
+    {
+        _renderSystem->freeSamplerDescriptor(_descriptorSetID);
+    }
 
     _freed = true;
 }
@@ -93,19 +99,11 @@ Texture *Texture::create3DTextureFromFile(class Device *device, const std::vecto
 
 void Texture::createImage(Device *device, const Builder &builder)
 {
-    // Create staging buffer to hold loaded data, ready to copy to device
-    Buffer imageStagingBuffer{*device, builder.imageSize, 1, vk::BufferUsageFlagBits::eTransferSrc,
-                              vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent};
-
-    imageStagingBuffer.map(builder.imageSize, 0);
-
-    int sliceSize = builder.width * builder.height * 4;
-    for (int i = 0; i < builder.depth; i++)
+    vk::FormatProperties formatProperties = device->physicalDevice().getFormatProperties(builder.format);
+    if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear))
     {
-        imageStagingBuffer.writeToBuffer(builder.images[i], sliceSize, i * sliceSize);
-        stbi_image_free(builder.images[i]);
+        throw std::runtime_error("texture image format does not support linear blitting!");
     }
-    imageStagingBuffer.unmap();
 
     vk::ImageCreateInfo imageInfo{};
 
@@ -125,12 +123,22 @@ void Texture::createImage(Device *device, const Builder &builder)
 
     device->createImageWithInfo(imageInfo, {vk::MemoryPropertyFlagBits::eDeviceLocal}, _image, _imageMemory);
 
-    // Copy image data
-    device->transitionImageLayout(_image, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
-                                  builder.mipLevels);
-    device->copyBufferToImage(imageStagingBuffer.getBuffer(), _image, builder.width, builder.height, builder.depth);
+    // slices are copied into the staging ring right away, mipmaps are generated on the graphics queue once they land
+    std::vector<const void *> slices(builder.images.begin(), builder.images.begin() + builder.depth);
+    const vk::DeviceSize sliceSize = vk::DeviceSize(builder.width) * builder.height * 4;
+
+    const vk::Extent3D extent{uint32_t(builder.width), uint32_t(builder.height), uint32_t(builder.depth)};
+
+    _uploadManager = &device->getUploadManager();
+    _uploadTicket = _uploadManager->uploadImage(_image, slices, sliceSize, extent, builder.mipLevels,
+                                                [&](vk::CommandBuffer commandBuffer) {
+                                                    generateMipmaps(commandBuffer, builder);
+                                                });
 
-    imageStagingBuffer.free();
+    for (int i = 0; i < builder.depth; i++)
+    {
+        stbi_image_free(builder.images[i]);
+    }
 }
 
 void Texture::Builder::loadTexture(const char *filepath)
@@ -259,16 +267,8 @@ void Texture::createSampler(class Device *device)
     _sampler = device->device().createSampler(samplerCreateInfo);
 }
 
-void Texture::generateMipmaps(class Device *device, const Builder &builder)
+void Texture::generateMipmaps(vk::CommandBuffer commandBuffer, const Builder &builder)
 {
-    vk::FormatProperties formatProperties = device->physicalDevice().getFormatProperties(builder.format);
-    if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear))
-    {
-        throw std::runtime_error("texture image format does not support linear blitting!");
-    }
-
-    vk::CommandBuffer commandBuffer = device->beginSingleTimeCommands();
-
     vk::ImageMemoryBarrier barrier{};
     barrier.image = _image;
     barrier.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
@@ -329,8 +329,19 @@ void Texture::generateMipmaps(class Device *device, const Builder &builder)
     barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
     commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {},
                                   0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+bool Texture::isReady() const
+{
+    return _uploadManager->isComplete(_uploadTicket);
+}
 
-    device->endSingleTimeCommands(commandBuffer);
+void Texture::prepareDescriptorSet()
+{
+    if (_descriptorSetID == SIZE_MAX)
+    {
+        _descriptorSetID = _renderSystem->createSamplerDescriptor(_imageView, _sampler);
+    }
 }
 
 void Texture::bind(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout)
@@ -1,12 +1,16 @@
 #ifndef CMX_TEXTURE
 #define CMX_TEXTURE
 
+// cmx
+#include "cmx_memory_allocator.h"
+
 // lib
 #include <stb_image.h>
 #include <tinyxml2.h>
 #include <vulkan/vulkan.hpp>
 
 // std
+#include <cstdint>
 #include <string>
 #include <vulkan/vulkan_enums.hpp>
 
@@ -43,6 +47,8 @@ class Texture
 
     void editor();
 
+    // classic per texture descriptor sets are only made for materials that still bind them, main thread only
+    void prepareDescriptorSet();
     void bind(vk::CommandBuffer, vk::PipelineLayout);
     static void bindMany(vk::CommandBuffer, vk::PipelineLayout, std::vector<Texture *> textures);
 
@@ -58,18 +64,28 @@ class Texture
         return _imageType;
     }
 
+    uint32_t getBindlessIndex() const
+    {
+        return _bindlessIndex;
+    }
+
+    // false until the upload and mipmap generation complete
+    bool isReady() const;
+
   protected:
     void createImage(class Device *, const Builder &);
     void createImageView(class Device *, const Builder &);
     void createSampler(class Device *);
-    void generateMipmaps(class Device *, const Builder &);
+    // records on the upload's graphics command buffer, the image is left in eShaderReadOnlyOptimal
+    void generateMipmaps(vk::CommandBuffer, const Builder &);
 
     vk::Image _image;
     vk::ImageView _imageView;
-    vk::DeviceMemory _imageMemory;
+    Allocation _imageMemory;
 
     vk::Sampler _sampler;
-    size_t _descriptorSetID;
+    size_t _descriptorSetID{SIZE_MAX};
+    uint32_t _bindlessIndex;
 
     std::vector<std::string> _filepaths;
     vk::ImageType _imageType;
@@ -77,8 +93,11 @@ class Texture
     bool _freed{false};
 
     class RenderSystem *_renderSystem;
+    class UploadManager *_uploadManager{nullptr};
+    uint64_t _uploadTicket{0};
 
-    static size_t _boundID;
+    // per thread, every thread records into its own command buffer
+    static thread_local size_t _boundID;
 };
 
 } // namespace cmx
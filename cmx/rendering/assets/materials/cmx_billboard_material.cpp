@@ -39,7 +39,7 @@ void BillboardMaterial::editor()
 {
     Material::editor();
 
-    ImGui::ColorPicker4("hue", (float *)&_hue);
+    _dirty |= ImGui::ColorPicker4("hue", (float *)&_hue);
 }
 
 tinyxml2::XMLElement *BillboardMaterial::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const
@@ -88,11 +88,7 @@ void BillboardMaterial::createPipelineLayout(std::vector<vk::DescriptorSetLayout
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    if (_renderSystem->getDevice()->device().createPipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout) !=
-        vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    _pipelineLayout = _renderSystem->getDevice()->getPipelineRegistry().acquireLayout(pipelineLayoutInfo);
 }
 
 void BillboardMaterial::createPipeline(vk::RenderPass renderPass)
@@ -114,8 +110,8 @@ void BillboardMaterial::createPipeline(vk::RenderPass renderPass)
     pipelineConfig.colorBlendAttachments[1].srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
     pipelineConfig.colorBlendAttachments[1].dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
 
-    _pipeline = std::make_unique<Pipeline>(*_renderSystem->getDevice(), _vertFilepath, _fragFilepath, pipelineConfig,
-                                           "billboard material pipeline");
+    _pipeline = _renderSystem->getDevice()->getPipelineRegistry().acquirePipeline(
+        _vertFilepath, _fragFilepath, pipelineConfig, "billboard material pipeline");
 }
 
 } // namespace cmx
@@ -40,6 +40,7 @@ class BillboardMaterial : public Material
     void setHue(const glm::vec4 hue)
     {
         _hue = hue;
+        markDirty();
     }
 
   protected:
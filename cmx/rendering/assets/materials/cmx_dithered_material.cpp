@@ -63,11 +63,11 @@ void DitheredMaterial::editor()
 {
     Material::editor();
 
-    ImGui::Checkbox("World space UV", &_worldSpaceUV);
-    ImGui::DragFloat("Scale", &_scale, 0.1f, 1.f, 8.f);
-    ImGui::SliderFloat("Threshold", &_threshold, 0.5f, 2.f);
-    ImGui::ColorEdit3("Light Color", (float *)&_lightColor);
-    ImGui::ColorEdit3("Dark Color", (float *)&_darkColor);
+    _dirty |= ImGui::Checkbox("World space UV", &_worldSpaceUV);
+    _dirty |= ImGui::DragFloat("Scale", &_scale, 0.1f, 1.f, 8.f);
+    _dirty |= ImGui::SliderFloat("Threshold", &_threshold, 0.5f, 2.f);
+    _dirty |= ImGui::ColorEdit3("Light Color", (float *)&_lightColor);
+    _dirty |= ImGui::ColorEdit3("Dark Color", (float *)&_darkColor);
 
     static const char *selected = _lightDots ? "light dots" : "dark dots";
     if (ImGui::BeginCombo("toggle", selected))
@@ -76,11 +76,13 @@ void DitheredMaterial::editor()
         {
             selected = "light dots";
             _lightDots = true;
+            _dirty = true;
         }
         if (ImGui::Selectable("dark dots", !_lightDots))
         {
             selected = "dark dots";
             _lightDots = false;
+            _dirty = true;
         }
         ImGui::EndCombo();
     }
@@ -161,11 +163,7 @@ void DitheredMaterial::createPipelineLayout(std::vector<vk::DescriptorSetLayout>
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    if (_renderSystem->getDevice()->device().createPipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout) !=
-        vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    _pipelineLayout = _renderSystem->getDevice()->getPipelineRegistry().acquireLayout(pipelineLayoutInfo);
 
     _requestedSamplerCount -= 1;
 }
@@ -178,8 +176,8 @@ void DitheredMaterial::createPipeline(vk::RenderPass renderPass)
     Pipeline::defaultPipelineConfigInfo(pipelineConfig);
     pipelineConfig.renderPass = renderPass;
     pipelineConfig.pipelineLayout = _pipelineLayout;
-    _pipeline = std::make_unique<Pipeline>(*_renderSystem->getDevice(), _vertFilepath, _fragFilepath, pipelineConfig,
-                                           "dithered material pipeline");
+    _pipeline = _renderSystem->getDevice()->getPipelineRegistry().acquirePipeline(
+        _vertFilepath, _fragFilepath, pipelineConfig, "dithered material pipeline");
 }
 
 } // namespace cmx
@@ -58,19 +58,19 @@ void DitheredTexturedMaterial::editor()
 {
     Material::editor();
 
-    ImGui::Checkbox("World space UV", &_worldSpaceUV);
+    _dirty |= ImGui::Checkbox("World space UV", &_worldSpaceUV);
     if (_worldSpaceUV)
     {
-        ImGui::SliderFloat2("UV offset", (float *)&_UVoffset, -1.f, 1.f);
-        ImGui::DragFloat("UV Scale##1", &_UVScale);
-        ImGui::DragFloat("UV Rotate", &_UVRotate, 1.f, -180.f, 180.f);
+        _dirty |= ImGui::SliderFloat2("UV offset", (float *)&_UVoffset, -1.f, 1.f);
+        _dirty |= ImGui::DragFloat("UV Scale##1", &_UVScale);
+        _dirty |= ImGui::DragFloat("UV Rotate", &_UVRotate, 1.f, -180.f, 180.f);
     }
 
     ImGui::Separator();
 
-    ImGui::DragFloat("Scale##2", &_scale, 0.1f, 1.f, 8.f);
-    ImGui::SliderFloat("Threshold", &_threshold, 0.5f, 2.f);
-    ImGui::SliderFloat("M", &_mSpacing, 0.f, 1.f);
+    _dirty |= ImGui::DragFloat("Scale##2", &_scale, 0.1f, 1.f, 8.f);
+    _dirty |= ImGui::SliderFloat("Threshold", &_threshold, 0.5f, 2.f);
+    _dirty |= ImGui::SliderFloat("M", &_mSpacing, 0.f, 1.f);
 }
 
 tinyxml2::XMLElement *DitheredTexturedMaterial::save(tinyxml2::XMLDocument &doc,
@@ -142,11 +142,7 @@ void DitheredTexturedMaterial::createPipelineLayout(std::vector<vk::DescriptorSe
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    if (_renderSystem->getDevice()->device().createPipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout) !=
-        vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    _pipelineLayout = _renderSystem->getDevice()->getPipelineRegistry().acquireLayout(pipelineLayoutInfo);
 
     _requestedSamplerCount -= 1;
 }
@@ -159,8 +155,8 @@ void DitheredTexturedMaterial::createPipeline(vk::RenderPass renderPass)
     Pipeline::defaultPipelineConfigInfo(pipelineConfig);
     pipelineConfig.renderPass = renderPass;
     pipelineConfig.pipelineLayout = _pipelineLayout;
-    _pipeline = std::make_unique<Pipeline>(*_renderSystem->getDevice(), _vertFilepath, _fragFilepath, pipelineConfig,
-                                           "dithered textured material pipeline");
+    _pipeline = _renderSystem->getDevice()->getPipelineRegistry().acquirePipeline(
+        _vertFilepath, _fragFilepath, pipelineConfig, "dithered textured material pipeline");
 }
 
 } // namespace cmx
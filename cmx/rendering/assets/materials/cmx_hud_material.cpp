@@ -48,11 +48,7 @@ void HudMaterial::createPipelineLayout(std::vector<vk::DescriptorSetLayout> desc
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
     pipelineLayoutInfo.pushConstantRangeCount = 0;
     pipelineLayoutInfo.pPushConstantRanges = NULL;
-    if (_renderSystem->getDevice()->device().createPipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout) !=
-        vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    _pipelineLayout = _renderSystem->getDevice()->getPipelineRegistry().acquireLayout(pipelineLayoutInfo);
 }
 
 void HudMaterial::createPipeline(vk::RenderPass renderPass)
@@ -74,8 +70,8 @@ void HudMaterial::createPipeline(vk::RenderPass renderPass)
     pipelineConfig.colorBlendAttachments[1].srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
     pipelineConfig.colorBlendAttachments[1].dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
 
-    _pipeline = std::make_unique<Pipeline>(*_renderSystem->getDevice(), _vertFilepath, _fragFilepath, pipelineConfig,
-                                           "HUD material pipeline");
+    _pipeline = _renderSystem->getDevice()->getPipelineRegistry().acquirePipeline(
+        _vertFilepath, _fragFilepath, pipelineConfig, "HUD material pipeline");
 }
 
 } // namespace cmx
@@ -40,7 +40,7 @@ void MeshMaterial::editor()
 {
     Material::editor();
 
-    ImGui::ColorPicker3("color", (float *)&_color);
+    _dirty |= ImGui::ColorPicker3("color", (float *)&_color);
 }
 
 tinyxml2::XMLElement *MeshMaterial::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const
@@ -91,11 +91,7 @@ void MeshMaterial::createPipelineLayout(std::vector<vk::DescriptorSetLayout> des
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    if (_renderSystem->getDevice()->device().createPipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout) !=
-        vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    _pipelineLayout = _renderSystem->getDevice()->getPipelineRegistry().acquireLayout(pipelineLayoutInfo);
 }
 
 void MeshMaterial::createPipeline(vk::RenderPass renderPass)
@@ -110,8 +106,8 @@ void MeshMaterial::createPipeline(vk::RenderPass renderPass)
     pipelineConfig.rasterizationInfo.lineWidth = 1.0f;
     pipelineConfig.rasterizationInfo.cullMode = vk::CullModeFlagBits::eNone;
 
-    _pipeline = std::make_unique<Pipeline>(*_renderSystem->getDevice(), _vertFilepath, _fragFilepath, pipelineConfig,
-                                           "mesh material pipeline");
+    _pipeline = _renderSystem->getDevice()->getPipelineRegistry().acquirePipeline(
+        _vertFilepath, _fragFilepath, pipelineConfig, "mesh material pipeline");
 }
 
 } // namespace cmx
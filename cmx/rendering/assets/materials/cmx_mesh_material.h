@@ -39,6 +39,7 @@ class MeshMaterial : public Material
     void setColor(const glm::vec3 color)
     {
         _color = color;
+        markDirty();
     }
 
   protected:
@@ -55,20 +55,20 @@ void ParallaxMaterial::editor()
 {
     Material::editor();
 
-    ImGui::Checkbox("World space UV", &_worldSpaceUV);
+    _dirty |= ImGui::Checkbox("World space UV", &_worldSpaceUV);
     if (_worldSpaceUV)
     {
-        ImGui::SliderFloat2("UV offset", (float *)&_UVoffset, -1.f, 1.f);
-        ImGui::DragFloat("Scale", &_UVScale);
-        ImGui::DragFloat("Rotate", &_UVRotate, 1.f, -180.f, 180.f);
+        _dirty |= ImGui::SliderFloat2("UV offset", (float *)&_UVoffset, -1.f, 1.f);
+        _dirty |= ImGui::DragFloat("Scale", &_UVScale);
+        _dirty |= ImGui::DragFloat("Rotate", &_UVRotate, 1.f, -180.f, 180.f);
     }
 
     ImGui::SeparatorText("Parallax");
-    ImGui::DragFloat("Depth", &_parallaxDepth, .01f, 0.f, .1f);
-    ImGui::Checkbox("Occlusion Mapping", &_occlusionMapping);
+    _dirty |= ImGui::DragFloat("Depth", &_parallaxDepth, .01f, 0.f, .1f);
+    _dirty |= ImGui::Checkbox("Occlusion Mapping", &_occlusionMapping);
     if (_occlusionMapping)
     {
-        ImGui::DragInt("Layer Resolution", &_parallaxLevels, 1, 1, 64);
+        _dirty |= ImGui::DragInt("Layer Resolution", &_parallaxLevels, 1, 1, 64);
     }
 }
 
@@ -144,11 +144,7 @@ void ParallaxMaterial::createPipelineLayout(std::vector<vk::DescriptorSetLayout>
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    if (_renderSystem->getDevice()->device().createPipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout) !=
-        vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    _pipelineLayout = _renderSystem->getDevice()->getPipelineRegistry().acquireLayout(pipelineLayoutInfo);
 
     _requestedSamplerCount -= 1;
 }
@@ -161,8 +157,8 @@ void ParallaxMaterial::createPipeline(vk::RenderPass renderPass)
     Pipeline::defaultPipelineConfigInfo(pipelineConfig);
     pipelineConfig.renderPass = renderPass;
     pipelineConfig.pipelineLayout = _pipelineLayout;
-    _pipeline = std::make_unique<Pipeline>(*_renderSystem->getDevice(), _vertFilepath, _fragFilepath, pipelineConfig,
-                                           "parallax material pipeline");
+    _pipeline = _renderSystem->getDevice()->getPipelineRegistry().acquirePipeline(
+        _vertFilepath, _fragFilepath, pipelineConfig, "parallax material pipeline");
 }
 
 } // namespace cmx
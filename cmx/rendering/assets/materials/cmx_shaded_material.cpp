@@ -20,53 +20,76 @@ void ShadedMaterial::bind(FrameInfo *frameInfo, const Drawable *drawable)
     if (_boundID != _id)
     {
         _pipeline->bind(frameInfo->commandBuffer);
-
-        frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 0, 1,
-                                                    &frameInfo->globalDescriptorSet, 0, nullptr);
-
-        const std::vector<size_t> &descriptorSetIDs = GraphicsManager::getDescriptorSetIDs();
-        frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 2, 1,
-                                                    &(_renderSystem->getSamplerDescriptorSet(descriptorSetIDs[0])), 0,
-                                                    nullptr);
+        bindDescriptorSets(frameInfo);
 
         _boundID = _id;
     }
 
-    PushConstantData push{};
     Transform transform = drawable->getWorldSpaceTransform();
+    bindObjectData(frameInfo, transform.mat4(), transform.normalMatrix());
+}
+
+void ShadedMaterial::bindInstanced(FrameInfo *frameInfo)
+{
+    _instancedPipeline->bind(frameInfo->commandBuffer);
+    bindDescriptorSets(frameInfo);
+
+    // the regular pipeline has to be bound again on the next bind
+    resetBoundID();
+
+    // matrices come from the instance stream, only the material parameters are read
+    bindObjectData(frameInfo, glm::mat4{1.f}, glm::mat4{1.f});
+}
 
-    push.modelMatrix = transform.mat4();
-    push.normalMatrix = transform.normalMatrix();
-    push.normalMatrix[3] = glm::vec4(_color, 1.0f);
+void ShadedMaterial::bindDescriptorSets(FrameInfo *frameInfo)
+{
+    frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 0, 1,
+                                                &frameInfo->globalDescriptorSet, 0, nullptr);
+    _renderSystem->bindBindlessTextures(frameInfo, _pipelineLayout, 1);
+
+    const std::vector<size_t> &descriptorSetIDs = GraphicsManager::getDescriptorSetIDs();
+    frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 2, 1,
+                                                &(_renderSystem->getSamplerDescriptorSet(descriptorSetIDs[0])), 0,
+                                                nullptr);
+}
+
+void ShadedMaterial::bindObjectData(FrameInfo *frameInfo, const glm::mat4 &modelMatrix, const glm::mat4 &normalMatrix)
+{
+    uint32_t dynamicOffset{0};
+    auto *objectData =
+        static_cast<ObjectData *>(_renderSystem->allocateFrameData(sizeof(ObjectData), dynamicOffset));
+    if (objectData == nullptr)
+    {
+        return;
+    }
 
-    push.normalMatrix[0][3] = _UVoffset.x;
-    push.normalMatrix[1][3] = _UVoffset.y;
-    push.normalMatrix[2][3] = _worldSpaceUV ? _UVScale : 0.f;
-    push.normalMatrix[3][3] = _textured ? glm::radians(_UVRotate) : 100.f;
+    objectData->modelMatrix = modelMatrix;
+    objectData->normalMatrix = normalMatrix;
+    objectData->color = glm::vec4(_color, _textured ? 1.f : 0.f);
+    objectData->uvParameters =
+        glm::vec4(_UVoffset, _worldSpaceUV ? _UVScale : 0.f, _textured ? glm::radians(_UVRotate) : 0.f);
 
-    frameInfo->commandBuffer.pushConstants(_pipelineLayout,
-                                           vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0,
-                                           sizeof(PushConstantData), &push);
+    _renderSystem->bindFrameData(frameInfo, _pipelineLayout, 3, dynamicOffset);
 }
 
 void ShadedMaterial::editor()
 {
     Material::editor();
 
-    ImGui::Checkbox("use texture", &_textured);
+    _dirty |= ImGui::Checkbox("use texture", &_textured);
 
     if (_textured)
     {
-        ImGui::Checkbox("World space UV", &_worldSpaceUV);
+        _dirty |= ImGui::Checkbox("World space UV", &_worldSpaceUV);
         if (_worldSpaceUV)
         {
-            ImGui::SliderFloat2("UV offset", (float *)&_UVoffset, -1.f, 1.f);
-            ImGui::DragFloat("Scale", &_UVScale);
-            ImGui::DragFloat("Rotate", &_UVRotate, 1.f, -180.f, 180.f);
+            _dirty |= ImGui::SliderFloat2("UV offset", (float *)&_UVoffset, -1.f, 1.f);
+            _dirty |= ImGui::DragFloat("Scale", &_UVScale);
+            _dirty |= ImGui::DragFloat("Rotate", &_UVRotate, 1.f, -180.f, 180.f);
         }
     }
 
-    ImGui::ColorEdit3("##", (float *)&_color);
+    _dirty |= ImGui::ColorEdit3("##", (float *)&_color);
 }
 
 tinyxml2::XMLElement *ShadedMaterial::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const
@@ -120,18 +143,20 @@ void ShadedMaterial::initialize()
     RenderSystem *renderSystem = RenderSystem::getInstance();
 
     loadBindings();
+    _bindlessTextures = true;
 
-    createPipelineLayout({renderSystem->getGlobalSetLayout(), renderSystem->getSamplerDescriptorSetLayout(),
-                          renderSystem->getSamplerDescriptorSetLayout()});
+    createPipelineLayout({renderSystem->getGlobalSetLayout(), renderSystem->getBindlessSetLayout(),
+                          renderSystem->getSamplerDescriptorSetLayout(), renderSystem->getObjectSetLayout()});
     createPipeline(renderSystem->getGBuffer()->getRenderPass());
 }
 
 void ShadedMaterial::createPipelineLayout(std::vector<vk::DescriptorSetLayout> descriptorSetLayouts)
 {
+    // per draw data is read from the frame's ring buffer, only the bindless texture indices are pushed
     vk::PushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment;
+    pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eFragment;
     pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(PushConstantData);
+    pushConstantRange.size = sizeof(TextureIndices);
 
     vk::PipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = vk::StructureType::ePipelineLayoutCreateInfo;
@@ -139,11 +164,7 @@ void ShadedMaterial::createPipelineLayout(std::vector<vk::DescriptorSetLayout> d
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-    if (_renderSystem->getDevice()->device().createPipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout) !=
-        vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    _pipelineLayout = _renderSystem->getDevice()->getPipelineRegistry().acquireLayout(pipelineLayoutInfo);
 
     _requestedSamplerCount -=
         1; // we are manually binding the shadow map, so we don't want this to show up for the user
@@ -157,8 +178,16 @@ void ShadedMaterial::createPipeline(vk::RenderPass renderPass)
     Pipeline::defaultPipelineConfigInfo(pipelineConfig);
     pipelineConfig.renderPass = renderPass;
     pipelineConfig.pipelineLayout = _pipelineLayout;
-    _pipeline = std::make_unique<Pipeline>(*_renderSystem->getDevice(), _vertFilepath, _fragFilepath, pipelineConfig,
-                                           "shaded material pipeline");
+    _pipeline = _renderSystem->getDevice()->getPipelineRegistry().acquirePipeline(
+        _vertFilepath, _fragFilepath, pipelineConfig, "shaded material pipeline");
+
+    // shares the fragment shader, only the vertex stage reads its matrices from the instance stream
+    PipelineConfigInfo instancedPipelineConfig{};
+    Pipeline::instancedPipelineConfigInfo(instancedPipelineConfig);
+    instancedPipelineConfig.renderPass = renderPass;
+    instancedPipelineConfig.pipelineLayout = _pipelineLayout;
+    _instancedPipeline = _renderSystem->getDevice()->getPipelineRegistry().acquirePipeline(
+        "shaded_instanced.vert.spv", _fragFilepath, instancedPipelineConfig, "shaded material instanced pipeline");
 }
 
 } // namespace cmx
@@ -21,6 +21,7 @@ class ShadedMaterial : public Material
     CLONEABLE_MATERIAL(ShadedMaterial)
 
     void bind(struct FrameInfo *, const class Drawable *) override;
+    void bindInstanced(struct FrameInfo *) override;
     void editor() override;
     tinyxml2::XMLElement *save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const override;
     void load(tinyxml2::XMLElement *materialElement) override;
@@ -31,6 +32,10 @@ class ShadedMaterial : public Material
     void createPipelineLayout(std::vector<vk::DescriptorSetLayout>) override;
     void createPipeline(vk::RenderPass) override;
 
+    void bindDescriptorSets(struct FrameInfo *);
+    // writes the draw's matrices and the material parameters in the frame's ring buffer, bound as set 3
+    void bindObjectData(struct FrameInfo *, const glm::mat4 &modelMatrix, const glm::mat4 &normalMatrix);
+
     glm::vec3 _color{1.f, 1.f, 1.f};
     glm::vec2 _UVoffset{};
     bool _worldSpaceUV{false};
@@ -18,23 +18,9 @@ namespace cmx
 
 void PostOutlineMaterial::bind(FrameInfo *frameInfo, const Drawable *)
 {
-    if (_boundID != _id)
-    {
-        _pipeline->bind(frameInfo->commandBuffer);
-
-        size_t *descriptorSetIDs = _renderSystem->getGBuffer()->getSamplerDescriptorSetIDs();
-        frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 0, 1,
-                                                    &(_renderSystem->getSamplerDescriptorSet(descriptorSetIDs[0])), 0,
-                                                    nullptr);
-        frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 1, 1,
-                                                    &(_renderSystem->getSamplerDescriptorSet(descriptorSetIDs[1])), 0,
-                                                    nullptr);
-        frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 2, 1,
-                                                    &(_renderSystem->getSamplerDescriptorSet(descriptorSetIDs[2])), 0,
-                                                    nullptr);
-
-        _boundID = _id;
-    }
+    // the input changes from one effect of the chain to the next, always bound
+    bindPostProcess(frameInfo);
+    _boundID = _id;
 
     PushConstantData push{};
     push.edgeColor = _edgeColor;
@@ -59,29 +45,29 @@ void PostOutlineMaterial::editor()
 {
     Material::editor();
 
-    ImGui::ColorEdit3("Edge Color##Outline", (float *)&_edgeColor);
+    _dirty |= ImGui::ColorEdit3("Edge Color##Outline", (float *)&_edgeColor);
 
     if (ImGui::TreeNode("Color"))
     {
-        ImGui::DragFloat("Line thickness##Color", &_colorEdgeThickness, 1.f, 0.f, 20.f);
-        ImGui::DragFloat("Edge threshold##Color", &_colorEdgeThreshold, 0.05f, 0.f, 1.f);
-        ImGui::DragFloat("Depth factor##Color", &_colorDepthFactor, 0.05f, 0.f, 5.f);
+        _dirty |= ImGui::DragFloat("Line thickness##Color", &_colorEdgeThickness, 1.f, 0.f, 20.f);
+        _dirty |= ImGui::DragFloat("Edge threshold##Color", &_colorEdgeThreshold, 0.05f, 0.f, 1.f);
+        _dirty |= ImGui::DragFloat("Depth factor##Color", &_colorDepthFactor, 0.05f, 0.f, 5.f);
         ImGui::TreePop();
     }
 
     if (ImGui::TreeNode("Normal"))
     {
-        ImGui::DragFloat("Line thickness##Normal", &_normalEdgeThickness, 1.f, 0.f, 20.f);
-        ImGui::DragFloat("Edge threshold##Normal", &_normalEdgeThreshold, 0.01f, 0.f, 1.f);
-        ImGui::DragFloat("Depth factor##Depth", &_normalDepthFactor, 0.01f, 0.01f, .5f);
+        _dirty |= ImGui::DragFloat("Line thickness##Normal", &_normalEdgeThickness, 1.f, 0.f, 20.f);
+        _dirty |= ImGui::DragFloat("Edge threshold##Normal", &_normalEdgeThreshold, 0.01f, 0.f, 1.f);
+        _dirty |= ImGui::DragFloat("Depth factor##Depth", &_normalDepthFactor, 0.01f, 0.01f, .5f);
         ImGui::TreePop();
     }
 
     if (ImGui::TreeNode("Depth"))
     {
-        ImGui::DragFloat("Line thickness##Depth", &_depthEdgeThickness, 1.f, 0.f, 20.f);
-        ImGui::DragFloat("Edge threshold##Depth", &_depthEdgeThreshold, 0.05f, 0.f, 10.f);
-        ImGui::DragFloat("Depth factor##Depth", &_depthDepthFactor, 0.01f, 0.01f, .5f);
+        _dirty |= ImGui::DragFloat("Line thickness##Depth", &_depthEdgeThickness, 1.f, 0.f, 20.f);
+        _dirty |= ImGui::DragFloat("Edge threshold##Depth", &_depthEdgeThreshold, 0.05f, 0.f, 10.f);
+        _dirty |= ImGui::DragFloat("Depth factor##Depth", &_depthDepthFactor, 0.01f, 0.01f, .5f);
         ImGui::TreePop();
     }
 }
@@ -121,11 +107,7 @@ void PostOutlineMaterial::createPipelineLayout(std::vector<vk::DescriptorSetLayo
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    if (_renderSystem->getDevice()->device().createPipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout) !=
-        vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    _pipelineLayout = _renderSystem->getDevice()->getPipelineRegistry().acquireLayout(pipelineLayoutInfo);
 
     _requestedSamplerCount -= 1;
 }
@@ -143,8 +125,18 @@ void PostOutlineMaterial::createPipeline(vk::RenderPass renderPass)
     pipelineConfig.bindingDescriptions.clear();
     pipelineConfig.attributeDescriptions.clear();
 
-    _pipeline = std::make_unique<Pipeline>(*_renderSystem->getDevice(), _vertFilepath, _fragFilepath, pipelineConfig,
-                                           "post outline material pipeline");
+    PipelineRegistry &pipelineRegistry = _renderSystem->getDevice()->getPipelineRegistry();
+    _pipeline = pipelineRegistry.acquirePipeline(_vertFilepath, _fragFilepath, pipelineConfig,
+                                                 "post outline material pipeline");
+
+    // fused with a passthrough, the outline draws over what it would have shown
+    _fusedPipelines.clear();
+    for (int source = 0; source < POST_PROCESS_SOURCE_COUNT; source++)
+    {
+        pipelineConfig.fragmentConstants = {uint32_t(source)};
+        _fusedPipelines.push_back(pipelineRegistry.acquirePipeline(_vertFilepath, _fragFilepath, pipelineConfig,
+                                                                   "post outline material fused pipeline"));
+    }
 }
 
 } // namespace cmx
@@ -19,23 +19,8 @@ namespace cmx
 
 void PostPassthroughMaterial::bind(FrameInfo *frameInfo, const Drawable *)
 {
-    if (_boundID != _id)
-    {
-        _pipeline->bind(frameInfo->commandBuffer);
-
-        size_t *descriptorSetIDs = _renderSystem->getGBuffer()->getSamplerDescriptorSetIDs();
-        frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 0, 1,
-                                                    &(_renderSystem->getSamplerDescriptorSet(descriptorSetIDs[0])), 0,
-                                                    nullptr);
-        frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 1, 1,
-                                                    &(_renderSystem->getSamplerDescriptorSet(descriptorSetIDs[1])), 0,
-                                                    nullptr);
-        frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, _pipelineLayout, 2, 1,
-                                                    &(_renderSystem->getSamplerDescriptorSet(descriptorSetIDs[2])), 0,
-                                                    nullptr);
-
-        _boundID = _id;
-    }
+    bindPostProcess(frameInfo);
+    _boundID = _id;
 
     PushConstantData push{};
     push.status = _status;
@@ -74,6 +59,7 @@ void PostPassthroughMaterial::editor()
             {
                 selected = name.c_str();
                 _status = status;
+                _dirty = true;
                 spdlog::info("{0}", _status);
                 isSelected = true;
             }
@@ -132,11 +118,7 @@ void PostPassthroughMaterial::createPipelineLayout(std::vector<vk::DescriptorSet
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    if (_renderSystem->getDevice()->device().createPipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout) !=
-        vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    _pipelineLayout = _renderSystem->getDevice()->getPipelineRegistry().acquireLayout(pipelineLayoutInfo);
 
     _requestedSamplerCount -= 1;
 }
@@ -154,8 +136,8 @@ void PostPassthroughMaterial::createPipeline(vk::RenderPass renderPass)
     pipelineConfig.bindingDescriptions.clear();
     pipelineConfig.attributeDescriptions.clear();
 
-    _pipeline = std::make_unique<Pipeline>(*_renderSystem->getDevice(), _vertFilepath, _fragFilepath, pipelineConfig,
-                                           "post outline material pipeline");
+    _pipeline = _renderSystem->getDevice()->getPipelineRegistry().acquirePipeline(
+        _vertFilepath, _fragFilepath, pipelineConfig, "post outline material pipeline");
 }
 
 } // namespace cmx
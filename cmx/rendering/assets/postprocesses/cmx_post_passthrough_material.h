@@ -26,6 +26,12 @@ class PostPassthroughMaterial : public Material
 
     void initialize() override;
 
+    // a function of the G-buffer at the shaded pixel, whichever it visualizes
+    int getFusionSource() const override
+    {
+        return _status;
+    }
+
   protected:
     struct PushConstantData
     {
@@ -85,11 +85,13 @@ void Camera::updateAspectRatio(float aspectRatio)
     setPerspectiveProjection(_FOV, _screenAspectRatio, _nearPlane, _farPlane);
 }
 
-void Camera::editor()
+bool Camera::editor()
 {
-    ImGui::SliderFloat("FOV", &_FOV, 10.f, 160.f);
-    ImGui::SliderFloat("far plane", &_farPlane, 1.f, 100000.f);
-    ImGui::SliderFloat("near plane", &_nearPlane, 1.f, 100000.f);
+    bool edited = ImGui::SliderFloat("FOV", &_FOV, 10.f, 160.f);
+    edited |= ImGui::SliderFloat("far plane", &_farPlane, 1.f, 100000.f);
+    edited |= ImGui::SliderFloat("near plane", &_nearPlane, 1.f, 100000.f);
+
+    return edited;
 }
 
 } // namespace cmx
@@ -35,7 +35,8 @@ class Camera
         return _viewMatrix;
     }
 
-    void editor();
+    // true when edited
+    bool editor();
 
     float getFOV() const
     {
@@ -0,0 +1,111 @@
+#include "cmx_culling.h"
+
+// lib
+#include <glm/geometric.hpp>
+
+// std
+#if defined(__SSE__) || defined(_M_X64)
+#define CMX_CULLING_SSE
+#include <immintrin.h>
+#endif
+
+namespace cmx
+{
+
+void CullingBounds::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+void CullingBounds::push(const glm::vec4 &sphere)
+{
+    x.push_back(sphere.x);
+    y.push_back(sphere.y);
+    z.push_back(sphere.z);
+    radius.push_back(sphere.w);
+}
+
+Frustum::Frustum(const glm::mat4 &projectionView)
+{
+    // glm is column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const glm::mat4 rows = glm::transpose(projectionView);
+
+    planes[0] = rows[3] + rows[0]; // left
+    planes[1] = rows[3] - rows[0]; // right
+    planes[2] = rows[3] + rows[1]; // bottom
+    planes[3] = rows[3] - rows[1]; // top
+    planes[4] = rows[2];           // near, depth is 0 to 1
+    planes[5] = rows[3] - rows[2]; // far
+
+    for (glm::vec4 &plane : planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+size_t cullSpheres(const Frustum &frustum, const CullingBounds &bounds, std::vector<uint32_t> &visibleIndices)
+{
+    const size_t count = bounds.size();
+    const size_t previousSize = visibleIndices.size();
+    size_t i = 0;
+
+#ifdef CMX_CULLING_SSE
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++)
+    {
+        planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(bounds.x.data() + i);
+        const __m128 y = _mm_loadu_ps(bounds.y.data() + i);
+        const __m128 z = _mm_loadu_ps(bounds.z.data() + i);
+        const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(bounds.radius.data() + i));
+
+        __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps());
+        for (int p = 0; p < 6; p++)
+        {
+            const __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(x, planeX[p]), _mm_mul_ps(y, planeY[p])),
+                _mm_add_ps(_mm_mul_ps(z, planeZ[p]), planeW[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                visibleIndices.push_back(uint32_t(i + lane));
+            }
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++)
+        {
+            const glm::vec4 &plane = frustum.planes[p];
+            const float distance = plane.x * bounds.x[i] + plane.y * bounds.y[i] + plane.z * bounds.z[i] + plane.w;
+            inside = distance >= -bounds.radius[i];
+        }
+
+        if (inside)
+        {
+            visibleIndices.push_back(uint32_t(i));
+        }
+    }
+
+    return count - (visibleIndices.size() - previousSize);
+}
+
+} // namespace cmx
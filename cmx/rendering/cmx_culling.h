@@ -0,0 +1,56 @@
+#ifndef CMX_CULLING
+#define CMX_CULLING
+
+// lib
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float4.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace cmx
+{
+
+// world space bounding spheres of a flattened render queue, one array per component so they can be tested 4 at a time
+struct CullingBounds
+{
+    void clear();
+    // radius is the w component, an infinite radius is never culled
+    void push(const glm::vec4 &sphere);
+
+    size_t size() const
+    {
+        return radius.size();
+    }
+
+    std::vector<float> x{};
+    std::vector<float> y{};
+    std::vector<float> z{};
+    std::vector<float> radius{};
+};
+
+struct Frustum
+{
+    // planes are extracted from the clip space of projection * view, normals pointing inwards
+    explicit Frustum(const glm::mat4 &projectionView);
+
+    glm::vec4 planes[6];
+};
+
+struct CullingStats
+{
+    uint32_t visible{0};
+    uint32_t culled{0};
+    uint32_t shadowVisible{0};
+    uint32_t shadowCulled{0};
+    // static casters reused from the cached layer rather than drawn
+    uint32_t shadowCached{0};
+};
+
+// appends the indices of the spheres touching the frustum in ascending order, returns how many were culled
+size_t cullSpheres(const Frustum &, const CullingBounds &, std::vector<uint32_t> &visibleIndices);
+
+} // namespace cmx
+
+#endif
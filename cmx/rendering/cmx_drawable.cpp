@@ -9,6 +9,7 @@
 #include "cmx_material.h"
 #include "cmx_model.h"
 #include "cmx_render_system.h"
+#include "cmx_scene_records.h"
 #include "cmx_texture.h"
 #include "cmx_utils.h"
 
@@ -22,6 +23,7 @@
 
 // std
 #include <cstdio>
+#include <limits>
 #include <string>
 
 namespace cmx
@@ -44,6 +46,7 @@ void Drawable::setDrawOption(const DrawOption &drawOption, size_t index)
     }
 
     _drawOptions[index] = drawOption;
+    markDirty();
 
     if (drawOption.material == nullptr)
     {
@@ -62,12 +65,11 @@ void Drawable::setDrawOption(const DrawOption &drawOption, size_t index)
 
 void Drawable::setMaterial(const char *name, size_t index)
 {
-    size_t oldID = _drawOptions[index].getMaterialID();
-
     AssetsManager *assetsManager = getParentActor()->getScene()->getAssetsManager();
     _drawOptions[index].material = assetsManager->getMaterial(name);
+    markDirty();
 
-    getParentActor()->getScene()->getGraphicsManager()->update(this, &_drawOptions[index], oldID);
+    getParentActor()->getScene()->getGraphicsManager()->update(this, &_drawOptions[index]);
 }
 
 void Drawable::setTextures(const std::vector<const char *> textures, size_t index)
@@ -80,12 +82,14 @@ void Drawable::setTextures(const std::vector<const char *> textures, size_t inde
     {
         _drawOptions[index].textures.push_back(assetsManager->getAnyTexture(name));
     }
+    markDirty();
 }
 
 void Drawable::setModel(const char *name, size_t index)
 {
     AssetsManager *assetsManager = getParentActor()->getScene()->getAssetsManager();
     _drawOptions[index].model = assetsManager->getModel(name);
+    markDirty();
 }
 
 size_t DrawOption::getMaterialID() const
@@ -223,6 +227,7 @@ void Drawable::editor(int i)
                                         drawOption.textures[textureIndex] = binding.dim == SpvDim2D
                                                                                 ? assetsManager->get2DTexture(selected)
                                                                                 : assetsManager->get3DTexture(selected);
+                                        markDirty();
                                     }
 
                                     if (isSelected)
@@ -316,25 +321,114 @@ void Drawable::load(tinyxml2::XMLElement *parentElement)
     }
 }
 
-void Drawable::render(FrameInfo &frameInfo, DrawOption *drawOption) const
+void Drawable::writeRecord(RecordWriter &writer) const
 {
-    if (drawOption->material == nullptr)
+    const size_t offset = writer.write(DrawableRecord{0});
+
+    for (auto &[index, option] : _drawOptions)
+    {
+        if (option.material == nullptr)
+        {
+            continue;
+        }
+
+        const bool hasModel = option.model != nullptr && option.material->needsModel();
+        const size_t textureCount = std::min(option.material->getRequestedSamplerCount(), option.textures.size());
+
+        writer.write(DrawOptionRecord{uint32_t(index), writer.addString(option.material->name),
+                                      hasModel ? writer.addString(option.model->name) : NO_RECORD_STRING,
+                                      uint32_t(textureCount)});
+        for (size_t i = 0; i < textureCount; i++)
+        {
+            writer.write(writer.addString(option.textures[i]->name));
+        }
+
+        writer.at<DrawableRecord>(offset).optionCount++;
+    }
+}
+
+void Drawable::readRecord(RecordReader &reader)
+{
+    const DrawableRecord *drawableRecord = reader.read<DrawableRecord>();
+    if (drawableRecord == nullptr)
+    {
         return;
+    }
+
+    for (uint32_t i = 0; i < drawableRecord->optionCount; i++)
+    {
+        const DrawOptionRecord *optionRecord = reader.read<DrawOptionRecord>();
+        const uint32_t *textures = optionRecord ? reader.read<uint32_t>(optionRecord->textureCount) : nullptr;
+        if (textures == nullptr)
+        {
+            return;
+        }
+
+        const size_t index = optionRecord->index;
+
+        setDrawOption(DrawOption{}, index);
+        setMaterial(reader.getString(optionRecord->material), index);
+
+        Material *material = _drawOptions[index].material;
+        if (material == nullptr)
+        {
+            continue;
+        }
+
+        if (material->needsModel())
+        {
+            setModel(reader.getString(optionRecord->model), index);
+        }
+
+        std::vector<const char *> textureNames{};
+        const size_t textureCount = std::min(material->getRequestedSamplerCount(), size_t(optionRecord->textureCount));
+        for (size_t j = 0; j < textureCount; j++)
+        {
+            textureNames.push_back(reader.getString(textures[j]));
+        }
+        setTextures(textureNames, index);
+    }
+}
+
+bool Drawable::canRender(DrawOption *drawOption) const
+{
+    if (drawOption->material == nullptr)
+        return false;
     if (!drawOption->material->isVisible())
-        return;
+        return false;
     if (!(*_parentP)->isVisible())
-        return;
+        return false;
 
     size_t textureCount = drawOption->material->getRequestedSamplerCount();
 
     drawOption->textures.resize(std::min(textureCount, drawOption->textures.size()));
 
     if (drawOption->textures.size() < textureCount)
-        return;
+        return false;
     if (drawOption->material->needsModel() && drawOption->model == nullptr)
+        return false;
+
+    // still uploading
+    if (drawOption->model && !drawOption->model->isReady())
+        return false;
+    for (const Texture *texture : drawOption->textures)
+    {
+        if (!texture->isReady())
+            return false;
+    }
+
+    return true;
+}
+
+void Drawable::bindTextures(FrameInfo &frameInfo, const DrawOption *drawOption)
+{
+    if (drawOption->material->usesBindlessTextures())
+    {
+        drawOption->material->bindTextureIndices(&frameInfo, drawOption->textures);
         return;
+    }
 
-    drawOption->material->bind(&frameInfo, this);
+    size_t textureCount = drawOption->material->getRequestedSamplerCount();
 
     if (textureCount > 1)
     {
@@ -344,6 +438,33 @@ void Drawable::render(FrameInfo &frameInfo, DrawOption *drawOption) const
     {
         drawOption->textures[0]->bind(frameInfo.commandBuffer, drawOption->material->getPipelineLayout());
     }
+}
+
+glm::vec4 Drawable::getWorldBoundingSphere(const DrawOption *drawOption) const
+{
+    if (drawOption->material == nullptr || !drawOption->material->needsModel() || drawOption->model == nullptr)
+    {
+        return glm::vec4{0.f, 0.f, 0.f, std::numeric_limits<float>::infinity()};
+    }
+
+    const Transform transform = getWorldSpaceTransform();
+    const glm::vec4 &localSphere = drawOption->model->getBoundingSphere();
+    const glm::vec3 scale = glm::abs(transform.scale);
+
+    const glm::vec3 center = transform.position + transform.rotation * (transform.scale * glm::vec3{localSphere});
+    const float radius = localSphere.w * std::max(scale.x, std::max(scale.y, scale.z));
+
+    return glm::vec4{center, radius};
+}
+
+void Drawable::render(FrameInfo &frameInfo, DrawOption *drawOption) const
+{
+    if (!canRender(drawOption))
+        return;
+
+    drawOption->material->bind(&frameInfo, this);
+
+    bindTextures(frameInfo, drawOption);
 
     if (drawOption->material->needsModel())
     {
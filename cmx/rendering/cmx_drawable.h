@@ -14,7 +14,6 @@
 namespace cmx
 {
 
-// TODO: static, dynamic for shadowmap rendering
 struct DrawOption
 {
     class Material *material{nullptr};
@@ -38,8 +37,15 @@ class Drawable : public virtual Transformable
     void editor(int i);
     tinyxml2::XMLElement &save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const;
     void load(tinyxml2::XMLElement *parentElement);
+    void writeRecord(class RecordWriter &) const;
+    void readRecord(class RecordReader &);
 
     void render(struct FrameInfo &, DrawOption *drawOption) const;
+    // whether render would draw anything, trims extra textures on the way
+    bool canRender(DrawOption *drawOption) const;
+    static void bindTextures(struct FrameInfo &, const DrawOption *drawOption);
+    // world space bounds of the option's model, infinite when there is no model to bound
+    glm::vec4 getWorldBoundingSphere(const DrawOption *drawOption) const;
 
     void setDrawOption(const DrawOption &, size_t index = 0);
     void setMaterial(const char *, size_t index = 0);
@@ -43,15 +43,15 @@ void GBuffer::updateAspectRatio(Device *device, const vk::Extent2D &resolution)
     renderSystem->freeSamplerDescriptor(_samplerDescriptorSetIDs[0]);
     device->device().destroyImageView(_colorImageView);
     device->device().destroyImage(_colorImage);
-    device->device().freeMemory(_colorImageMemory);
+    device->freeMemory(_colorImageMemory);
     renderSystem->freeSamplerDescriptor(_samplerDescriptorSetIDs[1]);
     device->device().destroyImageView(_normalImageView);
     device->device().destroyImage(_normalImage);
-    device->device().freeMemory(_normalImageMemory);
+    device->freeMemory(_normalImageMemory);
     renderSystem->freeSamplerDescriptor(_samplerDescriptorSetIDs[2]);
     device->device().destroyImageView(_depthImageView);
     device->device().destroyImage(_depthImage);
-    device->device().freeMemory(_depthImageMemory);
+    device->freeMemory(_depthImageMemory);
 
     createTextures(resolution, device);
 }
@@ -70,19 +70,8 @@ void GBuffer::beginRender(FrameInfo *frameInfo, const LightEnvironment *lightEnv
     renderPassBeginInfo.clearValueCount = 3;
     renderPassBeginInfo.pClearValues = clearValues.data();
 
-    frameInfo->commandBuffer.beginRenderPass(&renderPassBeginInfo, vk::SubpassContents::eInline);
-
-    static vk::Viewport viewport;
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)_resolution.width;
-    viewport.height = (float)_resolution.height;
-    viewport.minDepth = 0.f;
-    viewport.maxDepth = 1.f;
-
-    vk::Rect2D scissor{vk::Offset2D{0, 0}, _resolution};
-    frameInfo->commandBuffer.setViewport(0, 1, &viewport);
-    frameInfo->commandBuffer.setScissor(0, 1, &scissor);
+    // draws are recorded in secondary command buffers, which also set the viewport
+    frameInfo->commandBuffer.beginRenderPass(&renderPassBeginInfo, vk::SubpassContents::eSecondaryCommandBuffers);
 }
 
 void GBuffer::endRender(FrameInfo *frameInfo) const
@@ -344,17 +333,17 @@ void GBuffer::free(Device *device)
     device->device().destroySampler(_colorSampler);
     device->device().destroyImageView(_colorImageView);
     device->device().destroyImage(_colorImage);
-    device->device().freeMemory(_colorImageMemory);
+    device->freeMemory(_colorImageMemory);
     renderSystem->freeSamplerDescriptor(_samplerDescriptorSetIDs[1]);
     device->device().destroySampler(_normalSampler);
     device->device().destroyImageView(_normalImageView);
     device->device().destroyImage(_normalImage);
-    device->device().freeMemory(_normalImageMemory);
+    device->freeMemory(_normalImageMemory);
     renderSystem->freeSamplerDescriptor(_samplerDescriptorSetIDs[2]);
     device->device().destroySampler(_depthSampler);
     device->device().destroyImageView(_depthImageView);
     device->device().destroyImage(_depthImage);
-    device->device().freeMemory(_depthImageMemory);
+    device->freeMemory(_depthImageMemory);
 }
 
 } // namespace cmx
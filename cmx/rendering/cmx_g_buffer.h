@@ -1,6 +1,9 @@
 #ifndef CMX_G_BUFFER
 #define CMX_G_BUFFER
 
+// cmx
+#include "cmx_memory_allocator.h"
+
 // lib
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
@@ -31,10 +34,31 @@ class GBuffer
     {
         return _renderPass;
     };
+    vk::Extent2D getResolution() const
+    {
+        return _resolution;
+    };
     size_t *getSamplerDescriptorSetIDs()
     {
         return _samplerDescriptorSetIDs;
     };
+    // recreated along with the resolution
+    vk::Image getColorImage() const
+    {
+        return _colorImage;
+    }
+    vk::Image getNormalImage() const
+    {
+        return _normalImage;
+    }
+    vk::Image getDepthImage() const
+    {
+        return _depthImage;
+    }
+    vk::Format getColorFormat() const
+    {
+        return _colorFormat;
+    }
 
     void createTextures(vk::Extent2D resolution, class Device *);
 
@@ -50,15 +74,15 @@ class GBuffer
     vk::Image _colorImage;
     vk::ImageView _colorImageView;
     vk::Sampler _colorSampler;
-    vk::DeviceMemory _colorImageMemory;
+    Allocation _colorImageMemory;
     vk::Image _normalImage;
     vk::ImageView _normalImageView;
     vk::Sampler _normalSampler;
-    vk::DeviceMemory _normalImageMemory;
+    Allocation _normalImageMemory;
     vk::Image _depthImage;
     vk::ImageView _depthImageView;
     vk::Sampler _depthSampler;
-    vk::DeviceMemory _depthImageMemory;
+    Allocation _depthImageMemory;
     vk::Extent2D _resolution;
     vk::RenderPass _renderPass;
     vk::Framebuffer _framebuffer;
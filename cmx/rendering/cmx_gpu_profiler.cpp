@@ -0,0 +1,307 @@
+#include "cmx_gpu_profiler.h"
+
+// cmx
+#include "cmx_device.h"
+#include "cmx_swap_chain.h"
+
+// lib
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+
+// std
+#include <stdexcept>
+
+namespace cmx
+{
+
+namespace
+{
+
+// results come in bit order, which is GpuPipelineStatistics' order
+constexpr vk::QueryPipelineStatisticFlags STATISTIC_FLAGS =
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+    vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+constexpr uint32_t STATISTIC_COUNT = 5;
+
+} // namespace
+
+GpuProfiler::GpuProfiler(Device &device) : _device{device}
+{
+    _frames.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+
+    const uint32_t graphicsFamily = device.findPhysicalQueueFamilies().graphicsFamily;
+    const uint32_t validBits = device.physicalDevice().getQueueFamilyProperties()[graphicsFamily].timestampValidBits;
+
+    if (validBits == 0)
+    {
+        spdlog::warn("GpuProfiler: the graphics queue can't write timestamps, GPU timings are unavailable");
+        _enabled = false;
+    }
+    else
+    {
+        _timestampPeriod = device._properties.limits.timestampPeriod;
+        _timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1ull;
+
+        vk::QueryPoolCreateInfo createInfo{};
+        createInfo.queryType = vk::QueryType::eTimestamp;
+        createInfo.queryCount = SwapChain::MAX_FRAMES_IN_FLIGHT * GPU_PROFILER_MAX_SCOPES * 2;
+
+        if (device.device().createQueryPool(&createInfo, nullptr, &_timestampPool) != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("GpuProfiler: failed to create timestamp query pool");
+        }
+    }
+
+    if (device.supportsPipelineStatistics())
+    {
+        vk::QueryPoolCreateInfo createInfo{};
+        createInfo.queryType = vk::QueryType::ePipelineStatistics;
+        createInfo.queryCount = SwapChain::MAX_FRAMES_IN_FLIGHT * GPU_PROFILER_MAX_STATISTICS;
+        createInfo.pipelineStatistics = STATISTIC_FLAGS;
+
+        if (device.device().createQueryPool(&createInfo, nullptr, &_statisticsPool) != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("GpuProfiler: failed to create pipeline statistics query pool");
+        }
+    }
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    if (!_freed)
+    {
+        spdlog::error("GpuProfiler: forgot to free before deletion");
+    }
+}
+
+void GpuProfiler::free()
+{
+    if (_freed)
+        return;
+
+    if (_timestampPool)
+    {
+        _device.device().destroyQueryPool(_timestampPool);
+    }
+    if (_statisticsPool)
+    {
+        _device.device().destroyQueryPool(_statisticsPool);
+    }
+
+    _freed = true;
+}
+
+void GpuProfiler::beginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    _frameIndex = frameIndex;
+    _depth = 0;
+    _openStatistics = GPU_SCOPE_NONE;
+
+    Frame &frame = _frames[frameIndex];
+    if (frame.recorded)
+    {
+        readBack(frameIndex);
+    }
+    frame.records.clear();
+    frame.statisticsCount = 0;
+
+    // toggling mid frame only takes effect on the next one
+    _frameOpen = _enabled;
+    if (!_frameOpen)
+        return;
+
+    commandBuffer.resetQueryPool(_timestampPool, frameIndex * GPU_PROFILER_MAX_SCOPES * 2,
+                                 GPU_PROFILER_MAX_SCOPES * 2);
+    if (_statisticsPool)
+    {
+        commandBuffer.resetQueryPool(_statisticsPool, frameIndex * GPU_PROFILER_MAX_STATISTICS,
+                                     GPU_PROFILER_MAX_STATISTICS);
+    }
+
+    beginScope(commandBuffer, "frame");
+}
+
+void GpuProfiler::endFrame(vk::CommandBuffer commandBuffer)
+{
+    Frame &frame = _frames[_frameIndex];
+    if (frame.records.empty())
+        return;
+
+    if (_depth != 1)
+    {
+        spdlog::error("GpuProfiler: {0} scopes left open at the end of the frame", _depth - 1);
+        frame.records.clear();
+        _frameOpen = false;
+        return;
+    }
+
+    endScope(commandBuffer, 0);
+    frame.recorded = true;
+    _frameOpen = false;
+}
+
+uint32_t GpuProfiler::beginScope(vk::CommandBuffer commandBuffer, const std::string &name, bool statistics)
+{
+    Frame &frame = _frames[_frameIndex];
+
+    if (!_frameOpen || frame.records.size() >= GPU_PROFILER_MAX_SCOPES)
+        return GPU_SCOPE_NONE;
+
+    const uint32_t scope = uint32_t(frame.records.size());
+    frame.records.push_back({name, _depth++, GPU_SCOPE_NONE});
+
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, _timestampPool,
+                                 (_frameIndex * GPU_PROFILER_MAX_SCOPES + scope) * 2);
+
+    if (statistics && _collectStatistics && _openStatistics == GPU_SCOPE_NONE &&
+        frame.statisticsCount < GPU_PROFILER_MAX_STATISTICS)
+    {
+        ScopeRecord &record = frame.records.back();
+        record.statisticsQuery = frame.statisticsCount++;
+        commandBuffer.beginQuery(_statisticsPool, _frameIndex * GPU_PROFILER_MAX_STATISTICS + record.statisticsQuery,
+                                 {});
+        _openStatistics = scope;
+    }
+
+    return scope;
+}
+
+void GpuProfiler::endScope(vk::CommandBuffer commandBuffer, uint32_t scope)
+{
+    if (scope == GPU_SCOPE_NONE)
+        return;
+
+    const ScopeRecord &record = _frames[_frameIndex].records[scope];
+
+    if (record.statisticsQuery != GPU_SCOPE_NONE)
+    {
+        commandBuffer.endQuery(_statisticsPool, _frameIndex * GPU_PROFILER_MAX_STATISTICS + record.statisticsQuery);
+        _openStatistics = GPU_SCOPE_NONE;
+    }
+
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, _timestampPool,
+                                 (_frameIndex * GPU_PROFILER_MAX_SCOPES + scope) * 2 + 1);
+    _depth--;
+}
+
+vk::QueryPipelineStatisticFlags GpuProfiler::getInheritedStatistics() const
+{
+    return _openStatistics == GPU_SCOPE_NONE ? vk::QueryPipelineStatisticFlags{} : STATISTIC_FLAGS;
+}
+
+float GpuProfiler::getMilliseconds(const std::string &name) const
+{
+    for (const GpuScope &scope : _scopes)
+    {
+        if (scope.name == name)
+        {
+            return scope.milliseconds;
+        }
+    }
+
+    return 0.f;
+}
+
+void GpuProfiler::readBack(uint32_t frameIndex)
+{
+    Frame &frame = _frames[frameIndex];
+    frame.recorded = false;
+
+    const uint32_t scopeCount = uint32_t(frame.records.size());
+    _timestamps.resize(scopeCount * 2);
+
+    // the slot's fence was waited on before it was begun again, every query is already available
+    if (_device.device().getQueryPoolResults(_timestampPool, frameIndex * GPU_PROFILER_MAX_SCOPES * 2, scopeCount * 2,
+                                             _timestamps.size() * sizeof(uint64_t), _timestamps.data(),
+                                             sizeof(uint64_t), vk::QueryResultFlagBits::e64) != vk::Result::eSuccess)
+    {
+        return;
+    }
+
+    if (frame.statisticsCount > 0)
+    {
+        _statistics.resize(frame.statisticsCount * STATISTIC_COUNT);
+        if (_device.device().getQueryPoolResults(
+                _statisticsPool, frameIndex * GPU_PROFILER_MAX_STATISTICS, frame.statisticsCount,
+                _statistics.size() * sizeof(uint64_t), _statistics.data(), STATISTIC_COUNT * sizeof(uint64_t),
+                vk::QueryResultFlagBits::e64) != vk::Result::eSuccess)
+        {
+            return;
+        }
+    }
+
+    _scopes.resize(scopeCount);
+    for (uint32_t i = 0; i < scopeCount; i++)
+    {
+        const ScopeRecord &record = frame.records[i];
+        GpuScope &scope = _scopes[i];
+
+        const uint64_t ticks = (_timestamps[i * 2 + 1] - _timestamps[i * 2]) & _timestampMask;
+        scope.name = record.name;
+        scope.depth = record.depth;
+        scope.milliseconds = float(double(ticks) * _timestampPeriod / 1e6);
+        scope.hasStatistics = record.statisticsQuery != GPU_SCOPE_NONE;
+
+        if (scope.hasStatistics)
+        {
+            const uint64_t *statistics = &_statistics[record.statisticsQuery * STATISTIC_COUNT];
+            scope.statistics.vertices = statistics[0];
+            scope.statistics.primitives = statistics[1];
+            scope.statistics.vertexInvocations = statistics[2];
+            scope.statistics.clippedPrimitives = statistics[3];
+            scope.statistics.fragmentInvocations = statistics[4];
+        }
+    }
+
+    _resultCount++;
+}
+
+void GpuProfiler::editor()
+{
+    if (!isSupported())
+    {
+        ImGui::Text("the graphics queue can't write timestamps");
+        return;
+    }
+
+    bool enabled = _enabled;
+    if (ImGui::Checkbox("Timestamps", &enabled))
+    {
+        setEnabled(enabled);
+    }
+
+    if (supportsStatistics())
+    {
+        ImGui::SameLine();
+        bool collectStatistics = _collectStatistics;
+        if (ImGui::Checkbox("Pipeline statistics", &collectStatistics))
+        {
+            setCollectStatistics(collectStatistics);
+        }
+    }
+
+    if (!_enabled)
+        return;
+
+    for (const GpuScope &scope : _scopes)
+    {
+        const int indent = int(scope.depth) * 2;
+        ImGui::Text("%*s%s: %.3f ms", indent, "", scope.name.c_str(), scope.milliseconds);
+
+        if (scope.hasStatistics)
+        {
+            const GpuPipelineStatistics &statistics = scope.statistics;
+            ImGui::Text("%*svertices: %llu, primitives: %llu (%llu clipped)", indent + 2, "",
+                        (unsigned long long)statistics.vertices, (unsigned long long)statistics.primitives,
+                        (unsigned long long)statistics.clippedPrimitives);
+            ImGui::Text("%*svertex invocations: %llu, fragment invocations: %llu", indent + 2, "",
+                        (unsigned long long)statistics.vertexInvocations,
+                        (unsigned long long)statistics.fragmentInvocations);
+        }
+    }
+}
+
+} // namespace cmx
@@ -0,0 +1,152 @@
+#ifndef CMX_GPU_PROFILER
+#define CMX_GPU_PROFILER
+
+// lib
+#include <vulkan/vulkan.hpp>
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// per frame in flight
+#define GPU_PROFILER_MAX_SCOPES 128
+#define GPU_PROFILER_MAX_STATISTICS 16
+#define GPU_SCOPE_NONE UINT32_MAX
+
+namespace cmx
+{
+
+struct GpuPipelineStatistics
+{
+    uint64_t vertices{0};
+    uint64_t primitives{0};
+    uint64_t vertexInvocations{0};
+    uint64_t clippedPrimitives{0};
+    uint64_t fragmentInvocations{0};
+};
+
+// one timed scope of a frame the GPU finished
+struct GpuScope
+{
+    std::string name;
+    // 0 for the whole frame, 1 for the passes
+    uint32_t depth{0};
+    float milliseconds{0.f};
+    bool hasStatistics{false};
+    GpuPipelineStatistics statistics{};
+};
+
+// timestamp scopes, and optionally pipeline statistics, recorded into the frame's command buffer. A frame in flight
+// slot is read back when it's next begun, its fence has been waited on by then so the results come without stalling,
+// MAX_FRAMES_IN_FLIGHT frames after they were recorded
+class GpuProfiler
+{
+  public:
+    GpuProfiler(class Device &);
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+    void free();
+
+    // outside any render pass, reads the slot's last results back, resets its queries and opens the frame scope
+    void beginFrame(vk::CommandBuffer, uint32_t frameIndex);
+    void endFrame(vk::CommandBuffer);
+
+    // scopes nest and are recorded in the primary command buffer, GPU_SCOPE_NONE when disabled or out of queries
+    // statistics count everything until the scope ends, secondaries included, only one such scope is open at a time
+    uint32_t beginScope(vk::CommandBuffer, const std::string &name, bool statistics = false);
+    void endScope(vk::CommandBuffer, uint32_t scope);
+
+    // what secondaries executed under an open statistics scope have to inherit, empty otherwise
+    vk::QueryPipelineStatisticFlags getInheritedStatistics() const;
+
+    // the latest frame read back, in recording order, the frame scope first
+    const std::vector<GpuScope> &getScopes() const
+    {
+        return _scopes;
+    }
+    // milliseconds of the first scope called name in the latest frame, 0 if it wasn't recorded
+    float getMilliseconds(const std::string &name) const;
+    // increases every time a frame is read back, so callers can tell a new frame from the one they already saw
+    uint64_t getResultCount() const
+    {
+        return _resultCount;
+    }
+
+    // getters and setters :: begin
+    bool isSupported() const
+    {
+        return _timestampPeriod > 0.f;
+    }
+    bool supportsStatistics() const
+    {
+        return bool(_statisticsPool);
+    }
+    bool isEnabled() const
+    {
+        return _enabled;
+    }
+    void setEnabled(bool enabled)
+    {
+        _enabled = enabled && isSupported();
+    }
+    bool isCollectingStatistics() const
+    {
+        return _collectStatistics;
+    }
+    void setCollectStatistics(bool collect)
+    {
+        _collectStatistics = collect && supportsStatistics();
+    }
+    // getters and setters :: end
+
+    void editor();
+
+  private:
+    struct ScopeRecord
+    {
+        std::string name;
+        uint32_t depth;
+        uint32_t statisticsQuery;
+    };
+
+    struct Frame
+    {
+        std::vector<ScopeRecord> records{};
+        uint32_t statisticsCount{0};
+        bool recorded{false};
+    };
+
+    void readBack(uint32_t frameIndex);
+
+    class Device &_device;
+
+    vk::QueryPool _timestampPool;
+    vk::QueryPool _statisticsPool;
+    // nanoseconds per tick, 0 when the graphics queue can't write timestamps
+    float _timestampPeriod{0.f};
+    uint64_t _timestampMask{~0ull};
+
+    std::vector<Frame> _frames;
+    uint32_t _frameIndex{0};
+    // whether the frame being recorded had its queries reset and its frame scope opened
+    bool _frameOpen{false};
+    uint32_t _depth{0};
+    uint32_t _openStatistics{GPU_SCOPE_NONE};
+
+    std::vector<GpuScope> _scopes;
+    std::vector<uint64_t> _timestamps;
+    std::vector<uint64_t> _statistics;
+    uint64_t _resultCount{0};
+
+    bool _enabled{true};
+    bool _collectStatistics{false};
+    bool _freed{false};
+};
+
+} // namespace cmx
+
+#endif
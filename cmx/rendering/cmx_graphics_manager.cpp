@@ -3,14 +3,19 @@
 // cmx
 #include "cmx_assets_manager.h"
 #include "cmx_camera.h"
+#include "cmx_device.h"
 #include "cmx_drawable.h"
 #include "cmx_editor.h"
 #include "cmx_frame_info.h"
+#include "cmx_gpu_profiler.h"
 #include "cmx_light_environment.h"
 #include "cmx_material.h"
+#include "cmx_model.h"
 #include "cmx_post_outline_material.h"
 #include "cmx_post_passthrough_material.h"
+#include "cmx_render_graph.h"
 #include "cmx_render_system.h"
+#include "cmx_scene_records.h"
 #include "cmx_texture.h"
 #include "cmx_utils.h"
 #include "imgui.h"
@@ -20,46 +25,37 @@
 #include <immintrin.h>
 #include <spdlog/spdlog.h>
 
+// std
+#include <algorithm>
+#include <chrono>
+
 namespace cmx
 {
 
 std::vector<size_t> GraphicsManager::_shadowMapDescriptorSetIDs{};
 
-GraphicsManager::GraphicsManager() : _drawableRenderQueue{}
+GraphicsManager::GraphicsManager()
 {
     _renderSystem = RenderSystem::getInstance();
-    _postProcessMaterials = {new PostPassthroughMaterial()};
+    _recordingScratch.resize(_renderSystem->getRecordingSlotCount());
+    _postProcesses = {{new PostPassthroughMaterial()}};
+    _upsampleMaterial = new PostPassthroughMaterial();
 
-    for (Material *material : _postProcessMaterials)
+    for (PostProcessStage &postProcess : _postProcesses)
     {
-        material->initialize();
+        postProcess.material->initialize();
     }
+    _upsampleMaterial->initialize();
 }
 
-void GraphicsManager::update(Drawable *drawable, DrawOption *drawOption, size_t oldID)
+void GraphicsManager::update(Drawable *drawable, DrawOption *drawOption)
 {
     if (drawable == nullptr)
     {
         throw("GraphicsManager: attempted to update empty drawable to graphics manager");
     }
 
-    if (oldID != 0)
-    {
-        auto it = _drawableRenderQueue[oldID].begin();
-
-        while (it != _drawableRenderQueue[oldID].end())
-        {
-            if (it->second == drawOption)
-            {
-                it = _drawableRenderQueue[oldID].erase(it);
-            }
-            else
-            {
-                it++;
-            }
-        }
-    }
-
+    _renderQueue.remove(drawOption);
     add(drawable, drawOption);
 }
 
@@ -89,23 +85,12 @@ void GraphicsManager::add(Drawable *drawable, DrawOption *drawOption)
 #endif
     }
 
-    _drawableRenderQueue[id].push_back({drawable, drawOption});
+    _renderQueue.add(drawable, drawOption);
 }
 
 void GraphicsManager::remove(const DrawOption *drawOption)
 {
-    size_t id = drawOption->getMaterialID();
-    auto it = _drawableRenderQueue[id].begin();
-
-    while (it != _drawableRenderQueue[id].end())
-    {
-        if (it->second == drawOption)
-        {
-            _drawableRenderQueue[id].erase(it);
-            return;
-        }
-        it++;
-    }
+    _renderQueue.remove(drawOption);
 }
 
 void GraphicsManager::remove(const Drawable *drawable)
@@ -118,45 +103,262 @@ void GraphicsManager::remove(const Drawable *drawable)
     }
 }
 
-void GraphicsManager::drawRenderQueue(std::weak_ptr<Camera> cameraWk, LightEnvironment *graphicsManager)
+GraphicsManager::~GraphicsManager()
+{
+    if (_frameGraph)
+    {
+        _frameGraph->free();
+    }
+
+    for (size_t input : _postProcessInputs)
+    {
+        _renderSystem->freeSamplerDescriptor(input);
+    }
+    if (_postProcessSampler)
+    {
+        _renderSystem->getDevice()->device().destroySampler(_postProcessSampler);
+    }
+
+    _upsampleMaterial->free();
+    delete _upsampleMaterial;
+}
+
+void GraphicsManager::drawRenderQueue(std::weak_ptr<Camera> cameraWk, LightEnvironment *lightEnvironment)
 {
     FrameInfo *frameInfo = _renderSystem->beginCommandBuffer();
     if (!frameInfo)
         return;
 
-    graphicsManager->drawShadowMaps(frameInfo, _drawableRenderQueue, _shadowMapDescriptorSetIDs);
+    _passStart = std::chrono::steady_clock::now();
+
+    gatherBounds();
+    _cullingStats = CullingStats{};
+    _passTimings = PassTimings{};
+
+    // cascades are fitted to this frame's projection
+    std::shared_ptr<Camera> cameraLock = cameraWk.lock();
+    if (cameraLock)
+    {
+        _renderSystem->checkAspectRatio(cameraLock.get());
+    }
+    _frameCamera = cameraLock.get();
+    _frameLightEnvironment = lightEnvironment;
+
+    // the G-buffer is recreated along with the resolution, the shadow map along with the light environment
+    GBuffer *gBuffer = _renderSystem->getGBuffer();
+    if (!_frameGraph || _frameGraphDirty || _frameGraphColor != gBuffer->getColorImage() ||
+        _frameGraphShadowMap != lightEnvironment->getShadowMap() ||
+        _frameGraphTargetFormat != _renderSystem->getPostProcessFormat())
+    {
+        buildFrameGraph(lightEnvironment);
+    }
+
+    _frameGraph->execute(*frameInfo);
+
+    _renderSystem->endPostProcess(frameInfo);
+    _passTimings.submit = lap();
+}
+
+void GraphicsManager::buildFrameGraph(LightEnvironment *lightEnvironment)
+{
+    if (!_frameGraph)
+    {
+        _frameGraph = std::make_unique<RenderGraph>(*_renderSystem->getDevice());
+    }
+    _frameGraph->reset();
+
+    GBuffer *gBuffer = _renderSystem->getGBuffer();
+    _frameGraphColor = gBuffer->getColorImage();
+    _frameGraphShadowMap = lightEnvironment->getShadowMap();
+    _frameGraphTargetFormat = _renderSystem->getPostProcessFormat();
+    _frameGraphDirty = false;
+
+    RenderGraph &graph = *_frameGraph;
+    const vk::Extent2D resolution = gBuffer->getResolution();
+    const vk::ImageLayout readOnly = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+    const uint32_t shadowMap =
+        graph.importImage("shadow map", _frameGraphShadowMap,
+                          {vk::Format::eD32Sfloat, lightEnvironment->getShadowMapResolution(),
+                           vk::ImageAspectFlagBits::eDepth},
+                          readOnly);
+    const uint32_t color = graph.importImage("G-buffer color", gBuffer->getColorImage(),
+                                             {gBuffer->getColorFormat(), resolution}, readOnly);
+    const uint32_t normal = graph.importImage("G-buffer normal", gBuffer->getNormalImage(),
+                                              {vk::Format::eR16G16B16A16Snorm, resolution}, readOnly);
+    const uint32_t depth =
+        graph.importImage("G-buffer depth", gBuffer->getDepthImage(),
+                          {vk::Format::eD32Sfloat, resolution, vk::ImageAspectFlagBits::eDepth}, readOnly);
+    // the swap chain, or the editor's viewport, both transitioned by the renderer
+    const uint32_t target = graph.importImage("target", vk::Image{}, {}, vk::ImageLayout::eUndefined);
+
+    const uint32_t shadows = graph.addPass("shadows", [this](FrameInfo &frameInfo) { recordShadows(frameInfo); });
+    graph.write(shadows, shadowMap, RenderGraph::eDepthAttachment, readOnly);
+
+    const uint32_t geometry = graph.addPass("geometry", [this](FrameInfo &frameInfo) { recordGeometry(frameInfo); });
+    graph.read(geometry, shadowMap, RenderGraph::eSampled);
+    graph.write(geometry, color, RenderGraph::eColorAttachment, readOnly);
+    graph.write(geometry, normal, RenderGraph::eColorAttachment, readOnly);
+    graph.write(geometry, depth, RenderGraph::eDepthAttachment, readOnly);
+
+    // an effect the next one can compute its input from shares its draw, a chain ending below full resolution gets
+    // an extra draw copying it to the target, the sampler filters it on the way up
+    _postProcessDraws.clear();
+    std::vector<uint32_t> divisors{};
+    for (size_t i = 0; i < _postProcesses.size(); i++)
+    {
+        const PostProcessStage &stage = _postProcesses[i];
+        const PostProcessStage *next = i + 1 < _postProcesses.size() ? &_postProcesses[i + 1] : nullptr;
+
+        if (_fusePostProcesses && next && next->divisor == stage.divisor && next->material->supportsFusion() &&
+            stage.material->getFusionSource() != POST_PROCESS_UNFUSED)
+        {
+            _postProcessDraws.push_back(
+                {stage.material->name + " + " + next->material->name, next->material, stage.material});
+            i++;
+        }
+        else
+        {
+            _postProcessDraws.push_back({stage.material->name, stage.material});
+        }
+        divisors.push_back(stage.divisor);
+    }
+    if (_postProcessDraws.empty())
+    {
+        // every effect was removed, the target still needs the scene copied into it
+        _postProcessDraws.push_back({"passthrough", _upsampleMaterial});
+        divisors.push_back(1);
+    }
+    else if (divisors.back() > 1)
+    {
+        _postProcessDraws.push_back({"upsample", _upsampleMaterial});
+        divisors.push_back(1);
+    }
+
+    std::vector<uint32_t> outputs{};
+    uint32_t input = color;
+    for (size_t i = 0; i < _postProcessDraws.size(); i++)
+    {
+        const bool last = i + 1 == _postProcessDraws.size();
+        const RenderGraph::Execute execute = [this, i](FrameInfo &frameInfo) { recordPostProcess(frameInfo, i); };
+
+        const uint32_t pass = last ? graph.addPass("post process", execute)
+                                   : graph.addRasterPass("post process: " + _postProcessDraws[i].name, execute);
+        graph.read(pass, input, RenderGraph::eSampled);
+        graph.read(pass, normal, RenderGraph::eSampled);
+        graph.read(pass, depth, RenderGraph::eSampled);
+
+        if (last)
+        {
+            graph.write(pass, target, RenderGraph::eColorAttachment);
+            graph.setSideEffect(pass);
+            break;
+        }
+
+        // the target's format, so the graph's render passes are compatible with the effects' pipelines
+        const vk::Extent2D extent{std::max(1u, resolution.width / divisors[i]),
+                                  std::max(1u, resolution.height / divisors[i])};
+        input = graph.createImage("post process " + std::to_string(i), {_frameGraphTargetFormat, extent});
+        graph.write(pass, input, RenderGraph::eColorAttachment);
+        outputs.push_back(input);
+    }
+
+    graph.compile();
+
+    if (!_postProcessSampler)
+    {
+        vk::SamplerCreateInfo samplerInfo{};
+        samplerInfo.magFilter = vk::Filter::eLinear;
+        samplerInfo.minFilter = vk::Filter::eLinear;
+        samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+        samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+        samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+        samplerInfo.borderColor = vk::BorderColor::eIntOpaqueBlack;
+
+        _postProcessSampler = _renderSystem->getDevice()->device().createSampler(samplerInfo);
+    }
+
+    for (size_t postProcessInput : _postProcessInputs)
+    {
+        _renderSystem->freeSamplerDescriptor(postProcessInput);
+    }
+    _postProcessInputs.clear();
+
+    _postProcessDraws[0].input = gBuffer->getSamplerDescriptorSetIDs()[0];
+    for (size_t i = 0; i < outputs.size(); i++)
+    {
+        _postProcessInputs.push_back(
+            _renderSystem->createSamplerDescriptor(graph.getImageView(outputs[i]), _postProcessSampler));
+        _postProcessDraws[i + 1].input = _postProcessInputs.back();
+    }
+}
+
+float GraphicsManager::lap()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const float elapsed = std::chrono::duration<float, std::milli>{now - _passStart}.count();
+    _passStart = now;
+    return elapsed;
+}
+
+void GraphicsManager::recordShadows(FrameInfo &frameInfo)
+{
+    GpuProfiler *profiler = _renderSystem->getProfiler();
+
+    const uint32_t scope = profiler->beginScope(frameInfo.commandBuffer, "shadows", true);
+    _frameLightEnvironment->drawShadowMaps(&frameInfo, _frameCamera, _renderQueue.getEntries(), _renderBounds,
+                                           _cullingStats, _shadowMapDescriptorSetIDs);
+    profiler->endScope(frameInfo.commandBuffer, scope);
+
+    _passTimings.shadows = lap();
+}
 
-    if (Camera *camera = cameraWk.lock().get())
+void GraphicsManager::recordGeometry(FrameInfo &frameInfo)
+{
+    GpuProfiler *profiler = _renderSystem->getProfiler();
+    const uint32_t scope = profiler->beginScope(frameInfo.commandBuffer, "geometry", true);
+
+    if (Camera *camera = _frameCamera)
     {
         _noCameraFlag = false;
 
-        frameInfo->camera = camera;
-        _renderSystem->checkAspectRatio(camera);
+        frameInfo.camera = camera;
 
         GlobalUbo ubo{};
         ubo.projection = camera->getProjection();
         ubo.view = camera->getView();
         ubo.cameraPos = glm::vec4(camera->getPosition(), 1.0f);
 
-        if (graphicsManager)
+        _frameLightEnvironment->populateUbo(&ubo);
+        _frameLightEnvironment->clusterPointLights(*camera, uint32_t(frameInfo.frameIndex), &ubo,
+                                                   _renderSystem->getClusterBuffer(&frameInfo));
+        _renderSystem->writeUbo(&frameInfo, &ubo);
+
+        _visibleIndices.clear();
+        const Frustum frustum{ubo.projection * ubo.view};
+        _cullingStats.culled = uint32_t(cullSpheres(frustum, _renderBounds, _visibleIndices));
+        _cullingStats.visible = uint32_t(_visibleIndices.size());
+
+        _renderQueue.sort(_visibleIndices, _renderBounds, ubo.view, camera->getFarPlane());
+
+        _renderSystem->beginRender(&frameInfo, _frameLightEnvironment);
+
+        for (RecordingScratch &scratch : _recordingScratch)
         {
-            graphicsManager->populateUbo(&ubo);
+            scratch.bindStats = BindStats{};
         }
-        _renderSystem->writeUbo(frameInfo, &ubo);
 
-        _renderSystem->beginRender(frameInfo, graphicsManager);
+        GBuffer *gBuffer = _renderSystem->getGBuffer();
+        _renderSystem->recordParallel(&frameInfo, RenderSystem::eGeometryPass, gBuffer->getRenderPass(),
+                                      gBuffer->getResolution(), _renderQueue.getSortedIndices().size(),
+                                      [this](FrameInfo &slotFrameInfo, size_t slot, size_t begin, size_t end) {
+                                          recordSorted(&slotFrameInfo, _recordingScratch[slot], begin, end);
+                                      });
 
-        Material::resetBoundID();
-        for (auto &[materialID, drawableQueue] : _drawableRenderQueue)
+        _bindStats = BindStats{};
+        for (const RecordingScratch &scratch : _recordingScratch)
         {
-            Texture::resetBoundID();
-            for (auto &[drawable, drawOption] : drawableQueue)
-            {
-                if (drawable->isVisible())
-                {
-                    drawable->render(*frameInfo, drawOption);
-                }
-            }
+            _bindStats += scratch.bindStats;
         }
     }
     else
@@ -168,39 +370,225 @@ void GraphicsManager::drawRenderQueue(std::weak_ptr<Camera> cameraWk, LightEnvir
         }
     }
 
-    _renderSystem->endRender(frameInfo);
+    _renderSystem->endRender(&frameInfo);
+    profiler->endScope(frameInfo.commandBuffer, scope);
 
-    _renderSystem->beginPostProcess(frameInfo);
+    _passTimings.geometry = lap();
+}
 
-    for (Material *material : _postProcessMaterials)
+void GraphicsManager::recordPostProcess(FrameInfo &frameInfo, size_t draw)
+{
+    GpuProfiler *profiler = _renderSystem->getProfiler();
+    const PostProcessDraw &postProcessDraw = _postProcessDraws[draw];
+    const bool last = draw + 1 == _postProcessDraws.size();
+
+    // statistics would have to end inside the pass they started outside of
+    if (draw == 0)
+    {
+        _postProcessScope = profiler->beginScope(frameInfo.commandBuffer, "post process");
+    }
+    if (last)
+    {
+        // left open for the editor's interface, endPostProcess closes it
+        _renderSystem->beginPostProcess(&frameInfo);
+    }
+
+    // whatever this thread last bound was in a secondary command buffer
+    Material::resetBoundID();
+
+    const int fusionSource = postProcessDraw.fused ? postProcessDraw.fused->getFusionSource() : POST_PROCESS_UNFUSED;
+    postProcessDraw.material->setPostProcessInput(postProcessDraw.input, fusionSource);
+
+    const uint32_t scope = profiler->beginScope(frameInfo.commandBuffer, postProcessDraw.name);
+    postProcessDraw.material->bind(&frameInfo, nullptr);
+    frameInfo.commandBuffer.draw(6, 1, 0, 0);
+    profiler->endScope(frameInfo.commandBuffer, scope);
+
+    if (last)
+    {
+        _passTimings.postProcess = lap();
+        profiler->endScope(frameInfo.commandBuffer, _postProcessScope);
+    }
+}
+
+void GraphicsManager::gatherBounds()
+{
+    _renderBounds.clear();
+
+    for (auto &[drawable, drawOption] : _renderQueue.getEntries())
+    {
+        _renderBounds.push(drawable->getWorldBoundingSphere(drawOption));
+    }
+}
+
+void GraphicsManager::recordSorted(FrameInfo *frameInfo, RecordingScratch &scratch, size_t begin, size_t end)
+{
+    const std::vector<std::pair<Drawable *, DrawOption *>> &entries = _renderQueue.getEntries();
+    const std::vector<uint32_t> &indices = _renderQueue.getSortedIndices();
+    const std::vector<uint64_t> &keys = _renderQueue.getSortedKeys();
+
+    // a secondary starts with nothing bound
+    scratch.bindState = BindState{};
+
+    // ranks saturate on huge scenes, so runs are checked against the actual state as well
+    auto sameState = [](const DrawOption *a, const DrawOption *b) {
+        return a->material == b->material && a->model == b->model && a->textures == b->textures;
+    };
+
+    while (begin < end)
+    {
+        const DrawOption *first = entries[indices[begin]].second;
+
+        size_t runEnd = begin + 1;
+        while (runEnd < end && RenderQueue::stateOf(keys[runEnd]) == RenderQueue::stateOf(keys[begin]) &&
+               sameState(first, entries[indices[runEnd]].second))
+        {
+            runEnd++;
+        }
+
+        if (runEnd - begin > 1 && first->material->supportsInstancing() && first->material->needsModel() &&
+            drawInstances(frameInfo, scratch, begin, runEnd))
+        {
+            begin = runEnd;
+            continue;
+        }
+
+        for (size_t i = begin; i < runEnd; i++)
+        {
+            drawEntry(frameInfo, scratch, entries[indices[i]].first, entries[indices[i]].second);
+        }
+        begin = runEnd;
+    }
+}
+
+void GraphicsManager::bindDrawState(FrameInfo *frameInfo, RecordingScratch &scratch, const DrawOption *drawOption)
+{
+    BindState &state = scratch.bindState;
+
+    if (state.textures == nullptr || *state.textures != drawOption->textures)
+    {
+        Texture::resetBoundID();
+        Drawable::bindTextures(*frameInfo, drawOption);
+
+        state.textures = &drawOption->textures;
+        // bindless materials only push indices
+        const bool bindsSets = !drawOption->material->usesBindlessTextures() && !drawOption->textures.empty();
+        scratch.bindStats.descriptorSets += bindsSets ? 1 : 0;
+    }
+
+    if (drawOption->material->needsModel() && state.model != drawOption->model)
+    {
+        drawOption->model->bind(frameInfo->commandBuffer);
+
+        state.model = drawOption->model;
+        scratch.bindStats.vertexBuffers++;
+    }
+}
+
+void GraphicsManager::drawEntry(FrameInfo *frameInfo, RecordingScratch &scratch, const Drawable *drawable,
+                                DrawOption *drawOption)
+{
+    BindState &state = scratch.bindState;
+
+    if (state.material != drawOption->material)
+    {
+        // clones share their original's id but have pipelines of their own
+        Material::resetBoundID();
+
+        state.material = drawOption->material;
+        // another pipeline layout may disturb the texture set
+        state.textures = nullptr;
+        scratch.bindStats.pipelines++;
+    }
+    drawOption->material->bind(frameInfo, drawable);
+
+    bindDrawState(frameInfo, scratch, drawOption);
+
+    if (drawOption->material->needsModel())
+    {
+        drawOption->model->draw(frameInfo->commandBuffer);
+    }
+    else
     {
-        material->bind(frameInfo, nullptr);
         frameInfo->commandBuffer.draw(6, 1, 0, 0);
     }
-    _renderSystem->endPostProcess(frameInfo);
+    scratch.bindStats.draws++;
 }
 
-void GraphicsManager::editor(AssetsManager *assetsManager)
+bool GraphicsManager::drawInstances(FrameInfo *frameInfo, RecordingScratch &scratch, size_t begin, size_t end)
 {
-    auto it = _postProcessMaterials.begin();
+    const std::vector<std::pair<Drawable *, DrawOption *>> &entries = _renderQueue.getEntries();
+    const std::vector<uint32_t> &indices = _renderQueue.getSortedIndices();
+    const uint32_t instanceCount = uint32_t(end - begin);
+
+    // a frame out of instance space goes through the regular path
+    uint32_t firstInstance{0};
+    Model::Instance *instances = _renderSystem->allocateInstances(instanceCount, firstInstance);
+    if (instances == nullptr)
+    {
+        return false;
+    }
+
+    for (size_t i = begin; i < end; i++)
+    {
+        Transform transform = entries[indices[i]].first->getWorldSpaceTransform();
+
+        instances->modelMatrix = transform.mat4();
+        instances->normalMatrix = transform.normalMatrix();
+        instances++;
+    }
+
+    DrawOption *drawOption = entries[indices[begin]].second;
+
+    drawOption->material->bindInstanced(frameInfo);
+    // the regular pipeline has to be bound again on the next draw
+    scratch.bindState.material = nullptr;
+    scratch.bindState.textures = nullptr;
+    scratch.bindStats.pipelines++;
+
+    bindDrawState(frameInfo, scratch, drawOption);
+
+    _renderSystem->bindInstanceBuffer(frameInfo);
+    drawOption->model->draw(frameInfo->commandBuffer, instanceCount, firstInstance);
+    scratch.bindStats.instancedDraws++;
+
+    return true;
+}
+
+bool GraphicsManager::editor(AssetsManager *assetsManager)
+{
+    static const char *resolutions[] = {"full", "half", "quarter"};
+
+    bool edited{false};
+
+    auto it = _postProcesses.begin();
     int i = 0;
 
-    while (it != _postProcessMaterials.end())
+    while (it != _postProcesses.end())
     {
         ImGui::PushID(i++);
-        Material *material = *it;
+        Material *material = it->material;
         if (material)
         {
             ImGui::Text("%s", material->name.c_str());
-            if (i > 0)
+            // an empty chain falls back to a pass-through draw, the last effect can go too
+            ImGui::SameLine();
+            if (ImGui::Button(ICON_MS_DELETE))
             {
-                ImGui::SameLine();
-                if (ImGui::Button(ICON_MS_DELETE))
-                {
-                    _postProcessMaterials.erase(it);
-                    ImGui::PopID();
-                    continue;
-                }
+                it = _postProcesses.erase(it);
+                _frameGraphDirty = true;
+                edited = true;
+                ImGui::PopID();
+                continue;
+            }
+
+            int resolution = it->divisor == 4 ? 2 : int(it->divisor) - 1;
+            ImGui::SetNextItemWidth(170);
+            if (ImGui::Combo("Resolution", &resolution, resolutions, IM_ARRAYSIZE(resolutions)))
+            {
+                it->divisor = 1u << resolution;
+                _frameGraphDirty = true;
+                edited = true;
             }
             material->editor();
         }
@@ -242,23 +630,71 @@ void GraphicsManager::editor(AssetsManager *assetsManager)
     {
         Material *material = assetsManager->getPostProcess(selected);
         addPostProcess(material);
+        edited = true;
     }
+
+    if (ImGui::Checkbox("Fuse compatible effects", &_fusePostProcesses))
+    {
+        _frameGraphDirty = true;
+        edited = true;
+    }
+    ImGui::Text("draws: %zu for %zu effects", _postProcessDraws.size(), _postProcesses.size());
+
+    ImGui::SeparatorText("Culling");
+    ImGui::Text("drawn: %u, culled: %u", _cullingStats.visible, _cullingStats.culled);
+    ImGui::Text("shadow casters drawn: %u, culled: %u, cached: %u", _cullingStats.shadowVisible,
+                _cullingStats.shadowCulled, _cullingStats.shadowCached);
+
+    ImGui::SeparatorText("Binds");
+    ImGui::Text("pipelines: %u, texture sets: %u, vertex buffers: %u", _bindStats.pipelines,
+                _bindStats.descriptorSets, _bindStats.vertexBuffers);
+    ImGui::Text("draws: %u, instanced draws: %u", _bindStats.draws, _bindStats.instancedDraws);
+
+    ImGui::SeparatorText("GPU");
+    _renderSystem->getProfiler()->editor();
+
+    if (_frameGraph)
+    {
+        ImGui::SeparatorText("Frame graph");
+        ImGui::Text("transient memory: %.1f MB (%.1f MB without aliasing)",
+                    _frameGraph->getTransientMemory() / (1024.f * 1024.f),
+                    _frameGraph->getUnaliasedMemory() / (1024.f * 1024.f));
+    }
+
+    const MemoryStats memoryStats = _renderSystem->getDevice()->getAllocator().getStats();
+    ImGui::SeparatorText("Memory");
+    ImGui::Text("blocks: %u, allocations: %u (%u dedicated)", memoryStats.blocks, memoryStats.allocations,
+                memoryStats.dedicatedAllocations);
+    ImGui::Text("used: %.1f / %.1f MB, fragmentation: %.0f%%", memoryStats.used / (1024.f * 1024.f),
+                memoryStats.reserved / (1024.f * 1024.f), memoryStats.fragmentation() * 100.f);
+    if (ImGui::Button("Log memory report"))
+    {
+        _renderSystem->getDevice()->getAllocator().logReport();
+    }
+
+    return edited;
 }
 
 tinyxml2::XMLElement &GraphicsManager::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const
 {
     tinyxml2::XMLElement *graphicsManagerElement = doc.NewElement("graphicsManager");
 
+    graphicsManagerElement->SetAttribute("fusePostProcesses", _fusePostProcesses);
+
     int i = -1;
-    for (Material *material : _postProcessMaterials)
+    for (const PostProcessStage &postProcess : _postProcesses)
     {
         i++;
+        if (postProcess.divisor != 1)
+        {
+            graphicsManagerElement->SetAttribute(("pp" + std::to_string(i) + "Divisor").c_str(), postProcess.divisor);
+        }
         if (i == 0)
         {
             continue;
         }
 
-        graphicsManagerElement->SetAttribute(("pp" + std::to_string(i)).c_str(), material->name.c_str());
+        graphicsManagerElement->SetAttribute(("pp" + std::to_string(i)).c_str(), postProcess.material->name.c_str());
     }
 
     parentElement->InsertEndChild(graphicsManagerElement);
@@ -270,6 +706,8 @@ void GraphicsManager::load(tinyxml2::XMLElement *parentElement, AssetsManager *a
 {
     if (tinyxml2::XMLElement *graphicsManagerElement = parentElement->FirstChildElement("graphicsManager"))
     {
+        _fusePostProcesses = graphicsManagerElement->BoolAttribute("fusePostProcesses", true);
+
         int i = 0;
         while (true)
         {
@@ -286,7 +724,58 @@ void GraphicsManager::load(tinyxml2::XMLElement *parentElement, AssetsManager *a
                 break;
             }
         }
+
+        // only full, half and quarter resolution are offered
+        for (size_t j = 0; j < _postProcesses.size(); j++)
+        {
+            const std::string attributeName = "pp" + std::to_string(j) + "Divisor";
+            const uint32_t divisor = graphicsManagerElement->UnsignedAttribute(attributeName.c_str(), 1);
+            _postProcesses[j].divisor = divisor >= 4 ? 4 : divisor >= 2 ? 2 : 1;
+        }
+        _frameGraphDirty = true;
+    }
+}
+
+void GraphicsManager::writeRecord(RecordWriter &writer) const
+{
+    writer.write(GraphicsManagerRecord{_fusePostProcesses, uint32_t(_postProcesses.size())});
+
+    for (size_t i = 0; i < _postProcesses.size(); i++)
+    {
+        const PostProcessStage &postProcess = _postProcesses[i];
+        writer.write(PostProcessRecord{i == 0 ? NO_RECORD_STRING : writer.addString(postProcess.material->name),
+                                       postProcess.divisor});
+    }
+}
+
+void GraphicsManager::readRecord(RecordReader &reader, AssetsManager *assetsManager)
+{
+    const GraphicsManagerRecord *record = reader.read<GraphicsManagerRecord>();
+    const PostProcessRecord *stages = record ? reader.read<PostProcessRecord>(record->postProcessCount) : nullptr;
+    if (stages == nullptr)
+    {
+        return;
+    }
+
+    _fusePostProcesses = record->fusePostProcesses != 0;
+
+    for (uint32_t i = 0; i < record->postProcessCount; i++)
+    {
+        if (i > 0)
+        {
+            Material *material = assetsManager->getPostProcess(reader.getString(stages[i].material));
+            if (material == nullptr)
+            {
+                continue;
+            }
+            addPostProcess(material);
+        }
+
+        // only full, half and quarter resolution are offered
+        const uint32_t divisor = stages[i].divisor;
+        _postProcesses.back().divisor = divisor >= 4 ? 4 : divisor >= 2 ? 2 : 1;
     }
+    _frameGraphDirty = true;
 }
 
 void GraphicsManager::addPostProcess(Material *material)
@@ -296,7 +785,8 @@ void GraphicsManager::addPostProcess(Material *material)
         return;
     }
 
-    _postProcessMaterials.push_back(material);
+    _postProcesses.push_back({material});
+    _frameGraphDirty = true;
 }
 
 const std::vector<size_t> &GraphicsManager::getDescriptorSetIDs()
@@ -2,43 +2,157 @@
 #define CMX_GRAPHICS_MANAGER
 
 // cmx
+#include "cmx_culling.h"
 #include "cmx_light_environment.h"
+#include "cmx_render_queue.h"
 
 // std
-#include <map>
+#include <chrono>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace cmx
 {
 
+// CPU milliseconds spent on each part of the last frame
+struct PassTimings
+{
+    float shadows{0.f};
+    float geometry{0.f};
+    float postProcess{0.f};
+    // submission, and since the frame is waited on, the GPU's share of it
+    float submit{0.f};
+};
+
+// an effect of the post process chain, drawn at the G-buffer's resolution divided by divisor
+struct PostProcessStage
+{
+    class Material *material;
+    uint32_t divisor{1};
+};
+
 class GraphicsManager
 {
   public:
     GraphicsManager();
+    ~GraphicsManager();
 
     void free();
     void add(class Drawable *, struct DrawOption *);
     void remove(const class Drawable *);
     void remove(const struct DrawOption *);
-    void update(class Drawable *, struct DrawOption *, size_t oldID);
+    void update(class Drawable *, struct DrawOption *);
 
     void drawRenderQueue(std::weak_ptr<class Camera>, class LightEnvironment *);
     static const std::vector<size_t> &getDescriptorSetIDs();
 
-    void editor(class AssetsManager *assetsManager);
+    const CullingStats &getCullingStats() const
+    {
+        return _cullingStats;
+    }
+
+    const BindStats &getBindStats() const
+    {
+        return _bindStats;
+    }
+
+    const PassTimings &getPassTimings() const
+    {
+        return _passTimings;
+    }
+
+    // true when the post process chain was edited, the effects' own settings are saved with their materials
+    bool editor(class AssetsManager *assetsManager);
     tinyxml2::XMLElement &save(tinyxml2::XMLDocument &, tinyxml2::XMLElement *) const;
     void load(tinyxml2::XMLElement *, class AssetsManager *assetsManager);
+    void writeRecord(class RecordWriter &) const;
+    void readRecord(class RecordReader &, class AssetsManager *assetsManager);
 
   private:
     void addPostProcess(class Material *material);
 
-    std::map<uint8_t, std::vector<std::pair<class Drawable *, struct DrawOption *>>> _drawableRenderQueue;
+    // world bounds of every registered draw, shared by every pass
+    void gatherBounds();
+
+    // declares the frame's passes and the images they share, built again when those images are recreated
+    void buildFrameGraph(class LightEnvironment *);
+    void recordShadows(struct FrameInfo &);
+    void recordGeometry(struct FrameInfo &);
+    // every draw but the last renders into its own transient, which the next one samples, the last draws into the
+    // target and leaves its render pass open
+    void recordPostProcess(struct FrameInfo &, size_t draw);
+    // CPU milliseconds since the previous call
+    float lap();
+
+    // what a recording last bound, so sorted draws only bind what changed
+    struct BindState
+    {
+        const class Material *material{nullptr};
+        const std::vector<class Texture *> *textures{nullptr};
+        const class Model *model{nullptr};
+    };
+
+    // per recording slot, so parallel recordings never share state
+    struct RecordingScratch
+    {
+        BindState bindState{};
+        BindStats bindStats{};
+    };
+
+    // records the sorted draws [begin, end), runs sharing every state become instanced draws
+    void recordSorted(struct FrameInfo *, RecordingScratch &, size_t begin, size_t end);
+    void bindDrawState(struct FrameInfo *, RecordingScratch &, const struct DrawOption *);
+    void drawEntry(struct FrameInfo *, RecordingScratch &, const class Drawable *, struct DrawOption *);
+    // false when the frame is out of instance space
+    bool drawInstances(struct FrameInfo *, RecordingScratch &, size_t begin, size_t end);
+
+    RenderQueue _renderQueue;
+
+    CullingBounds _renderBounds;
+    std::vector<uint32_t> _visibleIndices;
+    std::vector<RecordingScratch> _recordingScratch;
+    CullingStats _cullingStats{};
+    BindStats _bindStats{};
+    PassTimings _passTimings{};
+    std::chrono::steady_clock::time_point _passStart{};
+
+    // a draw of the post process chain, an effect fused into the next one has none of its own
+    struct PostProcessDraw
+    {
+        std::string name;
+        class Material *material;
+        // computes its input itself from this one's fusion source, nullptr if unfused
+        class Material *fused{nullptr};
+        // sampler set of the previous draw's output, or of the G-buffer's color
+        size_t input{0};
+    };
+
+    std::unique_ptr<class RenderGraph> _frameGraph;
+    // what the graph imported, it's stale once they change
+    vk::Image _frameGraphColor{};
+    vk::Image _frameGraphShadowMap{};
+    vk::Format _frameGraphTargetFormat{vk::Format::eUndefined};
+    // set when the post process chain changes
+    bool _frameGraphDirty{false};
+
+    std::vector<PostProcessDraw> _postProcessDraws;
+    // sampler sets of the chain's transients, made again with every compile
+    std::vector<size_t> _postProcessInputs;
+    vk::Sampler _postProcessSampler{};
+    // copies a reduced resolution chain's output to the target
+    class Material *_upsampleMaterial{nullptr};
+    uint32_t _postProcessScope{0};
+    // this frame's, for the graph's passes
+    class Camera *_frameCamera{nullptr};
+    class LightEnvironment *_frameLightEnvironment{nullptr};
 
     // warning flags
     bool _noCameraFlag{false};
     class RenderSystem *_renderSystem;
-    std::vector<Material *> _postProcessMaterials;
+    std::vector<PostProcessStage> _postProcesses;
+    // consecutive effects at the same resolution share a draw when the first is a function of the G-buffer
+    bool _fusePostProcesses{true};
 
     static std::vector<size_t> _shadowMapDescriptorSetIDs;
 };
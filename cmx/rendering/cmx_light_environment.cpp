@@ -3,19 +3,28 @@
 // cmx
 #include "cmx_buffer.h"
 #include "cmx_camera.h"
+#include "cmx_culling.h"
 #include "cmx_drawable.h"
 #include "cmx_frame_info.h"
+#include "cmx_gpu_profiler.h"
+#include "cmx_job_system.h"
 #include "cmx_render_system.h"
 #include "cmx_renderer.h"
+#include "cmx_scene_records.h"
+#include "cmx_swap_chain.h"
 #include "cmx_texture.h"
 #include "cmx_void_material.h"
 
 // lib
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <glm/gtc/constants.hpp>
+#include <glm/matrix.hpp>
 #include <glm/trigonometric.hpp>
 #include <imgui.h>
 #include <imgui_gradient/imgui_gradient.hpp>
+#include <limits>
 #include <memory>
 #include <spdlog/spdlog.h>
 #include <vulkan/vulkan_core.h>
@@ -31,7 +40,7 @@ ImGG::GradientWidget atmosphereWidget;
 DirectionalLight::DirectionalLight()
 {
     _cameraView = std::make_unique<Camera>();
-    _imageResolution = vk::Extent2D{4096, 4096};
+    _imageResolution = vk::Extent2D{2048, 2048};
 }
 
 DirectionalLight::DirectionalLight(const glm::vec4 &direction_, const glm::vec4 &color_, const float &intensity_)
@@ -45,10 +54,10 @@ const class Camera *DirectionalLight::getCameraView() const
     return _cameraView.get();
 }
 
-void DirectionalLight::initializeShadowMap(class Device *device, uint32_t width, uint32_t height)
+void DirectionalLight::initializeShadowMap(class Device *device, uint32_t resolution)
 {
-    _imageResolution.width = width;
-    _imageResolution.height = height;
+    _imageResolution.width = resolution;
+    _imageResolution.height = resolution;
 
     createImage(device);
     createImageView(device);
@@ -57,6 +66,7 @@ void DirectionalLight::initializeShadowMap(class Device *device, uint32_t width,
     createSampler(device);
     createShadowUbo(device);
     createDescriptorSet(device);
+    clearLayers(device);
 
     _voidMaterial = new VoidMaterial();
     _voidMaterial->initialize(_renderPass, _shadowDescriptorSetLayout->getDescriptorSetLayout());
@@ -70,32 +80,60 @@ void DirectionalLight::createImage(class Device *device)
     imageInfo.imageType = vk::ImageType::e2D;
     imageInfo.extent = vk::Extent3D{_imageResolution.width, _imageResolution.height, 1u};
     imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = 1;
+    imageInfo.arrayLayers = MAX_SHADOW_CASCADES;
     imageInfo.samples = vk::SampleCountFlagBits::e1;
     imageInfo.format = vk::Format::eD32Sfloat;
     imageInfo.tiling = vk::ImageTiling::eOptimal;
     imageInfo.initialLayout = vk::ImageLayout::eUndefined;
-    imageInfo.usage = vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled;
+    imageInfo.usage = vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled |
+                      vk::ImageUsageFlagBits::eTransferDst;
 
     device->createImageWithInfo(imageInfo, {vk::MemoryPropertyFlagBits::eDeviceLocal}, _image, _imageMemory);
+
+    imageInfo.usage = vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eTransferSrc;
+
+    device->createImageWithInfo(imageInfo, {vk::MemoryPropertyFlagBits::eDeviceLocal}, _staticImage,
+                                _staticImageMemory);
 }
 
 void DirectionalLight::createImageView(class Device *device)
 {
     vk::ImageViewCreateInfo viewInfo{};
     viewInfo.image = _image; // The depth texture image
-    viewInfo.viewType = vk::ImageViewType::e2D;
+    viewInfo.viewType = vk::ImageViewType::e2DArray;
     viewInfo.format = vk::Format::eD32Sfloat;
     viewInfo.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eDepth;
     viewInfo.subresourceRange.baseMipLevel = 0;
     viewInfo.subresourceRange.levelCount = 1;
     viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
+    viewInfo.subresourceRange.layerCount = MAX_SHADOW_CASCADES;
 
     if (device->device().createImageView(&viewInfo, nullptr, &_imageView) != vk::Result::eSuccess)
     {
         throw std::runtime_error("failed to create texture image view!");
     }
+
+    // cascades are drawn one layer at a time
+    viewInfo.viewType = vk::ImageViewType::e2D;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    for (uint32_t i = 0; i < MAX_SHADOW_CASCADES; i++)
+    {
+        viewInfo.subresourceRange.baseArrayLayer = i;
+
+        viewInfo.image = _image;
+        if (device->device().createImageView(&viewInfo, nullptr, &_cascades[i].imageView) != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("failed to create texture image view!");
+        }
+
+        viewInfo.image = _staticImage;
+        if (device->device().createImageView(&viewInfo, nullptr, &_cascades[i].staticImageView) !=
+            vk::Result::eSuccess)
+        {
+            throw std::runtime_error("failed to create texture image view!");
+        }
+    }
 }
 
 void DirectionalLight::createRenderPass(class Device *device)
@@ -108,7 +146,7 @@ void DirectionalLight::createRenderPass(class Device *device)
     depthAttachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
     depthAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
     depthAttachment.initialLayout = vk::ImageLayout::eUndefined;
-    depthAttachment.finalLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    depthAttachment.finalLayout = vk::ImageLayout::eTransferSrcOptimal;
 
     vk::AttachmentReference depthAttachmentRef{};
     depthAttachmentRef.attachment = 0;
@@ -124,6 +162,16 @@ void DirectionalLight::createRenderPass(class Device *device)
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
 
+    if (device->device().createRenderPass(&renderPassInfo, nullptr, &_staticRenderPass) != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("failed to create depth render pass");
+    }
+
+    // compatible with the static pass, it keeps the copied static layer and leaves the map ready to be sampled
+    depthAttachment.loadOp = vk::AttachmentLoadOp::eLoad;
+    depthAttachment.initialLayout = vk::ImageLayout::eTransferDstOptimal;
+    depthAttachment.finalLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
     if (device->device().createRenderPass(&renderPassInfo, nullptr, &_renderPass) != vk::Result::eSuccess)
     {
         throw std::runtime_error("failed to create depth render pass");
@@ -133,16 +181,30 @@ void DirectionalLight::createRenderPass(class Device *device)
 void DirectionalLight::createFrameBuffer(class Device *device)
 {
     vk::FramebufferCreateInfo framebufferInfo{};
-    framebufferInfo.renderPass = _renderPass;
     framebufferInfo.attachmentCount = 1;
-    framebufferInfo.pAttachments = &_imageView;
     framebufferInfo.width = _imageResolution.width;
     framebufferInfo.height = _imageResolution.height;
     framebufferInfo.layers = 1;
 
-    if (device->device().createFramebuffer(&framebufferInfo, nullptr, &_framebuffer) != vk::Result::eSuccess)
+    for (Cascade &cascade : _cascades)
     {
-        throw std::runtime_error("failed to create frame buffer");
+        framebufferInfo.renderPass = _renderPass;
+        framebufferInfo.pAttachments = &cascade.imageView;
+
+        if (device->device().createFramebuffer(&framebufferInfo, nullptr, &cascade.framebuffer) !=
+            vk::Result::eSuccess)
+        {
+            throw std::runtime_error("failed to create frame buffer");
+        }
+
+        framebufferInfo.renderPass = _staticRenderPass;
+        framebufferInfo.pAttachments = &cascade.staticImageView;
+
+        if (device->device().createFramebuffer(&framebufferInfo, nullptr, &cascade.staticFramebuffer) !=
+            vk::Result::eSuccess)
+        {
+            throw std::runtime_error("failed to create frame buffer");
+        }
     }
 }
 
@@ -165,39 +227,106 @@ void DirectionalLight::createSampler(class Device *device)
 
 void DirectionalLight::createShadowUbo(class Device *device)
 {
-    _shadowUboBuffer = new Buffer(*device, sizeof(ShadowUbo), 1, vk::BufferUsageFlagBits::eUniformBuffer,
-                                  vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    _shadowUboBuffer = new Buffer(*device, sizeof(ShadowUbo), SwapChain::MAX_FRAMES_IN_FLIGHT * MAX_SHADOW_CASCADES,
+                                  vk::BufferUsageFlagBits::eUniformBuffer,
+                                  vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                  device->_properties.limits.minUniformBufferOffsetAlignment);
 
     _shadowUboBuffer->map();
 }
 
 void DirectionalLight::createDescriptorSet(class Device *device)
 {
-    _shadowDescriptorPool =
-        DescriptorPool::Builder(*device).setMaxSets(1).addPoolSize(vk::DescriptorType::eUniformBuffer, 1).build();
+    const uint32_t setCount = SwapChain::MAX_FRAMES_IN_FLIGHT * MAX_SHADOW_CASCADES;
+
+    _shadowDescriptorPool = DescriptorPool::Builder(*device)
+                                .setMaxSets(setCount)
+                                .addPoolSize(vk::DescriptorType::eUniformBuffer, setCount)
+                                .build();
 
     _shadowDescriptorSetLayout =
         DescriptorSetLayout::Builder(*device)
             .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eAllGraphics)
             .build();
 
-    auto bufferInfo = _shadowUboBuffer->descriptorInfo();
-    if (!DescriptorWriter(*_shadowDescriptorSetLayout.get(), *_shadowDescriptorPool.get())
-             .writeBuffer(0, &bufferInfo)
-             .build(_shadowDescriptorSet))
+    for (uint32_t i = 0; i < MAX_SHADOW_CASCADES; i++)
     {
-        throw std::runtime_error("DirectionalLight: Failed to create _shadowDescriptorSet!");
+        _cascades[i].descriptorSets.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+
+        for (uint32_t frame = 0; frame < SwapChain::MAX_FRAMES_IN_FLIGHT; frame++)
+        {
+            auto bufferInfo = _shadowUboBuffer->descriptorInfoForIndex(frame * MAX_SHADOW_CASCADES + i);
+            if (!DescriptorWriter(*_shadowDescriptorSetLayout.get(), *_shadowDescriptorPool.get())
+                     .writeBuffer(0, &bufferInfo)
+                     .build(_cascades[i].descriptorSets[frame]))
+            {
+                throw std::runtime_error("DirectionalLight: Failed to create shadow descriptor set!");
+            }
+        }
     }
 }
 
+void DirectionalLight::clearLayers(class Device *device)
+{
+    vk::CommandBuffer commandBuffer = device->beginSingleTimeCommands();
+
+    vk::ImageMemoryBarrier barriers[2]{};
+    for (vk::ImageMemoryBarrier &barrier : barriers)
+    {
+        barrier.oldLayout = vk::ImageLayout::eUndefined;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange = vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eDepth, 0, 1, 0,
+                                                             MAX_SHADOW_CASCADES};
+        barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+    }
+    barriers[0].image = _image;
+    barriers[0].newLayout = vk::ImageLayout::eTransferDstOptimal;
+    barriers[1].image = _staticImage;
+    barriers[1].newLayout = vk::ImageLayout::eTransferDstOptimal;
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, 0,
+                                  nullptr, 0, nullptr, 2, barriers);
+
+    vk::ClearDepthStencilValue clearDepth{1.f, 0};
+    vk::ImageSubresourceRange range{vk::ImageAspectFlagBits::eDepth, 0, 1, 0, MAX_SHADOW_CASCADES};
+    commandBuffer.clearDepthStencilImage(_image, vk::ImageLayout::eTransferDstOptimal, &clearDepth, 1, &range);
+    commandBuffer.clearDepthStencilImage(_staticImage, vk::ImageLayout::eTransferDstOptimal, &clearDepth, 1, &range);
+
+    // the layouts every frame expects to find them in
+    for (vk::ImageMemoryBarrier &barrier : barriers)
+    {
+        barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead;
+    }
+    barriers[0].newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    barriers[1].newLayout = vk::ImageLayout::eTransferSrcOptimal;
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eTransfer,
+                                  {}, 0, nullptr, 0, nullptr, 2, barriers);
+
+    device->endSingleTimeCommands(commandBuffer);
+}
+
 void DirectionalLight::freeShadowMap(class Device *device)
 {
-    device->device().destroyFramebuffer(_framebuffer);
+    for (Cascade &cascade : _cascades)
+    {
+        device->device().destroyFramebuffer(cascade.framebuffer);
+        device->device().destroyFramebuffer(cascade.staticFramebuffer);
+        device->device().destroyImageView(cascade.imageView);
+        device->device().destroyImageView(cascade.staticImageView);
+    }
     device->device().destroyRenderPass(_renderPass);
+    device->device().destroyRenderPass(_staticRenderPass);
     device->device().destroySampler(_sampler);
     device->device().destroyImageView(_imageView);
     device->device().destroyImage(_image);
-    device->device().freeMemory(_imageMemory);
+    device->device().destroyImage(_staticImage);
+    device->freeMemory(_imageMemory);
+    device->freeMemory(_staticImageMemory);
 
     _shadowUboBuffer->free();
     delete _shadowUboBuffer;
@@ -208,59 +337,187 @@ void DirectionalLight::freeShadowMap(class Device *device)
     _shadowDescriptorPool->free();
 }
 
-Material *DirectionalLight::beginRender(FrameInfo *frameInfo) const
+void DirectionalLight::fitCascades(Camera &camera, uint32_t frameIndex)
 {
-    _cameraView->setOrthographicProjection(-_boundingDimension, _boundingDimension, _boundingDimension,
-                                           -_boundingDimension, _boundingDimension, -_boundingDimension);
     _cameraView->setViewDirection(glm::vec3{0.f}, direction);
+    const glm::mat4 lightView = _cameraView->getView();
+
+    const float nearPlane = camera.getNearPlane();
+    const float farPlane = camera.getFarPlane();
+    const float shadowFar = std::clamp(_shadowDistance, nearPlane + 1e-3f, farPlane);
 
-    frameInfo->globalDescriptorSet = _shadowDescriptorSet;
+    // corners of the camera's near and far planes, slices are interpolated along the frustum's edges
+    const glm::mat4 inverseProjectionView = glm::inverse(camera.getProjection() * camera.getView());
+    glm::vec3 nearCorners[4];
+    glm::vec3 farCorners[4];
+    for (int i = 0; i < 4; i++)
+    {
+        const glm::vec2 ndc{(i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f};
+        const glm::vec4 nearCorner = inverseProjectionView * glm::vec4{ndc, 0.f, 1.f};
+        const glm::vec4 farCorner = inverseProjectionView * glm::vec4{ndc, 1.f, 1.f};
+        nearCorners[i] = glm::vec3{nearCorner} / nearCorner.w;
+        farCorners[i] = glm::vec3{farCorner} / farCorner.w;
+    }
 
-    ShadowUbo ubo{};
-    ubo.projection = _cameraView->getProjection();
-    ubo.view = _cameraView->getView();
+    auto split = [&](uint32_t i) {
+        const float ratio = float(i) / float(_cascadeCount);
+        const float logarithmicSplit = nearPlane * std::pow(shadowFar / nearPlane, ratio);
+        const float uniformSplit = nearPlane + (shadowFar - nearPlane) * ratio;
+        return SHADOW_SPLIT_LAMBDA * logarithmicSplit + (1.f - SHADOW_SPLIT_LAMBDA) * uniformSplit;
+    };
+
+    // backwards, so the light's view is left with the first cascade's projection
+    for (uint32_t i = _cascadeCount; i-- > 0;)
+    {
+        Cascade &cascade = _cascades[i];
 
-    _shadowUboBuffer->writeToBuffer(&ubo);
-    _shadowUboBuffer->flush();
+        const float splitBegin = split(i);
+        const float splitEnd = split(i + 1);
+
+        glm::vec3 corners[8];
+        glm::vec3 center{0.f};
+        for (int c = 0; c < 4; c++)
+        {
+            corners[c] = glm::mix(nearCorners[c], farCorners[c], (splitBegin - nearPlane) / (farPlane - nearPlane));
+            corners[c + 4] = glm::mix(nearCorners[c], farCorners[c], (splitEnd - nearPlane) / (farPlane - nearPlane));
+            center += corners[c] + corners[c + 4];
+        }
+        center /= 8.f;
+
+        // a sphere keeps the box's size constant while the camera turns, rounding keeps it from flickering
+        float radius = 0.f;
+        for (const glm::vec3 &corner : corners)
+        {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        radius = std::ceil(radius * 16.f) / 16.f;
+
+        // moving the box by whole texels keeps shadow edges from crawling while the camera moves
+        const float texelSize = 2.f * radius / float(_imageResolution.width);
+        glm::vec3 lightCenter{lightView * glm::vec4{center, 1.f}};
+        lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+        lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+
+        // casters up to the shadow distance towards the sun still throw their shadow into the cascade
+        const float zNear = lightCenter.z - radius - _shadowDistance;
+        const float zFar = lightCenter.z + radius;
+
+        _cameraView->setOrthographicProjection(lightCenter.x - radius, lightCenter.x + radius, lightCenter.y + radius,
+                                               lightCenter.y - radius, -zNear, -zFar);
+        cascade.projection = _cameraView->getProjection();
+        cascade.split = splitEnd;
+        cascade.bias = SHADOW_DEPTH_BIAS / (zFar - zNear);
+
+        ShadowUbo ubo{};
+        ubo.projection = cascade.projection;
+        ubo.view = lightView;
+
+        _shadowUboBuffer->writeToIndex(&ubo, frameIndex * MAX_SHADOW_CASCADES + i);
+        _shadowUboBuffer->flushIndex(frameIndex * MAX_SHADOW_CASCADES + i);
+    }
+}
+
+Material *DirectionalLight::beginStaticRender(FrameInfo *frameInfo, uint32_t cascade) const
+{
+    // last frame's copy may still be reading the static layer
+    frameInfo->commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                             vk::PipelineStageFlagBits::eEarlyFragmentTests, {}, 0, nullptr, 0,
+                                             nullptr, 0, nullptr);
+
+    frameInfo->globalDescriptorSet = _cascades[cascade].descriptorSets[frameInfo->frameIndex];
 
     vk::ClearValue clearDepth{};
     clearDepth.depthStencil = 1.f;
 
     vk::RenderPassBeginInfo renderPassBeginInfo{};
-    renderPassBeginInfo.renderPass = _renderPass;
-    renderPassBeginInfo.framebuffer = _framebuffer;
+    renderPassBeginInfo.renderPass = _staticRenderPass;
+    renderPassBeginInfo.framebuffer = _cascades[cascade].staticFramebuffer;
     renderPassBeginInfo.renderArea.extent = _imageResolution;
     renderPassBeginInfo.clearValueCount = 1;
     renderPassBeginInfo.pClearValues = &clearDepth;
 
-    frameInfo->commandBuffer.beginRenderPass(&renderPassBeginInfo, vk::SubpassContents::eInline);
+    // casters are recorded in secondary command buffers, which also set the viewport
+    frameInfo->commandBuffer.beginRenderPass(&renderPassBeginInfo, vk::SubpassContents::eSecondaryCommandBuffers);
+
+    return _voidMaterial;
+}
+
+Material *DirectionalLight::beginRender(FrameInfo *frameInfo, uint32_t cascade) const
+{
+    vk::ImageSubresourceRange subresourceRange{vk::ImageAspectFlagBits::eDepth, 0, 1, cascade, 1};
+
+    vk::ImageMemoryBarrier copyBarriers[2]{};
+    copyBarriers[0].oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+    copyBarriers[0].newLayout = vk::ImageLayout::eTransferSrcOptimal;
+    copyBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    copyBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    copyBarriers[0].image = _staticImage;
+    copyBarriers[0].subresourceRange = subresourceRange;
+    copyBarriers[0].srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+    copyBarriers[0].dstAccessMask = vk::AccessFlagBits::eTransferRead;
+
+    copyBarriers[1].oldLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    copyBarriers[1].newLayout = vk::ImageLayout::eTransferDstOptimal;
+    copyBarriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    copyBarriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    copyBarriers[1].image = _image;
+    copyBarriers[1].subresourceRange = subresourceRange;
+    copyBarriers[1].srcAccessMask = vk::AccessFlagBits::eShaderRead;
+    copyBarriers[1].dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+
+    frameInfo->commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eLateFragmentTests |
+                                                 vk::PipelineStageFlagBits::eFragmentShader,
+                                             vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 2,
+                                             copyBarriers);
+
+    vk::ImageCopy region{};
+    region.srcSubresource = vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eDepth, 0, cascade, 1};
+    region.dstSubresource = vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eDepth, 0, cascade, 1};
+    region.extent = vk::Extent3D{_imageResolution.width, _imageResolution.height, 1u};
+
+    frameInfo->commandBuffer.copyImage(_staticImage, vk::ImageLayout::eTransferSrcOptimal, _image,
+                                       vk::ImageLayout::eTransferDstOptimal, 1, &region);
+
+    vk::ImageMemoryBarrier depthBarrier{};
+    depthBarrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+    depthBarrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+    depthBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    depthBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    depthBarrier.image = _image;
+    depthBarrier.subresourceRange = subresourceRange;
+    depthBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    depthBarrier.dstAccessMask =
+        vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+
+    frameInfo->commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                             vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                                                 vk::PipelineStageFlagBits::eLateFragmentTests,
+                                             {}, 0, nullptr, 0, nullptr, 1, &depthBarrier);
+
+    frameInfo->globalDescriptorSet = _cascades[cascade].descriptorSets[frameInfo->frameIndex];
+
+    vk::RenderPassBeginInfo renderPassBeginInfo{};
+    renderPassBeginInfo.renderPass = _renderPass;
+    renderPassBeginInfo.framebuffer = _cascades[cascade].framebuffer;
+    renderPassBeginInfo.renderArea.extent = _imageResolution;
 
-    static vk::Viewport viewport;
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)_imageResolution.width;
-    viewport.height = (float)_imageResolution.height;
-    viewport.minDepth = 0.f;
-    viewport.maxDepth = 1.f;
-    vk::Rect2D scissor{vk::Offset2D{0, 0}, _imageResolution};
-    frameInfo->commandBuffer.setViewport(0, 1, &viewport);
-    frameInfo->commandBuffer.setScissor(0, 1, &scissor);
+    frameInfo->commandBuffer.beginRenderPass(&renderPassBeginInfo, vk::SubpassContents::eSecondaryCommandBuffers);
 
     return _voidMaterial;
 }
 
-size_t DirectionalLight::endRender(FrameInfo *frameInfo) const
+void DirectionalLight::endRender(FrameInfo *frameInfo) const
 {
     frameInfo->commandBuffer.endRenderPass();
-
-    return _samplerDescriptorSetID;
 }
 
 LightEnvironment::LightEnvironment()
 {
-    _pointLightsMap.reserve(MAX_POINT_LIGHTS);
+    _pointLights.reserve(MAX_POINT_LIGHTS);
+    _pointLightHandles.reserve(MAX_POINT_LIGHTS);
+    _dirtyPointLights.assign(SwapChain::MAX_FRAMES_IN_FLIGHT, glm::uvec2{UINT32_MAX, 0});
 
-    _sun.initializeShadowMap(RenderSystem::getInstance()->getDevice(), 4096u, 4096u);
+    _sun.initializeShadowMap(RenderSystem::getInstance()->getDevice(), 2048u);
 }
 
 LightEnvironment::~LightEnvironment()
@@ -268,64 +525,178 @@ LightEnvironment::~LightEnvironment()
     _sun.freeShadowMap(RenderSystem::getInstance()->getDevice());
 }
 
-void LightEnvironment::drawShadowMaps(
-    struct FrameInfo *frameInfo,
-    const std::map<uint8_t, std::vector<std::pair<Drawable *, DrawOption *>>> &drawableRenderQueue,
-    std::vector<size_t> &descriptorSetIDs)
+bool LightEnvironment::classifyShadowCasters(const std::vector<std::pair<Drawable *, DrawOption *>> &renderEntries)
 {
-    // if (_updateShadowMap) // TODO: only update shadow map on dynamic objects, or during editor mode
+    _shadowFrame++;
+
+    bool staticDirty = _updateShadowMap;
+
+    _casterLayers.assign(renderEntries.size(), eNoShadow);
+    _dynamicCasterCount = 0;
+    for (size_t i = 0; i < renderEntries.size(); i++)
     {
-        vk::DescriptorSet descriptorSetHolder = frameInfo->globalDescriptorSet;
+        auto &[drawable, drawOption] = renderEntries[i];
+        if (drawOption->material->isTransparent() || !drawable->isVisible() || !drawable->canRender(drawOption))
+        {
+            continue;
+        }
+
+        const glm::mat4 transform = drawable->getWorldSpaceTransform().mat4();
 
-        descriptorSetIDs.clear();
-        descriptorSetIDs.reserve(MAX_POINT_LIGHTS + 1);
+        auto [it, inserted] =
+            _shadowCasters.try_emplace(drawOption, ShadowCaster{transform, drawOption->model, 0, _shadowFrame, false});
+        ShadowCaster &caster = it->second;
 
-        Material *sunMaterial = _sun.beginRender(frameInfo);
-        for (auto &[materialID, drawableQueue] : drawableRenderQueue)
+        if (!inserted && (caster.transform != transform || caster.model != drawOption->model))
         {
-            Texture::resetBoundID();
-            for (auto &[drawable, drawOption] : drawableQueue)
-            {
-                if (drawOption->material->isTransparent())
+            // moving out of the static layer leaves a stale shadow behind
+            staticDirty |= caster.isStatic;
+            caster = ShadowCaster{transform, drawOption->model, 0, _shadowFrame, false};
+        }
+        else if (!caster.isStatic && ++caster.stillFrames >= SHADOW_STATIC_FRAMES)
+        {
+            caster.isStatic = true;
+            staticDirty = true;
+        }
+
+        caster.lastSeen = _shadowFrame;
+        _casterLayers[i] = caster.isStatic ? eStaticShadow : eDynamicShadow;
+        _dynamicCasterCount += caster.isStatic ? 0 : 1;
+    }
+
+    for (auto it = _shadowCasters.begin(); it != _shadowCasters.end();)
+    {
+        if (it->second.lastSeen != _shadowFrame)
+        {
+            staticDirty |= it->second.isStatic;
+            it = _shadowCasters.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    return staticDirty;
+}
+
+void LightEnvironment::drawShadowMaps(struct FrameInfo *frameInfo, Camera *camera,
+                                      const std::vector<std::pair<Drawable *, DrawOption *>> &renderEntries,
+                                      const CullingBounds &bounds, CullingStats &stats,
+                                      std::vector<size_t> &descriptorSetIDs)
+{
+    descriptorSetIDs.clear();
+    descriptorSetIDs.emplace_back(_sun._samplerDescriptorSetID);
+
+    if (camera == nullptr)
+        return;
+
+    const bool casterDirty = classifyShadowCasters(renderEntries);
+    _updateShadowMap = false;
+
+    _sun.fitCascades(*camera, uint32_t(frameInfo->frameIndex));
+    const glm::mat4 &lightView = _sun._cameraView->getView();
+
+    vk::DescriptorSet descriptorSetHolder = frameInfo->globalDescriptorSet;
+    GpuProfiler *profiler = RenderSystem::getInstance()->getProfiler();
+
+    auto recordCasters = [&](RenderSystem::RecordedPass pass, vk::RenderPass renderPass, Material *sunMaterial,
+                             const std::vector<uint32_t> &indices) {
+        RenderSystem::getInstance()->recordParallel(
+            frameInfo, pass, renderPass, _sun._imageResolution, indices.size(),
+            [&](FrameInfo &slotFrameInfo, size_t, size_t begin, size_t end) {
+                Material::resetBoundID();
+                Texture::resetBoundID();
+
+                DrawOption shadowDrawOption{};
+                shadowDrawOption.material = sunMaterial;
+
+                for (size_t i = begin; i < end; i++)
                 {
-                    continue;
+                    auto &[drawable, drawOption] = renderEntries[indices[i]];
+
+                    shadowDrawOption.model = drawOption->model;
+                    drawable->render(slotFrameInfo, &shadowDrawOption);
                 }
+            });
+    };
 
-                static DrawOption customDrawOption{};
+    for (uint32_t i = 0; i < _sun._cascadeCount; i++)
+    {
+        DirectionalLight::Cascade &cascade = _sun._cascades[i];
+        const glm::mat4 projectionView = cascade.projection * lightView;
 
-                customDrawOption.model = drawOption->model;
-                customDrawOption.material = sunMaterial;
-                drawable->render(*frameInfo, &customDrawOption);
+        // snapping only moves a cascade once the camera crossed a texel, the far ones stay put for a while
+        const bool staticDirty = casterDirty || projectionView != cascade.cachedProjectionView;
+
+        // nothing moved and nothing is moving, last frame's layer is still right
+        if (!staticDirty && _dynamicCasterCount == 0 && !cascade.hasDynamic)
+            continue;
+
+        _shadowVisibleIndices.clear();
+        stats.shadowCulled += uint32_t(cullSpheres(Frustum{projectionView}, bounds, _shadowVisibleIndices));
+
+        _staticVisibleIndices.clear();
+        _dynamicVisibleIndices.clear();
+        for (uint32_t index : _shadowVisibleIndices)
+        {
+            if (_casterLayers[index] == eStaticShadow)
+            {
+                _staticVisibleIndices.push_back(index);
+            }
+            else if (_casterLayers[index] == eDynamicShadow)
+            {
+                _dynamicVisibleIndices.push_back(index);
             }
         }
 
-        descriptorSetIDs.emplace_back(_sun.endRender(frameInfo));
+        const uint32_t cascadeScope = profiler->beginScope(frameInfo->commandBuffer, "cascade " + std::to_string(i));
 
-        frameInfo->globalDescriptorSet = descriptorSetHolder;
+        if (staticDirty)
+        {
+            const uint32_t staticScope = profiler->beginScope(frameInfo->commandBuffer, "static layer");
+            Material *sunMaterial = _sun.beginStaticRender(frameInfo, i);
+            recordCasters(RenderSystem::RecordedPass(RenderSystem::eStaticShadowPass + i), _sun._staticRenderPass,
+                          sunMaterial, _staticVisibleIndices);
+            _sun.endRender(frameInfo);
+            profiler->endScope(frameInfo->commandBuffer, staticScope);
+
+            cascade.cachedProjectionView = projectionView;
+        }
+
+        Material *sunMaterial = _sun.beginRender(frameInfo, i);
+        recordCasters(RenderSystem::RecordedPass(RenderSystem::eShadowPass + i), _sun._renderPass, sunMaterial,
+                      _dynamicVisibleIndices);
+        _sun.endRender(frameInfo);
+
+        profiler->endScope(frameInfo->commandBuffer, cascadeScope);
+
+        cascade.hasDynamic = !_dynamicVisibleIndices.empty();
 
-        _updateShadowMap = false;
+        stats.shadowVisible +=
+            uint32_t(_dynamicVisibleIndices.size() + (staticDirty ? _staticVisibleIndices.size() : 0));
+        stats.shadowCached += staticDirty ? 0 : uint32_t(_staticVisibleIndices.size());
     }
+
+    frameInfo->globalDescriptorSet = descriptorSetHolder;
 }
 
 void LightEnvironment::populateUbo(GlobalUbo *ubo) const
 {
-    PointLight pointLights[MAX_POINT_LIGHTS];
-
-    int i = 0;
-    for (auto &pair : _pointLightsMap)
-    {
-        ubo->pointLights[i].position = glm::vec4(*pair.second.position, 1.0f);
-        ubo->pointLights[i].color = glm::vec4(*pair.second.color, *pair.second.intensity);
-        i++;
-    }
-    ubo->numLights = i;
-
     if (_hasSun)
     {
         ubo->sun.projection = _sun.getCameraView()->getProjection();
         ubo->sun.view = _sun.getCameraView()->getView();
         ubo->sun.color = _sun.color;
         ubo->sun.direction = _sun.direction;
+
+        ubo->sunCascadeCount = int(_sun._cascadeCount);
+        for (uint32_t i = 0; i < _sun._cascadeCount; i++)
+        {
+            ubo->sunCascades[i] = _sun._cascades[i].projection * _sun.getCameraView()->getView();
+            ubo->sunCascadeSplits[i] = _sun._cascades[i].split;
+            ubo->sunCascadeBiases[i] = _sun._cascades[i].bias;
+        }
         ubo->ambientLight = glm::vec4(_sun.color.x, _sun.color.y, _sun.color.z, _sun.intensity * .1f + .05f);
     }
     else
@@ -335,6 +706,183 @@ void LightEnvironment::populateUbo(GlobalUbo *ubo) const
     }
 }
 
+void LightEnvironment::clusterPointLights(Camera &camera, uint32_t frameIndex, GlobalUbo *ubo,
+                                          ClusterBuffer *clusterBuffer)
+{
+    const float nearPlane = std::max(camera.getNearPlane(), 1e-3f);
+    const float farPlane = std::max(camera.getFarPlane(), nearPlane * 2.f);
+
+    if (ubo->projection != _clusterProjection || nearPlane != _clusterNear || farPlane != _clusterFar)
+    {
+        buildClusterBounds(ubo->projection, nearPlane, farPlane);
+    }
+
+    const float depthRatio = std::log(farPlane / nearPlane);
+    ubo->clusterDepth = glm::vec4{float(CLUSTER_GRID_Z) / depthRatio,
+                                  -float(CLUSTER_GRID_Z) * std::log(nearPlane) / depthRatio, 0.f, 0.f};
+
+    // the lights behind the dirty range are already in this frame's buffer from an earlier frame
+    glm::uvec2 &dirty = _dirtyPointLights[frameIndex];
+    const uint32_t dirtyEnd = std::min(dirty.y, uint32_t(_pointLights.size()));
+    if (dirty.x < dirtyEnd)
+    {
+        std::copy(_pointLights.begin() + dirty.x, _pointLights.begin() + dirtyEnd,
+                  clusterBuffer->pointLights + dirty.x);
+    }
+    dirty = glm::uvec2{UINT32_MAX, 0};
+
+    _clusterLights.clear();
+    for (const PointLightCompact &pointLight : _pointLights)
+    {
+        const glm::vec3 center{ubo->view * glm::vec4(glm::vec3(pointLight.position), 1.f)};
+        _clusterLights.push_back(glm::vec4(center, pointLight.position.w));
+    }
+
+    ubo->clusterGrid = glm::uvec4{CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z, uint32_t(_clusterLights.size())};
+
+    _clusterSlices.resize(CLUSTER_GRID_Z);
+    JobSystem::getInstance().parallelFor(
+        CLUSTER_GRID_Z,
+        [this](size_t begin, size_t end) {
+            for (size_t slice = begin; slice < end; slice++)
+            {
+                assignClusterSlice(uint32_t(slice));
+            }
+        },
+        1);
+
+    // the slices' lists are laid out back to back, clusters past the end of the index list lose their lights
+    uint32_t indexCount = 0;
+    bool overflow = false;
+    for (uint32_t slice = 0; slice < CLUSTER_GRID_Z; slice++)
+    {
+        const ClusterSlice &clusterSlice = _clusterSlices[slice];
+
+        const uint32_t base = indexCount;
+        const uint32_t count = std::min(uint32_t(clusterSlice.lightIndices.size()), MAX_CLUSTER_LIGHT_INDICES - base);
+        std::copy_n(clusterSlice.lightIndices.begin(), count, clusterBuffer->lightIndices + base);
+        indexCount += count;
+        overflow |= count < clusterSlice.lightIndices.size();
+
+        for (uint32_t tile = 0; tile < CLUSTER_GRID_X * CLUSTER_GRID_Y; tile++)
+        {
+            const glm::uvec2 &range = clusterSlice.ranges[tile];
+            const uint32_t offset = std::min(range.x, count);
+            clusterBuffer->clusters[slice * CLUSTER_GRID_X * CLUSTER_GRID_Y + tile] =
+                glm::uvec2{base + offset, std::min(range.y, count - offset)};
+        }
+    }
+
+    if (overflow && !_clusterOverflowFlag)
+    {
+        spdlog::warn("LightEnvironment: point lights overlap more clusters than the cluster buffer holds");
+    }
+    _clusterOverflowFlag = overflow;
+}
+
+void LightEnvironment::buildClusterBounds(const glm::mat4 &projection, float nearPlane, float farPlane)
+{
+    _clusterProjection = projection;
+    _clusterNear = nearPlane;
+    _clusterFar = farPlane;
+
+    _clusterDepths.resize(CLUSTER_GRID_Z + 1);
+    for (uint32_t slice = 0; slice <= CLUSTER_GRID_Z; slice++)
+    {
+        _clusterDepths[slice] = nearPlane * std::pow(farPlane / nearPlane, float(slice) / float(CLUSTER_GRID_Z));
+    }
+
+    _clusterMin.resize(CLUSTER_COUNT);
+    _clusterMax.resize(CLUSTER_COUNT);
+
+    const glm::mat4 inverseProjection = glm::inverse(projection);
+    const auto unproject = [&inverseProjection](float x, float y, float z) {
+        const glm::vec4 point = inverseProjection * glm::vec4{x, y, z, 1.f};
+        return glm::vec3(point) / point.w;
+    };
+
+    for (uint32_t y = 0; y < CLUSTER_GRID_Y; y++)
+    {
+        for (uint32_t x = 0; x < CLUSTER_GRID_X; x++)
+        {
+            // the tile's corner rays, both perspective and orthographic ones are lines through these points
+            glm::vec3 rayStarts[4];
+            glm::vec3 rayEnds[4];
+            for (uint32_t corner = 0; corner < 4; corner++)
+            {
+                const float ndcX = float(x + (corner & 1)) / float(CLUSTER_GRID_X) * 2.f - 1.f;
+                const float ndcY = float(y + (corner >> 1)) / float(CLUSTER_GRID_Y) * 2.f - 1.f;
+                rayStarts[corner] = unproject(ndcX, ndcY, 0.f);
+                rayEnds[corner] = unproject(ndcX, ndcY, 1.f);
+            }
+
+            for (uint32_t slice = 0; slice < CLUSTER_GRID_Z; slice++)
+            {
+                glm::vec3 min{std::numeric_limits<float>::max()};
+                glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+                for (uint32_t corner = 0; corner < 4; corner++)
+                {
+                    const glm::vec3 &start = rayStarts[corner];
+                    const glm::vec3 direction = rayEnds[corner] - start;
+
+                    for (uint32_t side = 0; side < 2; side++)
+                    {
+                        const float depth = _clusterDepths[slice + side];
+                        const glm::vec3 point = start + direction * ((depth - start.z) / direction.z);
+                        min = glm::min(min, point);
+                        max = glm::max(max, point);
+                    }
+                }
+
+                const uint32_t cluster = (slice * CLUSTER_GRID_Y + y) * CLUSTER_GRID_X + x;
+                _clusterMin[cluster] = min;
+                _clusterMax[cluster] = max;
+            }
+        }
+    }
+}
+
+void LightEnvironment::assignClusterSlice(uint32_t slice)
+{
+    ClusterSlice &clusterSlice = _clusterSlices[slice];
+    clusterSlice.candidates.clear();
+    clusterSlice.lightIndices.clear();
+    clusterSlice.ranges.resize(CLUSTER_GRID_X * CLUSTER_GRID_Y);
+
+    const float sliceNear = _clusterDepths[slice];
+    const float sliceFar = _clusterDepths[slice + 1];
+    for (uint32_t light = 0; light < _clusterLights.size(); light++)
+    {
+        const glm::vec4 &sphere = _clusterLights[light];
+        if (sphere.w > 0.f && sphere.z + sphere.w >= sliceNear && sphere.z - sphere.w <= sliceFar)
+        {
+            clusterSlice.candidates.push_back(light);
+        }
+    }
+
+    for (uint32_t tile = 0; tile < CLUSTER_GRID_X * CLUSTER_GRID_Y; tile++)
+    {
+        const uint32_t cluster = slice * CLUSTER_GRID_X * CLUSTER_GRID_Y + tile;
+        const uint32_t offset = uint32_t(clusterSlice.lightIndices.size());
+
+        for (uint32_t light : clusterSlice.candidates)
+        {
+            const glm::vec4 &sphere = _clusterLights[light];
+            const glm::vec3 center{sphere};
+            const glm::vec3 closest = glm::clamp(center, _clusterMin[cluster], _clusterMax[cluster]);
+            const glm::vec3 offsetToBox = closest - center;
+
+            if (glm::dot(offsetToBox, offsetToBox) <= sphere.w * sphere.w)
+            {
+                clusterSlice.lightIndices.push_back(light);
+            }
+        }
+
+        clusterSlice.ranges[tile] = glm::uvec2{offset, uint32_t(clusterSlice.lightIndices.size()) - offset};
+    }
+}
+
 void LightEnvironment::calculateSun()
 {
     float theta = (_timeOfDay / 24.f) * glm::two_pi<float>() - glm::half_pi<float>();
@@ -349,21 +897,79 @@ void LightEnvironment::calculateSun()
     _sun.intensity = sunIntensity;
 }
 
-void LightEnvironment::addPointLight(uint32_t id, const PointLight &pointLight)
+uint32_t LightEnvironment::createPointLight()
 {
-    if (_pointLightsMap.size() < MAX_POINT_LIGHTS)
+    if (_pointLights.size() >= MAX_POINT_LIGHTS)
+    {
+        spdlog::error("LightEnvironment: Reached maximum amount of point lights alloded by RenderSystem");
+        return INVALID_POINT_LIGHT;
+    }
+
+    uint32_t handle;
+    if (_freePointLightHandles.empty())
     {
-        _pointLightsMap[id] = pointLight;
+        handle = uint32_t(_pointLightIndices.size());
+        _pointLightIndices.push_back(0);
     }
     else
     {
-        spdlog::error("LightEnvironment: Reached maximum amount of point lights alloded by RenderSystem");
+        handle = _freePointLightHandles.back();
+        _freePointLightHandles.pop_back();
     }
+
+    _pointLightIndices[handle] = uint32_t(_pointLights.size());
+    _pointLightHandles.push_back(handle);
+    _pointLights.emplace_back();
+    markPointLightDirty(_pointLightIndices[handle]);
+
+    return handle;
 }
 
-void LightEnvironment::removePointLight(uint32_t id)
+void LightEnvironment::updatePointLight(uint32_t handle, const glm::vec3 &position, const glm::vec3 &color,
+                                        float intensity)
 {
-    _pointLightsMap.erase(id);
+    if (handle >= _pointLightIndices.size() || _pointLightIndices[handle] == INVALID_POINT_LIGHT)
+        return;
+
+    // distance at which the light's irradiance falls under the cutoff
+    const float brightest = intensity * std::max({color.r, color.g, color.b});
+    const float range = brightest > 0.f ? std::sqrt(brightest / POINT_LIGHT_CUTOFF) : 0.f;
+
+    const uint32_t index = _pointLightIndices[handle];
+    _pointLights[index].position = glm::vec4(position, range);
+    _pointLights[index].color = glm::vec4(color, intensity);
+    markPointLightDirty(index);
+}
+
+void LightEnvironment::releasePointLight(uint32_t handle)
+{
+    if (handle >= _pointLightIndices.size() || _pointLightIndices[handle] == INVALID_POINT_LIGHT)
+        return;
+
+    // the last light fills the hole so the array stays packed
+    const uint32_t index = _pointLightIndices[handle];
+    const uint32_t last = uint32_t(_pointLights.size()) - 1;
+    if (index != last)
+    {
+        _pointLights[index] = _pointLights[last];
+        _pointLightHandles[index] = _pointLightHandles[last];
+        _pointLightIndices[_pointLightHandles[index]] = index;
+        markPointLightDirty(index);
+    }
+    _pointLights.pop_back();
+    _pointLightHandles.pop_back();
+
+    _pointLightIndices[handle] = INVALID_POINT_LIGHT;
+    _freePointLightHandles.push_back(handle);
+}
+
+void LightEnvironment::markPointLightDirty(uint32_t index)
+{
+    for (glm::uvec2 &dirty : _dirtyPointLights)
+    {
+        dirty.x = std::min(dirty.x, index);
+        dirty.y = std::max(dirty.y, index + 1);
+    }
 }
 
 tinyxml2::XMLElement &LightEnvironment::save(tinyxml2::XMLDocument &doc, tinyxml2::XMLElement *parentElement) const
@@ -375,6 +981,8 @@ tinyxml2::XMLElement &LightEnvironment::save(tinyxml2::XMLDocument &doc, tinyxml
     {
         tinyxml2::XMLElement *sunElement = doc.NewElement("sun");
         sunElement->SetAttribute("axis", _sunAxis);
+        sunElement->SetAttribute("shadowDistance", _sun._shadowDistance);
+        sunElement->SetAttribute("shadowCascades", _sun._cascadeCount);
 
         tinyxml2::XMLElement *gradientElement = doc.NewElement("gradient");
 
@@ -419,6 +1027,9 @@ void LightEnvironment::load(tinyxml2::XMLElement *parentElement)
         {
             _hasSun = true;
             _sunAxis = sunElement->FloatAttribute("axis");
+            _sun._shadowDistance = sunElement->FloatAttribute("shadowDistance", 100.f);
+            _sun._cascadeCount = std::clamp(sunElement->UnsignedAttribute("shadowCascades", 3u), 2u,
+                                            uint32_t(MAX_SHADOW_CASCADES));
 
             if (tinyxml2::XMLElement *gradientELement = sunElement->FirstChildElement("gradient"))
             {
@@ -455,6 +1066,67 @@ void LightEnvironment::load(tinyxml2::XMLElement *parentElement)
     }
 }
 
+void LightEnvironment::writeRecord(RecordWriter &writer) const
+{
+    const auto &marks = atmosphereWidget.gradient().get_marks();
+
+    LightEnvironmentRecord record{_timeOfDay, _hasSun, _sunAxis, _sun._shadowDistance, _sun._cascadeCount};
+    record.ambientLighting[0] = _ambientLighting.r;
+    record.ambientLighting[1] = _ambientLighting.g;
+    record.ambientLighting[2] = _ambientLighting.b;
+    record.ambientLighting[3] = _ambientLighting.a;
+    record.markCount = _hasSun ? uint32_t(marks.size()) : 0;
+    writer.write(record);
+
+    if (!_hasSun)
+        return;
+
+    for (const auto &mark : marks)
+    {
+        writer.write(GradientMarkRecord{mark.position.get(), {mark.color.x, mark.color.y, mark.color.z}});
+    }
+}
+
+void LightEnvironment::readRecord(RecordReader &reader)
+{
+    loadDefaults();
+
+    const LightEnvironmentRecord *record = reader.read<LightEnvironmentRecord>();
+    const GradientMarkRecord *marks = record ? reader.read<GradientMarkRecord>(record->markCount) : nullptr;
+    if (marks == nullptr)
+    {
+        return;
+    }
+
+    _timeOfDay = record->timeOfDay;
+    _hasSun = record->hasSun != 0;
+
+    if (_hasSun)
+    {
+        _sunAxis = record->sunAxis;
+        _sun._shadowDistance = record->shadowDistance;
+        _sun._cascadeCount = std::clamp(record->shadowCascades, 2u, uint32_t(MAX_SHADOW_CASCADES));
+
+        atmosphereWidget.gradient().clear();
+        for (uint32_t i = 0; i < record->markCount; i++)
+        {
+            ImGG::Mark mark{};
+            mark.position.set(marks[i].position);
+            mark.color.x = marks[i].color[0];
+            mark.color.y = marks[i].color[1];
+            mark.color.z = marks[i].color[2];
+            atmosphereWidget.gradient().add_mark(mark);
+        }
+
+        calculateSun();
+    }
+    else
+    {
+        _ambientLighting = glm::vec4{record->ambientLighting[0], record->ambientLighting[1],
+                                     record->ambientLighting[2], record->ambientLighting[3]};
+    }
+}
+
 void LightEnvironment::loadDefaults()
 {
     _timeOfDay = 10.f;
@@ -481,35 +1153,42 @@ void LightEnvironment::loadDefaults()
     _hasSun = false;
 }
 
-void LightEnvironment::editor()
+bool LightEnvironment::editor()
 {
-    ImGui::Checkbox("has sun", &_hasSun);
+    bool edited = ImGui::Checkbox("has sun", &_hasSun);
 
-    const float pre =
-        _timeOfDay + _sunAxis + _ambientLighting.x + _ambientLighting.y + _ambientLighting.z + _sun._boundingDimension;
+    const float pre = _timeOfDay + _sunAxis + _ambientLighting.x + _ambientLighting.y + _ambientLighting.z;
 
     if (_hasSun)
     {
-        ImGui::DragFloat("Time of day", &_timeOfDay, 0.25f, 0.0f, 23.99f, "%.2f");
-        ImGui::DragFloat("Sun axis", &_sunAxis, 5.f, 0.f, 180.f, "%.0f");
-        atmosphereWidget.widget("Atmosphere color");
-        ImGui::DragFloat("ShadowMap bounds radius", &_sun._boundingDimension, 10.f, 10.f, 200.f);
+        edited |= ImGui::DragFloat("Time of day", &_timeOfDay, 0.25f, 0.0f, 23.99f, "%.2f");
+        edited |= ImGui::DragFloat("Sun axis", &_sunAxis, 5.f, 0.f, 180.f, "%.0f");
+        edited |= atmosphereWidget.widget("Atmosphere color");
+        edited |= ImGui::DragFloat("Shadow distance", &_sun._shadowDistance, 10.f, 10.f, 2000.f);
+
+        int cascadeCount = int(_sun._cascadeCount);
+        if (ImGui::SliderInt("Shadow cascades", &cascadeCount, 2, MAX_SHADOW_CASCADES))
+        {
+            _sun._cascadeCount = uint32_t(cascadeCount);
+            edited = true;
+        }
 
         calculateSun();
     }
     else
     {
-        ImGui::ColorPicker4("Ambient light", (float *)&_ambientLighting,
-                            ImGuiColorEditFlags_Float && ImGuiColorEditFlags_InputRGB);
+        edited |= ImGui::ColorPicker4("Ambient light", (float *)&_ambientLighting,
+                                      ImGuiColorEditFlags_Float && ImGuiColorEditFlags_InputRGB);
     }
 
-    const float post =
-        _timeOfDay + _sunAxis + _ambientLighting.x + _ambientLighting.y + _ambientLighting.z + _sun._boundingDimension;
+    const float post = _timeOfDay + _sunAxis + _ambientLighting.x + _ambientLighting.y + _ambientLighting.z;
 
     if (pre != post)
     {
         _updateShadowMap = true;
     }
+
+    return edited;
 }
 
 } // namespace cmx
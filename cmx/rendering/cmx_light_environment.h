@@ -5,8 +5,10 @@
 #include "cmx_descriptors.h"
 #include "tinyxml2.h"
 #include <glm/ext/matrix_common.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/vector_float3.hpp>
 #include <glm/ext/vector_float4.hpp>
+#include <glm/ext/vector_uint2.hpp>
 #include <glm/fwd.hpp>
 #include <memory>
 #include <vulkan/vulkan.hpp>
@@ -16,6 +18,18 @@
 #include <cstdint>
 #include <map>
 #include <unordered_map>
+#include <vector>
+
+// frames a shadow caster has to stand still before it moves to the cached static layer
+#define SHADOW_STATIC_FRAMES 30
+#define MAX_SHADOW_CASCADES 4
+// 0 splits the shadow distance evenly, 1 logarithmically
+#define SHADOW_SPLIT_LAMBDA .75f
+// world space distance a surface has to be behind the stored depth to be in shadow
+#define SHADOW_DEPTH_BIAS .5f
+// irradiance under which a point light no longer reaches a surface, sets the range it's clustered with
+#define POINT_LIGHT_CUTOFF .01f
+#define INVALID_POINT_LIGHT UINT32_MAX
 
 namespace cmx
 {
@@ -26,15 +40,10 @@ struct ShadowUbo
     glm::mat4 view;
 };
 
-struct PointLight
+struct PointLightCompact
 {
-    PointLight() = default;
-    PointLight(glm::vec3 *position_, glm::vec3 *color_, float *intensity_)
-        : position(position_), color(color_), intensity(intensity_) {};
-
-    glm::vec3 *position;
-    glm::vec3 *color;
-    float *intensity;
+    glm::vec4 position{}; // w is the range
+    glm::vec4 color{};    // a is intensity
 };
 
 class Material;
@@ -53,7 +62,28 @@ class DirectionalLight
     const class Camera *getCameraView() const;
 
   private:
-    void initializeShadowMap(class Device *, uint32_t width, uint32_t height);
+    // one per cascade, every frame in flight gets its own ShadowUbo
+    struct Cascade
+    {
+        glm::mat4 projection{1.f};
+        // view space depth the cascade ends at
+        float split{0.f};
+        float bias{0.f};
+
+        vk::ImageView imageView;
+        vk::ImageView staticImageView;
+        vk::Framebuffer framebuffer;
+        vk::Framebuffer staticFramebuffer;
+        // per frame in flight
+        std::vector<vk::DescriptorSet> descriptorSets{};
+
+        // what the static layer was drawn with
+        glm::mat4 cachedProjectionView{0.f};
+        // the layer holds last frame's dynamic casters, so it has to be rebuilt even without any left
+        bool hasDynamic{false};
+    };
+
+    void initializeShadowMap(class Device *, uint32_t resolution);
     void createImage(class Device *);
     void createImageView(class Device *);
     void createRenderPass(class Device *);
@@ -61,29 +91,43 @@ class DirectionalLight
     void createSampler(class Device *);
     void createShadowUbo(class Device *);
     void createDescriptorSet(class Device *);
+    // every layer starts out as an empty shadow map, cascades past the count are never drawn
+    void clearLayers(class Device *);
 
     void freeShadowMap(class Device *);
-    [[nodiscard]] Material *beginRender(struct FrameInfo *) const;
-    [[nodiscard]] size_t endRender(struct FrameInfo *) const;
+    // splits the camera's view up to the shadow distance and fits a texel snapped box around each slice
+    void fitCascades(class Camera &, uint32_t frameIndex);
+    // the static layer holds the casters that stood still, it's only drawn again when they change
+    [[nodiscard]] Material *beginStaticRender(struct FrameInfo *, uint32_t cascade) const;
+    // the shadow map starts as a copy of the static layer, dynamic casters are then drawn on top of it
+    [[nodiscard]] Material *beginRender(struct FrameInfo *, uint32_t cascade) const;
+    void endRender(struct FrameInfo *) const;
 
     vk::Image _image;
     vk::ImageView _imageView;
     vk::Sampler _sampler;
     size_t _samplerDescriptorSetID;
-    vk::DeviceMemory _imageMemory;
+    Allocation _imageMemory;
     vk::RenderPass _renderPass;
-    vk::Framebuffer _framebuffer;
 
-    float _boundingDimension = 10.f;
+    vk::Image _staticImage;
+    Allocation _staticImageMemory;
+    vk::RenderPass _staticRenderPass;
+
+    Cascade _cascades[MAX_SHADOW_CASCADES];
+    uint32_t _cascadeCount{3};
+    // how far from the camera shadows are drawn
+    float _shadowDistance{100.f};
 
     class VoidMaterial *_voidMaterial;
     std::unique_ptr<class DescriptorPool> _shadowDescriptorPool;
     std::unique_ptr<class DescriptorSetLayout> _shadowDescriptorSetLayout;
-    vk::DescriptorSet _shadowDescriptorSet;
     class Buffer *_shadowUboBuffer;
 
+    // shared light view, its projection is the first cascade's
     std::unique_ptr<class Camera> _cameraView;
 
+    // per cascade
     vk::Extent2D _imageResolution;
 };
 
@@ -93,24 +137,81 @@ class LightEnvironment
     LightEnvironment();
     ~LightEnvironment();
 
-    void addPointLight(uint32_t, const PointLight &);
-    void removePointLight(uint32_t);
+    // packed point light registry, INVALID_POINT_LIGHT once full, the slot stays unlit until its first update
+    uint32_t createPointLight();
+    // the owner only calls this when its light changed, only the dirty range reaches the cluster buffers
+    void updatePointLight(uint32_t handle, const glm::vec3 &position, const glm::vec3 &color, float intensity);
+    void releasePointLight(uint32_t handle);
 
     void populateUbo(struct GlobalUbo *) const;
+    // assigns the point lights to the camera's froxels, the ubo's view and projection must already be set
+    void clusterPointLights(class Camera &, uint32_t frameIndex, struct GlobalUbo *, struct ClusterBuffer *);
 
-    void drawShadowMaps(struct FrameInfo *,
-                        const std::map<uint8_t, std::vector<std::pair<class Drawable *, struct DrawOption *>>> &,
-                        std::vector<size_t> &descriptorSetIDs);
+    // cascades follow the camera, shadows aren't drawn without one
+    void drawShadowMaps(struct FrameInfo *, class Camera *,
+                        const std::vector<std::pair<class Drawable *, struct DrawOption *>> &,
+                        const struct CullingBounds &, struct CullingStats &, std::vector<size_t> &descriptorSetIDs);
     tinyxml2::XMLElement &save(tinyxml2::XMLDocument &, tinyxml2::XMLElement *) const;
     void load(tinyxml2::XMLElement *);
+    void writeRecord(class RecordWriter &) const;
+    void readRecord(class RecordReader &);
     void unload();
     void loadDefaults();
-    void editor();
+    // true when edited, the scene is then marked dirty
+    bool editor();
+
+    // every cascade's layer, left in eShaderReadOnlyOptimal by drawShadowMaps
+    vk::Image getShadowMap() const
+    {
+        return _sun._image;
+    }
+    vk::Extent2D getShadowMapResolution() const
+    {
+        return _sun._imageResolution;
+    }
 
   private:
     void calculateSun();
-
-    std::unordered_map<uint32_t, PointLight> _pointLightsMap;
+    // sorts the casters into the static and dynamic layers, true when the static layer has to be drawn again
+    bool classifyShadowCasters(const std::vector<std::pair<class Drawable *, struct DrawOption *>> &);
+    // view space box around every cluster, only changes with the projection
+    void buildClusterBounds(const glm::mat4 &projection, float nearPlane, float farPlane);
+    void assignClusterSlice(uint32_t slice);
+    void markPointLightDirty(uint32_t index);
+
+    enum ShadowLayer : uint8_t
+    {
+        eNoShadow,
+        eStaticShadow,
+        eDynamicShadow
+    };
+
+    struct ShadowCaster
+    {
+        glm::mat4 transform;
+        const class Model *model;
+        uint32_t stillFrames;
+        uint64_t lastSeen;
+        bool isStatic;
+    };
+
+    // lights reaching one depth slice's clusters, every slice is filled by its own job
+    struct ClusterSlice
+    {
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> lightIndices;
+        // per tile, offset into lightIndices and count
+        std::vector<glm::uvec2> ranges;
+    };
+
+    // dense, in the order the cluster buffers hold them
+    std::vector<PointLightCompact> _pointLights;
+    // handle to dense index and back
+    std::vector<uint32_t> _pointLightIndices;
+    std::vector<uint32_t> _pointLightHandles;
+    std::vector<uint32_t> _freePointLightHandles;
+    // per frame in flight, the [begin, end) range of _pointLights its cluster buffer hasn't received yet
+    std::vector<glm::uvec2> _dirtyPointLights;
     DirectionalLight _sun;
 
     float _timeOfDay{11.f};
@@ -121,6 +222,28 @@ class LightEnvironment
     glm::vec4 _ambientLighting{1.f, 1.f, 1.f, 0.2f};
 
     bool _updateShadowMap{true};
+
+    std::unordered_map<const struct DrawOption *, ShadowCaster> _shadowCasters;
+    // per render entry, the layer it's drawn into this frame
+    std::vector<ShadowLayer> _casterLayers;
+    uint32_t _dynamicCasterCount{0};
+    uint64_t _shadowFrame{0};
+
+    std::vector<uint32_t> _shadowVisibleIndices;
+    std::vector<uint32_t> _staticVisibleIndices;
+    std::vector<uint32_t> _dynamicVisibleIndices;
+
+    glm::mat4 _clusterProjection{0.f};
+    float _clusterNear{0.f};
+    float _clusterFar{0.f};
+    // view space depth every slice starts at, the last one being the far plane
+    std::vector<float> _clusterDepths;
+    std::vector<glm::vec3> _clusterMin;
+    std::vector<glm::vec3> _clusterMax;
+    // view space position, w is the range
+    std::vector<glm::vec4> _clusterLights;
+    std::vector<ClusterSlice> _clusterSlices;
+    bool _clusterOverflowFlag{false};
 };
 
 } // namespace cmx
@@ -0,0 +1,622 @@
+#include "cmx_render_graph.h"
+
+// cmx
+#include "cmx_debug_util.h"
+#include "cmx_device.h"
+#include "cmx_frame_info.h"
+
+// lib
+#include <spdlog/spdlog.h>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace cmx
+{
+
+namespace
+{
+
+struct UsageInfo
+{
+    vk::PipelineStageFlags stages;
+    vk::AccessFlags readAccess;
+    vk::AccessFlags writeAccess;
+    vk::ImageLayout layout;
+    vk::ImageUsageFlags imageUsage;
+};
+
+UsageInfo usageInfo(RenderGraph::Usage usage)
+{
+    switch (usage)
+    {
+    case RenderGraph::eColorAttachment:
+        return {vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::AccessFlagBits::eColorAttachmentRead,
+                vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eColorAttachmentOptimal,
+                vk::ImageUsageFlagBits::eColorAttachment};
+    case RenderGraph::eDepthAttachment:
+        return {vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+                vk::AccessFlagBits::eDepthStencilAttachmentRead, vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::ImageUsageFlagBits::eDepthStencilAttachment};
+    case RenderGraph::eSampled:
+        return {vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eShaderRead, {},
+                vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageUsageFlagBits::eSampled};
+    case RenderGraph::eTransferSource:
+        return {vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead, {},
+                vk::ImageLayout::eTransferSrcOptimal, vk::ImageUsageFlagBits::eTransferSrc};
+    case RenderGraph::eTransferDestination:
+    default:
+        return {vk::PipelineStageFlagBits::eTransfer, {}, vk::AccessFlagBits::eTransferWrite,
+                vk::ImageLayout::eTransferDstOptimal, vk::ImageUsageFlagBits::eTransferDst};
+    }
+}
+
+bool isAttachment(RenderGraph::Usage usage)
+{
+    return usage == RenderGraph::eColorAttachment || usage == RenderGraph::eDepthAttachment;
+}
+
+} // namespace
+
+RenderGraph::RenderGraph(Device &device) : _device{device}
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    if (!_freed)
+    {
+        spdlog::error("RenderGraph: forgot to free before deletion");
+    }
+}
+
+void RenderGraph::free()
+{
+    if (_freed)
+        return;
+
+    for (Pass &pass : _passes)
+    {
+        if (pass.framebuffer)
+        {
+            _device.device().destroyFramebuffer(pass.framebuffer);
+        }
+        if (pass.renderPass)
+        {
+            _device.device().destroyRenderPass(pass.renderPass);
+        }
+        pass.framebuffer = vk::Framebuffer{};
+        pass.renderPass = vk::RenderPass{};
+    }
+
+    for (Resource &resource : _resources)
+    {
+        if (resource.imported)
+            continue;
+
+        if (resource.imageView)
+        {
+            _device.device().destroyImageView(resource.imageView);
+        }
+        if (resource.image)
+        {
+            _device.device().destroyImage(resource.image);
+        }
+        resource.imageView = vk::ImageView{};
+        resource.image = vk::Image{};
+    }
+
+    for (Slot &slot : _slots)
+    {
+        _device.freeMemory(slot.memory);
+    }
+    _slots.clear();
+    _transientMemory = 0;
+    _unaliasedMemory = 0;
+
+    _compiled = false;
+    _freed = true;
+}
+
+void RenderGraph::reset()
+{
+    free();
+
+    _passes.clear();
+    _resources.clear();
+}
+
+uint32_t RenderGraph::importImage(const std::string &name, vk::Image image, const ImageDescription &description,
+                                  vk::ImageLayout layout)
+{
+    Resource resource{name, description, true, layout};
+    resource.image = image;
+    _resources.push_back(resource);
+    _compiled = false;
+
+    return uint32_t(_resources.size() - 1);
+}
+
+uint32_t RenderGraph::createImage(const std::string &name, const ImageDescription &description)
+{
+    _resources.push_back(Resource{name, description, false, vk::ImageLayout::eUndefined});
+    _compiled = false;
+
+    return uint32_t(_resources.size() - 1);
+}
+
+uint32_t RenderGraph::addPass(const std::string &name, Execute execute)
+{
+    return addPass(name, std::move(execute), false);
+}
+
+uint32_t RenderGraph::addRasterPass(const std::string &name, Execute execute)
+{
+    return addPass(name, std::move(execute), true);
+}
+
+uint32_t RenderGraph::addPass(const std::string &name, Execute execute, bool raster)
+{
+    Pass pass{};
+    pass.name = name;
+    pass.execute = std::move(execute);
+    pass.raster = raster;
+
+    _passes.push_back(std::move(pass));
+    _compiled = false;
+
+    return uint32_t(_passes.size() - 1);
+}
+
+void RenderGraph::setSideEffect(uint32_t pass)
+{
+    _passes.at(pass).sideEffect = true;
+}
+
+void RenderGraph::read(uint32_t pass, uint32_t resource, Usage usage)
+{
+    _passes.at(pass).accesses.push_back(
+        {resource, usage, false, vk::ImageLayout::eUndefined, vk::AttachmentLoadOp::eLoad, vk::ClearValue{}});
+    _compiled = false;
+}
+
+void RenderGraph::write(uint32_t pass, uint32_t resource, Usage usage, vk::ImageLayout finalLayout)
+{
+    _passes.at(pass).accesses.push_back({resource, usage, true, finalLayout, vk::AttachmentLoadOp::eDontCare, {}});
+    _compiled = false;
+}
+
+void RenderGraph::clear(uint32_t pass, uint32_t resource, vk::ClearValue clearValue)
+{
+    for (Access &access : _passes.at(pass).accesses)
+    {
+        if (access.resource == resource && access.write)
+        {
+            access.loadOp = vk::AttachmentLoadOp::eClear;
+            access.clearValue = clearValue;
+            _compiled = false;
+            return;
+        }
+    }
+
+    spdlog::error("RenderGraph: {0} clears {1} without writing it", _passes[pass].name, _resources[resource].name);
+}
+
+void RenderGraph::compile()
+{
+    free();
+    _freed = false;
+
+    cullPasses();
+    createTransients();
+    createRenderPasses();
+
+    _compiled = true;
+}
+
+void RenderGraph::cullPasses()
+{
+    for (Resource &resource : _resources)
+    {
+        resource.firstPass = RENDER_GRAPH_NONE;
+        resource.lastPass = 0;
+    }
+
+    // walking backwards, a pass is needed if it has side effects or writes something a later needed pass reads
+    std::vector<bool> needed(_resources.size(), false);
+    for (size_t i = _passes.size(); i-- > 0;)
+    {
+        Pass &pass = _passes[i];
+
+        bool kept = pass.sideEffect;
+        for (const Access &access : pass.accesses)
+        {
+            kept = kept || (access.write && needed[access.resource]);
+        }
+
+        pass.culled = !kept;
+        if (pass.culled)
+            continue;
+
+        for (const Access &access : pass.accesses)
+        {
+            if (!access.write)
+            {
+                needed[access.resource] = true;
+            }
+
+            Resource &resource = _resources[access.resource];
+            resource.firstPass = std::min(resource.firstPass, uint32_t(i));
+            resource.lastPass = std::max(resource.lastPass, uint32_t(i));
+        }
+    }
+}
+
+void RenderGraph::createTransients()
+{
+    std::vector<uint32_t> transients{};
+
+    for (uint32_t i = 0; i < uint32_t(_resources.size()); i++)
+    {
+        Resource &resource = _resources[i];
+        resource.state = State{};
+        resource.state.layout = resource.importLayout;
+        resource.slot = RENDER_GRAPH_NONE;
+
+        if (resource.imported || resource.firstPass == RENDER_GRAPH_NONE)
+            continue;
+
+        vk::ImageUsageFlags usage = resource.description.usage;
+        for (const Pass &pass : _passes)
+        {
+            for (const Access &access : pass.accesses)
+            {
+                if (access.resource == i && !pass.culled)
+                {
+                    usage |= usageInfo(access.usage).imageUsage;
+                }
+            }
+        }
+
+        vk::ImageCreateInfo imageInfo{};
+        imageInfo.imageType = vk::ImageType::e2D;
+        imageInfo.extent = vk::Extent3D{resource.description.extent.width, resource.description.extent.height, 1u};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = vk::SampleCountFlagBits::e1;
+        imageInfo.format = resource.description.format;
+        imageInfo.tiling = vk::ImageTiling::eOptimal;
+        imageInfo.initialLayout = vk::ImageLayout::eUndefined;
+        imageInfo.usage = usage;
+
+        if (_device.device().createImage(&imageInfo, nullptr, &resource.image) != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("RenderGraph: failed to create transient image " + resource.name);
+        }
+        DebugUtil::nameObject(resource.image, vk::ObjectType::eImage, resource.name);
+
+        resource.requirements = _device.device().getImageMemoryRequirements(resource.image);
+        _unaliasedMemory += resource.requirements.size;
+        transients.push_back(i);
+    }
+
+    // largest first, every slot is sized by its first resource and only takes the ones fitting in it
+    std::sort(transients.begin(), transients.end(), [this](uint32_t a, uint32_t b) {
+        return _resources[a].requirements.size > _resources[b].requirements.size;
+    });
+
+    for (uint32_t index : transients)
+    {
+        Resource &resource = _resources[index];
+
+        auto overlaps = [this, &resource](uint32_t other) {
+            return _resources[other].firstPass <= resource.lastPass && resource.firstPass <= _resources[other].lastPass;
+        };
+
+        for (uint32_t s = 0; s < uint32_t(_slots.size()); s++)
+        {
+            Slot &slot = _slots[s];
+            const bool fits = slot.size >= resource.requirements.size &&
+                              (slot.memoryTypeBits & resource.requirements.memoryTypeBits) != 0;
+            if (fits && std::none_of(slot.resources.begin(), slot.resources.end(), overlaps))
+            {
+                resource.slot = s;
+                break;
+            }
+        }
+
+        if (resource.slot == RENDER_GRAPH_NONE)
+        {
+            resource.slot = uint32_t(_slots.size());
+            _slots.emplace_back();
+            _slots.back().size = resource.requirements.size;
+        }
+
+        Slot &slot = _slots[resource.slot];
+        slot.memoryTypeBits &= resource.requirements.memoryTypeBits;
+        slot.resources.push_back(index);
+    }
+
+    for (Slot &slot : _slots)
+    {
+        vk::MemoryRequirements requirements{};
+        requirements.size = slot.size;
+        requirements.memoryTypeBits = slot.memoryTypeBits;
+        for (uint32_t index : slot.resources)
+        {
+            requirements.alignment = std::max(requirements.alignment, _resources[index].requirements.alignment);
+        }
+
+        slot.memory = _device.getAllocator().allocate(requirements, vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                      MemoryAllocator::eLongLived, true);
+        _transientMemory += slot.size;
+
+        for (uint32_t index : slot.resources)
+        {
+            Resource &resource = _resources[index];
+            _device.device().bindImageMemory(resource.image, slot.memory.memory, slot.memory.offset);
+
+            vk::ImageViewCreateInfo viewInfo{};
+            viewInfo.image = resource.image;
+            viewInfo.viewType = vk::ImageViewType::e2D;
+            viewInfo.format = resource.description.format;
+            viewInfo.subresourceRange = vk::ImageSubresourceRange{resource.description.aspect, 0, 1, 0, 1};
+
+            if (_device.device().createImageView(&viewInfo, nullptr, &resource.imageView) != vk::Result::eSuccess)
+            {
+                throw std::runtime_error("RenderGraph: failed to create transient image view " + resource.name);
+            }
+        }
+    }
+}
+
+void RenderGraph::createRenderPasses()
+{
+    for (Pass &pass : _passes)
+    {
+        if (!pass.raster || pass.culled)
+            continue;
+
+        std::vector<vk::AttachmentDescription> attachments{};
+        std::vector<vk::AttachmentReference> colorReferences{};
+        vk::AttachmentReference depthReference{};
+        std::vector<vk::ImageView> views{};
+        bool hasDepth{false};
+
+        pass.clearValues.clear();
+        pass.extent = vk::Extent2D{};
+
+        for (const Access &access : pass.accesses)
+        {
+            if (!access.write || !isAttachment(access.usage))
+                continue;
+
+            const Resource &resource = _resources[access.resource];
+            if (!resource.imageView)
+            {
+                throw std::runtime_error("RenderGraph: " + pass.name + " can only draw to transient images");
+            }
+
+            // reading the attachment it writes means drawing over what's there
+            const bool loads = std::any_of(pass.accesses.begin(), pass.accesses.end(), [&access](const Access &other) {
+                return !other.write && other.resource == access.resource && isAttachment(other.usage);
+            });
+
+            const vk::ImageLayout layout = usageInfo(access.usage).layout;
+
+            vk::AttachmentDescription attachment{};
+            attachment.format = resource.description.format;
+            attachment.samples = vk::SampleCountFlagBits::e1;
+            attachment.loadOp = loads ? vk::AttachmentLoadOp::eLoad : access.loadOp;
+            attachment.storeOp = vk::AttachmentStoreOp::eStore;
+            attachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
+            attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
+            // the graph's barriers do the transitions
+            attachment.initialLayout = layout;
+            attachment.finalLayout = layout;
+
+            const uint32_t attachmentIndex = uint32_t(attachments.size());
+            if (access.usage == eDepthAttachment)
+            {
+                depthReference = vk::AttachmentReference{attachmentIndex, layout};
+                hasDepth = true;
+            }
+            else
+            {
+                colorReferences.emplace_back(attachmentIndex, layout);
+            }
+
+            attachments.push_back(attachment);
+            views.push_back(resource.imageView);
+            pass.clearValues.push_back(access.clearValue);
+            pass.extent = resource.description.extent;
+        }
+
+        if (attachments.empty())
+        {
+            throw std::runtime_error("RenderGraph: raster pass " + pass.name + " writes no attachment");
+        }
+
+        vk::SubpassDescription subpass{};
+        subpass.pipelineBindPoint = vk::PipelineBindPoint::eGraphics;
+        subpass.colorAttachmentCount = uint32_t(colorReferences.size());
+        subpass.pColorAttachments = colorReferences.data();
+        subpass.pDepthStencilAttachment = hasDepth ? &depthReference : nullptr;
+
+        vk::RenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.attachmentCount = uint32_t(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+
+        if (_device.device().createRenderPass(&renderPassInfo, nullptr, &pass.renderPass) != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("RenderGraph: failed to create render pass for " + pass.name);
+        }
+        DebugUtil::nameObject(pass.renderPass, vk::ObjectType::eRenderPass, pass.name + " RenderPass");
+
+        vk::FramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.renderPass = pass.renderPass;
+        framebufferInfo.attachmentCount = uint32_t(views.size());
+        framebufferInfo.pAttachments = views.data();
+        framebufferInfo.width = pass.extent.width;
+        framebufferInfo.height = pass.extent.height;
+        framebufferInfo.layers = 1;
+
+        if (_device.device().createFramebuffer(&framebufferInfo, nullptr, &pass.framebuffer) != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("RenderGraph: failed to create framebuffer for " + pass.name);
+        }
+    }
+}
+
+void RenderGraph::execute(FrameInfo &frameInfo)
+{
+    if (!_compiled)
+    {
+        compile();
+    }
+
+    for (Resource &resource : _resources)
+    {
+        // transients start undefined, imported images where the previous frame left them
+        resource.state.touched = false;
+        resource.state.readStages = vk::PipelineStageFlags{};
+        resource.state.writeStages = vk::PipelineStageFlags{};
+        resource.state.writeAccess = vk::AccessFlags{};
+    }
+
+    for (const Pass &pass : _passes)
+    {
+        if (pass.culled)
+            continue;
+
+        recordBarriers(frameInfo.commandBuffer, pass);
+
+        if (!pass.raster)
+        {
+            pass.execute(frameInfo);
+            continue;
+        }
+
+        vk::RenderPassBeginInfo beginInfo{};
+        beginInfo.renderPass = pass.renderPass;
+        beginInfo.framebuffer = pass.framebuffer;
+        beginInfo.renderArea.extent = pass.extent;
+        beginInfo.clearValueCount = uint32_t(pass.clearValues.size());
+        beginInfo.pClearValues = pass.clearValues.data();
+
+        frameInfo.commandBuffer.beginRenderPass(&beginInfo, vk::SubpassContents::eInline);
+
+        vk::Viewport viewport{0.f, 0.f, float(pass.extent.width), float(pass.extent.height), 0.f, 1.f};
+        vk::Rect2D scissor{vk::Offset2D{0, 0}, pass.extent};
+        frameInfo.commandBuffer.setViewport(0, 1, &viewport);
+        frameInfo.commandBuffer.setScissor(0, 1, &scissor);
+
+        pass.execute(frameInfo);
+
+        frameInfo.commandBuffer.endRenderPass();
+    }
+}
+
+void RenderGraph::recordBarriers(vk::CommandBuffer commandBuffer, const Pass &pass)
+{
+    std::vector<vk::ImageMemoryBarrier> barriers{};
+    vk::PipelineStageFlags srcStages{};
+    vk::PipelineStageFlags dstStages{};
+
+    for (const Access &access : pass.accesses)
+    {
+        Resource &resource = _resources[access.resource];
+        State &state = resource.state;
+        const UsageInfo info = usageInfo(access.usage);
+
+        // images external passes write are transitioned by their own render passes
+        const bool external = access.write && !pass.raster;
+        const vk::ImageLayout layout = external ? state.layout : info.layout;
+
+        vk::PipelineStageFlags waitStages = state.writeStages;
+        vk::AccessFlags waitAccess = state.writeAccess;
+        if (access.write)
+        {
+            waitStages |= state.readStages;
+        }
+
+        // an alias may have used the memory earlier in the frame, or the previous frame left it in any state
+        if (!resource.imported && !state.touched)
+        {
+            state.layout = vk::ImageLayout::eUndefined;
+            waitStages |= _slots[resource.slot].stages;
+            waitAccess |= _slots[resource.slot].access;
+        }
+
+        const bool transition = !external && state.layout != layout;
+        if (resource.image && (transition || waitStages))
+        {
+            vk::ImageMemoryBarrier barrier{};
+            barrier.oldLayout = transition ? state.layout : layout;
+            barrier.newLayout = layout;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = resource.image;
+            barrier.subresourceRange = vk::ImageSubresourceRange{resource.description.aspect, 0,
+                                                                 VK_REMAINING_MIP_LEVELS, 0,
+                                                                 VK_REMAINING_ARRAY_LAYERS};
+            barrier.srcAccessMask = waitAccess;
+            barrier.dstAccessMask = info.readAccess | info.writeAccess;
+
+            barriers.push_back(barrier);
+            srcStages |= waitStages ? waitStages : vk::PipelineStageFlags{vk::PipelineStageFlagBits::eTopOfPipe};
+            dstStages |= info.stages;
+        }
+
+        state.touched = true;
+        state.layout = external && access.finalLayout != vk::ImageLayout::eUndefined ? access.finalLayout : layout;
+        if (access.write)
+        {
+            state.writeStages = info.stages;
+            state.writeAccess = info.writeAccess;
+            state.readStages = vk::PipelineStageFlags{};
+        }
+        else
+        {
+            state.readStages |= info.stages;
+        }
+
+        if (resource.slot != RENDER_GRAPH_NONE)
+        {
+            Slot &slot = _slots[resource.slot];
+            slot.stages = access.write ? info.stages : slot.stages | info.stages;
+            slot.access = access.write ? info.writeAccess : slot.access;
+        }
+    }
+
+    if (!barriers.empty())
+    {
+        commandBuffer.pipelineBarrier(srcStages, dstStages, {}, 0, nullptr, 0, nullptr, uint32_t(barriers.size()),
+                                      barriers.data());
+    }
+}
+
+vk::Image RenderGraph::getImage(uint32_t resource) const
+{
+    return _resources.at(resource).image;
+}
+
+vk::ImageView RenderGraph::getImageView(uint32_t resource) const
+{
+    return _resources.at(resource).imageView;
+}
+
+vk::RenderPass RenderGraph::getRenderPass(uint32_t pass) const
+{
+    return _passes.at(pass).renderPass;
+}
+
+bool RenderGraph::isCulled(uint32_t pass) const
+{
+    return _passes.at(pass).culled;
+}
+
+} // namespace cmx
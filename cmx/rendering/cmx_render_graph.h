@@ -0,0 +1,190 @@
+#ifndef CMX_RENDER_GRAPH
+#define CMX_RENDER_GRAPH
+
+// cmx
+#include "cmx_memory_allocator.h"
+
+// lib
+#include <vulkan/vulkan.hpp>
+
+// std
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define RENDER_GRAPH_NONE UINT32_MAX
+
+namespace cmx
+{
+
+// passes declare the images they read and write, compile() culls the passes nothing needs, creates the transient
+// images, sharing memory between those whose lifetimes don't overlap, and the render passes of the passes it owns.
+// execute() then records every pass in declaration order, preceded by the barriers its accesses need.
+// Built once and compiled again when what it's declared from changes, resources and passes are indices
+class RenderGraph
+{
+  public:
+    // sets the stage, access and layout a barrier waits for or transitions to
+    enum Usage
+    {
+        eColorAttachment,
+        eDepthAttachment,
+        // fragment shader reads
+        eSampled,
+        eTransferSource,
+        eTransferDestination
+    };
+
+    struct ImageDescription
+    {
+        vk::Format format{vk::Format::eUndefined};
+        vk::Extent2D extent{};
+        vk::ImageAspectFlags aspect{vk::ImageAspectFlagBits::eColor};
+        // added to whatever the declared usages need, transients only
+        vk::ImageUsageFlags usage{};
+    };
+
+    using Execute = std::function<void(struct FrameInfo &)>;
+
+    RenderGraph(class Device &);
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph &) = delete;
+    RenderGraph &operator=(const RenderGraph &) = delete;
+
+    // releases the transient images and the render passes, the GPU must be done with them
+    void free();
+    // forgets every pass and resource, free() included
+    void reset();
+
+    // owned elsewhere and in layout when the frame starts, a null image is only tracked to order and cull passes
+    uint32_t importImage(const std::string &name, vk::Image, const ImageDescription &, vk::ImageLayout);
+    // lives for the frame only, its contents are undefined when its first pass starts
+    uint32_t createImage(const std::string &name, const ImageDescription &);
+
+    // records its own render passes, if any, the graph only places barriers around it
+    uint32_t addPass(const std::string &name, Execute);
+    // the graph creates its render pass out of the attachments it writes and begins it around execute
+    uint32_t addRasterPass(const std::string &name, Execute);
+    // kept even if nothing reads what it writes, for passes drawing to the swap chain
+    void setSideEffect(uint32_t pass);
+
+    void read(uint32_t pass, uint32_t resource, Usage);
+    // finalLayout is the layout an external pass's render pass leaves the image in, the graph doesn't transition
+    // images external passes write, it only orders them. Raster passes write their attachments in the usage's layout
+    void write(uint32_t pass, uint32_t resource, Usage, vk::ImageLayout finalLayout = vk::ImageLayout::eUndefined);
+    // raster passes only, the attachment is cleared instead of starting undefined
+    void clear(uint32_t pass, uint32_t resource, vk::ClearValue);
+
+    void compile();
+    bool isCompiled() const
+    {
+        return _compiled;
+    }
+    void execute(struct FrameInfo &);
+
+    // compiled resources only, null for culled transients
+    vk::Image getImage(uint32_t resource) const;
+    vk::ImageView getImageView(uint32_t resource) const;
+    vk::RenderPass getRenderPass(uint32_t pass) const;
+    bool isCulled(uint32_t pass) const;
+
+    // transient memory actually allocated, and what it would take without aliasing
+    vk::DeviceSize getTransientMemory() const
+    {
+        return _transientMemory;
+    }
+    vk::DeviceSize getUnaliasedMemory() const
+    {
+        return _unaliasedMemory;
+    }
+
+  private:
+    struct Access
+    {
+        uint32_t resource;
+        Usage usage;
+        bool write;
+        vk::ImageLayout finalLayout;
+        vk::AttachmentLoadOp loadOp;
+        vk::ClearValue clearValue;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        Execute execute;
+        bool raster;
+        bool sideEffect{false};
+        bool culled{false};
+        std::vector<Access> accesses{};
+
+        vk::RenderPass renderPass{};
+        vk::Framebuffer framebuffer{};
+        vk::Extent2D extent{};
+        std::vector<vk::ClearValue> clearValues{};
+    };
+
+    // where the last accesses left an image, what the next barrier starts from
+    struct State
+    {
+        vk::ImageLayout layout{vk::ImageLayout::eUndefined};
+        vk::PipelineStageFlags writeStages{};
+        vk::AccessFlags writeAccess{};
+        // reads since the last write, a write has to wait for them
+        vk::PipelineStageFlags readStages{};
+        bool touched{false};
+    };
+
+    struct Resource
+    {
+        std::string name;
+        ImageDescription description;
+        bool imported;
+        vk::ImageLayout importLayout;
+
+        vk::Image image{};
+        vk::ImageView imageView{};
+        // transients sharing memory share a slot
+        uint32_t slot{RENDER_GRAPH_NONE};
+        // first and last pass using it, in declaration order
+        uint32_t firstPass{RENDER_GRAPH_NONE};
+        uint32_t lastPass{0};
+        vk::MemoryRequirements requirements{};
+
+        State state{};
+    };
+
+    // memory shared by transients, and the last accesses of whichever of them used it last
+    struct Slot
+    {
+        Allocation memory{};
+        vk::DeviceSize size{0};
+        uint32_t memoryTypeBits{~0u};
+        std::vector<uint32_t> resources{};
+        vk::PipelineStageFlags stages{};
+        vk::AccessFlags access{};
+    };
+
+    uint32_t addPass(const std::string &name, Execute, bool raster);
+    void cullPasses();
+    void createTransients();
+    void createRenderPasses();
+    void recordBarriers(vk::CommandBuffer, const Pass &);
+
+    class Device &_device;
+
+    std::vector<Pass> _passes{};
+    std::vector<Resource> _resources{};
+    std::vector<Slot> _slots{};
+    vk::DeviceSize _transientMemory{0};
+    vk::DeviceSize _unaliasedMemory{0};
+
+    bool _compiled{false};
+    bool _freed{true};
+};
+
+} // namespace cmx
+
+#endif
@@ -0,0 +1,222 @@
+#include "cmx_render_queue.h"
+
+// cmx
+#include "cmx_drawable.h"
+#include "cmx_material.h"
+#include "cmx_model.h"
+#include "cmx_texture.h"
+
+// lib
+#include <spdlog/spdlog.h>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace cmx
+{
+
+BindStats &BindStats::operator+=(const BindStats &other)
+{
+    pipelines += other.pipelines;
+    descriptorSets += other.descriptorSets;
+    vertexBuffers += other.vertexBuffers;
+    draws += other.draws;
+    instancedDraws += other.instancedDraws;
+
+    return *this;
+}
+
+uint64_t RenderQueue::makeKey(Pass pass, uint32_t pipeline, uint32_t textureSet, uint32_t model, uint32_t depth)
+{
+    uint64_t key = uint64_t(pass);
+    key = (key << PIPELINE_BITS) | std::min(pipeline, (1u << PIPELINE_BITS) - 1);
+    key = (key << TEXTURE_SET_BITS) | std::min(textureSet, (1u << TEXTURE_SET_BITS) - 1);
+    key = (key << MODEL_BITS) | std::min(model, (1u << MODEL_BITS) - 1);
+    key = (key << DEPTH_BITS) | std::min(depth, (1u << DEPTH_BITS) - 1);
+
+    return key;
+}
+
+void RenderQueue::add(Drawable *drawable, DrawOption *drawOption)
+{
+    if (!_entryIndices.emplace(drawOption, uint32_t(_entries.size())).second)
+    {
+        spdlog::warn("RenderQueue: draw option added twice, ignoring");
+        return;
+    }
+
+    _entries.push_back({drawable, drawOption});
+}
+
+void RenderQueue::remove(const DrawOption *drawOption)
+{
+    auto it = _entryIndices.find(drawOption);
+    if (it == _entryIndices.end())
+        return;
+
+    const uint32_t index = it->second;
+    _entryIndices.erase(it);
+
+    if (index != _entries.size() - 1)
+    {
+        _entries[index] = _entries.back();
+        _entryIndices[_entries[index].second] = index;
+    }
+    _entries.pop_back();
+}
+
+void RenderQueue::sort(const std::vector<uint32_t> &visibleIndices, const CullingBounds &bounds,
+                       const glm::mat4 &view, float farPlane)
+{
+    _candidates.clear();
+    for (uint32_t index : visibleIndices)
+    {
+        auto &[drawable, drawOption] = _entries[index];
+        if (!drawable->isVisible() || !drawable->canRender(drawOption))
+            continue;
+
+        // recording threads can't allocate descriptor sets
+        if (!drawOption->material->usesBindlessTextures())
+        {
+            for (Texture *texture : drawOption->textures)
+            {
+                texture->prepareDescriptorSet();
+            }
+        }
+        _candidates.push_back(index);
+    }
+
+    rankPipelines();
+    _textureSetRanks.clear();
+    _modelRanks.clear();
+
+    // view space z of the bounding sphere's center, +z being forward
+    const glm::vec3 forward{view[0][2], view[1][2], view[2][2]};
+    const float depthScale = float((1u << DEPTH_BITS) - 1) / std::max(farPlane, 1e-3f);
+
+    _sortedKeys.clear();
+    _sortedIndices.clear();
+    for (uint32_t index : _candidates)
+    {
+        const DrawOption *drawOption = _entries[index].second;
+
+        uint32_t depth = 0;
+        if (std::isfinite(bounds.radius[index]))
+        {
+            const float z = forward.x * bounds.x[index] + forward.y * bounds.y[index] +
+                            forward.z * bounds.z[index] + view[3][2];
+            depth = uint32_t(std::clamp(z * depthScale, 0.f, float((1u << DEPTH_BITS) - 1)));
+        }
+
+        const Pass pass = drawOption->material->isTransparent() ? eTransparent : eOpaque;
+        if (pass == eTransparent)
+        {
+            // back to front within a state group
+            depth = ((1u << DEPTH_BITS) - 1) - depth;
+        }
+
+        _sortedKeys.push_back(makeKey(pass, _pipelineRanks[drawOption->material],
+                                      rankTextureSet(drawOption->textures), rankModel(drawOption->model), depth));
+        _sortedIndices.push_back(index);
+    }
+
+    radixSort(_sortedKeys, _sortedIndices, _scratchKeys, _scratchIndices);
+}
+
+size_t RenderQueue::TextureSetHash::operator()(const std::vector<Texture *> &textures) const
+{
+    size_t hash = textures.size();
+    for (Texture *texture : textures)
+    {
+        hash ^= std::hash<Texture *>{}(texture) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+
+    return hash;
+}
+
+void RenderQueue::rankPipelines()
+{
+    _pipelineOrder.clear();
+    _pipelineRanks.clear();
+
+    for (uint32_t index : _candidates)
+    {
+        Material *material = _entries[index].second->material;
+        if (_pipelineRanks.emplace(material, 0).second)
+        {
+            _pipelineOrder.push_back(material);
+        }
+    }
+
+    // clones share their id, the pointer keeps their pipelines apart
+    std::sort(_pipelineOrder.begin(), _pipelineOrder.end(), [](const Material *a, const Material *b) {
+        return a->getID() != b->getID() ? a->getID() < b->getID() : std::less<const Material *>{}(a, b);
+    });
+
+    for (uint32_t rank = 0; rank < _pipelineOrder.size(); rank++)
+    {
+        _pipelineRanks[_pipelineOrder[rank]] = rank;
+    }
+}
+
+uint32_t RenderQueue::rankTextureSet(const std::vector<Texture *> &textures)
+{
+    return _textureSetRanks.emplace(textures, uint32_t(_textureSetRanks.size())).first->second;
+}
+
+uint32_t RenderQueue::rankModel(const Model *model)
+{
+    return _modelRanks.emplace(model, uint32_t(_modelRanks.size())).first->second;
+}
+
+void radixSort(std::vector<uint64_t> &keys, std::vector<uint32_t> &values, std::vector<uint64_t> &scratchKeys,
+               std::vector<uint32_t> &scratchValues)
+{
+    const size_t count = keys.size();
+    if (count < 2)
+        return;
+
+    scratchKeys.resize(count);
+    scratchValues.resize(count);
+
+    // every digit's histogram in a single read
+    uint32_t histograms[8][256] = {};
+    for (uint64_t key : keys)
+    {
+        for (int digit = 0; digit < 8; digit++)
+        {
+            histograms[digit][(key >> (digit * 8)) & 0xff]++;
+        }
+    }
+
+    for (int digit = 0; digit < 8; digit++)
+    {
+        uint32_t *histogram = histograms[digit];
+
+        // every key shares this digit, the pass wouldn't move anything
+        if (histogram[(keys[0] >> (digit * 8)) & 0xff] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (int bucket = 0; bucket < 256; bucket++)
+        {
+            const uint32_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint32_t destination = histogram[(keys[i] >> (digit * 8)) & 0xff]++;
+            scratchKeys[destination] = keys[i];
+            scratchValues[destination] = values[i];
+        }
+
+        keys.swap(scratchKeys);
+        values.swap(scratchValues);
+    }
+}
+
+} // namespace cmx
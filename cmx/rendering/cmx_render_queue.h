@@ -0,0 +1,112 @@
+#ifndef CMX_RENDER_QUEUE
+#define CMX_RENDER_QUEUE
+
+// cmx
+#include "cmx_culling.h"
+
+// lib
+#include <glm/ext/matrix_float4x4.hpp>
+
+// std
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace cmx
+{
+
+struct BindStats
+{
+    uint32_t pipelines{0};
+    uint32_t descriptorSets{0};
+    uint32_t vertexBuffers{0};
+    uint32_t draws{0};
+    uint32_t instancedDraws{0};
+
+    BindStats &operator+=(const BindStats &);
+};
+
+// flat list of every registered draw, sorted each frame by a 64 bit key, most significant bits first:
+// pass (2) | pipeline (14) | texture set (16) | model (16) | depth (16)
+// so state changes only happen when the leading fields change, and draws sharing all state are contiguous
+class RenderQueue
+{
+  public:
+    enum Pass
+    {
+        eOpaque,
+        eTransparent
+    };
+
+    static constexpr uint32_t PASS_BITS = 2;
+    static constexpr uint32_t PIPELINE_BITS = 14;
+    static constexpr uint32_t TEXTURE_SET_BITS = 16;
+    static constexpr uint32_t MODEL_BITS = 16;
+    static constexpr uint32_t DEPTH_BITS = 16;
+
+    static uint64_t makeKey(Pass, uint32_t pipeline, uint32_t textureSet, uint32_t model, uint32_t depth);
+    // the key without its depth, equal for draws sharing every bound state
+    static uint64_t stateOf(uint64_t key)
+    {
+        return key >> DEPTH_BITS;
+    }
+
+    void add(class Drawable *, struct DrawOption *);
+    // O(1), the last entry takes the removed one's place
+    void remove(const struct DrawOption *);
+
+    // keys the renderable draws among visibleIndices and sorts them, depth is view space z over the far plane
+    void sort(const std::vector<uint32_t> &visibleIndices, const CullingBounds &, const glm::mat4 &view,
+              float farPlane);
+
+    // getters and setters :: begin
+    const std::vector<std::pair<class Drawable *, struct DrawOption *>> &getEntries() const
+    {
+        return _entries;
+    }
+
+    // entry indices in key order, filled by sort
+    const std::vector<uint32_t> &getSortedIndices() const
+    {
+        return _sortedIndices;
+    }
+
+    const std::vector<uint64_t> &getSortedKeys() const
+    {
+        return _sortedKeys;
+    }
+    // getters and setters :: end
+
+  private:
+    struct TextureSetHash
+    {
+        size_t operator()(const std::vector<class Texture *> &) const;
+    };
+
+    // dense per frame ranks, pipelines are ranked in material id order so the draw order matches older scenes
+    void rankPipelines();
+    uint32_t rankTextureSet(const std::vector<class Texture *> &);
+    uint32_t rankModel(const class Model *);
+
+    std::vector<std::pair<class Drawable *, struct DrawOption *>> _entries;
+    std::unordered_map<const struct DrawOption *, uint32_t> _entryIndices;
+
+    std::vector<uint32_t> _candidates;
+    std::vector<class Material *> _pipelineOrder;
+    std::unordered_map<const class Material *, uint32_t> _pipelineRanks;
+    std::unordered_map<std::vector<class Texture *>, uint32_t, TextureSetHash> _textureSetRanks;
+    std::unordered_map<const class Model *, uint32_t> _modelRanks;
+
+    std::vector<uint64_t> _sortedKeys;
+    std::vector<uint32_t> _sortedIndices;
+    std::vector<uint64_t> _scratchKeys;
+    std::vector<uint32_t> _scratchIndices;
+};
+
+// least significant digit first radix sort of keys, values follow their key, stable
+void radixSort(std::vector<uint64_t> &keys, std::vector<uint32_t> &values, std::vector<uint64_t> &scratchKeys,
+               std::vector<uint32_t> &scratchValues);
+
+} // namespace cmx
+
+#endif
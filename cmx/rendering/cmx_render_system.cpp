@@ -10,9 +10,12 @@
 #include "cmx_frame_info.h"
 #include "cmx_g_buffer.h"
 #include "cmx_game.h"
+#include "cmx_gpu_profiler.h"
+#include "cmx_job_system.h"
 #include "cmx_light_environment.h"
 #include "cmx_renderer.h"
 #include "cmx_swap_chain.h"
+#include "cmx_upload_manager.h"
 
 // lib
 #include <imgui.h>
@@ -20,6 +23,8 @@
 #include <vulkan/vulkan_core.h>
 
 // std
+#include <algorithm>
+#include <array>
 #include <cstdlib>
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_handles.hpp>
@@ -67,8 +72,10 @@ RenderSystem::RenderSystem()
 #endif
     _device = std::make_unique<Device>(*_window);
     _renderer = std::make_unique<Renderer>(*_window, *_device.get());
+    _profiler = std::make_unique<GpuProfiler>(*_device.get());
 
     _uboBuffers = std::vector<std::unique_ptr<Buffer>>{SwapChain::MAX_FRAMES_IN_FLIGHT};
+    _clusterBuffers = std::vector<std::unique_ptr<Buffer>>{SwapChain::MAX_FRAMES_IN_FLIGHT};
 
     _globalDescriptorSets = std::vector<vk::DescriptorSet>{SwapChain::MAX_FRAMES_IN_FLIGHT};
     _samplerDescriptorPool = DescriptorPool::Builder(*_device.get())
@@ -76,10 +83,6 @@ RenderSystem::RenderSystem()
                                  .addPoolSize(vk::DescriptorType::eCombinedImageSampler, 100)
                                  .build();
 
-    _globalSetLayout = DescriptorSetLayout::Builder(*_device.get())
-                           .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eAllGraphics)
-                           .build();
-
     _samplerDescriptorSetLayout =
         DescriptorSetLayout::Builder(*_device.get())
             .addBinding(0, vk::DescriptorType::eCombinedImageSampler, {vk::ShaderStageFlagBits::eFragment})
@@ -88,6 +91,10 @@ RenderSystem::RenderSystem()
     _samplerDescriptorSets.reserve(MAX_SAMPLER_SETS);
 
     initializeUbo();
+    initializeInstanceBuffers();
+    initializeFrameData();
+    initializeBindlessTable();
+    initializeRecordingPools();
 }
 
 RenderSystem::~RenderSystem()
@@ -98,28 +105,158 @@ void RenderSystem::initializeUbo()
 {
     for (size_t i = 0; i < _uboBuffers.size(); i++)
     {
-        _uboBuffers[i] =
-            std::make_unique<Buffer>(*_device.get(), sizeof(GlobalUbo), 1, vk::BufferUsageFlagBits::eUniformBuffer,
-                                     vk::MemoryPropertyFlagBits::eHostVisible);
+        _uboBuffers[i] = std::make_unique<Buffer>(
+            *_device.get(), sizeof(GlobalUbo), 1, vk::BufferUsageFlagBits::eUniformBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
         _uboBuffers[i]->map();
+
+        _clusterBuffers[i] = std::make_unique<Buffer>(
+            *_device.get(), sizeof(ClusterBuffer), 1, vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        _clusterBuffers[i]->map();
     }
 
+    // global and per draw data sets
     _globalPool = DescriptorPool::Builder(*_device.get())
-                      .setMaxSets(SwapChain::MAX_FRAMES_IN_FLIGHT)
+                      .setMaxSets(SwapChain::MAX_FRAMES_IN_FLIGHT * 2)
                       .addPoolSize(vk::DescriptorType::eUniformBuffer, SwapChain::MAX_FRAMES_IN_FLIGHT)
+                      .addPoolSize(vk::DescriptorType::eStorageBuffer, SwapChain::MAX_FRAMES_IN_FLIGHT)
+                      .addPoolSize(vk::DescriptorType::eUniformBufferDynamic, SwapChain::MAX_FRAMES_IN_FLIGHT)
                       .build();
 
     _globalSetLayout = DescriptorSetLayout::Builder(*_device.get())
                            .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eAllGraphics)
+                           .addBinding(1, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
                            .build();
 
     for (size_t i = 0; i < _globalDescriptorSets.size(); i++)
     {
         auto bufferInfo = _uboBuffers[i]->descriptorInfo();
-        DescriptorWriter(*_globalSetLayout, *_globalPool).writeBuffer(0, &bufferInfo).build(_globalDescriptorSets[i]);
+        auto clusterInfo = _clusterBuffers[i]->descriptorInfo();
+        DescriptorWriter(*_globalSetLayout, *_globalPool)
+            .writeBuffer(0, &bufferInfo)
+            .writeBuffer(1, &clusterInfo)
+            .build(_globalDescriptorSets[i]);
+    }
+}
+
+void RenderSystem::initializeInstanceBuffers()
+{
+    _instanceBuffers = std::vector<std::unique_ptr<Buffer>>{SwapChain::MAX_FRAMES_IN_FLIGHT};
+
+    for (size_t i = 0; i < _instanceBuffers.size(); i++)
+    {
+        _instanceBuffers[i] = std::make_unique<Buffer>(
+            *_device.get(), sizeof(Model::Instance), MAX_INSTANCES, vk::BufferUsageFlagBits::eVertexBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        _instanceBuffers[i]->map();
+    }
+}
+
+void RenderSystem::initializeFrameData()
+{
+    _frameDataAlignment = std::max<vk::DeviceSize>(_device->_properties.limits.minUniformBufferOffsetAlignment, 1);
+
+    _objectSetLayout =
+        DescriptorSetLayout::Builder(*_device.get())
+            .addBinding(0, vk::DescriptorType::eUniformBufferDynamic, vk::ShaderStageFlagBits::eAllGraphics)
+            .build();
+
+    _frameDataBuffers = std::vector<std::unique_ptr<Buffer>>{SwapChain::MAX_FRAMES_IN_FLIGHT};
+    _objectDescriptorSets = std::vector<vk::DescriptorSet>{SwapChain::MAX_FRAMES_IN_FLIGHT};
+
+    for (size_t i = 0; i < _frameDataBuffers.size(); i++)
+    {
+        _frameDataBuffers[i] = std::make_unique<Buffer>(
+            *_device.get(), FRAME_DATA_SIZE, 1,
+            vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        _frameDataBuffers[i]->map();
+
+        // the dynamic offset moves this window over the whole ring
+        auto bufferInfo = _frameDataBuffers[i]->descriptorInfo(sizeof(ObjectData), 0);
+        DescriptorWriter(*_objectSetLayout, *_globalPool).writeBuffer(0, &bufferInfo).build(_objectDescriptorSets[i]);
+    }
+}
+
+void RenderSystem::initializeBindlessTable()
+{
+    // slots are written while frames using other slots are in flight, and unwritten slots are never read
+    _bindlessSetLayout = DescriptorSetLayout::Builder(*_device.get())
+                             .addBinding(0, vk::DescriptorType::eCombinedImageSampler,
+                                         vk::ShaderStageFlagBits::eFragment, MAX_BINDLESS_TEXTURES,
+                                         vk::DescriptorBindingFlagBits::ePartiallyBound |
+                                             vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+                                             vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending)
+                             .build();
+
+    _bindlessPool = DescriptorPool::Builder(*_device.get())
+                        .setMaxSets(1)
+                        .setPoolFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind)
+                        .addPoolSize(vk::DescriptorType::eCombinedImageSampler, MAX_BINDLESS_TEXTURES)
+                        .build();
+
+    vk::DescriptorSetAllocateInfo setAllocInfo{};
+    setAllocInfo.descriptorPool = _bindlessPool->getDescriptorPool();
+    setAllocInfo.descriptorSetCount = 1;
+    setAllocInfo.pSetLayouts = &(_bindlessSetLayout->getDescriptorSetLayout());
+
+    if (_device->device().allocateDescriptorSets(&setAllocInfo, &_bindlessSet) != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("RenderSystem: failed to allocate bindless texture table");
     }
 }
 
+void RenderSystem::initializeRecordingPools()
+{
+    _recordingSlotCount = JobSystem::getInstance().getWorkerCount() + 1;
+
+    _recordingPools.resize(SwapChain::MAX_FRAMES_IN_FLIGHT * _recordingSlotCount);
+    _secondaryCommandBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT * eRecordedPassCount * _recordingSlotCount);
+
+    vk::CommandPoolCreateInfo poolInfo{};
+    poolInfo.queueFamilyIndex = _device->findPhysicalQueueFamilies().graphicsFamily;
+    poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+
+    for (size_t frame = 0; frame < SwapChain::MAX_FRAMES_IN_FLIGHT; frame++)
+    {
+        for (size_t slot = 0; slot < _recordingSlotCount; slot++)
+        {
+            vk::CommandPool &pool = _recordingPools[frame * _recordingSlotCount + slot];
+            if (_device->device().createCommandPool(&poolInfo, nullptr, &pool) != vk::Result::eSuccess)
+            {
+                throw std::runtime_error("RenderSystem: failed to create recording command pool");
+            }
+
+            vk::CommandBufferAllocateInfo allocInfo{};
+            allocInfo.commandPool = pool;
+            allocInfo.level = vk::CommandBufferLevel::eSecondary;
+            allocInfo.commandBufferCount = 1;
+
+            for (size_t pass = 0; pass < eRecordedPassCount; pass++)
+            {
+                const size_t index = (frame * eRecordedPassCount + pass) * _recordingSlotCount + slot;
+                if (_device->device().allocateCommandBuffers(&allocInfo, &_secondaryCommandBuffers[index]) !=
+                    vk::Result::eSuccess)
+                {
+                    throw std::runtime_error("RenderSystem: failed to allocate secondary command buffers");
+                }
+            }
+        }
+    }
+}
+
+void RenderSystem::freeRecordingPools()
+{
+    // destroying a pool frees its command buffers
+    for (vk::CommandPool pool : _recordingPools)
+    {
+        _device->device().destroyCommandPool(pool);
+    }
+    _recordingPools.clear();
+    _secondaryCommandBuffers.clear();
+}
+
 void RenderSystem::closeWindow()
 {
     spdlog::info("global release");
@@ -130,7 +267,15 @@ void RenderSystem::closeWindow()
     _gBuffer->free(_device.get());
     _globalPool->free();
     _samplerDescriptorPool->free();
+    _bindlessPool->free();
     _device->device().destroyDescriptorSetLayout(_samplerDescriptorSetLayout->getDescriptorSetLayout());
+    _device->device().destroyDescriptorSetLayout(_bindlessSetLayout->getDescriptorSetLayout());
+    _device->device().destroyDescriptorSetLayout(_objectSetLayout->getDescriptorSetLayout());
+
+    freeRecordingPools();
+
+    _profiler->free();
+    _profiler.reset();
 
     _renderer->free();
     delete _renderer.release();
@@ -141,8 +286,32 @@ void RenderSystem::closeWindow()
     }
     _uboBuffers.clear();
 
+    for (auto &buffer : _clusterBuffers)
+    {
+        buffer->free();
+    }
+    _clusterBuffers.clear();
+
+    for (auto &buffer : _instanceBuffers)
+    {
+        buffer->free();
+    }
+    _instanceBuffers.clear();
+
+    for (auto &buffer : _frameDataBuffers)
+    {
+        buffer->free();
+    }
+    _frameDataBuffers.clear();
+
     delete _device.release();
-    delete _window;
+    // the game owns the window
+    _window = nullptr;
+}
+
+void RenderSystem::readLastFrame(std::vector<uint8_t> &pixels, vk::Extent2D &extent)
+{
+    _renderer->readLastFrame(pixels, extent);
 }
 
 size_t RenderSystem::createSamplerDescriptor(vk::ImageView imageView, vk::Sampler sampler)
@@ -194,6 +363,52 @@ vk::DescriptorSet &RenderSystem::getSamplerDescriptorSet(size_t index)
     return _samplerDescriptorSets[index];
 }
 
+uint32_t RenderSystem::registerBindlessTexture(vk::ImageView imageView, vk::Sampler sampler)
+{
+    uint32_t index;
+    if (!_freeBindlessIndices.empty())
+    {
+        index = _freeBindlessIndices.back();
+        _freeBindlessIndices.pop_back();
+    }
+    else if (_bindlessCount < MAX_BINDLESS_TEXTURES)
+    {
+        index = _bindlessCount++;
+    }
+    else
+    {
+        throw std::runtime_error("RenderSystem: bindless texture table is full");
+    }
+
+    vk::DescriptorImageInfo imageInfo{};
+    imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    imageInfo.imageView = imageView;
+    imageInfo.sampler = sampler;
+
+    vk::WriteDescriptorSet descriptorWrite{};
+    descriptorWrite.dstSet = _bindlessSet;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.dstArrayElement = index;
+    descriptorWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+
+    _device->device().updateDescriptorSets(1, &descriptorWrite, 0, nullptr);
+
+    return index;
+}
+
+void RenderSystem::freeBindlessTexture(uint32_t index)
+{
+    _freeBindlessIndices.push_back(index);
+}
+
+void RenderSystem::bindBindlessTextures(FrameInfo *frameInfo, vk::PipelineLayout pipelineLayout, uint32_t set) const
+{
+    frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, set, 1,
+                                                &_bindlessSet, 0, nullptr);
+}
+
 void RenderSystem::checkAspectRatio(Camera *camera)
 {
     vk::Extent2D newResolution{};
@@ -229,7 +444,7 @@ void RenderSystem::checkAspectRatio(Camera *camera)
     freeSamplerDescriptor(_samplerDescriptorSetID);
     _device->device().destroyImageView(_imageView);
     _device->device().destroyImage(_image);
-    _device->device().freeMemory(_imageMemory);
+    _device->freeMemory(_imageMemory);
 
     createTexture();
 }
@@ -238,10 +453,24 @@ FrameInfo *RenderSystem::beginCommandBuffer()
 {
     FrameInfo *frameInfo{nullptr};
 
+    // uploads recorded since last frame start copying, finished ones make their assets drawable
+    _device->getUploadManager().update();
+
     if ((_commandBuffer = _renderer->beginFrame()))
     {
         int frameIndex = _renderer->getFrameIndex();
         frameInfo = new FrameInfo{frameIndex, _commandBuffer, _globalDescriptorSets[frameIndex]};
+
+        _frameIndex = frameIndex;
+        _instanceCount.store(0);
+        _frameDataOffset.store(0);
+
+        for (size_t slot = 0; slot < _recordingSlotCount; slot++)
+        {
+            _device->device().resetCommandPool(_recordingPools[frameIndex * _recordingSlotCount + slot]);
+        }
+
+        _profiler->beginFrame(_commandBuffer, uint32_t(frameIndex));
     }
 
     return frameInfo;
@@ -312,11 +541,48 @@ void RenderSystem::endPostProcess(struct FrameInfo *frameInfo) const
 #endif
 
     _renderer->endSwapChainRenderPass(frameInfo->commandBuffer);
+    _profiler->endFrame(frameInfo->commandBuffer);
     _renderer->endFrame();
 
     _device->device().waitIdle();
 }
 
+void RenderSystem::drawLoadingFrame(float progress)
+{
+    FrameInfo *frameInfo = beginCommandBuffer();
+    if (!frameInfo)
+        return;
+
+    vk::CommandBuffer commandBuffer = frameInfo->commandBuffer;
+    _renderer->beginSwapChainRenderPass(commandBuffer);
+
+    // cleared rather than drawn, it needs no pipeline
+    const vk::Extent2D extent = _renderer->getSwapChainExtent();
+    const uint32_t barHeight = std::max(extent.height / 60u, 1u);
+    const uint32_t barWidth = uint32_t(float(extent.width) * std::clamp(progress, 0.f, 1.f));
+    if (barWidth > 0)
+    {
+        vk::ClearAttachment attachment{};
+        attachment.aspectMask = vk::ImageAspectFlagBits::eColor;
+        attachment.colorAttachment = 0;
+        attachment.clearValue.color = vk::ClearColorValue{std::array<float, 4>{.8f, .8f, .8f, 1.f}};
+
+        vk::ClearRect rect{};
+        rect.rect = vk::Rect2D{vk::Offset2D{0, int32_t(extent.height - barHeight)}, vk::Extent2D{barWidth, barHeight}};
+        rect.baseArrayLayer = 0;
+        rect.layerCount = 1;
+
+        commandBuffer.clearAttachments(1, &attachment, 1, &rect);
+    }
+
+    _renderer->endSwapChainRenderPass(commandBuffer);
+    _profiler->endFrame(commandBuffer);
+    // the frame fences keep the next loading frame from reusing these buffers early
+    _renderer->endFrame();
+
+    delete frameInfo;
+}
+
 vk::RenderPass RenderSystem::getRenderPass()
 {
 #ifndef NDEBUG
@@ -328,6 +594,17 @@ vk::RenderPass RenderSystem::getRenderPass()
     return _renderer->getSwapChainRenderPass();
 }
 
+vk::Format RenderSystem::getPostProcessFormat()
+{
+#ifndef NDEBUG
+    if (Editor::isActive())
+    {
+        return _format;
+    }
+#endif
+    return _renderer->getSwapChainImageFormat();
+}
+
 void RenderSystem::createGBuffer()
 {
 #ifndef NDEBUG
@@ -352,8 +629,113 @@ void RenderSystem::createGBuffer()
 
 void RenderSystem::writeUbo(FrameInfo *frameInfo, GlobalUbo *ubo)
 {
+    // coherent, no flush needed
     _uboBuffers[frameInfo->frameIndex]->writeToBuffer(ubo);
-    _uboBuffers[frameInfo->frameIndex]->flush();
+}
+
+ClusterBuffer *RenderSystem::getClusterBuffer(FrameInfo *frameInfo)
+{
+    return static_cast<ClusterBuffer *>(_clusterBuffers[frameInfo->frameIndex]->getMappedMemory());
+}
+
+Model::Instance *RenderSystem::allocateInstances(uint32_t count, uint32_t &firstInstance)
+{
+    // called from recording threads, a frame that ran out stays out
+    firstInstance = _instanceCount.fetch_add(count);
+    if (firstInstance + count > MAX_INSTANCES)
+    {
+        return nullptr;
+    }
+
+    return static_cast<Model::Instance *>(_instanceBuffers[_frameIndex]->getMappedMemory()) + firstInstance;
+}
+
+void RenderSystem::bindInstanceBuffer(FrameInfo *frameInfo) const
+{
+    vk::Buffer buffers[] = {_instanceBuffers[frameInfo->frameIndex]->getBuffer()};
+    vk::DeviceSize offsets[] = {0};
+    frameInfo->commandBuffer.bindVertexBuffers(1, 1, buffers, offsets);
+}
+
+void *RenderSystem::allocateFrameData(vk::DeviceSize size, uint32_t &dynamicOffset)
+{
+    // called from recording threads, a frame that ran out stays out
+    const vk::DeviceSize alignedSize = (size + _frameDataAlignment - 1) / _frameDataAlignment * _frameDataAlignment;
+    const vk::DeviceSize offset = _frameDataOffset.fetch_add(alignedSize);
+    if (offset + alignedSize > FRAME_DATA_SIZE)
+    {
+        // only the allocation straddling the end gets here with an offset still inside the ring
+        if (offset <= FRAME_DATA_SIZE)
+        {
+            spdlog::warn("RenderSystem: frame data ring full past {0} bytes, raise FRAME_DATA_SIZE", FRAME_DATA_SIZE);
+        }
+        return nullptr;
+    }
+
+    dynamicOffset = uint32_t(offset);
+    return static_cast<char *>(_frameDataBuffers[_frameIndex]->getMappedMemory()) + offset;
+}
+
+void RenderSystem::bindFrameData(FrameInfo *frameInfo, vk::PipelineLayout pipelineLayout, uint32_t set,
+                                 uint32_t dynamicOffset) const
+{
+    frameInfo->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, set, 1,
+                                                &_objectDescriptorSets[frameInfo->frameIndex], 1, &dynamicOffset);
+}
+
+void RenderSystem::recordParallel(
+    FrameInfo *frameInfo, RecordedPass pass, vk::RenderPass renderPass, vk::Extent2D extent, size_t count,
+    const std::function<void(FrameInfo &, size_t slot, size_t begin, size_t end)> &record)
+{
+    if (count == 0)
+        return;
+
+    const size_t maxSlots = (count + MIN_DRAWS_PER_RECORDING - 1) / MIN_DRAWS_PER_RECORDING;
+    const size_t slotCount = std::min(_recordingSlotCount, maxSlots);
+    const size_t slotSize = (count + slotCount - 1) / slotCount;
+
+    vk::CommandBuffer *commandBuffers =
+        &_secondaryCommandBuffers[(frameInfo->frameIndex * eRecordedPassCount + pass) * _recordingSlotCount];
+
+    vk::CommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.renderPass = renderPass;
+    inheritanceInfo.subpass = 0;
+    // a profiler scope counting pipeline statistics may be open around the pass
+    inheritanceInfo.pipelineStatistics = _profiler->getInheritedStatistics();
+
+    vk::CommandBufferBeginInfo beginInfo{};
+    beginInfo.flags =
+        vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    vk::Viewport viewport{0.f, 0.f, (float)extent.width, (float)extent.height, 0.f, 1.f};
+    vk::Rect2D scissor{vk::Offset2D{0, 0}, extent};
+
+    JobSystem::getInstance().parallelFor(
+        slotCount,
+        [&](size_t slotBegin, size_t slotEnd) {
+            for (size_t slot = slotBegin; slot < slotEnd; slot++)
+            {
+                vk::CommandBuffer &commandBuffer = commandBuffers[slot];
+                if (commandBuffer.begin(&beginInfo) != vk::Result::eSuccess)
+                {
+                    throw std::runtime_error("RenderSystem: failed to begin secondary command buffer");
+                }
+
+                // dynamic state isn't inherited from the primary
+                commandBuffer.setViewport(0, 1, &viewport);
+                commandBuffer.setScissor(0, 1, &scissor);
+
+                FrameInfo slotFrameInfo{frameInfo->frameIndex, commandBuffer, frameInfo->globalDescriptorSet,
+                                        frameInfo->camera};
+                record(slotFrameInfo, slot, slot * slotSize, std::min((slot + 1) * slotSize, count));
+
+                commandBuffer.end();
+            }
+        },
+        1);
+
+    frameInfo->commandBuffer.executeCommands(uint32_t(slotCount), commandBuffers);
 }
 
 Device *RenderSystem::getDevice()
@@ -499,7 +881,7 @@ void RenderSystem::freeImages()
     _device->device().destroySampler(_sampler);
     _device->device().destroyImageView(_imageView);
     _device->device().destroyImage(_image);
-    _device->device().freeMemory(_imageMemory);
+    _device->freeMemory(_imageMemory);
 }
 #endif
 
@@ -5,14 +5,29 @@
 #include "cmx_descriptors.h"
 #include "cmx_g_buffer.h"
 #include "cmx_light_environment.h"
+#include "cmx_model.h"
 #include "cmx_viewport_ui.h"
 
 // lib
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
-#define MAX_POINT_LIGHTS 10
+// std
+#include <atomic>
+#include <functional>
+
+#define MAX_POINT_LIGHTS 1024
+// froxel grid point lights are assigned to, screen tiles by exponential depth slices
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define CLUSTER_COUNT (CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z)
+#define MAX_CLUSTER_LIGHT_INDICES (64 * 1024)
 #define MAX_SAMPLER_SETS 200
+#define MAX_BINDLESS_TEXTURES 4096
+#define MAX_INSTANCES 16384
+#define MIN_DRAWS_PER_RECORDING 64
+#define FRAME_DATA_SIZE (8 * 1024 * 1024)
 
 namespace cmx
 {
@@ -25,10 +40,12 @@ struct DirectionalLightCompact
     glm::vec4 direction{};
 };
 
-struct PointLightCompact
+// every frame's point lights and the clusters they reach, read through the global set's storage buffer
+struct ClusterBuffer
 {
-    glm::vec4 position{}; // ignore w
-    glm::vec4 color{};    // a is intensity
+    glm::uvec2 clusters[CLUSTER_COUNT]; // offset into lightIndices, light count
+    PointLightCompact pointLights[MAX_POINT_LIGHTS];
+    uint32_t lightIndices[MAX_CLUSTER_LIGHT_INDICES];
 };
 
 struct GlobalUbo
@@ -38,13 +55,37 @@ struct GlobalUbo
     glm::vec4 ambientLight{1.f};
     glm::vec4 cameraPos{0.f};
     DirectionalLightCompact sun{};
-    PointLightCompact pointLights[MAX_POINT_LIGHTS];
-    int numLights;
+    glm::uvec4 clusterGrid{0};   // x, y and z cluster counts, w the point light count
+    glm::vec4 clusterDepth{0.f}; // slice = log(view depth) * x + y
+    int sunCascadeCount{0};
+    // view space depth each cascade ends at, std140 puts it on the next 16 bytes
+    alignas(16) glm::vec4 sunCascadeSplits{0.f};
+    glm::vec4 sunCascadeBiases{0.f};
+    glm::mat4 sunCascades[MAX_SHADOW_CASCADES]{}; // projection * view
+};
+
+// per draw data, written into the frame's ring buffer and read through a dynamic uniform offset
+struct ObjectData
+{
+    glm::mat4 modelMatrix{1.f};
+    glm::mat4 normalMatrix{1.f};
+    glm::vec4 color{1.f};        // a is 0 when untextured
+    glm::vec4 uvParameters{0.f}; // offset, world space scale (0 for model uvs), rotation
 };
 
 class RenderSystem
 {
   public:
+    // passes recorded in parallel, each gets its own set of secondary command buffers
+    enum RecordedPass
+    {
+        // one of each per cascade
+        eStaticShadowPass,
+        eShadowPass = eStaticShadowPass + MAX_SHADOW_CASCADES,
+        eGeometryPass = eShadowPass + MAX_SHADOW_CASCADES,
+        eRecordedPassCount
+    };
+
     static RenderSystem *getInstance();
     ~RenderSystem();
 
@@ -57,14 +98,45 @@ class RenderSystem
     void endRender(struct FrameInfo *) const;
     void beginPostProcess(struct FrameInfo *) const;
     void endPostProcess(struct FrameInfo *) const;
+    // a whole frame with nothing but a progress bar, for while there is no scene to draw
+    void drawLoadingFrame(float progress);
     void writeUbo(struct FrameInfo *, struct GlobalUbo *);
+    // this frame's cluster buffer, persistently mapped and coherent
+    struct ClusterBuffer *getClusterBuffer(struct FrameInfo *);
+
+    // returns room for count instances in this frame's instance buffer, nullptr if the frame ran out
+    Model::Instance *allocateInstances(uint32_t count, uint32_t &firstInstance);
+    void bindInstanceBuffer(struct FrameInfo *) const;
+
+    // room for size bytes of per draw data in this frame's ring buffer, aligned for a dynamic uniform offset,
+    // nullptr if the frame ran out, the memory is persistently mapped and coherent so writing is all there is to do
+    void *allocateFrameData(vk::DeviceSize size, uint32_t &dynamicOffset);
+    // binds this frame's per draw data at the given offset as set, the layout must use getObjectSetLayout there
+    void bindFrameData(struct FrameInfo *, vk::PipelineLayout, uint32_t set, uint32_t dynamicOffset) const;
+
+    // splits [0, count) over the job system, every slot records its range into its own secondary command buffer which
+    // the primary then executes, the render pass has to be begun with vk::SubpassContents::eSecondaryCommandBuffers
+    void recordParallel(struct FrameInfo *, RecordedPass, vk::RenderPass, vk::Extent2D, size_t count,
+                        const std::function<void(struct FrameInfo &, size_t slot, size_t begin, size_t end)> &record);
+    size_t getRecordingSlotCount() const
+    {
+        return _recordingSlotCount;
+    }
 
     void closeWindow();
 
+    // headless only, the final image of the last frame as RGBA8
+    void readLastFrame(std::vector<uint8_t> &pixels, vk::Extent2D &extent);
+
     size_t createSamplerDescriptor(vk::ImageView, vk::Sampler);
     void freeSamplerDescriptor(size_t descriptorSetID);
     vk::DescriptorSet &getSamplerDescriptorSet(size_t index);
 
+    // slot in the bindless texture table, a single combined image sampler array every frame shares
+    uint32_t registerBindlessTexture(vk::ImageView, vk::Sampler);
+    void freeBindlessTexture(uint32_t index);
+    void bindBindlessTextures(struct FrameInfo *, vk::PipelineLayout, uint32_t set) const;
+
     friend void ViewportUI::initImGUI();
 
     class Device *getDevice();
@@ -73,6 +145,14 @@ class RenderSystem
     {
         return _globalSetLayout->getDescriptorSetLayout();
     };
+    vk::DescriptorSetLayout getBindlessSetLayout()
+    {
+        return _bindlessSetLayout->getDescriptorSetLayout();
+    };
+    vk::DescriptorSetLayout getObjectSetLayout()
+    {
+        return _objectSetLayout->getDescriptorSetLayout();
+    };
     vk::DescriptorSetLayout getSamplerDescriptorSetLayout()
     {
         return _samplerDescriptorSetLayout->getDescriptorSetLayout();
@@ -81,7 +161,13 @@ class RenderSystem
     {
         return _renderer.get();
     };
+    class GpuProfiler *getProfiler()
+    {
+        return _profiler.get();
+    }
     vk::RenderPass getRenderPass();
+    // of getRenderPass()'s only attachment, post process chain targets use it to share its pipelines
+    vk::Format getPostProcessFormat();
     size_t getSamplerDescriptorSetID()
     {
         return _samplerDescriptorSetID;
@@ -98,6 +184,11 @@ class RenderSystem
   private:
     RenderSystem();
     void initializeUbo();
+    void initializeInstanceBuffers();
+    void initializeFrameData();
+    void initializeBindlessTable();
+    void initializeRecordingPools();
+    void freeRecordingPools();
 
     void createGBuffer();
 
@@ -114,7 +205,7 @@ class RenderSystem
     vk::Image _image;
     vk::ImageView _imageView;
     vk::Sampler _sampler;
-    vk::DeviceMemory _imageMemory;
+    Allocation _imageMemory;
     vk::Extent2D _resolution;
     vk::RenderPass _renderPass;
     vk::Framebuffer _framebuffer;
@@ -131,17 +222,41 @@ class RenderSystem
 
     std::unique_ptr<class Renderer> _renderer;
     std::unique_ptr<class Device> _device;
+    std::unique_ptr<class GpuProfiler> _profiler;
     class Window *_window;
     vk::CommandBuffer _commandBuffer;
     std::vector<std::unique_ptr<class Buffer>> _uboBuffers;
+    std::vector<std::unique_ptr<class Buffer>> _clusterBuffers;
     std::vector<vk::DescriptorSet> _globalDescriptorSets;
 
+    std::vector<std::unique_ptr<class Buffer>> _instanceBuffers;
+    std::atomic<uint32_t> _instanceCount{0};
+    int _frameIndex{0};
+
+    // ring of per draw data, rewound every frame, bound through _objectDescriptorSets with dynamic offsets
+    std::vector<std::unique_ptr<class Buffer>> _frameDataBuffers;
+    std::vector<vk::DescriptorSet> _objectDescriptorSets;
+    std::unique_ptr<DescriptorSetLayout> _objectSetLayout;
+    std::atomic<vk::DeviceSize> _frameDataOffset{0};
+    vk::DeviceSize _frameDataAlignment{256};
+
+    // one pool per frame and slot, command buffers are indexed [frame][pass][slot]
+    size_t _recordingSlotCount{1};
+    std::vector<vk::CommandPool> _recordingPools;
+    std::vector<vk::CommandBuffer> _secondaryCommandBuffers;
+
     std::unique_ptr<DescriptorSetLayout> _globalSetLayout;
 
     std::unique_ptr<class DescriptorPool> _samplerDescriptorPool;
     std::unique_ptr<class DescriptorSetLayout> _samplerDescriptorSetLayout;
     std::vector<vk::DescriptorSet> _samplerDescriptorSets;
 
+    std::unique_ptr<class DescriptorPool> _bindlessPool;
+    std::unique_ptr<class DescriptorSetLayout> _bindlessSetLayout;
+    vk::DescriptorSet _bindlessSet;
+    std::vector<uint32_t> _freeBindlessIndices;
+    uint32_t _bindlessCount{0};
+
     static RenderSystem *_instance;
 };
 
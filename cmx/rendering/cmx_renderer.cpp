@@ -153,6 +153,14 @@ void Renderer::endFrame()
     _currentFrameIndex = (_currentFrameIndex + 1) % SwapChain::MAX_FRAMES_IN_FLIGHT;
 }
 
+void Renderer::readLastFrame(std::vector<uint8_t> &pixels, vk::Extent2D &extent)
+{
+    assert(!_isFrameStarted && "Can't call readLastFrame while a frame is in progress");
+
+    extent = _swapChain->getSwapChainExtent();
+    _swapChain->readImage(_currentImageIndex, pixels);
+}
+
 void Renderer::beginSwapChainRenderPass(vk::CommandBuffer commandBuffer)
 {
     assert(_isFrameStarted && "Can't call beginSwapChainRenderPass if frame is not in progress");
@@ -30,6 +30,16 @@ class Renderer
         return _swapChain->getRenderPass();
     }
 
+    vk::Extent2D getSwapChainExtent() const
+    {
+        return _swapChain->getSwapChainExtent();
+    }
+
+    vk::Format getSwapChainImageFormat() const
+    {
+        return _swapChain->getSwapChainImageFormat();
+    }
+
     float getAspectRatio() const
     {
         return _swapChain->extentAspectRatio();
@@ -58,6 +68,8 @@ class Renderer
 
     vk::CommandBuffer beginFrame();
     void endFrame();
+    // headless only, the image the last frame ended in as RGBA8, the frame must be done on the GPU
+    void readLastFrame(std::vector<uint8_t> &pixels, vk::Extent2D &extent);
     void beginSwapChainRenderPass(vk::CommandBuffer);
     void endSwapChainRenderPass(vk::CommandBuffer);
 
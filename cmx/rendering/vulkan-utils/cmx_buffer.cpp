@@ -41,7 +41,12 @@ Buffer::Buffer(Device &device, vk::DeviceSize instanceSize, uint32_t instanceCou
 {
     _alignmentSize = getAlignment(instanceSize, minOffsetAlignment);
     _bufferSize = _alignmentSize * instanceCount;
-    device.createBuffer(_bufferSize, usageFlags, memoryPropertyFlags, _buffer, _memory);
+
+    // staging buffers only live for the copy, they're packed in linear blocks
+    const MemoryAllocator::Strategy strategy = usageFlags == vk::BufferUsageFlagBits::eTransferSrc
+                                                   ? MemoryAllocator::eTransient
+                                                   : MemoryAllocator::eLongLived;
+    device.createBuffer(_bufferSize, usageFlags, memoryPropertyFlags, _buffer, _memory, strategy);
 }
 
 Buffer::~Buffer()
@@ -56,7 +61,7 @@ void Buffer::free()
 {
     unmap();
     _device.device().destroyBuffer(_buffer);
-    _device.device().freeMemory(_memory);
+    _device.freeMemory(_memory);
 
     _freed = true;
 }
@@ -72,22 +77,25 @@ void Buffer::free()
  */
 vk::Result Buffer::map(vk::DeviceSize size, vk::DeviceSize offset)
 {
-    assert(_buffer && _memory && "Called map on buffer before create");
-    return _device.device().mapMemory(_memory, offset, size, vk::MemoryMapFlagBits{}, &_mapped);
+    assert(_buffer && _memory.memory && "Called map on buffer before create");
+    if (!_memory.mapped)
+    {
+        return vk::Result::eErrorMemoryMapFailed;
+    }
+
+    // the allocator keeps host visible blocks mapped, mapping only points into them
+    _mapped = static_cast<char *>(_memory.mapped) + offset;
+    return vk::Result::eSuccess;
 }
 
 /**
  * Unmap a mapped memory range
  *
- * @note Does not return a result as vkUnmapMemory can't fail
+ * @note The block itself stays mapped until the allocator releases it
  */
 void Buffer::unmap()
 {
-    if (_mapped)
-    {
-        _device.device().unmapMemory(_memory);
-        _mapped = nullptr;
-    }
+    _mapped = nullptr;
 }
 
 /**
@@ -128,11 +136,7 @@ void Buffer::writeToBuffer(void *data, vk::DeviceSize size, vk::DeviceSize offse
  */
 vk::Result Buffer::flush(vk::DeviceSize size, vk::DeviceSize offset)
 {
-    vk::MappedMemoryRange mappedRange = {};
-    mappedRange.sType = vk::StructureType::eMappedMemoryRange;
-    mappedRange.memory = _memory;
-    mappedRange.offset = offset;
-    mappedRange.size = size;
+    vk::MappedMemoryRange mappedRange = _device.getAllocator().mappedRange(_memory, size, offset);
     return _device.device().flushMappedMemoryRanges(1, &mappedRange);
 }
 
@@ -149,11 +153,7 @@ vk::Result Buffer::flush(vk::DeviceSize size, vk::DeviceSize offset)
  */
 vk::Result Buffer::invalidate(vk::DeviceSize size, vk::DeviceSize offset)
 {
-    vk::MappedMemoryRange mappedRange = {};
-    mappedRange.sType = vk::StructureType::eMappedMemoryRange;
-    mappedRange.memory = _memory;
-    mappedRange.offset = offset;
-    mappedRange.size = size;
+    vk::MappedMemoryRange mappedRange = _device.getAllocator().mappedRange(_memory, size, offset);
     return _device.device().invalidateMappedMemoryRanges(1, &mappedRange);
 }
 
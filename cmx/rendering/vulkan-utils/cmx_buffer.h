@@ -69,7 +69,7 @@ class Buffer
     Device &_device;
     void *_mapped = nullptr;
     vk::Buffer _buffer = VK_NULL_HANDLE;
-    vk::DeviceMemory _memory = VK_NULL_HANDLE;
+    Allocation _memory{};
 
     vk::DeviceSize _bufferSize;
     uint32_t _instanceCount;
@@ -14,7 +14,8 @@ namespace cmx
 
 DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::addBinding(uint32_t binding,
                                                                        vk::DescriptorType descriptorType,
-                                                                       vk::ShaderStageFlags stageFlags, uint32_t count)
+                                                                       vk::ShaderStageFlags stageFlags, uint32_t count,
+                                                                       vk::DescriptorBindingFlags bindingFlags)
 {
     assert(_bindings.count(binding) == 0 && "Binding already in use");
     vk::DescriptorSetLayoutBinding layoutBinding{};
@@ -23,30 +24,45 @@ DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::addBinding(uint32_t
     layoutBinding.descriptorCount = count;
     layoutBinding.stageFlags = stageFlags;
     _bindings[binding] = layoutBinding;
+    _bindingFlags[binding] = bindingFlags;
     return *this;
 }
 
 std::unique_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::build() const
 {
-    return std::make_unique<DescriptorSetLayout>(_device, _bindings);
+    return std::make_unique<DescriptorSetLayout>(_device, _bindings, _bindingFlags);
 }
 
 // *************** Descriptor Set Layout *********************
 
 DescriptorSetLayout::DescriptorSetLayout(Device &device,
-                                         std::unordered_map<uint32_t, vk::DescriptorSetLayoutBinding> bindings)
+                                         std::unordered_map<uint32_t, vk::DescriptorSetLayoutBinding> bindings,
+                                         std::unordered_map<uint32_t, vk::DescriptorBindingFlags> bindingFlags)
     : _device{device}, _bindings{bindings}
 {
     std::vector<vk::DescriptorSetLayoutBinding> setLayoutBindings{};
+    std::vector<vk::DescriptorBindingFlags> setLayoutBindingFlags{};
+    bool updateAfterBind = false;
     for (auto kv : bindings)
     {
         setLayoutBindings.push_back(kv.second);
+        setLayoutBindingFlags.push_back(bindingFlags[kv.first]);
+        updateAfterBind |= bool(bindingFlags[kv.first] & vk::DescriptorBindingFlagBits::eUpdateAfterBind);
     }
 
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setLayoutBindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = setLayoutBindingFlags.data();
+
     vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
     descriptorSetLayoutInfo.sType = vk::StructureType::eDescriptorSetLayoutCreateInfo;
     descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
     descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
+    descriptorSetLayoutInfo.pNext = &bindingFlagsInfo;
+    if (updateAfterBind)
+    {
+        descriptorSetLayoutInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+    }
 
     if (_device.device().createDescriptorSetLayout(&descriptorSetLayoutInfo, nullptr, &_descriptorSetLayout) !=
         vk::Result::eSuccess)
@@ -24,15 +24,18 @@ class DescriptorSetLayout
         }
 
         Builder &addBinding(uint32_t binding, vk::DescriptorType descriptorType, vk::ShaderStageFlags stageFlags,
-                            uint32_t count = 1);
+                            uint32_t count = 1, vk::DescriptorBindingFlags bindingFlags = {});
         std::unique_ptr<DescriptorSetLayout> build() const;
 
       private:
         Device &_device;
         std::unordered_map<uint32_t, vk::DescriptorSetLayoutBinding> _bindings{};
+        std::unordered_map<uint32_t, vk::DescriptorBindingFlags> _bindingFlags{};
     };
 
-    DescriptorSetLayout(Device &cmxDevice, std::unordered_map<uint32_t, vk::DescriptorSetLayoutBinding> bindings);
+    // any update after bind flag makes the layout need an update after bind pool
+    DescriptorSetLayout(Device &cmxDevice, std::unordered_map<uint32_t, vk::DescriptorSetLayoutBinding> bindings,
+                        std::unordered_map<uint32_t, vk::DescriptorBindingFlags> bindingFlags = {});
     ~DescriptorSetLayout();
 
     DescriptorSetLayout(const DescriptorSetLayout &) = delete;
@@ -1,5 +1,7 @@
 #include "cmx_device.h"
 #include "cmx_debug_util.h"
+#include "cmx_pipeline.h"
+#include "cmx_upload_manager.h"
 
 // lib
 #include <cmath>
@@ -10,7 +12,9 @@
 #include <vulkan/vulkan_enums.hpp>
 
 // std
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <set>
 #include <unordered_set>
@@ -72,18 +76,40 @@ void Device::destroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMess
 // class member functions
 Device::Device(Window &window) : _window{window}
 {
+    // nothing is presented, lavapipe and other surfaceless drivers are enough
+    if (_window.isHeadless())
+    {
+        _deviceExtensions.erase(std::remove_if(_deviceExtensions.begin(), _deviceExtensions.end(),
+                                               [](const char *extension) {
+                                                   return strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0;
+                                               }),
+                                _deviceExtensions.end());
+    }
+
     createInstance();
     setupDebugMessenger();
     createSurface();
     pickPhysicalDevice();
     createLogicalDevice();
     createCommandPool();
+    createPipelineCache();
+    _pipelineRegistry = std::make_unique<PipelineRegistry>(*this);
+
+    _allocator.initialize(_device, _physicalDevice);
+    _uploadManager = std::make_unique<UploadManager>(*this);
 
     DebugUtil::initialize(_device, _instance);
 }
 
 Device::~Device()
 {
+    _pipelineRegistry->free();
+    _pipelineRegistry.reset();
+    _uploadManager->free();
+    _uploadManager.reset();
+    _allocator.destroy();
+    savePipelineCache();
+    _device.destroyPipelineCache(_pipelineCache);
     _device.destroyCommandPool(_commandPool);
     _device.destroy();
 
@@ -109,7 +135,8 @@ void Device::createInstance()
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    // descriptor indexing, for the bindless texture table, is core in 1.2
+    appInfo.apiVersion = VK_API_VERSION_1_2;
 
     vk::InstanceCreateInfo createInfo = {};
     createInfo.sType = vk::StructureType::eInstanceCreateInfo;
@@ -176,6 +203,10 @@ void Device::createLogicalDevice()
 
     std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
+    if (indices.transferFamilyHasValue)
+    {
+        uniqueQueueFamilies.insert(indices.transferFamily);
+    }
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -191,6 +222,11 @@ void Device::createLogicalDevice()
     vk::PhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
     deviceFeatures.fillModeNonSolid = VK_TRUE;
+    // optional, only the GPU profiler counts with them, through the secondaries of parallel recordings as well
+    const vk::PhysicalDeviceFeatures supportedFeatures = _physicalDevice.getFeatures();
+    _pipelineStatistics = supportedFeatures.pipelineStatisticsQuery && supportedFeatures.inheritedQueries;
+    deviceFeatures.pipelineStatisticsQuery = _pipelineStatistics;
+    deviceFeatures.inheritedQueries = _pipelineStatistics;
 
     vk::DeviceCreateInfo createInfo = {};
     createInfo.sType = vk::StructureType::eDeviceCreateInfo;
@@ -198,6 +234,15 @@ void Device::createLogicalDevice()
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
+    vk::PhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+    vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+    vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+
+    createInfo.pNext = &vulkan12Features;
     createInfo.pEnabledFeatures = &deviceFeatures;
     createInfo.enabledExtensionCount = static_cast<uint32_t>(_deviceExtensions.size());
     createInfo.ppEnabledExtensionNames = _deviceExtensions.data();
@@ -221,6 +266,7 @@ void Device::createLogicalDevice()
 
     _graphicsQueue = _device.getQueue(indices.graphicsFamily, 0);
     _presentQueue = _device.getQueue(indices.presentFamily, 0);
+    _transferQueue = indices.transferFamilyHasValue ? _device.getQueue(indices.transferFamily, 0) : _graphicsQueue;
 }
 
 void Device::createCommandPool()
@@ -238,8 +284,120 @@ void Device::createCommandPool()
     }
 }
 
+namespace
+{
+
+// precedes the driver's data in the file
+struct PipelineCacheFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    float coldPipelineTime;
+    uint32_t coldPipelineCount;
+};
+
+constexpr char PIPELINE_CACHE_MAGIC[4] = {'C', 'M', 'X', 'P'};
+
+} // namespace
+
+void Device::createPipelineCache()
+{
+    const std::string filepath = std::string(SHADER_FILES) + PIPELINE_CACHE_FILE;
+
+    std::vector<char> data{};
+    std::ifstream file{filepath, std::ios::ate | std::ios::binary};
+    if (file.is_open())
+    {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), data.size());
+    }
+
+    PipelineCacheFileHeader fileHeader{};
+    VkPipelineCacheHeaderVersionOne cacheHeader{};
+    bool valid = data.size() >= sizeof(fileHeader) + sizeof(cacheHeader);
+    if (valid)
+    {
+        memcpy(&fileHeader, data.data(), sizeof(fileHeader));
+        memcpy(&cacheHeader, data.data() + sizeof(fileHeader), sizeof(cacheHeader));
+
+        // a cache from another driver or GPU would be rejected at best
+        valid = memcmp(fileHeader.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC)) == 0 &&
+                fileHeader.version == PIPELINE_CACHE_VERSION &&
+                cacheHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                cacheHeader.vendorID == _properties.vendorID && cacheHeader.deviceID == _properties.deviceID &&
+                memcmp(cacheHeader.pipelineCacheUUID, _properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+    }
+
+    vk::PipelineCacheCreateInfo createInfo{};
+    createInfo.sType = vk::StructureType::ePipelineCacheCreateInfo;
+    if (valid)
+    {
+        createInfo.initialDataSize = data.size() - sizeof(fileHeader);
+        createInfo.pInitialData = data.data() + sizeof(fileHeader);
+
+        _coldPipelineTime = fileHeader.coldPipelineTime;
+        _coldPipelineCount = fileHeader.coldPipelineCount;
+        spdlog::info("Device: loaded pipeline cache `{0}`, {1} bytes", filepath, createInfo.initialDataSize);
+    }
+    else if (!data.empty())
+    {
+        spdlog::warn("Device: pipeline cache `{0}` doesn't match this device, starting from scratch", filepath);
+    }
+
+    if (_device.createPipelineCache(&createInfo, nullptr, &_pipelineCache) != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+}
+
+void Device::savePipelineCache()
+{
+    const std::string filepath = std::string(SHADER_FILES) + PIPELINE_CACHE_FILE;
+
+    // the first run without a cache sets the reference
+    if (_coldPipelineCount == 0)
+    {
+        _coldPipelineTime = _pipelineTime;
+        _coldPipelineCount = _pipelineCount;
+    }
+    else if (_pipelineCount > 0)
+    {
+        const float expected = _coldPipelineTime / float(_coldPipelineCount) * float(_pipelineCount);
+        spdlog::info("Device: {0} pipelines created in {1:.1f}ms, the pipeline cache saved {2:.1f}ms",
+                     _pipelineCount, _pipelineTime, expected - _pipelineTime);
+    }
+
+    std::vector<uint8_t> data = _device.getPipelineCacheData(_pipelineCache);
+
+    PipelineCacheFileHeader fileHeader{};
+    memcpy(fileHeader.magic, PIPELINE_CACHE_MAGIC, sizeof(PIPELINE_CACHE_MAGIC));
+    fileHeader.version = PIPELINE_CACHE_VERSION;
+    fileHeader.coldPipelineTime = _coldPipelineTime;
+    fileHeader.coldPipelineCount = _coldPipelineCount;
+
+    std::ofstream file{filepath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open())
+    {
+        spdlog::warn("Device: couldn't write pipeline cache to `{0}`", filepath);
+        return;
+    }
+
+    file.write(reinterpret_cast<const char *>(&fileHeader), sizeof(fileHeader));
+    file.write(reinterpret_cast<const char *>(data.data()), data.size());
+}
+
+void Device::recordPipelineCreation(float milliseconds)
+{
+    _pipelineTime += milliseconds;
+    _pipelineCount++;
+}
+
 void Device::createSurface()
 {
+    if (_window.isHeadless())
+        return;
+
     _window.createWindowSurface(_instance, &_surface);
 }
 
@@ -249,8 +407,8 @@ bool Device::isDeviceSuitable(vk::PhysicalDevice device)
 
     bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported)
+    bool swapChainAdequate = _window.isHeadless();
+    if (extensionsSupported && !swapChainAdequate)
     {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -259,7 +417,41 @@ bool Device::isDeviceSuitable(vk::PhysicalDevice device)
     vk::PhysicalDeviceFeatures supportedFeatures;
     supportedFeatures = device.getFeatures();
 
-    return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+    return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy &&
+           supportsBindless(device) && supportsTimelineSemaphores(device);
+}
+
+bool Device::supportsBindless(vk::PhysicalDevice device)
+{
+    if (device.getProperties().apiVersion < VK_API_VERSION_1_2)
+    {
+        return false;
+    }
+
+    vk::PhysicalDeviceVulkan12Features vulkan12Features{};
+    vk::PhysicalDeviceFeatures2 features{};
+    features.pNext = &vulkan12Features;
+    device.getFeatures2(&features);
+
+    return vulkan12Features.runtimeDescriptorArray && vulkan12Features.descriptorBindingPartiallyBound &&
+           vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+           vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+           vulkan12Features.shaderSampledImageArrayNonUniformIndexing;
+}
+
+bool Device::supportsTimelineSemaphores(vk::PhysicalDevice device)
+{
+    if (device.getProperties().apiVersion < VK_API_VERSION_1_2)
+    {
+        return false;
+    }
+
+    vk::PhysicalDeviceVulkan12Features vulkan12Features{};
+    vk::PhysicalDeviceFeatures2 features{};
+    features.pNext = &vulkan12Features;
+    device.getFeatures2(&features);
+
+    return vulkan12Features.timelineSemaphore;
 }
 
 void Device::populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo)
@@ -316,11 +508,15 @@ bool Device::checkValidationLayerSupport()
 
 std::vector<const char *> Device::getRequiredExtensions()
 {
-    uint32_t glfwExtensionCount = 0;
-    const char **glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char *> extensions{};
+    if (!_window.isHeadless())
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char **glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-    std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (_enableValidationLayers)
     {
@@ -409,7 +605,16 @@ QueueFamilyIndices Device::findQueueFamilies(vk::PhysicalDevice device)
             indices.graphicsFamily = i;
             indices.graphicsFamilyHasValue = true;
         }
-        vk::Bool32 presentSupport = device.getSurfaceSupportKHR(i, _surface);
+        // without a surface, the graphics queue stands in for presentation
+        vk::Bool32 presentSupport = VK_FALSE;
+        if (_surface)
+        {
+            presentSupport = device.getSurfaceSupportKHR(i, _surface);
+        }
+        else if (queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)
+        {
+            presentSupport = VK_TRUE;
+        }
         if (queueFamily.queueCount > 0 && presentSupport)
         {
             indices.presentFamily = i;
@@ -423,6 +628,21 @@ QueueFamilyIndices Device::findQueueFamilies(vk::PhysicalDevice device)
         i++;
     }
 
+    // a family without graphics or compute is the dedicated copy engine on most discrete GPUs
+    i = 0;
+    for (const auto &queueFamily : queueFamilies)
+    {
+        if (queueFamily.queueCount > 0 && (queueFamily.queueFlags & vk::QueueFlagBits::eTransfer) &&
+            !(queueFamily.queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute)))
+        {
+            indices.transferFamily = i;
+            indices.transferFamilyHasValue = true;
+            break;
+        }
+
+        i++;
+    }
+
     return indices;
 }
 
@@ -472,7 +692,7 @@ uint32_t Device::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags pro
 }
 
 void Device::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties,
-                          vk::Buffer &buffer, vk::DeviceMemory &bufferMemory)
+                          vk::Buffer &buffer, Allocation &bufferMemory, MemoryAllocator::Strategy strategy)
 {
     vk::BufferCreateInfo bufferInfo{};
     bufferInfo.sType = vk::StructureType::eBufferCreateInfo;
@@ -486,18 +706,9 @@ void Device::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::M
     }
 
     vk::MemoryRequirements memRequirements = _device.getBufferMemoryRequirements(buffer);
+    bufferMemory = _allocator.allocate(memRequirements, properties, strategy, false);
 
-    vk::MemoryAllocateInfo allocInfo{};
-    allocInfo.sType = vk::StructureType::eMemoryAllocateInfo;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-    if (_device.allocateMemory(&allocInfo, nullptr, &bufferMemory) != vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to allocate vertex buffer memory !");
-    }
-
-    _device.bindBufferMemory(buffer, bufferMemory, 0);
+    _device.bindBufferMemory(buffer, bufferMemory.memory, bufferMemory.offset);
 }
 
 vk::CommandBuffer Device::beginSingleTimeCommands()
@@ -580,7 +791,7 @@ void Device::copyBufferToImage(vk::Buffer buffer, vk::Image image, uint32_t widt
 }
 
 void Device::createImageWithInfo(const vk::ImageCreateInfo &imageInfo, vk::MemoryPropertyFlags properties,
-                                 vk::Image &image, vk::DeviceMemory &imageMemory)
+                                 vk::Image &image, Allocation &imageMemory)
 {
     if (_device.createImage(&imageInfo, nullptr, &image) != vk::Result::eSuccess)
     {
@@ -588,18 +799,15 @@ void Device::createImageWithInfo(const vk::ImageCreateInfo &imageInfo, vk::Memor
     }
 
     vk::MemoryRequirements memRequirements = _device.getImageMemoryRequirements(image);
+    imageMemory = _allocator.allocate(memRequirements, properties, MemoryAllocator::eLongLived,
+                                      imageInfo.tiling == vk::ImageTiling::eOptimal);
 
-    vk::MemoryAllocateInfo allocInfo{};
-    allocInfo.sType = vk::StructureType::eMemoryAllocateInfo;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-    if (_device.allocateMemory(&allocInfo, nullptr, &imageMemory) != vk::Result::eSuccess)
-    {
-        throw std::runtime_error("failed to allocate image memory!");
-    }
+    _device.bindImageMemory(image, imageMemory.memory, imageMemory.offset);
+}
 
-    _device.bindImageMemory(image, imageMemory, 0);
+void Device::freeMemory(Allocation &memory)
+{
+    _allocator.free(memory);
 }
 
 void Device::transitionImageLayout(vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
@@ -2,14 +2,19 @@
 #define CMX_DEVICE
 
 // cmx
+#include "cmx_memory_allocator.h"
 #include "cmx_window.h"
 
 // std
+#include <memory>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_core.h>
 #include <vulkan/vulkan_enums.hpp>
 
+#define PIPELINE_CACHE_FILE "pipeline_cache.bin"
+#define PIPELINE_CACHE_VERSION 1
+
 namespace cmx
 {
 
@@ -24,8 +29,11 @@ struct QueueFamilyIndices
 {
     uint32_t graphicsFamily;
     uint32_t presentFamily;
+    // transfer only family, copies there run alongside rendering
+    uint32_t transferFamily;
     bool graphicsFamilyHasValue = false;
     bool presentFamilyHasValue = false;
+    bool transferFamilyHasValue = false;
     bool isComplete()
     {
         return graphicsFamilyHasValue && presentFamilyHasValue;
@@ -59,6 +67,10 @@ class Device
     {
         return _surface;
     }
+    bool isHeadless() const
+    {
+        return _window.isHeadless();
+    }
     vk::Queue graphicsQueue()
     {
         return _graphicsQueue;
@@ -67,6 +79,11 @@ class Device
     {
         return _presentQueue;
     }
+    // the graphics queue when there's no dedicated transfer family
+    vk::Queue transferQueue()
+    {
+        return _transferQueue;
+    }
     vk::PhysicalDevice physicalDevice()
     {
         return _physicalDevice;
@@ -76,6 +93,10 @@ class Device
         return _instance;
     }
     vk::SampleCountFlagBits getSampleCount();
+    bool supportsPipelineStatistics() const
+    {
+        return _pipelineStatistics;
+    }
 
     SwapChainSupportDetails getSwapChainSupport()
     {
@@ -89,14 +110,40 @@ class Device
     vk::Format findSupportedFormat(const std::vector<vk::Format> &candidates, vk::ImageTiling, vk::FormatFeatureFlags);
 
     // Buffer Helper Functions
-    void createBuffer(vk::DeviceSize, vk::BufferUsageFlags, vk::MemoryPropertyFlags, vk::Buffer &, vk::DeviceMemory &);
+    void createBuffer(vk::DeviceSize, vk::BufferUsageFlags, vk::MemoryPropertyFlags, vk::Buffer &, Allocation &,
+                      MemoryAllocator::Strategy = MemoryAllocator::eLongLived);
     vk::CommandBuffer beginSingleTimeCommands();
     void endSingleTimeCommands(vk::CommandBuffer);
     void copyBuffer(vk::Buffer src, vk::Buffer dst, vk::DeviceSize);
     void copyBufferToImage(vk::Buffer, vk::Image, uint32_t width, uint32_t height, uint32_t depth = 1,
                            uint32_t layerCount = 1);
 
-    void createImageWithInfo(const vk::ImageCreateInfo &, vk::MemoryPropertyFlags, vk::Image &, vk::DeviceMemory &);
+    void createImageWithInfo(const vk::ImageCreateInfo &, vk::MemoryPropertyFlags, vk::Image &, Allocation &);
+    // releases memory from createBuffer or createImageWithInfo, the resource must be destroyed already
+    void freeMemory(Allocation &);
+
+    MemoryAllocator &getAllocator()
+    {
+        return _allocator;
+    }
+
+    class UploadManager &getUploadManager()
+    {
+        return *_uploadManager;
+    }
+
+    // pipelines and layouts are requested through it so identical materials share them
+    class PipelineRegistry &getPipelineRegistry()
+    {
+        return *_pipelineRegistry;
+    }
+
+    // shared by every pipeline, loaded from and saved to PIPELINE_CACHE_FILE next to the compiled shaders
+    vk::PipelineCache getPipelineCache()
+    {
+        return _pipelineCache;
+    }
+    void recordPipelineCreation(float milliseconds);
     void transitionImageLayout(vk::Image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout, uint32_t mipLevels);
 
     vk::PhysicalDeviceProperties _properties;
@@ -113,9 +160,15 @@ class Device
     void pickPhysicalDevice();
     void createLogicalDevice();
     void createCommandPool();
+    void createPipelineCache();
+    void savePipelineCache();
 
     // helper functions
     bool isDeviceSuitable(vk::PhysicalDevice);
+    // descriptor indexing features the bindless texture table relies on
+    bool supportsBindless(vk::PhysicalDevice);
+    // uploads track their completion with timeline semaphores
+    bool supportsTimelineSemaphores(vk::PhysicalDevice);
     std::vector<const char *> getRequiredExtensions();
     bool checkValidationLayerSupport();
     QueueFamilyIndices findQueueFamilies(vk::PhysicalDevice);
@@ -134,9 +187,23 @@ class Device
     vk::SurfaceKHR _surface;
     vk::Queue _graphicsQueue;
     vk::Queue _presentQueue;
+    vk::Queue _transferQueue;
+    bool _pipelineStatistics{false};
+
+    MemoryAllocator _allocator;
+    std::unique_ptr<class UploadManager> _uploadManager;
+
+    std::unique_ptr<class PipelineRegistry> _pipelineRegistry;
+    vk::PipelineCache _pipelineCache;
+    // pipeline creation time of the run that started without a cache, carried over in the file to report the savings
+    float _coldPipelineTime{0.f};
+    uint32_t _coldPipelineCount{0};
+    float _pipelineTime{0.f};
+    uint32_t _pipelineCount{0};
 
     const std::vector<const char *> _validationLayers = {"VK_LAYER_KHRONOS_validation"};
-    const std::vector<const char *> _deviceExtensions = {
+    // the swap chain's is dropped when headless
+    std::vector<const char *> _deviceExtensions = {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
         VK_KHR_MAINTENANCE_2_EXTENSION_NAME,
     };
@@ -0,0 +1,421 @@
+#include "cmx_memory_allocator.h"
+
+// lib
+#include <spdlog/spdlog.h>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace cmx
+{
+
+float MemoryStats::fragmentation() const
+{
+    if (free == 0)
+        return 0.f;
+
+    return 1.f - float(largestFree) / float(free);
+}
+
+MemoryStats &MemoryStats::operator+=(const MemoryStats &other)
+{
+    blocks += other.blocks;
+    dedicatedAllocations += other.dedicatedAllocations;
+    allocations += other.allocations;
+    reserved += other.reserved;
+    used += other.used;
+    free += other.free;
+    largestFree = std::max(largestFree, other.largestFree);
+
+    return *this;
+}
+
+void MemoryAllocator::initialize(vk::Device device, vk::PhysicalDevice physicalDevice)
+{
+    _device = device;
+    _memoryProperties = physicalDevice.getMemoryProperties();
+    _nonCoherentAtomSize = std::max<vk::DeviceSize>(physicalDevice.getProperties().limits.nonCoherentAtomSize, 1);
+
+    _buddyOrders = 0;
+    while ((vk::DeviceSize(MIN_ALLOCATION_SIZE) << _buddyOrders) < MEMORY_BLOCK_SIZE)
+    {
+        _buddyOrders++;
+    }
+
+    _pools.resize(poolIndex(VK_MAX_MEMORY_TYPES, eLongLived, false));
+}
+
+void MemoryAllocator::destroy()
+{
+    logReport();
+
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    uint32_t leaked = 0;
+    for (Pool &pool : _pools)
+    {
+        for (Block &block : pool.blocks)
+        {
+            leaked += block.allocations;
+            releaseBlock(block);
+        }
+        leaked += pool.dedicatedAllocations;
+    }
+    _pools.clear();
+
+    if (leaked > 0)
+    {
+        spdlog::error("MemoryAllocator: {0} allocations were never freed", leaked);
+    }
+}
+
+Allocation MemoryAllocator::allocate(const vk::MemoryRequirements &requirements, vk::MemoryPropertyFlags properties,
+                                     Strategy strategy, bool image)
+{
+    const uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+    const vk::MemoryPropertyFlags typeFlags = _memoryProperties.memoryTypes[memoryType].propertyFlags;
+
+    vk::DeviceSize alignment = std::max<vk::DeviceSize>(requirements.alignment, 1);
+    if ((typeFlags & vk::MemoryPropertyFlagBits::eHostVisible) &&
+        !(typeFlags & vk::MemoryPropertyFlagBits::eHostCoherent))
+    {
+        // flushes work on whole atoms, allocations mustn't share one
+        alignment = std::max(alignment, _nonCoherentAtomSize);
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    Allocation allocation{};
+    allocation.pool = poolIndex(memoryType, strategy, image);
+    allocation.size = requirements.size;
+    Pool &pool = _pools[allocation.pool];
+
+    const vk::DeviceSize blockSize = strategy == eLongLived ? MEMORY_BLOCK_SIZE : STAGING_BLOCK_SIZE;
+    if (requirements.size + alignment > blockSize)
+    {
+        Block dedicated = createBlock(memoryType, requirements.size);
+        allocation.memory = dedicated.memory;
+        allocation.mapped = dedicated.mapped;
+
+        pool.dedicatedAllocations++;
+        pool.dedicatedSize += requirements.size;
+        return allocation;
+    }
+
+    vk::DeviceSize span = MIN_ALLOCATION_SIZE;
+    while (span < requirements.size || span < alignment)
+    {
+        span <<= 1;
+        allocation.order++;
+    }
+
+    auto tryAllocate = [&](Block &block) {
+        if (!block.memory)
+            return false;
+
+        return strategy == eLongLived ? allocateBuddy(block, allocation.order, allocation.offset)
+                                      : allocateLinear(block, requirements.size, alignment, allocation.offset);
+    };
+
+    for (uint32_t i = 0; i < pool.blocks.size() && allocation.block == UINT32_MAX; i++)
+    {
+        if (tryAllocate(pool.blocks[i]))
+        {
+            allocation.block = i;
+        }
+    }
+
+    if (allocation.block == UINT32_MAX)
+    {
+        // released blocks leave their slot behind, allocations refer to blocks by index
+        auto slot = std::find_if(pool.blocks.begin(), pool.blocks.end(), [](const Block &b) { return !b.memory; });
+        if (slot == pool.blocks.end())
+        {
+            slot = pool.blocks.emplace(pool.blocks.end());
+        }
+
+        *slot = createBlock(memoryType, blockSize);
+        if (strategy == eLongLived)
+        {
+            slot->freeOffsets.resize(_buddyOrders + 1);
+            slot->freeOffsets[_buddyOrders].insert(0);
+        }
+
+        tryAllocate(*slot);
+        allocation.block = uint32_t(slot - pool.blocks.begin());
+    }
+
+    Block &block = pool.blocks[allocation.block];
+    block.allocations++;
+    block.used += requirements.size;
+
+    allocation.memory = block.memory;
+    allocation.mapped = block.mapped ? static_cast<char *>(block.mapped) + allocation.offset : nullptr;
+
+    return allocation;
+}
+
+void MemoryAllocator::free(Allocation &allocation)
+{
+    if (!allocation.memory)
+        return;
+
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    Pool &pool = _pools[allocation.pool];
+    if (allocation.block == UINT32_MAX)
+    {
+        if (allocation.mapped)
+        {
+            _device.unmapMemory(allocation.memory);
+        }
+        _device.freeMemory(allocation.memory);
+
+        pool.dedicatedAllocations--;
+        pool.dedicatedSize -= allocation.size;
+        allocation = Allocation{};
+        return;
+    }
+
+    Block &block = pool.blocks[allocation.block];
+    block.allocations--;
+    block.used -= allocation.size;
+
+    if (!block.freeOffsets.empty())
+    {
+        freeBuddy(block, allocation.order, allocation.offset);
+    }
+
+    if (block.allocations == 0)
+    {
+        block.head = 0;
+
+        // a single empty block is kept per pool, so freeing and reallocating doesn't go back to the driver
+        const bool otherEmpty = std::any_of(pool.blocks.begin(), pool.blocks.end(), [&](const Block &other) {
+            return &other != &block && other.memory && other.allocations == 0;
+        });
+        if (otherEmpty)
+        {
+            releaseBlock(block);
+        }
+    }
+
+    allocation = Allocation{};
+}
+
+vk::MappedMemoryRange MemoryAllocator::mappedRange(const Allocation &allocation, vk::DeviceSize size,
+                                                   vk::DeviceSize offset) const
+{
+    vk::DeviceSize memorySize = allocation.size;
+    if (allocation.block != UINT32_MAX)
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        memorySize = _pools[allocation.pool].blocks[allocation.block].size;
+    }
+
+    if (size == VK_WHOLE_SIZE)
+    {
+        size = allocation.size - offset;
+    }
+
+    const vk::DeviceSize begin = allocation.offset + offset;
+    const vk::DeviceSize end = (begin + size + _nonCoherentAtomSize - 1) / _nonCoherentAtomSize * _nonCoherentAtomSize;
+
+    vk::MappedMemoryRange range{};
+    range.sType = vk::StructureType::eMappedMemoryRange;
+    range.memory = allocation.memory;
+    range.offset = begin - begin % _nonCoherentAtomSize;
+    range.size = end >= memorySize ? VK_WHOLE_SIZE : end - range.offset;
+
+    return range;
+}
+
+MemoryStats MemoryAllocator::getStats() const
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    MemoryStats stats{};
+    for (uint32_t i = 0; i < _pools.size(); i++)
+    {
+        stats += poolStats(i);
+    }
+
+    return stats;
+}
+
+void MemoryAllocator::logReport() const
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    constexpr float MB = 1024.f * 1024.f;
+
+    MemoryStats total{};
+    for (uint32_t i = 0; i < _pools.size(); i++)
+    {
+        const MemoryStats stats = poolStats(i);
+        if (stats.blocks == 0 && stats.dedicatedAllocations == 0)
+            continue;
+
+        spdlog::info("MemoryAllocator: type {0} {1} {2}, {3} blocks, {4} allocations ({5} dedicated), "
+                     "{6:.1f}/{7:.1f} MB used, largest free range {8:.1f} MB, {9:.0f}% fragmented",
+                     i / 4, (i / 2) % 2 == eLongLived ? "long lived" : "transient", i % 2 ? "images" : "buffers",
+                     stats.blocks, stats.allocations, stats.dedicatedAllocations, stats.used / MB,
+                     stats.reserved / MB, stats.largestFree / MB, stats.fragmentation() * 100.f);
+        total += stats;
+    }
+
+    spdlog::info("MemoryAllocator: {0} allocations in {1:.1f} MB, {2:.1f} MB used", total.allocations,
+                 total.reserved / MB, total.used / MB);
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+MemoryAllocator::Block MemoryAllocator::createBlock(uint32_t memoryType, vk::DeviceSize size)
+{
+    vk::MemoryAllocateInfo allocInfo{};
+    allocInfo.sType = vk::StructureType::eMemoryAllocateInfo;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    Block block{};
+    block.size = size;
+    if (_device.allocateMemory(&allocInfo, nullptr, &block.memory) != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("failed to allocate device memory!");
+    }
+
+    if (_memoryProperties.memoryTypes[memoryType].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible)
+    {
+        if (_device.mapMemory(block.memory, 0, VK_WHOLE_SIZE, vk::MemoryMapFlags{}, &block.mapped) !=
+            vk::Result::eSuccess)
+        {
+            spdlog::warn("MemoryAllocator: failed to map host visible block");
+        }
+    }
+
+    return block;
+}
+
+void MemoryAllocator::releaseBlock(Block &block)
+{
+    if (!block.memory)
+        return;
+
+    if (block.mapped)
+    {
+        _device.unmapMemory(block.memory);
+    }
+    _device.freeMemory(block.memory);
+
+    block = Block{};
+}
+
+bool MemoryAllocator::allocateBuddy(Block &block, uint32_t order, vk::DeviceSize &offset)
+{
+    uint32_t available = order;
+    while (available <= _buddyOrders && block.freeOffsets[available].empty())
+    {
+        available++;
+    }
+    if (available > _buddyOrders)
+        return false;
+
+    // lowest offset first, keeps the top of the block free for large allocations
+    offset = *block.freeOffsets[available].begin();
+    block.freeOffsets[available].erase(block.freeOffsets[available].begin());
+
+    while (available > order)
+    {
+        available--;
+        block.freeOffsets[available].insert(offset + (vk::DeviceSize(MIN_ALLOCATION_SIZE) << available));
+    }
+
+    return true;
+}
+
+void MemoryAllocator::freeBuddy(Block &block, uint32_t order, vk::DeviceSize offset)
+{
+    while (order < _buddyOrders)
+    {
+        const vk::DeviceSize buddy = offset ^ (vk::DeviceSize(MIN_ALLOCATION_SIZE) << order);
+
+        auto it = block.freeOffsets[order].find(buddy);
+        if (it == block.freeOffsets[order].end())
+            break;
+
+        block.freeOffsets[order].erase(it);
+        offset = std::min(offset, buddy);
+        order++;
+    }
+
+    block.freeOffsets[order].insert(offset);
+}
+
+bool MemoryAllocator::allocateLinear(Block &block, vk::DeviceSize size, vk::DeviceSize alignment,
+                                     vk::DeviceSize &offset)
+{
+    const vk::DeviceSize aligned = (block.head + alignment - 1) / alignment * alignment;
+    if (aligned + size > block.size)
+        return false;
+
+    offset = aligned;
+    block.head = aligned + size;
+
+    return true;
+}
+
+MemoryStats MemoryAllocator::poolStats(uint32_t index) const
+{
+    const Pool &pool = _pools[index];
+
+    MemoryStats stats{};
+    stats.dedicatedAllocations = pool.dedicatedAllocations;
+    stats.allocations = pool.dedicatedAllocations;
+    stats.reserved = pool.dedicatedSize;
+    stats.used = pool.dedicatedSize;
+
+    for (const Block &block : pool.blocks)
+    {
+        if (!block.memory)
+            continue;
+
+        stats.blocks++;
+        stats.allocations += block.allocations;
+        stats.reserved += block.size;
+        stats.used += block.used;
+
+        if (block.freeOffsets.empty())
+        {
+            // linear blocks only ever reuse what's past their head
+            stats.free += block.size - block.head;
+            stats.largestFree = std::max(stats.largestFree, block.size - block.head);
+            continue;
+        }
+
+        for (uint32_t order = 0; order <= _buddyOrders; order++)
+        {
+            const vk::DeviceSize span = vk::DeviceSize(MIN_ALLOCATION_SIZE) << order;
+            stats.free += block.freeOffsets[order].size() * span;
+            if (!block.freeOffsets[order].empty())
+            {
+                stats.largestFree = std::max(stats.largestFree, span);
+            }
+        }
+    }
+
+    return stats;
+}
+
+} // namespace cmx
@@ -0,0 +1,125 @@
+#ifndef CMX_MEMORY_ALLOCATOR
+#define CMX_MEMORY_ALLOCATOR
+
+// lib
+#include <vulkan/vulkan.hpp>
+
+// std
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#define MEMORY_BLOCK_SIZE (64 * 1024 * 1024)
+#define STAGING_BLOCK_SIZE (16 * 1024 * 1024)
+#define MIN_ALLOCATION_SIZE 256
+
+namespace cmx
+{
+
+// a range of a device memory block, resources are bound at its offset
+struct Allocation
+{
+    vk::DeviceMemory memory{VK_NULL_HANDLE};
+    vk::DeviceSize offset{0};
+    vk::DeviceSize size{0};
+    // host visible blocks stay mapped for their whole lifetime, points at offset
+    void *mapped{nullptr};
+
+    uint32_t pool{0};
+    // UINT32_MAX for allocations too large for a block, which get their own memory
+    uint32_t block{UINT32_MAX};
+    uint32_t order{0};
+};
+
+struct MemoryStats
+{
+    uint32_t blocks{0};
+    uint32_t dedicatedAllocations{0};
+    uint32_t allocations{0};
+    vk::DeviceSize reserved{0};
+    // requested bytes, rounding and alignment excluded
+    vk::DeviceSize used{0};
+    vk::DeviceSize free{0};
+    vk::DeviceSize largestFree{0};
+
+    // 0 when the free space is a single range, close to 1 when it's scattered in small holes
+    float fragmentation() const;
+    MemoryStats &operator+=(const MemoryStats &);
+};
+
+// sub-allocates buffers and images out of large blocks, one set of blocks per memory type and strategy
+// long lived resources go through a buddy allocator, staging through linear blocks that rewind once emptied
+class MemoryAllocator
+{
+  public:
+    enum Strategy
+    {
+        eLongLived,
+        eTransient
+    };
+
+    void initialize(vk::Device, vk::PhysicalDevice);
+    // releases every block, allocations still alive are reported
+    void destroy();
+
+    // image is required so linear and optimal resources never share a block (bufferImageGranularity)
+    Allocation allocate(const vk::MemoryRequirements &, vk::MemoryPropertyFlags, Strategy, bool image);
+    void free(Allocation &);
+
+    // flushes or invalidates need atom aligned ranges relative to the block
+    vk::MappedMemoryRange mappedRange(const Allocation &, vk::DeviceSize size, vk::DeviceSize offset) const;
+
+    MemoryStats getStats() const;
+    void logReport() const;
+
+  private:
+    struct Block
+    {
+        vk::DeviceMemory memory{VK_NULL_HANDLE};
+        vk::DeviceSize size{0};
+        void *mapped{nullptr};
+
+        // buddy blocks, free offsets per order, order n spans MIN_ALLOCATION_SIZE << n bytes
+        std::vector<std::set<vk::DeviceSize>> freeOffsets{};
+        // linear blocks
+        vk::DeviceSize head{0};
+
+        uint32_t allocations{0};
+        vk::DeviceSize used{0};
+    };
+
+    struct Pool
+    {
+        std::vector<Block> blocks{};
+        uint32_t dedicatedAllocations{0};
+        vk::DeviceSize dedicatedSize{0};
+    };
+
+    static uint32_t poolIndex(uint32_t memoryType, Strategy strategy, bool image)
+    {
+        return (memoryType * 2 + uint32_t(strategy)) * 2 + uint32_t(image);
+    }
+
+    uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags) const;
+    Block createBlock(uint32_t memoryType, vk::DeviceSize size);
+    void releaseBlock(Block &);
+
+    bool allocateBuddy(Block &, uint32_t order, vk::DeviceSize &offset);
+    void freeBuddy(Block &, uint32_t order, vk::DeviceSize offset);
+    bool allocateLinear(Block &, vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize &offset);
+
+    MemoryStats poolStats(uint32_t pool) const;
+
+    vk::Device _device;
+    vk::PhysicalDeviceMemoryProperties _memoryProperties;
+    vk::DeviceSize _nonCoherentAtomSize{1};
+    uint32_t _buddyOrders{0};
+
+    std::vector<Pool> _pools{};
+    mutable std::mutex _mutex;
+};
+
+} // namespace cmx
+
+#endif
@@ -10,9 +10,12 @@
 
 // std
 #include <cassert>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <type_traits>
 #include <vulkan/vulkan_enums.hpp>
 
 namespace cmx
@@ -36,8 +39,6 @@ Pipeline::~Pipeline()
 
 void Pipeline::free()
 {
-    _device.device().destroyShaderModule(_vertShaderModule);
-    _device.device().destroyShaderModule(_fragShaderModule);
     _device.device().destroyPipeline(_graphicsPipeline);
 
     _freed = true;
@@ -76,25 +77,43 @@ void Pipeline::createGraphicsPipeline(const std::string &vertFilepath, const std
     std::vector<char> vertCode = readFile(vertFilepath);
     std::vector<char> fragCode = readFile(fragFilepath);
 
-    createShaderModule(vertCode, &_vertShaderModule);
-    createShaderModule(fragCode, &_fragShaderModule);
+    vk::ShaderModule vertShaderModule;
+    vk::ShaderModule fragShaderModule;
+    createShaderModule(vertCode, &vertShaderModule);
+    createShaderModule(fragCode, &fragShaderModule);
 
     vk::PipelineShaderStageCreateInfo shaderStages[2];
     shaderStages[0].sType = vk::StructureType::ePipelineShaderStageCreateInfo;
     shaderStages[0].stage = vk::ShaderStageFlagBits::eVertex;
-    shaderStages[0].module = _vertShaderModule;
+    shaderStages[0].module = vertShaderModule;
     shaderStages[0].pName = "main";
     shaderStages[0].flags = vk::PipelineShaderStageCreateFlagBits{};
     shaderStages[0].pNext = nullptr;
     shaderStages[0].pSpecializationInfo = nullptr;
     shaderStages[1].sType = vk::StructureType::ePipelineShaderStageCreateInfo;
     shaderStages[1].stage = vk::ShaderStageFlagBits::eFragment;
-    shaderStages[1].module = _fragShaderModule;
+    shaderStages[1].module = fragShaderModule;
     shaderStages[1].pName = "main";
     shaderStages[1].flags = vk::PipelineShaderStageCreateFlagBits{};
     shaderStages[1].pNext = nullptr;
     shaderStages[1].pSpecializationInfo = nullptr;
 
+    std::vector<vk::SpecializationMapEntry> specializationEntries{};
+    vk::SpecializationInfo specializationInfo{};
+    if (!configInfo.fragmentConstants.empty())
+    {
+        for (uint32_t i = 0; i < uint32_t(configInfo.fragmentConstants.size()); i++)
+        {
+            specializationEntries.push_back({i, uint32_t(i * sizeof(uint32_t)), sizeof(uint32_t)});
+        }
+
+        specializationInfo.mapEntryCount = uint32_t(specializationEntries.size());
+        specializationInfo.pMapEntries = specializationEntries.data();
+        specializationInfo.dataSize = configInfo.fragmentConstants.size() * sizeof(uint32_t);
+        specializationInfo.pData = configInfo.fragmentConstants.data();
+        shaderStages[1].pSpecializationInfo = &specializationInfo;
+    }
+
     const std::vector<vk::VertexInputBindingDescription> &bindingDescriptions = configInfo.bindingDescriptions;
     const std::vector<vk::VertexInputAttributeDescription> &attributeDescriptions = configInfo.attributeDescriptions;
 
@@ -125,11 +144,20 @@ void Pipeline::createGraphicsPipeline(const std::string &vertFilepath, const std
     pipelineInfo.basePipelineIndex = -1;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (_device.device().createGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_graphicsPipeline) !=
-        vk::Result::eSuccess)
+    const auto creationStart = std::chrono::steady_clock::now();
+
+    if (_device.device().createGraphicsPipelines(_device.getPipelineCache(), 1, &pipelineInfo, nullptr,
+                                                 &_graphicsPipeline) != vk::Result::eSuccess)
     {
         throw std::runtime_error("failed to create graphics pipeline");
     }
+
+    const std::chrono::duration<float, std::milli> creationTime = std::chrono::steady_clock::now() - creationStart;
+    _device.recordPipelineCreation(creationTime.count());
+
+    // the pipeline keeps its own copy of the compiled stages
+    _device.device().destroyShaderModule(vertShaderModule);
+    _device.device().destroyShaderModule(fragShaderModule);
 }
 
 void Pipeline::createShaderModule(const std::vector<char> &code, vk::ShaderModule *shaderModule)
@@ -232,4 +260,244 @@ void Pipeline::defaultPipelineConfigInfo(PipelineConfigInfo &configInfo)
     configInfo.attributeDescriptions = Model::Vertex::getAttributeDescriptions();
 }
 
+void Pipeline::instancedPipelineConfigInfo(PipelineConfigInfo &configInfo)
+{
+    defaultPipelineConfigInfo(configInfo);
+
+    const std::vector<vk::VertexInputBindingDescription> instanceBindings = Model::Instance::getBindingDescriptions();
+    const std::vector<vk::VertexInputAttributeDescription> instanceAttributes =
+        Model::Instance::getAttributeDescriptions();
+
+    configInfo.bindingDescriptions.insert(configInfo.bindingDescriptions.end(), instanceBindings.begin(),
+                                          instanceBindings.end());
+    configInfo.attributeDescriptions.insert(configInfo.attributeDescriptions.end(), instanceAttributes.begin(),
+                                            instanceAttributes.end());
+}
+
+PipelineRegistry::PipelineRegistry(Device &device) : _device{device}
+{
+}
+
+PipelineRegistry::~PipelineRegistry()
+{
+    if (!_freed)
+    {
+        spdlog::error("PipelineRegistry: forgot to free before deletion");
+    }
+}
+
+void PipelineRegistry::free()
+{
+    if (!_pipelines.empty() || !_layouts.empty())
+    {
+        spdlog::warn("PipelineRegistry: {0} pipelines and {1} layouts were never released", _pipelines.size(),
+                     _layouts.size());
+    }
+
+    for (auto &[key, entry] : _pipelines)
+    {
+        entry.pipeline->free();
+    }
+    for (auto &[key, entry] : _layouts)
+    {
+        _device.device().destroyPipelineLayout(entry.layout);
+    }
+
+    _pipelines.clear();
+    _pipelineKeys.clear();
+    _layouts.clear();
+    _layoutKeys.clear();
+
+    _freed = true;
+}
+
+Pipeline *PipelineRegistry::acquirePipeline(const std::string &vertFilepath, const std::string &fragFilepath,
+                                            const PipelineConfigInfo &configInfo, const std::string &debugName)
+{
+    _pipelineRequests++;
+
+    PipelineKey key{vertFilepath, fragFilepath, describeConfig(configInfo)};
+    auto it = _pipelines.find(key);
+    if (it == _pipelines.end())
+    {
+        PipelineEntry entry{};
+        entry.pipeline = std::make_unique<Pipeline>(_device, vertFilepath, fragFilepath, configInfo, debugName);
+        it = _pipelines.emplace(key, std::move(entry)).first;
+        _pipelineKeys[it->second.pipeline.get()] = key;
+
+        spdlog::info("PipelineRegistry: {0} pipelines for {1} requests", _pipelines.size(), _pipelineRequests);
+    }
+
+    it->second.references++;
+    return it->second.pipeline.get();
+}
+
+void PipelineRegistry::releasePipeline(Pipeline *pipeline)
+{
+    auto keyIt = _pipelineKeys.find(pipeline);
+    if (keyIt == _pipelineKeys.end())
+    {
+        spdlog::warn("PipelineRegistry: releasing an unknown pipeline");
+        return;
+    }
+
+    auto it = _pipelines.find(keyIt->second);
+    if (--it->second.references == 0)
+    {
+        it->second.pipeline->free();
+        _pipelines.erase(it);
+        _pipelineKeys.erase(keyIt);
+    }
+}
+
+vk::PipelineLayout PipelineRegistry::acquireLayout(const vk::PipelineLayoutCreateInfo &createInfo)
+{
+    _layoutRequests++;
+
+    Description key = describeLayout(createInfo);
+    auto it = _layouts.find(key);
+    if (it == _layouts.end())
+    {
+        LayoutEntry entry{};
+        if (_device.device().createPipelineLayout(&createInfo, nullptr, &entry.layout) != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("failed to create pipeline layout!");
+        }
+
+        _layoutKeys[entry.layout] = key;
+        it = _layouts.emplace(std::move(key), entry).first;
+    }
+
+    it->second.references++;
+    return it->second.layout;
+}
+
+void PipelineRegistry::releaseLayout(vk::PipelineLayout layout)
+{
+    auto keyIt = _layoutKeys.find(layout);
+    if (keyIt == _layoutKeys.end())
+    {
+        spdlog::warn("PipelineRegistry: releasing an unknown pipeline layout");
+        return;
+    }
+
+    auto it = _layouts.find(keyIt->second);
+    if (--it->second.references == 0)
+    {
+        _device.device().destroyPipelineLayout(it->second.layout);
+        _layouts.erase(it);
+        _layoutKeys.erase(keyIt);
+    }
+}
+
+// widened to 64 bits, floats by their bits so the comparison is exact
+template <typename T> static uint64_t describeField(const T &field)
+{
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        static_assert(sizeof(T) == sizeof(uint32_t));
+        uint32_t bits;
+        std::memcpy(&bits, &field, sizeof(bits));
+        return bits;
+    }
+    else if constexpr (std::is_pointer<T>::value)
+    {
+        return reinterpret_cast<uintptr_t>(field);
+    }
+    else
+    {
+        return static_cast<uint64_t>(field);
+    }
+}
+
+template <typename... T> static void describe(std::vector<uint64_t> &description, const T &...fields)
+{
+    (description.push_back(describeField(fields)), ...);
+}
+
+PipelineRegistry::Description PipelineRegistry::describeConfig(const PipelineConfigInfo &configInfo)
+{
+    Description description{};
+
+    for (const vk::VertexInputBindingDescription &binding : configInfo.bindingDescriptions)
+    {
+        describe(description, binding.binding, binding.stride, binding.inputRate);
+    }
+    for (const vk::VertexInputAttributeDescription &attribute : configInfo.attributeDescriptions)
+    {
+        describe(description, attribute.location, attribute.binding, attribute.format, attribute.offset);
+    }
+
+    const vk::PipelineInputAssemblyStateCreateInfo &inputAssembly = configInfo.inputAssemblyInfo;
+    describe(description, inputAssembly.topology, inputAssembly.primitiveRestartEnable);
+
+    const vk::PipelineRasterizationStateCreateInfo &rasterization = configInfo.rasterizationInfo;
+    describe(description, rasterization.depthClampEnable, rasterization.rasterizerDiscardEnable,
+             rasterization.polygonMode, static_cast<uint32_t>(rasterization.cullMode), rasterization.frontFace,
+             rasterization.depthBiasEnable, rasterization.depthBiasConstantFactor, rasterization.depthBiasClamp,
+             rasterization.depthBiasSlopeFactor, rasterization.lineWidth);
+
+    const vk::PipelineMultisampleStateCreateInfo &multisample = configInfo.multisampleInfo;
+    describe(description, multisample.rasterizationSamples, multisample.sampleShadingEnable,
+             multisample.minSampleShading, multisample.alphaToCoverageEnable, multisample.alphaToOneEnable);
+
+    // read through the create info, materials may point it somewhere else than colorBlendAttachments
+    const vk::PipelineColorBlendStateCreateInfo &colorBlend = configInfo.colorBlendInfo;
+    describe(description, colorBlend.logicOpEnable, colorBlend.logicOp, colorBlend.attachmentCount);
+    for (uint32_t i = 0; i < colorBlend.attachmentCount; i++)
+    {
+        const vk::PipelineColorBlendAttachmentState &attachment = colorBlend.pAttachments[i];
+        describe(description, attachment.blendEnable, attachment.srcColorBlendFactor, attachment.dstColorBlendFactor,
+                 attachment.colorBlendOp, attachment.srcAlphaBlendFactor, attachment.dstAlphaBlendFactor,
+                 attachment.alphaBlendOp, static_cast<uint32_t>(attachment.colorWriteMask));
+    }
+    for (float constant : colorBlend.blendConstants)
+    {
+        describe(description, constant);
+    }
+
+    const vk::PipelineDepthStencilStateCreateInfo &depthStencil = configInfo.depthStencilInfo;
+    describe(description, depthStencil.depthTestEnable, depthStencil.depthWriteEnable, depthStencil.depthCompareOp,
+             depthStencil.depthBoundsTestEnable, depthStencil.minDepthBounds, depthStencil.maxDepthBounds,
+             depthStencil.stencilTestEnable);
+    for (const vk::StencilOpState &stencil : {depthStencil.front, depthStencil.back})
+    {
+        describe(description, stencil.failOp, stencil.passOp, stencil.depthFailOp, stencil.compareOp,
+                 stencil.compareMask, stencil.writeMask, stencil.reference);
+    }
+
+    for (uint32_t i = 0; i < configInfo.dynamicStateInfo.dynamicStateCount; i++)
+    {
+        describe(description, configInfo.dynamicStateInfo.pDynamicStates[i]);
+    }
+
+    describe(description, static_cast<VkPipelineLayout>(configInfo.pipelineLayout),
+             static_cast<VkRenderPass>(configInfo.renderPass), configInfo.subpass);
+    for (uint32_t constant : configInfo.fragmentConstants)
+    {
+        describe(description, constant);
+    }
+
+    return description;
+}
+
+PipelineRegistry::Description PipelineRegistry::describeLayout(const vk::PipelineLayoutCreateInfo &createInfo)
+{
+    Description description{};
+
+    describe(description, static_cast<uint32_t>(createInfo.flags), createInfo.setLayoutCount,
+             createInfo.pushConstantRangeCount);
+    for (uint32_t i = 0; i < createInfo.setLayoutCount; i++)
+    {
+        describe(description, static_cast<VkDescriptorSetLayout>(createInfo.pSetLayouts[i]));
+    }
+    for (uint32_t i = 0; i < createInfo.pushConstantRangeCount; i++)
+    {
+        const vk::PushConstantRange &range = createInfo.pPushConstantRanges[i];
+        describe(description, static_cast<uint32_t>(range.stageFlags), range.offset, range.size);
+    }
+
+    return description;
+}
+
 } // namespace cmx
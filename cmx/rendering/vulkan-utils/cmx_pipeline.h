@@ -7,7 +7,11 @@
 #include <vulkan/vulkan_core.h>
 
 // std
+#include <map>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace cmx
@@ -32,6 +36,8 @@ struct PipelineConfigInfo
     vk::PipelineLayout pipelineLayout = nullptr;
     vk::RenderPass renderPass = nullptr;
     uint32_t subpass = 0;
+    // the fragment shader's constant_id i takes fragmentConstants[i], permutations of one SPIR-V
+    std::vector<uint32_t> fragmentConstants{};
 };
 
 class Pipeline
@@ -49,6 +55,8 @@ class Pipeline
     void free();
 
     static void defaultPipelineConfigInfo(PipelineConfigInfo &);
+    // default config plus the per instance stream at binding 1, see Model::Instance
+    static void instancedPipelineConfigInfo(PipelineConfigInfo &);
 
   private:
     static std::vector<char> readFile(const std::string &filepath);
@@ -60,11 +68,64 @@ class Pipeline
 
     Device &_device;
     vk::Pipeline _graphicsPipeline;
-    vk::ShaderModule _vertShaderModule;
-    vk::ShaderModule _fragShaderModule;
 
     bool _freed{false};
 };
+
+// pipelines and layouts shared by every material asking for the same shaders and state, reference counted
+// clones and variants that only differ in their parameters end up on one pipeline, main thread only
+class PipelineRegistry
+{
+  public:
+    PipelineRegistry(Device &);
+    ~PipelineRegistry();
+
+    PipelineRegistry(const PipelineRegistry &) = delete;
+    PipelineRegistry &operator=(const PipelineRegistry &) = delete;
+
+    void free();
+
+    Pipeline *acquirePipeline(const std::string &vertFilepath, const std::string &fragFilepath,
+                              const PipelineConfigInfo &, const std::string &debugName);
+    void releasePipeline(Pipeline *);
+
+    vk::PipelineLayout acquireLayout(const vk::PipelineLayoutCreateInfo &);
+    void releaseLayout(vk::PipelineLayout);
+
+    // everything a pipeline or layout is created from, flattened to compare whole on lookup, a hash alone could
+    // hand out a colliding entry without anyone noticing
+    using Description = std::vector<uint64_t>;
+    static Description describeConfig(const PipelineConfigInfo &);
+    static Description describeLayout(const vk::PipelineLayoutCreateInfo &);
+
+  private:
+    using PipelineKey = std::tuple<std::string, std::string, Description>;
+
+    struct PipelineEntry
+    {
+        std::unique_ptr<Pipeline> pipeline;
+        uint32_t references{0};
+    };
+
+    struct LayoutEntry
+    {
+        vk::PipelineLayout layout;
+        uint32_t references{0};
+    };
+
+    Device &_device;
+
+    std::map<PipelineKey, PipelineEntry> _pipelines{};
+    std::unordered_map<const Pipeline *, PipelineKey> _pipelineKeys{};
+    std::map<Description, LayoutEntry> _layouts{};
+    std::unordered_map<VkPipelineLayout, Description> _layoutKeys{};
+
+    uint32_t _pipelineRequests{0};
+    uint32_t _layoutRequests{0};
+
+    bool _freed{false};
+};
+
 } // namespace cmx
 
 #endif
@@ -11,6 +11,7 @@
 
 // std
 #include <array>
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
@@ -37,7 +38,14 @@ SwapChain::SwapChain(Device &deviceRef, vk::Extent2D extent, std::shared_ptr<Swa
 
 void SwapChain::init()
 {
-    createSwapChain();
+    if (_device.isHeadless())
+    {
+        createOffscreenImages();
+    }
+    else
+    {
+        createSwapChain();
+    }
     createImageViews();
     createRenderPass();
     createFramebuffers();
@@ -68,6 +76,13 @@ void SwapChain::free()
     }
     _swapChainImageViews.clear();
 
+    for (size_t i = 0; i < _offscreenImageMemory.size(); i++)
+    {
+        _device.device().destroyImage(_swapChainImages[i], nullptr);
+        _device.freeMemory(_offscreenImageMemory[i]);
+    }
+    _offscreenImageMemory.clear();
+
     if (_swapChain != nullptr)
     {
         _device.device().destroySwapchainKHR(_swapChain, nullptr);
@@ -93,6 +108,12 @@ vk::Result SwapChain::acquireNextImage(uint32_t *imageIndex)
         spdlog::warn("SwapChain: failed to wait for fences");
     }
 
+    if (_device.isHeadless())
+    {
+        *imageIndex = uint32_t(_currentFrame);
+        return vk::Result::eSuccess;
+    }
+
     vk::Result result = _device.device().acquireNextImageKHR(
         _swapChain, std::numeric_limits<uint64_t>::max(),
         _imageAvailableSemaphores[_currentFrame], // must be a not signaled semaphore
@@ -116,6 +137,25 @@ vk::Result SwapChain::submitCommandBuffers(const vk::CommandBuffer *buffers, uin
     vk::SubmitInfo submitInfo = {};
     submitInfo.sType = vk::StructureType::eSubmitInfo;
 
+    // nothing to wait on nor present to
+    if (_device.isHeadless())
+    {
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = buffers;
+
+        if (_device.device().resetFences(1, &_inFlightFences[_currentFrame]) != vk::Result::eSuccess)
+        {
+            spdlog::warn("SwapChain: failed to reset fence");
+        }
+        if (_device.graphicsQueue().submit(1, &submitInfo, _inFlightFences[_currentFrame]) != vk::Result::eSuccess)
+        {
+            throw std::runtime_error("failed to submit draw command buffer");
+        }
+
+        _currentFrame = (_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        return vk::Result::eSuccess;
+    }
+
     vk::Semaphore waitSemaphores[] = {_imageAvailableSemaphores[_currentFrame]};
     vk::PipelineStageFlags waitStages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
     submitInfo.waitSemaphoreCount = 1;
@@ -230,6 +270,77 @@ void SwapChain::createSwapChain()
     _swapChainExtent = extent;
 }
 
+void SwapChain::createOffscreenImages()
+{
+    _swapChainImageFormat = vk::Format::eR8G8B8A8Srgb;
+    _swapChainExtent = _windowExtent;
+
+    _swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+    _offscreenImageMemory.resize(MAX_FRAMES_IN_FLIGHT);
+
+    vk::ImageCreateInfo imageInfo{};
+    imageInfo.sType = vk::StructureType::eImageCreateInfo;
+    imageInfo.imageType = vk::ImageType::e2D;
+    imageInfo.extent = vk::Extent3D{_swapChainExtent.width, _swapChainExtent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = _swapChainImageFormat;
+    imageInfo.tiling = vk::ImageTiling::eOptimal;
+    imageInfo.initialLayout = vk::ImageLayout::eUndefined;
+    imageInfo.usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc;
+    imageInfo.samples = vk::SampleCountFlagBits::e1;
+    imageInfo.sharingMode = vk::SharingMode::eExclusive;
+
+    for (size_t i = 0; i < _swapChainImages.size(); i++)
+    {
+        _device.createImageWithInfo(imageInfo, vk::MemoryPropertyFlagBits::eDeviceLocal, _swapChainImages[i],
+                                    _offscreenImageMemory[i]);
+        DebugUtil::nameObject(_swapChainImages[i], vk::ObjectType::eImage, "SwapChain Offscreen Image");
+    }
+}
+
+void SwapChain::readImage(uint32_t imageIndex, std::vector<uint8_t> &pixels)
+{
+    assert(_device.isHeadless() && "SwapChain: only offscreen images can be read back");
+
+    const vk::DeviceSize size = vk::DeviceSize(_swapChainExtent.width) * _swapChainExtent.height * 4;
+
+    vk::Buffer stagingBuffer;
+    Allocation stagingMemory;
+    _device.createBuffer(size, vk::BufferUsageFlagBits::eTransferDst,
+                         vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                         stagingBuffer, stagingMemory, MemoryAllocator::eTransient);
+
+    vk::BufferImageCopy region{};
+    region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = vk::Extent3D{_swapChainExtent.width, _swapChainExtent.height, 1};
+
+    // the render pass already left it in eTransferSrcOptimal, its writes still have to be made visible to the copy
+    vk::ImageMemoryBarrier barrier{};
+    barrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+    barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+    barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _swapChainImages[imageIndex];
+    barrier.subresourceRange = vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+
+    vk::CommandBuffer commandBuffer = _device.beginSingleTimeCommands();
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                  vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 1, &barrier);
+    commandBuffer.copyImageToBuffer(_swapChainImages[imageIndex], vk::ImageLayout::eTransferSrcOptimal, stagingBuffer,
+                                    1, &region);
+    _device.endSingleTimeCommands(commandBuffer);
+
+    pixels.resize(size);
+    memcpy(pixels.data(), stagingMemory.mapped, size);
+
+    _device.device().destroyBuffer(stagingBuffer, nullptr);
+    _device.freeMemory(stagingMemory);
+}
+
 void SwapChain::createImageViews()
 {
     _swapChainImageViews.resize(_swapChainImages.size());
@@ -263,7 +374,8 @@ void SwapChain::createRenderPass()
     colorAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
     colorAttachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
     colorAttachment.initialLayout = vk::ImageLayout::eUndefined;
-    colorAttachment.finalLayout = vk::ImageLayout::ePresentSrcKHR;
+    colorAttachment.finalLayout =
+        _device.isHeadless() ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
 
     vk::AttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
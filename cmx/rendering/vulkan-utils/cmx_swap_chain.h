@@ -69,6 +69,9 @@ class SwapChain
     vk::Result acquireNextImage(uint32_t *imageIndex);
     vk::Result submitCommandBuffers(const vk::CommandBuffer *buffers, uint32_t *imageIndex);
 
+    // headless only, copies a finished image back as tightly packed RGBA8
+    void readImage(uint32_t imageIndex, std::vector<uint8_t> &pixels);
+
     bool compareSwapFormats(const SwapChain &swapChain) const
     {
         return (_swapChainDepthFormat == swapChain._swapChainDepthFormat &&
@@ -80,6 +83,8 @@ class SwapChain
   private:
     void init();
     void createSwapChain();
+    // headless, one image per frame in flight stands in for the swap chain's, left in eTransferSrcOptimal
+    void createOffscreenImages();
     void createImageViews();
     void createRenderPass();
     void createFramebuffers();
@@ -98,6 +103,7 @@ class SwapChain
 
     std::vector<vk::Image> _swapChainImages;
     std::vector<vk::ImageView> _swapChainImageViews;
+    std::vector<Allocation> _offscreenImageMemory;
 
     vk::Extent2D _windowExtent;
 
@@ -0,0 +1,391 @@
+#include "cmx_upload_manager.h"
+
+// cmx
+#include "cmx_buffer.h"
+#include "cmx_device.h"
+
+// lib
+#include <spdlog/spdlog.h>
+
+// std
+#include <cstring>
+#include <stdexcept>
+
+namespace cmx
+{
+
+UploadManager::UploadManager(Device &device) : _device{device}
+{
+    QueueFamilyIndices indices = device.findPhysicalQueueFamilies();
+    _graphicsFamily = indices.graphicsFamily;
+    _transferFamily = indices.transferFamilyHasValue ? indices.transferFamily : indices.graphicsFamily;
+
+    vk::CommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = vk::StructureType::eCommandPoolCreateInfo;
+    poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+
+    poolInfo.queueFamilyIndex = _transferFamily;
+    _transferPool = device.device().createCommandPool(poolInfo);
+    poolInfo.queueFamilyIndex = _graphicsFamily;
+    _graphicsPool = device.device().createCommandPool(poolInfo);
+
+    vk::SemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+    timelineInfo.initialValue = 0;
+
+    vk::SemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.pNext = &timelineInfo;
+    _transferTimeline = device.device().createSemaphore(semaphoreInfo);
+    _graphicsTimeline = device.device().createSemaphore(semaphoreInfo);
+
+    _ring = std::make_unique<Buffer>(device, STAGING_RING_SIZE, 1, vk::BufferUsageFlagBits::eTransferSrc,
+                                     vk::MemoryPropertyFlagBits::eHostVisible |
+                                         vk::MemoryPropertyFlagBits::eHostCoherent);
+    _ring->map();
+
+    spdlog::info("UploadManager: uploading through {0}", hasTransferQueue() ? "a dedicated transfer queue"
+                                                                              : "the graphics queue");
+}
+
+UploadManager::~UploadManager()
+{
+    if (!_freed)
+    {
+        spdlog::error("UploadManager: forgot to free before deletion");
+    }
+}
+
+void UploadManager::free()
+{
+    if (_freed)
+        return;
+
+    if (_open.transferCommands)
+    {
+        submit();
+    }
+    wait(_submittedValue);
+
+    _ring->free();
+    _ring.reset();
+
+    _device.device().destroySemaphore(_transferTimeline);
+    _device.device().destroySemaphore(_graphicsTimeline);
+    _device.device().destroyCommandPool(_transferPool);
+    _device.device().destroyCommandPool(_graphicsPool);
+
+    _freed = true;
+}
+
+uint64_t UploadManager::uploadBuffer(vk::Buffer dst, const void *data, vk::DeviceSize size,
+                                     vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess)
+{
+    Staging staging = reserve(size);
+    memcpy(staging.mapped, data, static_cast<size_t>(size));
+
+    Batch &batch = openBatch();
+
+    vk::BufferCopy region{};
+    region.srcOffset = staging.offset;
+    region.dstOffset = 0;
+    region.size = size;
+    batch.transferCommands.copyBuffer(staging.buffer, dst, 1, &region);
+
+    vk::BufferMemoryBarrier barrier{};
+    barrier.buffer = dst;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    barrier.srcQueueFamilyIndex = hasTransferQueue() ? _transferFamily : vk::QueueFamilyIgnored;
+    barrier.dstQueueFamilyIndex = hasTransferQueue() ? _graphicsFamily : vk::QueueFamilyIgnored;
+
+    if (hasTransferQueue())
+    {
+        // release, the matching acquire below is what makes the copy visible
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = {};
+        batch.transferCommands.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                               vk::PipelineStageFlagBits::eBottomOfPipe, {}, 0, nullptr, 1, &barrier,
+                                               0, nullptr);
+    }
+
+    barrier.srcAccessMask = hasTransferQueue() ? vk::AccessFlags{} : vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask = dstAccess;
+    batch.graphicsCommands.pipelineBarrier(hasTransferQueue() ? vk::PipelineStageFlagBits::eTopOfPipe
+                                                               : vk::PipelineStageFlagBits::eTransfer,
+                                           dstStage, {}, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    batch.stagedBytes += size;
+    const uint64_t ticket = batch.value;
+    if (batch.stagedBytes >= UPLOAD_BATCH_SIZE)
+    {
+        submit();
+    }
+
+    return ticket;
+}
+
+uint64_t UploadManager::uploadImage(vk::Image image, const std::vector<const void *> &slices,
+                                    vk::DeviceSize sliceSize, vk::Extent3D extent, uint32_t mipLevels,
+                                    const std::function<void(vk::CommandBuffer)> &finish)
+{
+    const vk::DeviceSize size = sliceSize * slices.size();
+
+    Staging staging = reserve(size);
+    for (size_t i = 0; i < slices.size(); i++)
+    {
+        memcpy(staging.mapped + i * sliceSize, slices[i], static_cast<size_t>(sliceSize));
+    }
+
+    Batch &batch = openBatch();
+
+    vk::ImageMemoryBarrier barrier{};
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
+    barrier.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
+    barrier.oldLayout = vk::ImageLayout::eUndefined;
+    barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.srcAccessMask = {};
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+    batch.transferCommands.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                           vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 1,
+                                           &barrier);
+
+    vk::BufferImageCopy region{};
+    region.bufferOffset = staging.offset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = vk::Offset3D{0, 0, 0};
+    region.imageExtent = extent;
+    batch.transferCommands.copyBufferToImage(staging.buffer, image, vk::ImageLayout::eTransferDstOptimal, 1,
+                                             &region);
+
+    // the layout stays eTransferDstOptimal across the ownership transfer, finish takes it from there
+    barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.srcQueueFamilyIndex = hasTransferQueue() ? _transferFamily : vk::QueueFamilyIgnored;
+    barrier.dstQueueFamilyIndex = hasTransferQueue() ? _graphicsFamily : vk::QueueFamilyIgnored;
+
+    if (hasTransferQueue())
+    {
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = {};
+        batch.transferCommands.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                               vk::PipelineStageFlagBits::eBottomOfPipe, {}, 0, nullptr, 0, nullptr,
+                                               1, &barrier);
+    }
+
+    barrier.srcAccessMask = hasTransferQueue() ? vk::AccessFlags{} : vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite;
+    batch.graphicsCommands.pipelineBarrier(hasTransferQueue() ? vk::PipelineStageFlagBits::eTopOfPipe
+                                                               : vk::PipelineStageFlagBits::eTransfer,
+                                           vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 1,
+                                           &barrier);
+
+    finish(batch.graphicsCommands);
+
+    batch.stagedBytes += size;
+    const uint64_t ticket = batch.value;
+    if (batch.stagedBytes >= UPLOAD_BATCH_SIZE)
+    {
+        submit();
+    }
+
+    return ticket;
+}
+
+void UploadManager::update()
+{
+    if (_open.transferCommands)
+    {
+        submit();
+    }
+    retire();
+}
+
+void UploadManager::wait(uint64_t ticket)
+{
+    if (ticket == 0 || isComplete(ticket))
+        return;
+
+    if (ticket > _submittedValue)
+    {
+        submit();
+    }
+
+    vk::SemaphoreWaitInfo waitInfo{};
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &_graphicsTimeline;
+    waitInfo.pValues = &ticket;
+
+    if (_device.device().waitSemaphores(waitInfo, UINT64_MAX) != vk::Result::eSuccess)
+    {
+        spdlog::warn("UploadManager: failed waiting for upload {0}", ticket);
+    }
+
+    retire();
+}
+
+UploadManager::Batch &UploadManager::openBatch()
+{
+    if (_open.transferCommands)
+        return _open;
+
+    vk::CommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = vk::StructureType::eCommandBufferAllocateInfo;
+    allocInfo.level = vk::CommandBufferLevel::ePrimary;
+    allocInfo.commandBufferCount = 1;
+
+    allocInfo.commandPool = _transferPool;
+    if (_device.device().allocateCommandBuffers(&allocInfo, &_open.transferCommands) != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+    allocInfo.commandPool = _graphicsPool;
+    if (_device.device().allocateCommandBuffers(&allocInfo, &_open.graphicsCommands) != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+
+    vk::CommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = vk::StructureType::eCommandBufferBeginInfo;
+    beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+    if (_open.transferCommands.begin(&beginInfo) != vk::Result::eSuccess ||
+        _open.graphicsCommands.begin(&beginInfo) != vk::Result::eSuccess)
+    {
+        spdlog::warn("UploadManager: failed to begin command buffer !");
+    }
+
+    _open.value = _submittedValue + 1;
+    return _open;
+}
+
+UploadManager::Staging UploadManager::reserve(vk::DeviceSize size)
+{
+    if (size > STAGING_RING_SIZE)
+    {
+        auto buffer = std::make_unique<Buffer>(_device, size, 1, vk::BufferUsageFlagBits::eTransferSrc,
+                                               vk::MemoryPropertyFlagBits::eHostVisible |
+                                                   vk::MemoryPropertyFlagBits::eHostCoherent);
+        buffer->map();
+
+        Staging staging{buffer->getBuffer(), 0, static_cast<char *>(buffer->getMappedMemory())};
+        openBatch().oversized.push_back(std::move(buffer));
+        return staging;
+    }
+
+    for (;;)
+    {
+        uint64_t start = (_ringHead + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+        if (start % STAGING_RING_SIZE + size > STAGING_RING_SIZE)
+        {
+            // never straddles the end, skips to the start of the ring instead
+            start = (start / STAGING_RING_SIZE + 1) * STAGING_RING_SIZE;
+        }
+
+        if (start + size - _ringTail <= STAGING_RING_SIZE)
+        {
+            _ringHead = start + size;
+
+            const vk::DeviceSize offset = start % STAGING_RING_SIZE;
+            return Staging{_ring->getBuffer(), offset, static_cast<char *>(_ring->getMappedMemory()) + offset};
+        }
+
+        // the ring is full of copies in flight, wait for the oldest to free its space
+        if (_inFlight.empty())
+        {
+            submit();
+        }
+        wait(_inFlight.front().value);
+    }
+}
+
+void UploadManager::submit()
+{
+    if (!_open.transferCommands)
+        return;
+
+    _open.transferCommands.end();
+    _open.graphicsCommands.end();
+    _open.ringEnd = _ringHead;
+
+    const uint64_t value = _open.value;
+
+    vk::TimelineSemaphoreSubmitInfo transferTimelineInfo{};
+    transferTimelineInfo.signalSemaphoreValueCount = 1;
+    transferTimelineInfo.pSignalSemaphoreValues = &value;
+
+    vk::SubmitInfo transferSubmit{};
+    transferSubmit.sType = vk::StructureType::eSubmitInfo;
+    transferSubmit.pNext = &transferTimelineInfo;
+    transferSubmit.commandBufferCount = 1;
+    transferSubmit.pCommandBuffers = &_open.transferCommands;
+    transferSubmit.signalSemaphoreCount = 1;
+    transferSubmit.pSignalSemaphores = &_transferTimeline;
+
+    if (_device.transferQueue().submit(1, &transferSubmit, VK_NULL_HANDLE) != vk::Result::eSuccess)
+    {
+        spdlog::warn("UploadManager: failed to submit transfer queue !");
+    }
+
+    vk::TimelineSemaphoreSubmitInfo graphicsTimelineInfo{};
+    graphicsTimelineInfo.waitSemaphoreValueCount = 1;
+    graphicsTimelineInfo.pWaitSemaphoreValues = &value;
+    graphicsTimelineInfo.signalSemaphoreValueCount = 1;
+    graphicsTimelineInfo.pSignalSemaphoreValues = &value;
+
+    const vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eAllCommands;
+
+    vk::SubmitInfo graphicsSubmit{};
+    graphicsSubmit.sType = vk::StructureType::eSubmitInfo;
+    graphicsSubmit.pNext = &graphicsTimelineInfo;
+    graphicsSubmit.waitSemaphoreCount = 1;
+    graphicsSubmit.pWaitSemaphores = &_transferTimeline;
+    graphicsSubmit.pWaitDstStageMask = &waitStage;
+    graphicsSubmit.commandBufferCount = 1;
+    graphicsSubmit.pCommandBuffers = &_open.graphicsCommands;
+    graphicsSubmit.signalSemaphoreCount = 1;
+    graphicsSubmit.pSignalSemaphores = &_graphicsTimeline;
+
+    if (_device.graphicsQueue().submit(1, &graphicsSubmit, VK_NULL_HANDLE) != vk::Result::eSuccess)
+    {
+        spdlog::warn("UploadManager: failed to submit graphics queue !");
+    }
+
+    _submittedValue = value;
+    _inFlight.push_back(std::move(_open));
+    _open = Batch{};
+}
+
+void UploadManager::retire()
+{
+    if (_inFlight.empty())
+        return;
+
+    _completedValue = _device.device().getSemaphoreCounterValue(_graphicsTimeline);
+
+    while (!_inFlight.empty() && _inFlight.front().value <= _completedValue)
+    {
+        Batch &batch = _inFlight.front();
+
+        _device.device().freeCommandBuffers(_transferPool, 1, &batch.transferCommands);
+        _device.device().freeCommandBuffers(_graphicsPool, 1, &batch.graphicsCommands);
+        for (std::unique_ptr<Buffer> &buffer : batch.oversized)
+        {
+            buffer->free();
+        }
+
+        _ringTail = batch.ringEnd;
+        _inFlight.pop_front();
+    }
+}
+
+} // namespace cmx
@@ -0,0 +1,108 @@
+#ifndef CMX_UPLOAD_MANAGER
+#define CMX_UPLOAD_MANAGER
+
+// lib
+#include <vulkan/vulkan.hpp>
+
+// std
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#define STAGING_RING_SIZE (32 * 1024 * 1024)
+#define STAGING_ALIGNMENT 16
+// a batch is submitted as soon as it has staged this much, so the GPU starts copying while the rest is recorded
+#define UPLOAD_BATCH_SIZE (8 * 1024 * 1024)
+
+namespace cmx
+{
+
+// records asset uploads into batches of copies staged through a persistent ring buffer, copies run on the transfer
+// queue when the device has a dedicated one, then the graphics queue acquires the resources and finishes them
+// every upload returns a ticket, the resource is usable once isComplete(ticket), main thread only
+class UploadManager
+{
+  public:
+    UploadManager(class Device &);
+    ~UploadManager();
+
+    UploadManager(const UploadManager &) = delete;
+    UploadManager &operator=(const UploadManager &) = delete;
+
+    // waits for every upload in flight
+    void free();
+
+    // dst must have been created with eTransferDst, dstStage and dstAccess describe its first use
+    uint64_t uploadBuffer(vk::Buffer dst, const void *data, vk::DeviceSize size, vk::PipelineStageFlags dstStage,
+                          vk::AccessFlags dstAccess);
+    // copies the slices back to back into mip 0, leaving every mip in eTransferDstOptimal
+    // finish then records on the graphics queue, it must leave the image ready to be sampled
+    uint64_t uploadImage(vk::Image, const std::vector<const void *> &slices, vk::DeviceSize sliceSize, vk::Extent3D,
+                         uint32_t mipLevels, const std::function<void(vk::CommandBuffer)> &finish);
+
+    // submits what's been recorded and releases the staging space of finished batches, once per frame
+    void update();
+    void wait(uint64_t ticket);
+
+    bool isComplete(uint64_t ticket) const
+    {
+        return ticket <= _completedValue;
+    }
+
+  private:
+    struct Batch
+    {
+        uint64_t value{0};
+        vk::CommandBuffer transferCommands{};
+        vk::CommandBuffer graphicsCommands{};
+        uint64_t ringEnd{0};
+        vk::DeviceSize stagedBytes{0};
+        // staging for uploads larger than the whole ring
+        std::vector<std::unique_ptr<class Buffer>> oversized{};
+    };
+
+    struct Staging
+    {
+        vk::Buffer buffer;
+        vk::DeviceSize offset;
+        char *mapped;
+    };
+
+    Batch &openBatch();
+    Staging reserve(vk::DeviceSize size);
+    void submit();
+    void retire();
+
+    bool hasTransferQueue() const
+    {
+        return _transferFamily != _graphicsFamily;
+    }
+
+    class Device &_device;
+
+    uint32_t _transferFamily;
+    uint32_t _graphicsFamily;
+    vk::CommandPool _transferPool;
+    vk::CommandPool _graphicsPool;
+    // one per queue, both reach a batch's value once its part is done, so a batch is complete with the graphics one
+    vk::Semaphore _transferTimeline;
+    vk::Semaphore _graphicsTimeline;
+
+    std::unique_ptr<class Buffer> _ring;
+    // monotonic byte positions, the ring offset is position % STAGING_RING_SIZE
+    uint64_t _ringHead{0};
+    uint64_t _ringTail{0};
+
+    Batch _open{};
+    std::deque<Batch> _inFlight{};
+    uint64_t _submittedValue{0};
+    uint64_t _completedValue{0};
+
+    bool _freed{false};
+};
+
+} // namespace cmx
+
+#endif
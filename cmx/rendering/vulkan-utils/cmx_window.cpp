@@ -11,13 +11,25 @@ namespace cmx
 
 Window::Window(int w, int h, std::string name) : _width{w}, _height{h}, _windowName{name}
 {
-    initWindow();
 }
 
 Window::~Window()
 {
-    glfwDestroyWindow(_glfwWindow);
-    glfwTerminate();
+    if (_glfwWindow)
+    {
+        glfwDestroyWindow(_glfwWindow);
+        glfwTerminate();
+    }
+}
+
+void Window::open(bool headless)
+{
+    _headless = headless;
+    _opened = true;
+    if (!_headless)
+    {
+        initWindow();
+    }
 }
 
 void Window::framebufferResizeCallback(GLFWwindow *glfwWindow, int width, int height)
@@ -21,9 +21,26 @@ class Window
     Window(const Window &) = delete;
     Window &operator=(const Window &) = delete;
 
+    // creates the GLFW window, a headless one only has a size, GLFW isn't even initialized
+    void open(bool headless = false);
+    bool isOpen() const
+    {
+        return _opened;
+    }
+
     bool shouldClose() const
     {
-        return glfwWindowShouldClose(_glfwWindow);
+        return _headless ? false : glfwWindowShouldClose(_glfwWindow);
+    }
+    // no surface nor swap chain, frames are rendered into offscreen images
+    bool isHeadless() const
+    {
+        return _headless;
+    }
+    void setExtent(int width, int height)
+    {
+        _width = width;
+        _height = height;
     }
     vk::Extent2D getExtent() const
     {
@@ -53,7 +70,9 @@ class Window
     bool _framebufferResized = false;
 
     std::string _windowName;
-    GLFWwindow *_glfwWindow;
+    GLFWwindow *_glfwWindow{nullptr};
+    bool _headless{false};
+    bool _opened{false};
 };
 
 } // namespace cmx
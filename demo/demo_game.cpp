@@ -52,6 +52,8 @@ void Demo::run()
         float dt = std::min(glfwGetTime(), 0.2);
         glfwSetTime(0.);
 
+        updateSceneLoading();
+
 #ifndef NDEBUG
         editor->update(dt);
         if (!cmx::Editor::isActive())
@@ -75,5 +77,7 @@ void Demo::load()
     _inputManager->load();
 
     _scenes.push_back(&mainScene);
-    setScene(0);
+    // nothing runs until the first scene is ready, a progress bar is drawn meanwhile
+    setSceneAsync(0);
+    finishSceneLoading();
 }
@@ -4,6 +4,7 @@
 #include "cmx_game.h"
 #include "cmx_input_manager.h"
 #include "cmx_mesh_component.h"
+#include "cmx_scene_records.h"
 
 // lib
 #include "imgui.h"
@@ -11,10 +12,25 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
+struct RotatingActorRecord
+{
+    float slowSpeed;
+    float fastSpeed;
+};
+
+RotatingActor::RotatingActor(cmx::Scene *scene, uint32_t id, const std::string &name, const cmx::Transform &transform)
+    : cmx::Actor{scene, id, name, transform}
+{
+    // purely cosmetic, it can slow down far from the camera
+    _tickLOD = true;
+}
+
 void RotatingActor::onBegin()
 {
     cmx::Actor::onBegin();
 
+    _threadSafeUpdate = true;
+
     cmx::InputManager *inputManager = getScene()->getGame()->getInputManager();
     if (inputManager)
     {
@@ -43,8 +59,8 @@ void RotatingActor::editor()
 {
     if (ImGui::CollapsingHeader("Rotation"))
     {
-        ImGui::DragFloat("Slow Speed", &rotationSpeedSlow, 0.01f, -10.0f, 10.0f, "%.2f");
-        ImGui::DragFloat("Fast Speed", &rotationSpeedFast, 0.01f, -10.0f, 10.0f, "%.2f");
+        _dirty |= ImGui::DragFloat("Slow Speed", &rotationSpeedSlow, 0.01f, -10.0f, 10.0f, "%.2f");
+        _dirty |= ImGui::DragFloat("Fast Speed", &rotationSpeedFast, 0.01f, -10.0f, 10.0f, "%.2f");
     }
 
     cmx::Actor::editor();
@@ -68,3 +84,21 @@ void RotatingActor::load(tinyxml2::XMLElement *actorElement)
     rotationSpeedFast = actorElement->FloatAttribute("fastSpeed");
     rotationSpeed = rotationSpeedFast;
 }
+
+void RotatingActor::writeRecord(cmx::RecordWriter &writer) const
+{
+    cmx::Actor::writeRecord(writer);
+    writer.write(RotatingActorRecord{rotationSpeedSlow, rotationSpeedFast});
+}
+
+void RotatingActor::readRecord(cmx::RecordReader &reader, const cmx::ActorRecord &actorRecord)
+{
+    cmx::Actor::readRecord(reader, actorRecord);
+
+    if (const RotatingActorRecord *record = reader.read<RotatingActorRecord>())
+    {
+        rotationSpeedSlow = record->slowSpeed;
+        rotationSpeedFast = record->fastSpeed;
+        rotationSpeed = rotationSpeedFast;
+    }
+}
@@ -7,7 +7,7 @@
 class RotatingActor : public cmx::Actor
 {
   public:
-    using cmx::Actor::Actor;
+    RotatingActor(cmx::Scene *, uint32_t id, const std::string &name, const cmx::Transform &);
 
     void onBegin() override;
     void update(float dt) override;
@@ -18,6 +18,8 @@ class RotatingActor : public cmx::Actor
 
     tinyxml2::XMLElement &save(tinyxml2::XMLDocument &, tinyxml2::XMLElement *) const override;
     void load(tinyxml2::XMLElement *) override;
+    void writeRecord(cmx::RecordWriter &) const override;
+    void readRecord(cmx::RecordReader &, const cmx::ActorRecord &) override;
 
   private:
     float rotationSpeedSlow{0.03f};
@@ -33,6 +33,7 @@ class BulletActor : public cmx::PhysicsActor
         return *e;
     }; // cannot be saved
     void load(tinyxml2::XMLElement *) override {}; // cannot be saved
+    void writeRecord(cmx::RecordWriter &) const override {}; // cannot be saved
 
     void setBulletInfo(const BulletInfo &);
     void setDirection(const glm::vec3 &direction)
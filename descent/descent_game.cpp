@@ -52,6 +52,8 @@ void Descent::run()
         float dt = (float)glfwGetTime();
         glfwSetTime(0.);
 
+        updateSceneLoading();
+
 #ifndef NDEBUG
         editor->update(dt);
         if (!cmx::Editor::isActive())
@@ -75,5 +77,7 @@ void Descent::load()
     _inputManager->load();
 
     _scenes.push_back(&mainScene);
-    setScene(0);
+    // nothing runs until the first scene is ready, a progress bar is drawn meanwhile
+    setSceneAsync(0);
+    finishSceneLoading();
 }
@@ -29,6 +29,8 @@ void EnemyShipActor::onBegin()
 {
     cmx::PhysicsActor::onBegin();
 
+    _threadSafeUpdate = true;
+
     _transform.scale.x = _transform.scale.y = _transform.scale.z = .6f;
 
     _gunComponent = std::make_shared<GunComponent>();
@@ -48,11 +48,14 @@ void GunComponent::shoot()
 
     transform.position = transform.position + (transform.up() * -1.0f);
 
-    const std::string name = fmt::format("Bullet_{}", BulletActor::bulletId++);
-    BulletActor *actor = cmx::Actor::spawn<BulletActor>(getScene(), name.c_str(), transform);
-    actor->setBulletInfo(_gunInfo.bulletInfo);
+    // may be called from a parallel actor update, the bullet is spawned once the tick group is done
+    getScene()->defer([scene = getScene(), transform, bulletInfo = _gunInfo.bulletInfo]() {
+        const std::string name = fmt::format("Bullet_{}", BulletActor::bulletId++);
+        BulletActor *actor = cmx::Actor::spawn<BulletActor>(scene, name.c_str(), transform);
+        actor->setBulletInfo(bulletInfo);
 
-    actor->setDirection(transform.forward());
+        actor->setDirection(transform.forward());
+    });
 
     _t = _gunInfo.timeBetweenShots;
     _ammunitions--;
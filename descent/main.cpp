@@ -4,16 +4,23 @@
 #include <cstdlib>
 
 // cmx
+#include <cmx_benchmark.h>
 #include <cmx_editor.h>
 #include <cmx_register.h>
 
-int main()
+int main(int argc, char **argv)
 {
+    // opens the window headless when asked to benchmark, so it has to come before the game
+    cmx::Benchmark benchmark{argc, argv};
     Descent app{};
 
     try
     {
         app.load();
+        if (benchmark.isEnabled())
+        {
+            return benchmark.run(app);
+        }
 #ifndef NDEBUG
         cmx::Editor *editor = cmx::Editor::getInstance();
         editor->load(app.getWindow());
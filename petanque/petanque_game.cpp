@@ -50,6 +50,8 @@ void Petanque::run()
         float dt = std::min(glfwGetTime(), 0.2);
         glfwSetTime(0.);
 
+        updateSceneLoading();
+
 #ifndef NDEBUG
         editor->update(dt);
         if (!cmx::Editor::isActive())
@@ -78,5 +80,7 @@ void Petanque::load()
     _inputManager->load();
 
     _scenes.emplace_back(new cmx::Scene("scenes/field.xml", this, "field"));
-    setScene(0);
+    // nothing runs until the first scene is ready, a progress bar is drawn meanwhile
+    setSceneAsync(0);
+    finishSceneLoading();
 }
@@ -14,12 +14,6 @@ struct DirectionalLight
     vec4 direction;
 };
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo
 {
     mat4 projectionMatrix;
@@ -27,8 +21,8 @@ layout(set = 0, binding = 0) uniform GlobalUbo
     vec4 ambientLight;
     vec4 cameraPosition;
     DirectionalLight sun;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
 }
 ubo;
 
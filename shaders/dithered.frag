@@ -4,13 +4,12 @@ layout(location = 0) in vec3 inPositionWorld;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormalWorld;
 layout(location = 3) in vec2 inUV;
-layout(location = 4) in vec4 inPositionLightSpace;
 
 layout(location = 5) in vec3 inDarkColor;
 layout(location = 6) in vec3 inLightColor;
 
 layout(set = 1, binding = 0) uniform sampler3D sDitheringPattern;
-layout(set = 2, binding = 0) uniform sampler2D sShadowMap;
+layout(set = 2, binding = 0) uniform sampler2DArray sShadowMap;
 
 layout(location = 0) out vec4 outColor;
 layout(location = 1) out vec4 outNormal;
@@ -23,12 +22,6 @@ struct DirectionalLight
     vec4 direction;
 };
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo
 {
     mat4 projectionMatrix;
@@ -36,8 +29,12 @@ layout(set = 0, binding = 0) uniform GlobalUbo
     vec4 ambientLight;
     vec4 cameraPosition;
     DirectionalLight sun;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
+    int sunCascadeCount;
+    vec4 sunCascadeSplits; // view space depth each cascade ends at
+    vec4 sunCascadeBiases;
+    mat4 sunCascades[4]; // projection * view
 }
 ubo;
 
@@ -101,35 +98,54 @@ vec2 propperDitheringScale(float brightness)
     return vec2(exp2(roundedLogCurve), subLayer);
 }
 
-float getShadowFactor(vec2 inUV, vec3 projCoords)
+float getShadowFactor(vec2 inUV, vec3 projCoords, int cascade)
 {
-    float depth = texture(sShadowMap, inUV).r;
+    float depth = texture(sShadowMap, vec3(inUV, cascade)).r;
 
-    if (projCoords.z - depth < 0.025)
+    if (projCoords.z - depth < ubo.sunCascadeBiases[cascade])
     {
         return 1.0;
     }
     return 0.2;
 }
 
-float getPCFShadow(vec3 projCoords)
+float getPCFShadow(vec3 projCoords, int cascade)
 {
     const float angle = two_PI / 8.0;
     const vec2 lightUVCoords = 0.5 * projCoords.xy + 0.5;
-    const vec2 texelSize = 1.0 / textureSize(sShadowMap, 0) * 1.5;
+    const vec2 texelSize = 1.0 / textureSize(sShadowMap, 0).xy * 1.5;
     ;
 
-    float combined = getShadowFactor(lightUVCoords, projCoords);
+    float combined = getShadowFactor(lightUVCoords, projCoords, cascade);
 
     for (int i = 0; i < 8; i++)
     {
         const vec2 uvOffset = vec2(cos(angle * i), sin(angle * i)) * texelSize.x;
-        combined += getShadowFactor(lightUVCoords + uvOffset, projCoords);
+        combined += getShadowFactor(lightUVCoords + uvOffset, projCoords, cascade);
     }
 
     return combined / 9.0;
 }
 
+float getCascadedShadow()
+{
+    const float viewDepth = (ubo.viewMatrix * vec4(inPositionWorld, 1.0)).z;
+    if (viewDepth > ubo.sunCascadeSplits[ubo.sunCascadeCount - 1])
+    {
+        return 1.0;
+    }
+
+    // the nearest cascade holding the fragment has the most texels per world unit
+    int cascade = 0;
+    while (cascade < ubo.sunCascadeCount - 1 && viewDepth > ubo.sunCascadeSplits[cascade])
+    {
+        cascade++;
+    }
+
+    const vec4 positionLightSpace = ubo.sunCascades[cascade] * vec4(inPositionWorld, 1.0);
+    return getPCFShadow(positionLightSpace.xyz / positionLightSpace.w, cascade);
+}
+
 vec3 getDiffuseLight()
 {
     // ambient light
@@ -140,8 +156,7 @@ vec3 getDiffuseLight()
     if (ubo.sun.color.w > 0)
     {
         float cosAngIncidence = max(dot(surfaceNormal, -ubo.sun.direction.xyz), 0.0);
-        const vec3 projCoords = inPositionLightSpace.xyz / inPositionLightSpace.w;
-        diffuseLight += ubo.sun.color.xyz * ubo.sun.color.w * min(getPCFShadow(projCoords), cosAngIncidence);
+        diffuseLight += ubo.sun.color.xyz * ubo.sun.color.w * min(getCascadedShadow(), cosAngIncidence);
     }
 
     return diffuseLight;
@@ -10,7 +10,6 @@ layout(location = 0) out vec3 outPositionWorld;
 layout(location = 1) out vec3 outColor;
 layout(location = 2) out vec3 outNormalWorld;
 layout(location = 3) out vec2 outUV;
-layout(location = 4) out vec4 outPositionLightSpace;
 
 layout(location = 5) out vec3 outDarkColor;
 layout(location = 6) out vec3 outLightColor;
@@ -23,12 +22,6 @@ struct DirectionalLight
     vec4 direction;
 };
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo
 {
     mat4 projectionMatrix;
@@ -36,8 +29,8 @@ layout(set = 0, binding = 0) uniform GlobalUbo
     vec4 ambientLight;
     vec4 cameraPosition;
     DirectionalLight sun;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
 }
 ubo;
 
@@ -80,7 +73,6 @@ void main()
     outNormalWorld = normalize(mat3(push.normalMatrix) * normal);
     outPositionWorld = worldPosition.xyz;
     outColor = color;
-    outPositionLightSpace = ubo.sun.projectionMatrix * ubo.sun.viewMatrix * worldPosition;
 
     outUV = worldSpaceUV ? getWorldSpaceUV() : uv;
 }
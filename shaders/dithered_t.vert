@@ -10,7 +10,6 @@ layout(location = 0) out vec3 outPositionWorld;
 layout(location = 1) out vec3 outColor;
 layout(location = 2) out vec3 outNormalWorld;
 layout(location = 3) out vec2 outUV;
-layout(location = 4) out vec4 outPositionLightSpace;
 
 struct DirectionalLight
 {
@@ -20,12 +19,6 @@ struct DirectionalLight
     vec4 direction;
 };
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo
 {
     mat4 projectionMatrix;
@@ -33,8 +26,8 @@ layout(set = 0, binding = 0) uniform GlobalUbo
     vec4 ambientLight;
     vec4 cameraPosition;
     DirectionalLight sun;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
 }
 ubo;
 
@@ -71,7 +64,6 @@ void main()
     outNormalWorld = normalize(mat3(push.normalMatrix) * normal);
     outPositionWorld = worldPosition.xyz;
     outColor = color;
-    outPositionLightSpace = ubo.sun.projectionMatrix * ubo.sun.viewMatrix * worldPosition;
 
     if (push.normalMatrix[2][3] == 0.f)
     {
@@ -7,19 +7,13 @@ layout(location = 2) in vec3 inNormalWorld;
 layout(location = 0) out vec4 outColor;
 layout(location = 1) out vec4 outNormal;
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo
 {
     mat4 projectionMatrix;
     mat4 viewMatrix;
     vec4 ambientLight;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
 }
 ubo;
 
@@ -10,19 +10,13 @@ layout(location = 0) out vec3 outColor;
 layout(location = 1) out vec3 outPositionWorld;
 layout(location = 2) out vec3 outNormalWorld;
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo
 {
     mat4 projectionMatrix;
     mat4 viewMatrix;
     vec4 ambientLight;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
 }
 ubo;
 
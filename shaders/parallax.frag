@@ -4,7 +4,6 @@ layout(location = 0) in vec3 inPositionWorld;
 layout(location = 1) in vec3 inNormalWorld;
 layout(location = 2) in vec3 inColor;
 layout(location = 3) in vec2 inUV;
-layout(location = 4) in vec4 inPositionLightSpace;
 
 layout(location = 5) in vec3 inSunDirectionTangent;
 layout(location = 6) in vec3 inCameraPositionTangent;
@@ -12,7 +11,7 @@ layout(location = 7) in vec3 inPositionTangent;
 
 layout(set = 1, binding = 0) uniform sampler2D sColor;
 layout(set = 2, binding = 0) uniform sampler2D sNormalHeight;
-layout(set = 3, binding = 0) uniform sampler2D sShadowMap;
+layout(set = 3, binding = 0) uniform sampler2DArray sShadowMap;
 
 layout(location = 0) out vec4 outColor;
 layout(location = 1) out vec4 outNormal;
@@ -25,12 +24,6 @@ struct DirectionalLight
     vec4 direction;
 };
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo
 {
     mat4 projectionMatrix;
@@ -38,8 +31,12 @@ layout(set = 0, binding = 0) uniform GlobalUbo
     vec4 ambientLight;
     vec4 cameraPosition;
     DirectionalLight sun;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
+    int sunCascadeCount;
+    vec4 sunCascadeSplits; // view space depth each cascade ends at
+    vec4 sunCascadeBiases;
+    mat4 sunCascades[4]; // projection * view
 }
 ubo;
 
@@ -53,34 +50,53 @@ push;
 const float PI = 3.1415;
 const float two_PI = 6.2831;
 
-float getShadowFactor(vec2 inUV, vec3 projCoords)
+float getShadowFactor(vec2 inUV, vec3 projCoords, int cascade)
 {
-    float depth = texture(sShadowMap, inUV).r;
+    float depth = texture(sShadowMap, vec3(inUV, cascade)).r;
 
-    if (projCoords.z - depth < 0.025)
+    if (projCoords.z - depth < ubo.sunCascadeBiases[cascade])
     {
         return 1.0;
     }
     return 0.f;
 }
 
-float getPCFShadow(vec3 projCoords)
+float getPCFShadow(vec3 projCoords, int cascade)
 {
     const float angle = two_PI / 8.f;
     const vec2 lightUVCoords = 0.5 * projCoords.xy + 0.5;
-    const vec2 texelSize = 1.0 / textureSize(sShadowMap, 0) * 1.5;
+    const vec2 texelSize = 1.0 / textureSize(sShadowMap, 0).xy * 1.5;
 
-    float combined = getShadowFactor(lightUVCoords, projCoords);
+    float combined = getShadowFactor(lightUVCoords, projCoords, cascade);
 
     for (int i = 0; i < 8; i++)
     {
         const vec2 uvOffset = vec2(cos(angle * i), sin(angle * i)) * texelSize.x;
-        combined += getShadowFactor(lightUVCoords + uvOffset, projCoords);
+        combined += getShadowFactor(lightUVCoords + uvOffset, projCoords, cascade);
     }
 
     return combined / 9.f;
 }
 
+float getCascadedShadow()
+{
+    const float viewDepth = (ubo.viewMatrix * vec4(inPositionWorld, 1.0)).z;
+    if (viewDepth > ubo.sunCascadeSplits[ubo.sunCascadeCount - 1])
+    {
+        return 1.0;
+    }
+
+    // the nearest cascade holding the fragment has the most texels per world unit
+    int cascade = 0;
+    while (cascade < ubo.sunCascadeCount - 1 && viewDepth > ubo.sunCascadeSplits[cascade])
+    {
+        cascade++;
+    }
+
+    const vec4 positionLightSpace = ubo.sunCascades[cascade] * vec4(inPositionWorld, 1.0);
+    return getPCFShadow(positionLightSpace.xyz / positionLightSpace.w, cascade);
+}
+
 vec3 getDiffuseLight(vec3 surfaceNormal)
 {
     // ambient light
@@ -91,8 +107,7 @@ vec3 getDiffuseLight(vec3 surfaceNormal)
     if (ubo.sun.color.w > 0)
     {
         const float cosAngIncidence = max(dot(surfaceNormal, -inSunDirectionTangent), 0.0);
-        const vec3 projCoords = inPositionLightSpace.xyz / inPositionLightSpace.w;
-        diffuseLight += ubo.sun.color.xyz * ubo.sun.color.w * min(getPCFShadow(projCoords), cosAngIncidence);
+        diffuseLight += ubo.sun.color.xyz * ubo.sun.color.w * min(getCascadedShadow(), cosAngIncidence);
     }
 
     return diffuseLight;
@@ -10,7 +10,6 @@ layout(location = 0) out vec3 outPositionWorld;
 layout(location = 1) out vec3 outNormalWorld;
 layout(location = 2) out vec3 outColor;
 layout(location = 3) out vec2 outUV;
-layout(location = 4) out vec4 outPositionLightSpace;
 
 layout(location = 5) out vec3 outSunDirectionTangent;
 layout(location = 6) out vec3 outCameraPositionTangent;
@@ -24,12 +23,6 @@ struct DirectionalLight
     vec4 direction;
 };
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo
 {
     mat4 projectionMatrix;
@@ -37,8 +30,8 @@ layout(set = 0, binding = 0) uniform GlobalUbo
     vec4 ambientLight;
     vec4 cameraPosition;
     DirectionalLight sun;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
 }
 ubo;
 
@@ -81,7 +74,6 @@ void main()
 
     outNormalWorld = normalize(mat3(push.normalMatrix) * inNormal);
     outPositionWorld = worldPosition.xyz;
-    outPositionLightSpace = ubo.sun.projectionMatrix * ubo.sun.viewMatrix * worldPosition;
     outColor = inColor;
 
     // if we have push.normalMatrix[2][3] != 0, then we should be using tiling uv mapping. otherwise it's regular uv
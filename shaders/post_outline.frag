@@ -8,6 +8,9 @@ layout(set = 2, binding = 0) uniform sampler2D sDepth;
 
 layout(location = 0) out vec4 outColor;
 
+// fused with a passthrough, what it would have shown: 0 color, 1 normals, 2 depth. -1 reads the chain's input
+layout(constant_id = 0) const int FUSED_SOURCE = -1;
+
 layout(push_constant) uniform Push
 {
     vec3 edgeColor;
@@ -82,6 +85,20 @@ bool isNormalEdge(vec2 uv, float threshold, float edgeThickness)
     return edgeFactor > threshold;
 }
 
+vec4 inputColor(vec2 uv)
+{
+    switch (FUSED_SOURCE)
+    {
+    case 1:
+        return vec4(((texture(sNormal, uv) + 1.0) / 2.0).rgb, 1.0);
+    case 2:
+        float depth = linearizedDepth(texture(sDepth, uv).r, push.nearPlane, push.farPlane);
+        return vec4(vec3((depth - push.nearPlane) / (push.farPlane - push.nearPlane)), 1.0);
+    default:
+        return vec4(texture(sColor, uv).rgb, 1.0);
+    }
+}
+
 void main()
 {
     const float depth = linearizedDepth(texture(sDepth, inUV, 1.).r, push.nearPlane, push.farPlane);
@@ -101,5 +118,5 @@ void main()
         return;
     }
 
-    discard;
+    outColor = inputColor(inUV);
 }
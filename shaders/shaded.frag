@@ -1,13 +1,13 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3 inPositionWorld;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormalWorld;
 layout(location = 3) in vec2 inUV;
-layout(location = 4) in vec4 inPositionLightSpace;
 
-layout(set = 1, binding = 0) uniform sampler2D sColor;
-layout(set = 2, binding = 0) uniform sampler2D sShadowMap;
+layout(set = 1, binding = 0) uniform sampler2D sTextures[];
+layout(set = 2, binding = 0) uniform sampler2DArray sShadowMap;
 
 layout(location = 0) out vec4 outColor;
 layout(location = 1) out vec4 outNormal;
@@ -22,8 +22,8 @@ struct DirectionalLight
 
 struct PointLight
 {
-    vec4 position;
-    vec4 color;
+    vec4 position; // w is the range
+    vec4 color;    // a is intensity
 };
 
 layout(set = 0, binding = 0) uniform GlobalUbo
@@ -33,63 +33,120 @@ layout(set = 0, binding = 0) uniform GlobalUbo
     vec4 ambientLight;
     vec4 cameraPosition;
     DirectionalLight sun;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
+    int sunCascadeCount;
+    vec4 sunCascadeSplits; // view space depth each cascade ends at
+    vec4 sunCascadeBiases;
+    mat4 sunCascades[4]; // projection * view
 }
 ubo;
 
-layout(push_constant) uniform Push
+// point lights assigned to froxels, each cluster lists the lights reaching it
+layout(std430, set = 0, binding = 1) readonly buffer ClusterBuffer
+{
+    uvec2 clusters[3456]; // offset into lightIndices, light count
+    PointLight pointLights[1024];
+    uint lightIndices[];
+}
+lights;
+
+layout(set = 3, binding = 0) uniform ObjectData
 {
     mat4 modelMatrix;
-    mat4 normalMatrix; // + color on last column
+    mat4 normalMatrix;
+    vec4 color;        // a is 0 when untextured
+    vec4 uvParameters; // offset, world space scale (0 for model uvs), rotation
 }
-push;
+object;
+
+// slots of the draw's textures in the bindless table
+layout(push_constant) uniform TextureIndices
+{
+    uvec4 indices;
+}
+textures;
 
 const float PI = 3.1415;
 const float two_PI = 6.2831;
 
-float getShadowFactor(vec2 inUV, vec3 projCoords)
+float getShadowFactor(vec2 inUV, vec3 projCoords, int cascade)
 {
-    float depth = texture(sShadowMap, inUV).r;
+    float depth = texture(sShadowMap, vec3(inUV, cascade)).r;
 
-    if (projCoords.z - depth < 0.025)
+    if (projCoords.z - depth < ubo.sunCascadeBiases[cascade])
     {
         return 1.0f;
     }
     return 0.f;
 }
 
-float getPCFShadow(vec3 projCoords)
+float getPCFShadow(vec3 projCoords, int cascade)
 {
     const float angle = two_PI / 8.f;
     const vec2 lightUVCoords = 0.5 * projCoords.xy + 0.5;
-    const vec2 texelSize = 1.0f / textureSize(sShadowMap, 0) * 1.5f;
+    const vec2 texelSize = 1.0f / textureSize(sShadowMap, 0).xy * 1.5f;
     ;
 
-    float combined = getShadowFactor(lightUVCoords, projCoords);
+    float combined = getShadowFactor(lightUVCoords, projCoords, cascade);
 
     for (int i = 0; i < 8; i++)
     {
         const vec2 uvOffset = vec2(cos(angle * i), sin(angle * i)) * texelSize.x;
-        combined += getShadowFactor(lightUVCoords + uvOffset, projCoords);
+        combined += getShadowFactor(lightUVCoords + uvOffset, projCoords, cascade);
     }
 
     return combined / 9.f;
 }
 
+float getCascadedShadow()
+{
+    const float viewDepth = (ubo.viewMatrix * vec4(inPositionWorld, 1.0)).z;
+    if (viewDepth > ubo.sunCascadeSplits[ubo.sunCascadeCount - 1])
+    {
+        return 1.0;
+    }
+
+    // the nearest cascade holding the fragment has the most texels per world unit
+    int cascade = 0;
+    while (cascade < ubo.sunCascadeCount - 1 && viewDepth > ubo.sunCascadeSplits[cascade])
+    {
+        cascade++;
+    }
+
+    const vec4 positionLightSpace = ubo.sunCascades[cascade] * vec4(inPositionWorld, 1.0);
+    return getPCFShadow(positionLightSpace.xyz / positionLightSpace.w, cascade);
+}
+
+uint getClusterIndex()
+{
+    const vec4 positionView = ubo.viewMatrix * vec4(inPositionWorld, 1.0);
+    const vec4 positionClip = ubo.projectionMatrix * positionView;
+
+    const vec2 tile = (positionClip.xy / positionClip.w * 0.5 + 0.5) * vec2(ubo.clusterGrid.xy);
+    const float slice = log(max(positionView.z, 1e-4)) * ubo.clusterDepth.x + ubo.clusterDepth.y;
+    const uvec3 cluster = uvec3(clamp(vec3(tile, slice), vec3(0.0), vec3(ubo.clusterGrid.xyz - 1u)));
+
+    return (cluster.z * ubo.clusterGrid.y + cluster.y) * ubo.clusterGrid.x + cluster.x;
+}
+
 vec3 getDiffuseLight()
 {
     // ambient light
     vec3 diffuseLight = ubo.ambientLight.xyz * ubo.ambientLight.w;
     vec3 surfaceNormal = normalize(inNormalWorld);
 
-    // point lights
-    for (int i = 0; i < ubo.numPointLights; i++)
+    // point lights, only those reaching this fragment's cluster
+    const uvec2 cluster = ubo.clusterGrid.w > 0 ? lights.clusters[getClusterIndex()] : uvec2(0);
+    for (uint i = 0; i < cluster.y; i++)
     {
-        PointLight light = ubo.pointLights[i];
+        PointLight light = lights.pointLights[lights.lightIndices[cluster.x + i]];
         vec3 directionToLight = light.position.xyz - inPositionWorld;
 
-        float attenuation = 1.0f / dot(directionToLight, directionToLight);
+        // fades out at the light's range so the clusters' cutoff doesn't show
+        const float distanceSquared = dot(directionToLight, directionToLight);
+        const float falloff = clamp(1.0 - pow(distanceSquared / (light.position.w * light.position.w), 2.0), 0.0, 1.0);
+        float attenuation = falloff * falloff / distanceSquared;
         vec3 intensity = light.color.xyz * light.color.w * attenuation;
 
         float cosAngIncidence = max(dot(surfaceNormal, -normalize(directionToLight)), 0.0f);
@@ -101,8 +158,7 @@ vec3 getDiffuseLight()
     if (ubo.sun.color.w > 0)
     {
         const float cosAngIncidence = max(dot(surfaceNormal, -ubo.sun.direction.xyz), 0.0f);
-        const vec3 projCoords = inPositionLightSpace.xyz / inPositionLightSpace.w;
-        diffuseLight += ubo.sun.color.xyz * ubo.sun.color.w * min(getPCFShadow(projCoords), cosAngIncidence);
+        diffuseLight += ubo.sun.color.xyz * ubo.sun.color.w * min(getCascadedShadow(), cosAngIncidence);
     }
 
     return diffuseLight;
@@ -112,14 +168,14 @@ void main()
 {
     vec3 diffuseLight = getDiffuseLight();
 
-    // if we have push.normalMatrix[3][3] != 100, then we should be using vertex color
-    if (push.normalMatrix[3][3] == 100)
+    // untextured materials use the vertex color
+    if (object.color.a == 0)
     {
-        outColor = vec4(diffuseLight * push.normalMatrix[3].xyz * inColor, 1.0f);
+        outColor = vec4(diffuseLight * object.color.xyz * inColor, 1.0f);
     }
     else
     {
-        outColor = vec4(diffuseLight * push.normalMatrix[3].xyz, 1.0f) * texture(sColor, inUV);
+        outColor = vec4(diffuseLight * object.color.xyz, 1.0f) * texture(sTextures[textures.indices.x], inUV);
     }
 
     outColor.a = 1.0f;
@@ -10,7 +10,6 @@ layout(location = 0) out vec3 outPositionWorld;
 layout(location = 1) out vec3 outColor;
 layout(location = 2) out vec3 outNormalWorld;
 layout(location = 3) out vec2 outUV;
-layout(location = 4) out vec4 outPositionLightSpace;
 
 struct DirectionalLight
 {
@@ -20,12 +19,6 @@ struct DirectionalLight
     vec4 direction;
 };
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo
 {
     mat4 projectionMatrix;
@@ -33,24 +26,26 @@ layout(set = 0, binding = 0) uniform GlobalUbo
     vec4 ambientLight;
     vec4 cameraPosition;
     DirectionalLight sun;
-    PointLight pointLights[10];
-    int numPointLights;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
 }
 ubo;
 
-layout(push_constant) uniform Push
+layout(set = 3, binding = 0) uniform ObjectData
 {
     mat4 modelMatrix;
     mat4 normalMatrix;
+    vec4 color;        // a is 0 when untextured
+    vec4 uvParameters; // offset, world space scale (0 for model uvs), rotation
 }
-push;
+object;
 
 vec2 getWorldSpaceUV()
 {
-    float scale = push.normalMatrix[2][3];
-    float theta = push.normalMatrix[3][3];
+    float scale = object.uvParameters.z;
+    float theta = object.uvParameters.w;
 
-    vec2 uvOffset = vec2(push.normalMatrix[0][3], push.normalMatrix[1][3]);
+    vec2 uvOffset = object.uvParameters.xy;
 
     mat2 rotationMatrix = mat2(cos(theta), -sin(theta), sin(theta), cos(theta));
 
@@ -63,18 +58,17 @@ vec2 getWorldSpaceUV()
 
 void main()
 {
-    vec4 worldPosition = push.modelMatrix * vec4(inPosition, 1.0f);
+    vec4 worldPosition = object.modelMatrix * vec4(inPosition, 1.0f);
     gl_Position = ubo.projectionMatrix * ubo.viewMatrix * worldPosition;
 
-    outNormalWorld = normalize(mat3(push.normalMatrix) * inNormal);
+    outNormalWorld = normalize(mat3(object.normalMatrix) * inNormal);
     outPositionWorld = worldPosition.xyz;
-    outPositionLightSpace = ubo.sun.projectionMatrix * ubo.sun.viewMatrix * worldPosition;
     outColor = inColor;
 
-    // if we have push.normalMatrix[2][3] != 0, then we should be using tiling uv mapping. otherwise it's regular uv
-    if (push.normalMatrix[2][3] == 0)
+    // a world space scale means tiling uv mapping, otherwise it's the model's uvs
+    if (object.uvParameters.z == 0)
     {
-        vec2 uvOffset = vec2(push.normalMatrix[0][3], push.normalMatrix[1][3]);
+        vec2 uvOffset = object.uvParameters.xy;
         vec2 adaptedUV = vec2(inUV.x, 1.0 - inUV.y);
 
         outUV = adaptedUV + uvOffset;
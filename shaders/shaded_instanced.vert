@@ -0,0 +1,83 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+layout(location = 4) in vec3 inTangent;
+layout(location = 5) in mat4 inModelMatrix;
+layout(location = 9) in mat4 inNormalMatrix;
+
+layout(location = 0) out vec3 outPositionWorld;
+layout(location = 1) out vec3 outColor;
+layout(location = 2) out vec3 outNormalWorld;
+layout(location = 3) out vec2 outUV;
+
+struct DirectionalLight
+{
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    vec4 color;
+    vec4 direction;
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo
+{
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    vec4 ambientLight;
+    vec4 cameraPosition;
+    DirectionalLight sun;
+    uvec4 clusterGrid; // x, y and z cluster counts, w the point light count
+    vec4 clusterDepth; // slice = log(view depth) * x + y
+}
+ubo;
+
+// matrices come from the instance stream, only the material parameters are used here
+layout(set = 3, binding = 0) uniform ObjectData
+{
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+    vec4 color;        // a is 0 when untextured
+    vec4 uvParameters; // offset, world space scale (0 for model uvs), rotation
+}
+object;
+
+vec2 getWorldSpaceUV()
+{
+    float scale = object.uvParameters.z;
+    float theta = object.uvParameters.w;
+
+    vec2 uvOffset = object.uvParameters.xy;
+
+    mat2 rotationMatrix = mat2(cos(theta), -sin(theta), sin(theta), cos(theta));
+
+    vec3 up = abs(outNormalWorld.z) > 0.999 ? vec3(1, 0, 0) : vec3(0, 0, 1);
+    vec3 tangent = normalize(cross(outNormalWorld, up));
+    vec3 bitangent = cross(outNormalWorld, tangent);
+
+    return rotationMatrix * (vec2(dot(outPositionWorld, tangent), dot(outPositionWorld, bitangent)) / scale + uvOffset);
+}
+
+void main()
+{
+    vec4 worldPosition = inModelMatrix * vec4(inPosition, 1.0f);
+    gl_Position = ubo.projectionMatrix * ubo.viewMatrix * worldPosition;
+
+    outNormalWorld = normalize(mat3(inNormalMatrix) * inNormal);
+    outPositionWorld = worldPosition.xyz;
+    outColor = inColor;
+
+    // a world space scale means tiling uv mapping, otherwise it's the model's uvs
+    if (object.uvParameters.z == 0)
+    {
+        vec2 uvOffset = object.uvParameters.xy;
+        vec2 adaptedUV = vec2(inUV.x, 1.0 - inUV.y);
+
+        outUV = adaptedUV + uvOffset;
+    }
+    else
+    {
+        outUV = getWorldSpaceUV();
+    }
+}